@@ -1,24 +1,108 @@
+#include <algorithm>
+#include <sys/mman.h>
+
 #include "buffer/buffer_pool_manager.h"
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager) {
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
+namespace {
+
+/**
+ * The atomic section open on a thread, with the frames and pages it holds over every pool instance
+ */
+struct AtomicSection {
+  int depth_{0};
+  std::vector<std::pair<BufferPoolManager *, frame_id_t>> frames_;
+  std::vector<std::pair<BufferPoolManager *, page_id_t>> freed_pages_;
+  bool has_record_{false};
+  LogRecord record_;
+  Transaction *txn_{nullptr};
+};
+
+thread_local AtomicSection atomic_section;
+
+}  // namespace
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, ReplacerType replacer_type,
+                                     LogManager *log_manager)
+        : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+  AllocateFrames();
+  if (log_manager_ != nullptr) {
+    shadows_ = new char[pool_size_ * PAGE_SIZE];
+  }
+  switch (replacer_type) {
+    case ReplacerType::kLRUK:
+      replacer_ = new LRUKReplacer(pool_size_);
+      break;
+    case ReplacerType::kClock:
+      replacer_ = new ClockReplacer(pool_size_);
+      break;
+    default:
+      replacer_ = new LRUReplacer(pool_size_);
+      break;
+  }
   for (size_t i = 0; i < pool_size_; i++) {
     free_list_.emplace_back(i);
   }
 }
 
+BufferPoolManager::BufferPoolManager(DiskManager *disk_manager, LogManager *log_manager)
+        : pool_size_(0), pages_(nullptr), frames_(nullptr), frames_size_(0), disk_manager_(disk_manager),
+          replacer_(nullptr), log_manager_(log_manager) {}
+
 BufferPoolManager::~BufferPoolManager() {
+  {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
+    shutdown_ = true;
+  }
+  prefetch_cv_.notify_all();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
   for (auto page: page_table_) {
     FlushPage(page.first);
   }
-  delete[] pages_;
+  FreeFrames();
+  delete[] shadows_;
   delete replacer_;
 }
 
+void BufferPoolManager::AllocateFrames() {
+  frames_size_ = pool_size_ * PAGE_SIZE;
+  frames_ = static_cast<char *>(MAP_FAILED);
+  if (BUFFER_POOL_HUGE_PAGES) {
+    // explicit huge pages need the size rounded up to the huge page size
+    frames_size_ = (frames_size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    frames_ = static_cast<char *>(mmap(nullptr, frames_size_, PROT_READ | PROT_WRITE,
+                                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0));
+  }
+  if (frames_ == MAP_FAILED) {
+    frames_ = static_cast<char *>(mmap(nullptr, frames_size_, PROT_READ | PROT_WRITE,
+                                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    ASSERT(frames_ != MAP_FAILED, "Failed to map buffer pool frames.");
+    if (BUFFER_POOL_HUGE_PAGES) {
+      // no reserved huge pages, fall back to transparent huge pages
+      madvise(frames_, frames_size_, MADV_HUGEPAGE);
+    }
+  }
+  // anonymous mappings are zero-filled, no need to reset the frames
+  pages_ = static_cast<Page *>(::operator new[](pool_size_ * sizeof(Page)));
+  for (size_t i = 0; i < pool_size_; i++) {
+    new(&pages_[i]) Page(frames_ + i * PAGE_SIZE);
+  }
+}
+
+void BufferPoolManager::FreeFrames() {
+  if (pages_ == nullptr) {
+    return;
+  }
+  for (size_t i = 0; i < pool_size_; i++) {
+    pages_[i].~Page();
+  }
+  ::operator delete[](pages_);
+  munmap(frames_, frames_size_);
+}
+
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
@@ -28,41 +112,38 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
   if(page_id == INVALID_PAGE_ID) return nullptr;
-  unordered_map<page_id_t, frame_id_t>::iterator iter = page_table_.find(page_id);
+  std::unique_lock<std::recursive_mutex> lock(latch_);
+  unordered_map<page_id_t, frame_id_t>::iterator iter = FindPage(lock, page_id);
   if( iter != page_table_.end() ) {
     replacer_->Pin(iter->second);
     pages_[iter->second].pin_count_++;
     return &pages_[iter->second];
   }
   frame_id_t allocated_frame_id;
-  Page *allocated_Page;
-  if( !free_list_.empty() ) {
-    allocated_frame_id = free_list_.front();
-    free_list_.pop_front();
-    allocated_Page = &pages_[allocated_frame_id];
-  }else{
-    if( replacer_->Victim(&allocated_frame_id) ) {
-      allocated_Page = &pages_[allocated_frame_id];
-      // if( allocated_Page->IsDirty() ) disk_manager_->WritePage(pages_[allocated_frame_id].page_id_ , pages_[allocated_frame_id].GetData());
-      // page_table_.erase(pages_[allocated_frame_id].page_id_);
-    }
-    else allocated_Page = nullptr;
-  }
-  if( allocated_Page ){
-    char page_data[PAGE_SIZE];
-    memset(page_data,0,PAGE_SIZE);
-    replacer_->Pin(allocated_frame_id);
-    // if(allocated_Page->page_id_==4 &&allocated_Page->IsDirty() ) cout<<"Write "<<allocated_Page->page_id_<<endl;
-    if(allocated_Page->is_dirty_) disk_manager_->WritePage(allocated_Page->page_id_,allocated_Page->GetData());
-    page_table_.erase(allocated_Page->page_id_);
-    allocated_Page->ResetMemory();
-    allocated_Page->page_id_ = page_id;
-    allocated_Page->pin_count_ = 1;
-    allocated_Page->is_dirty_ = false;
-    disk_manager_->ReadPage(allocated_Page->page_id_,page_data);
-    std::memcpy(allocated_Page->GetData(), page_data, PAGE_SIZE);
-    page_table_.insert(std::make_pair(page_id, allocated_frame_id));
+  if( !AcquireFrame(lock, allocated_frame_id) ) return nullptr;
+  // another thread may have read the page in while the victim was written back
+  iter = FindPage(lock, page_id);
+  if( iter != page_table_.end() ) {
+    pages_[allocated_frame_id].page_id_ = INVALID_PAGE_ID;
+    free_list_.emplace_front(allocated_frame_id);
+    replacer_->Pin(iter->second);
+    pages_[iter->second].pin_count_++;
+    return &pages_[iter->second];
   }
+  Page *allocated_Page = &pages_[allocated_frame_id];
+  allocated_Page->page_id_ = page_id;
+  allocated_Page->pin_count_ = 1;
+  allocated_Page->is_dirty_ = false;
+  page_table_.insert(std::make_pair(page_id, allocated_frame_id));
+  // read straight into the frame without the latch, FindPage makes other fetchers of the page wait for
+  // the data; the disk manager zero-fills anything past the end of file
+  io_frames_.insert(allocated_frame_id);
+  lock.unlock();
+  disk_manager_->ReadPage(allocated_Page->page_id_,allocated_Page->GetData());
+  lock.lock();
+  io_frames_.erase(allocated_frame_id);
+  if( shadows_ != nullptr ) memcpy(shadows_ + allocated_frame_id * PAGE_SIZE, allocated_Page->GetData(), PAGE_SIZE);
+  io_cv_.notify_all();
   return allocated_Page;
 }
 
@@ -72,64 +153,131 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
+  std::unique_lock<std::recursive_mutex> lock(latch_);
+  frame_id_t allocated_frame_id;
+  if( !AcquireFrame(lock, allocated_frame_id) ) return nullptr;
+  page_id = AllocatePage();
+  if( page_id == INVALID_PAGE_ID ) {
+    // disk is full, hand the frame back
+    pages_[allocated_frame_id].page_id_ = INVALID_PAGE_ID;
+    free_list_.emplace_front(allocated_frame_id);
+    return nullptr;
+  }
+  Page *allocated_Page = &pages_[allocated_frame_id];
+  allocated_Page->ResetMemory();
+  allocated_Page->page_id_ = page_id;
+  allocated_Page->pin_count_ = 1;
+  allocated_Page->is_dirty_ = false;
+  allocated_Page->is_new_ = true;
+  if( shadows_ != nullptr ) memset(shadows_ + allocated_frame_id * PAGE_SIZE, 0, PAGE_SIZE);
+  page_table_.insert(std::make_pair(page_id, allocated_frame_id));
+  return allocated_Page;
+}
+
+Page *BufferPoolManager::NewPageAt(page_id_t page_id) {
+  std::unique_lock<std::recursive_mutex> lock(latch_);
   frame_id_t allocated_frame_id;
-  Page *allocated_Page;
+  if( !AcquireFrame(lock, allocated_frame_id) ) return nullptr;
+  Page *allocated_Page = &pages_[allocated_frame_id];
+  allocated_Page->ResetMemory();
+  allocated_Page->page_id_ = page_id;
+  allocated_Page->pin_count_ = 1;
+  allocated_Page->is_dirty_ = false;
+  allocated_Page->is_new_ = true;
+  if( shadows_ != nullptr ) memset(shadows_ + allocated_frame_id * PAGE_SIZE, 0, PAGE_SIZE);
+  page_table_.insert(std::make_pair(page_id, allocated_frame_id));
+  return allocated_Page;
+}
+
+bool BufferPoolManager::AcquireFrame(std::unique_lock<std::recursive_mutex> &lock, frame_id_t &frame_id) {
   if( !free_list_.empty() ) {
-    allocated_frame_id = free_list_.front();
+    frame_id = free_list_.front();
     free_list_.pop_front();
-    allocated_Page = &pages_[allocated_frame_id];
-  }
-  else{
-    if( replacer_->Victim(&allocated_frame_id) ) { 
-      allocated_Page = &pages_[allocated_frame_id];
-      if( allocated_Page->IsDirty() ) disk_manager_->WritePage(pages_[allocated_frame_id].page_id_ , pages_[allocated_frame_id].GetData());
-      page_table_.erase(pages_[allocated_frame_id].page_id_);
-    }
-    else allocated_Page = nullptr;
+    replacer_->Pin(frame_id);
+    return true;
   }
-  if( allocated_Page ){
-    page_id = AllocatePage();
-    allocated_Page->ResetMemory();
-    allocated_Page->page_id_ = page_id;
-    allocated_Page->pin_count_ = 0;
-    allocated_Page->is_dirty_ = false;
-    page_table_.insert(std::make_pair(page_id, allocated_frame_id));
+  if( !replacer_->Victim(&frame_id) ) return false;
+  Page *victim = &pages_[frame_id];
+  if( victim->IsDirty() ) {
+    // the victim stays in the page table until it is on disk, FindPage makes its fetchers wait meanwhile
+    io_frames_.insert(frame_id);
+    WriteBack(frame_id, &lock);
+    io_frames_.erase(frame_id);
+    io_cv_.notify_all();
   }
-  return allocated_Page;
+  victim->is_dirty_ = false;
+  victim->last_lsn_ = INVALID_LSN;
+  victim->rec_lsn_ = INVALID_LSN;
+  victim->is_new_ = false;
+  page_table_.erase(victim->page_id_);
+  return true;
 }
 
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
-  // 1.   If P does not exist, return true.
+  // 1.   If P does not exist, deallocate it and return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  
-  unordered_map<page_id_t, frame_id_t>::iterator iter = page_table_.find(page_id);
-  if( iter == page_table_.end()) return true;
-  else{
-    if( pages_[iter->second].pin_count_ != 0) return false;
-    else{
-      DeallocatePage(page_id);
-      pages_[iter->second].ResetMemory();
-      pages_[iter->second].is_dirty_ = false;
-      pages_[iter->second].page_id_ = INVALID_PAGE_ID;
-      free_list_.emplace_back(iter->first);
-      page_table_.erase(page_id);
-      return true;
-    }
+  std::unique_lock<std::recursive_mutex> lock(latch_);
+  if( log_manager_ != nullptr && atomic_section.depth_ > 0 ) {
+    // the section may still hold a pin on the page, it is freed when the section is logged
+    atomic_section.freed_pages_.emplace_back(this, page_id);
+    return true;
   }
+  unordered_map<page_id_t, frame_id_t>::iterator iter = FindPage(lock, page_id);
+  if( iter != page_table_.end() && pages_[iter->second].pin_count_ != 0 ) return false;
+  if( log_manager_ != nullptr ) {
+    // the disk may show the page free only after the free is logged
+    LogRecord record(LogRecordType::kPageWrite);
+    record.AddFreedPage(page_id);
+    log_manager_->AppendLogRecord(record);
+  }
+  return FreePage(page_id);
+}
 
-  return false;
+bool BufferPoolManager::FreePage(page_id_t page_id) {
+  std::unique_lock<std::recursive_mutex> lock(latch_);
+  unordered_map<page_id_t, frame_id_t>::iterator iter = FindPage(lock, page_id);
+  if( iter != page_table_.end() ) {
+    if( pages_[iter->second].pin_count_ != 0 ) return false;
+    replacer_->Pin(iter->second);
+    pages_[iter->second].ResetMemory();
+    pages_[iter->second].is_dirty_ = false;
+    pages_[iter->second].last_lsn_ = INVALID_LSN;
+    pages_[iter->second].rec_lsn_ = INVALID_LSN;
+    pages_[iter->second].is_new_ = false;
+    pages_[iter->second].page_id_ = INVALID_PAGE_ID;
+    free_list_.emplace_back(iter->second);
+    page_table_.erase(iter);
+  }
+  DeallocatePage(page_id);
+  raw_pages_.erase(page_id);
+  return true;
 }
 
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   unordered_map<page_id_t, frame_id_t>::iterator iter = page_table_.find(page_id);
   if( iter != page_table_.end() ){
-    pages_[iter->second].is_dirty_ |= is_dirty;
-    if(pages_[iter->second].pin_count_ > 0) {
-      pages_[iter->second].pin_count_--;
-      if(pages_[iter->second].pin_count_ == 0) {
+    Page *page = &pages_[iter->second];
+    page->is_dirty_ |= is_dirty;
+    if(is_dirty && shadows_ != nullptr) {
+      if(atomic_section.depth_ > 0) {
+        auto &frames = atomic_section.frames_;
+        if(std::find(frames.begin(), frames.end(), std::make_pair(this, iter->second)) == frames.end()) {
+          // the section takes over the pin of the caller until the page is logged
+          page->section_count_++;
+          frames.emplace_back(this, iter->second);
+          return true;
+        }
+      } else {
+        LogChanges(iter->second);
+      }
+    }
+    if(page->pin_count_ > 0) {
+      page->pin_count_--;
+      if(page->pin_count_ == 0) {
         replacer_->Unpin(iter->second);
       }
     }
@@ -139,14 +287,359 @@ bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
 }
 
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  unordered_map<page_id_t, frame_id_t>::iterator iter = page_table_.find(page_id);
+  std::unique_lock<std::recursive_mutex> lock(latch_);
+  unordered_map<page_id_t, frame_id_t>::iterator iter = FindPage(lock, page_id);
   if( iter != page_table_.end() ){
-    disk_manager_->WritePage(page_id,pages_[iter->second].GetData());
+    FlushFrame(iter->second, lock);
     return true;
   }
   else return false;
 }
 
+void BufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  if (shutdown_) return;
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID && page_table_.find(page_id) == page_table_.end()) {
+      prefetch_queue_.push_back(page_id);
+    }
+  }
+  if (prefetch_queue_.empty()) return;
+  if (!prefetch_thread_.joinable()) {
+    prefetch_thread_ = std::thread(&BufferPoolManager::PrefetchWorker, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::PrefetchWorker() {
+  std::unique_lock<std::recursive_mutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return shutdown_ || !prefetch_queue_.empty(); });
+    if (shutdown_) return;
+    page_id_t page_id = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    if (page_table_.find(page_id) != page_table_.end()) continue;
+    frame_id_t frame_id;
+    // every frame is pinned, drop the hint rather than wait
+    if (!AcquireFrame(lock, frame_id)) continue;
+    // the page may have been read in while a victim was written back
+    if (page_table_.find(page_id) != page_table_.end()) {
+      pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+      free_list_.emplace_front(frame_id);
+      continue;
+    }
+    // keep the frame pinned while reading, FindPage makes fetchers of this page wait for the data
+    Page *page = &pages_[frame_id];
+    page->page_id_ = page_id;
+    page->pin_count_ = 1;
+    page->is_dirty_ = false;
+    page_table_.insert(std::make_pair(page_id, frame_id));
+    io_frames_.insert(frame_id);
+    lock.unlock();
+    disk_manager_->ReadPage(page_id, page->GetData());
+    lock.lock();
+    io_frames_.erase(frame_id);
+    if (shadows_ != nullptr) memcpy(shadows_ + frame_id * PAGE_SIZE, page->GetData(), PAGE_SIZE);
+    if (--page->pin_count_ == 0) {
+      replacer_->Unpin(frame_id);
+    }
+    io_cv_.notify_all();
+  }
+}
+
+unordered_map<page_id_t, frame_id_t>::iterator BufferPoolManager::FindPage(std::unique_lock<std::recursive_mutex> &lock,
+                                                                           page_id_t page_id) {
+  auto iter = page_table_.find(page_id);
+  while (iter != page_table_.end() && io_frames_.find(iter->second) != io_frames_.end()) {
+    io_cv_.wait(lock);
+    // the page may have been evicted again before this thread woke up
+    iter = page_table_.find(page_id);
+  }
+  return iter;
+}
+
+void BufferPoolManager::MarkRawPage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  raw_pages_.insert(page_id);
+}
+
+void BufferPoolManager::LogChanges(frame_id_t frame_id) {
+  if (pages_[frame_id].section_count_ > 0) {
+    return;
+  }
+  LogRecord record(LogRecordType::kPageWrite);
+  if (!CollectChanges(frame_id, record)) {
+    return;
+  }
+  uint64_t offset;
+  lsn_t lsn = log_manager_->AppendLogRecord(record, &offset);
+  StampChanges(frame_id, lsn, offset);
+}
+
+bool BufferPoolManager::CollectChanges(frame_id_t frame_id, LogRecord &record) {
+  Page *page = &pages_[frame_id];
+  char *data = page->GetData();
+  char *shadow = shadows_ + frame_id * PAGE_SIZE;
+  bool lsn_slot = raw_pages_.find(page->page_id_) == raw_pages_.end();
+  if (lsn_slot) {
+    // the slot is rewritten with the LSN of the record anyway
+    memcpy(shadow + Page::OFFSET_LSN, data + Page::OFFSET_LSN, sizeof(lsn_t));
+  }
+  // compare a word at a time, every run of changed words becomes one run of the record
+  static constexpr size_t WORD_SIZE = sizeof(uint64_t);
+  auto *words = reinterpret_cast<const uint64_t *>(data);
+  auto *shadow_words = reinterpret_cast<const uint64_t *>(shadow);
+  std::vector<std::pair<size_t, size_t>> runs;
+  size_t i = 0;
+  while (i < PAGE_SIZE / WORD_SIZE) {
+    if (words[i] == shadow_words[i]) {
+      i++;
+      continue;
+    }
+    size_t begin = i;
+    while (i < PAGE_SIZE / WORD_SIZE && words[i] != shadow_words[i]) {
+      i++;
+    }
+    runs.emplace_back(begin * WORD_SIZE, (i - begin) * WORD_SIZE);
+  }
+  // a new page is logged even if it is still all zeros, redo must not keep what the disk holds
+  if (runs.empty() && !page->is_new_) {
+    return false;
+  }
+  record.AddPage(page->page_id_, lsn_slot, page->is_new_);
+  for (auto &run : runs) {
+    record.AddRun(run.first, data + run.first, run.second);
+    memcpy(shadow + run.first, data + run.first, run.second);
+  }
+  if (page->rec_lsn_ == INVALID_LSN) {
+    // the record is appended after this, so the next LSN is a safe bound until it is stamped
+    log_manager_->GetAppendPosition(page->rec_lsn_, page->rec_offset_);
+  }
+  page->is_new_ = false;
+  return true;
+}
+
+void BufferPoolManager::StampChanges(frame_id_t frame_id, lsn_t lsn, uint64_t offset) {
+  Page *page = &pages_[frame_id];
+  page->last_lsn_ = lsn;
+  if (page->rec_lsn_ == INVALID_LSN) {
+    page->rec_lsn_ = lsn;
+    page->rec_offset_ = offset;
+  }
+  if (raw_pages_.find(page->page_id_) == raw_pages_.end()) {
+    page->SetLSN(lsn);
+    memcpy(shadows_ + frame_id * PAGE_SIZE + Page::OFFSET_LSN, page->GetData() + Page::OFFSET_LSN, sizeof(lsn_t));
+  }
+}
+
+void BufferPoolManager::WriteBack(frame_id_t frame_id, std::unique_lock<std::recursive_mutex> *lock) {
+  Page *page = &pages_[frame_id];
+  lsn_t last_lsn = INVALID_LSN;
+  if (log_manager_ != nullptr) {
+    if (page->section_count_ > 0) {
+      // the changes are not logged yet, the page is written once the section ends
+      return;
+    }
+    // changes made without unpinning the page dirty are logged here at the latest
+    LogChanges(frame_id);
+    last_lsn = page->last_lsn_;
+  }
+  // cleared up front, a pinned page dirtied again while the latch is released stays dirty
+  page->is_dirty_ = false;
+  lsn_t rec_lsn = page->rec_lsn_;
+  if (lock != nullptr) {
+    lock->unlock();
+  }
+  if (log_manager_ != nullptr && last_lsn > log_manager_->GetPersistentLSN()) {
+    log_manager_->Flush(last_lsn);
+  }
+  disk_manager_->WritePage(page->page_id_, page->GetData());
+  if (lock != nullptr) {
+    lock->lock();
+  }
+  // the page stays in the dirty page table until it is on disk, unless it was changed meanwhile
+  if (page->rec_lsn_ == rec_lsn && page->last_lsn_ == last_lsn) {
+    page->rec_lsn_ = INVALID_LSN;
+  }
+}
+
+void BufferPoolManager::FlushFrame(frame_id_t frame_id, std::unique_lock<std::recursive_mutex> &lock) {
+  // pinned for the write so it is not chosen as a victim, FindPage makes its fetchers wait
+  Page *page = &pages_[frame_id];
+  if (page->pin_count_++ == 0) {
+    replacer_->Pin(frame_id);
+  }
+  io_frames_.insert(frame_id);
+  WriteBack(frame_id, &lock);
+  io_frames_.erase(frame_id);
+  if (--page->pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
+  }
+  io_cv_.notify_all();
+}
+
+void BufferPoolManager::BeginAtomic() {
+  if (log_manager_ == nullptr) {
+    return;
+  }
+  atomic_section.depth_++;
+}
+
+lsn_t BufferPoolManager::EndAtomic(Transaction *txn, const LogRecord *record) {
+  if (log_manager_ == nullptr) {
+    return INVALID_LSN;
+  }
+  AtomicSection &section = atomic_section;
+  ASSERT(section.depth_ > 0, "No atomic section to end.");
+  if (record != nullptr) {
+    ASSERT(!section.has_record_, "An atomic section holds one logical record.");
+    section.record_ = *record;
+    section.has_record_ = true;
+    section.txn_ = txn;
+  } else if (txn != nullptr) {
+    section.txn_ = txn;
+  }
+  if (--section.depth_ > 0) {
+    return INVALID_LSN;
+  }
+  LogRecord log_record = section.has_record_ ? std::move(section.record_) : LogRecord(LogRecordType::kPageWrite);
+  txn = section.txn_;
+  std::vector<std::pair<BufferPoolManager *, frame_id_t>> frames;
+  std::vector<std::pair<BufferPoolManager *, page_id_t>> freed_pages;
+  frames.swap(section.frames_);
+  freed_pages.swap(section.freed_pages_);
+  bool has_record = section.has_record_;
+  section.has_record_ = false;
+  section.txn_ = nullptr;
+
+  std::vector<char> changed(frames.size(), false);
+  for (size_t i = 0; i < frames.size(); i++) {
+    std::scoped_lock<std::recursive_mutex> lock(frames[i].first->latch_);
+    changed[i] = frames[i].first->CollectChanges(frames[i].second, log_record);
+  }
+  for (auto &freed_page : freed_pages) {
+    log_record.AddFreedPage(freed_page.second);
+  }
+  lsn_t lsn = INVALID_LSN;
+  uint64_t offset = 0;
+  if (has_record || log_record.GetPageCount() > 0) {
+    if (txn != nullptr) {
+      log_record.SetTxnId(txn->GetTxnId());
+      log_record.SetPrevLSN(txn->GetPrevLSN());
+    }
+    lsn = log_manager_->AppendLogRecord(log_record, &offset);
+    if (txn != nullptr) {
+      txn->SetPrevLSN(lsn);
+    }
+  }
+  // hand the pins taken over by the section back
+  for (size_t i = 0; i < frames.size(); i++) {
+    BufferPoolManager *bpm = frames[i].first;
+    std::scoped_lock<std::recursive_mutex> lock(bpm->latch_);
+    Page *page = &bpm->pages_[frames[i].second];
+    if (changed[i]) {
+      bpm->StampChanges(frames[i].second, lsn, offset);
+    }
+    page->section_count_--;
+    if (page->pin_count_ > 0 && --page->pin_count_ == 0) {
+      bpm->replacer_->Unpin(frames[i].second);
+    }
+  }
+  for (auto &freed_page : freed_pages) {
+    if (!freed_page.first->FreePage(freed_page.second)) {
+      LOG(WARNING) << "Page " << freed_page.second << " deleted while pinned, it is not freed";
+    }
+  }
+  return lsn;
+}
+
+void BufferPoolManager::GetDirtyPages(std::vector<DirtyPage> &dirty_pages) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  for (auto &entry : page_table_) {
+    Page *page = &pages_[entry.second];
+    if (page->rec_lsn_ != INVALID_LSN) {
+      dirty_pages.push_back(DirtyPage{entry.first, page->rec_lsn_, page->rec_offset_});
+    }
+  }
+}
+
+void BufferPoolManager::FlushOldPages(lsn_t lsn) {
+  std::vector<page_id_t> page_ids;
+  {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
+    for (auto &entry : page_table_) {
+      Page *page = &pages_[entry.second];
+      if (page->rec_lsn_ != INVALID_LSN && page->rec_lsn_ < lsn && page->pin_count_ == 0) {
+        page_ids.push_back(entry.first);
+      }
+    }
+  }
+  // take the latch page by page, the writes must not hold up everyone else
+  std::unique_lock<std::recursive_mutex> lock(latch_);
+  for (auto page_id : page_ids) {
+    auto iter = page_table_.find(page_id);
+    if (iter == page_table_.end()) continue;
+    Page *page = &pages_[iter->second];
+    if (page->rec_lsn_ != INVALID_LSN && page->rec_lsn_ < lsn && page->pin_count_ == 0 &&
+        io_frames_.find(iter->second) == io_frames_.end()) {
+      FlushFrame(iter->second, lock);
+    }
+  }
+}
+
+void BufferPoolManager::FlushAllPages() {
+  std::unique_lock<std::recursive_mutex> lock(latch_);
+  // the latch is released during each write, walk a copy of the page table
+  std::vector<page_id_t> page_ids;
+  for (auto &entry : page_table_) {
+    page_ids.push_back(entry.first);
+  }
+  for (auto page_id : page_ids) {
+    auto iter = page_table_.find(page_id);
+    if (iter == page_table_.end()) continue;
+    if (pages_[iter->second].is_dirty_ && io_frames_.find(iter->second) == io_frames_.end()) {
+      FlushFrame(iter->second, lock);
+    }
+  }
+}
+
+void BufferPoolManager::RedoPageWrite(const LogRecord &record, uint32_t index, uint64_t offset) {
+  page_id_t page_id = record.GetPageId(index);
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  if (record.IsFreedPage(index)) {
+    FreePage(page_id);
+    return;
+  }
+  // pages allocated after the last checkpoint may be free in the bitmaps on disk
+  disk_manager_->AllocatePageAt(page_id);
+  Page *page = FetchPage(page_id);
+  ASSERT(page != nullptr, "Buffer pool full during recovery.");
+  frame_id_t frame_id = page_table_[page_id];
+  // a new page is redone anyway, the slot on disk may hold data of a raw page freed before
+  bool done = record.HasLSNSlot(index) && !record.IsNewPage(index) && page->GetLSN() >= record.GetLSN();
+  if (!done) {
+    record.ApplyTo(index, page->GetData());
+    if (shadows_ != nullptr) {
+      memcpy(shadows_ + frame_id * PAGE_SIZE, page->GetData(), PAGE_SIZE);
+    }
+    if (record.HasLSNSlot(index)) {
+      raw_pages_.erase(page_id);
+    } else {
+      raw_pages_.insert(page_id);
+    }
+    page->is_dirty_ = true;
+    page->last_lsn_ = record.GetLSN();
+    if (page->rec_lsn_ == INVALID_LSN) {
+      page->rec_lsn_ = record.GetLSN();
+      page->rec_offset_ = offset;
+    }
+  }
+  // unpin without logging, the change is in the log already
+  if (--page->pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
+  }
+}
+
 page_id_t BufferPoolManager::AllocatePage() {
   int next_page_id = disk_manager_->AllocatePage();
   return next_page_id;
@@ -162,9 +655,11 @@ bool BufferPoolManager::IsPageFree(page_id_t page_id) {
 
 // Only used for debug
 bool BufferPoolManager::CheckAllUnpinned() {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   bool res = true;
   for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].pin_count_ != 0) {
+    // a frame still being prefetched is pinned by the pool itself, not by a caller
+    if (pages_[i].pin_count_ != 0 && io_frames_.find(i) == io_frames_.end()) {
       res = false;
       LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
     }
@@ -0,0 +1,48 @@
+#include "buffer/clock_replacer.h"
+
+ClockReplacer::ClockReplacer(size_t num_pages)
+        : in_replacer_(num_pages, false), ref_bit_(num_pages, false) {}
+
+ClockReplacer::~ClockReplacer() = default;
+
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  if (size_ == 0) {
+    return false;
+  }
+  // at most two sweeps: the first one may only clear reference bits
+  size_t num_pages = in_replacer_.size();
+  while (true) {
+    size_t cur = hand_;
+    hand_ = (hand_ + 1) % num_pages;
+    if (!in_replacer_[cur]) {
+      continue;
+    }
+    if (ref_bit_[cur]) {
+      ref_bit_[cur] = false;
+      continue;
+    }
+    in_replacer_[cur] = false;
+    size_--;
+    *frame_id = static_cast<frame_id_t>(cur);
+    return true;
+  }
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) < in_replacer_.size() && in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = false;
+    size_--;
+  }
+}
+
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  ref_bit_[frame_id] = true;
+  if (!in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = true;
+    size_++;
+  }
+}
+
+size_t ClockReplacer::Size() {
+  return size_;
+}
@@ -0,0 +1,48 @@
+#include "buffer/lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+        : k_(k), history_(num_pages), evictable_(num_pages, false) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  if (evict_set_.empty()) {
+    return false;
+  }
+  *frame_id = evict_set_.begin()->second;
+  evict_set_.erase(evict_set_.begin());
+  evictable_[*frame_id] = false;
+  // the frame will hold another page, its history no longer applies
+  history_[*frame_id].clear();
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  if (evictable_[frame_id]) {
+    evict_set_.erase(std::make_pair(GetEvictKey(frame_id), frame_id));
+    evictable_[frame_id] = false;
+  }
+  auto &history = history_[frame_id];
+  history.push_back(current_timestamp_++);
+  if (history.size() > k_) {
+    history.pop_front();
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  if (evictable_[frame_id]) {
+    return;
+  }
+  evict_set_.emplace(GetEvictKey(frame_id), frame_id);
+  evictable_[frame_id] = true;
+}
+
+size_t LRUKReplacer::Size() {
+  return evict_set_.size();
+}
+
+LRUKReplacer::EvictKey LRUKReplacer::GetEvictKey(frame_id_t frame_id) const {
+  const auto &history = history_[frame_id];
+  // history holds at most K accesses, so its front is the K-th most recent one once full
+  return std::make_pair(history.size() >= k_, history.empty() ? 0 : history.front());
+}
@@ -1,35 +1,49 @@
 #include "buffer/lru_replacer.h"
 
-LRUReplacer::LRUReplacer(size_t num_pages) {
-  max_supported_list_size = num_pages;
+LRUReplacer::LRUReplacer(size_t num_pages)
+        : prev_(num_pages + 1), next_(num_pages + 1), in_list_(num_pages, false),
+          head_(static_cast<frame_id_t>(num_pages)), size_(0) {
+  prev_[head_] = head_;
+  next_[head_] = head_;
 }
 
 LRUReplacer::~LRUReplacer() = default;
 
 bool LRUReplacer::Victim(frame_id_t *frame_id) {
-  if( !lru_list.empty() ){
-    *frame_id = lru_list.back();
-    lru_list.pop_back();
-    return true;
+  if (size_ == 0) {
+    return false;
   }
-  return false;
+  // least recently unpinned frame sits at the tail
+  *frame_id = prev_[head_];
+  Unlink(*frame_id);
+  return true;
 }
 
 void LRUReplacer::Pin(frame_id_t frame_id) {
-  vector<int>::iterator it = find(lru_list.begin(),lru_list.end(),frame_id);
-  if( it != lru_list.end() ) lru_list.erase(it);
+  if (static_cast<size_t>(frame_id) < in_list_.size() && in_list_[frame_id]) {
+    Unlink(frame_id);
+  }
 }
 
 void LRUReplacer::Unpin(frame_id_t frame_id) {
-  vector<int>::iterator it = find(lru_list.begin(),lru_list.end(),frame_id);
-  if( it == lru_list.end() )
-  {  //not in list
-    if( Size() == max_supported_list_size ) //if the list is full
-      lru_list.pop_back();
-    lru_list.insert(lru_list.begin(),frame_id);
+  if (in_list_[frame_id]) {
+    return;
   }
+  prev_[frame_id] = head_;
+  next_[frame_id] = next_[head_];
+  prev_[next_[head_]] = frame_id;
+  next_[head_] = frame_id;
+  in_list_[frame_id] = true;
+  size_++;
 }
 
 size_t LRUReplacer::Size() {
-  return (size_t)lru_list.size();
-}
\ No newline at end of file
+  return size_;
+}
+
+void LRUReplacer::Unlink(frame_id_t frame_id) {
+  next_[prev_[frame_id]] = next_[frame_id];
+  prev_[next_[frame_id]] = prev_[frame_id];
+  in_list_[frame_id] = false;
+  size_--;
+}
@@ -0,0 +1,99 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, ReplacerType replacer_type,
+                                                     LogManager *log_manager)
+        : BufferPoolManager(disk_manager, log_manager) {
+  ASSERT(num_instances > 0, "Parallel buffer pool needs at least one instance.");
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.push_back(new BufferPoolManager(pool_size, disk_manager, replacer_type, log_manager));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) return nullptr;
+  return GetInstance(page_id)->FetchPage(page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  if (page_id == INVALID_PAGE_ID) return false;
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) return false;
+  return GetInstance(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id) {
+  // the disk decides the page id, which in turn decides the instance that must host it
+  page_id = disk_manager_->AllocatePage();
+  if (page_id == INVALID_PAGE_ID) return nullptr;
+  Page *page = GetInstance(page_id)->NewPageAt(page_id);
+  if (page == nullptr) {
+    disk_manager_->DeAllocatePage(page_id);
+    page_id = INVALID_PAGE_ID;
+  }
+  return page;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) return true;
+  return GetInstance(page_id)->DeletePage(page_id);
+}
+
+bool ParallelBufferPoolManager::CheckAllUnpinned() {
+  bool res = true;
+  for (auto instance : instances_) {
+    res &= instance->CheckAllUnpinned();
+  }
+  return res;
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  // every instance has its own I/O thread, hand each one its own pages
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      instance_page_ids[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!instance_page_ids[i].empty()) {
+      instances_[i]->PrefetchPages(instance_page_ids[i]);
+    }
+  }
+}
+
+void ParallelBufferPoolManager::MarkRawPage(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) return;
+  GetInstance(page_id)->MarkRawPage(page_id);
+}
+
+void ParallelBufferPoolManager::GetDirtyPages(std::vector<DirtyPage> &dirty_pages) {
+  for (auto instance : instances_) {
+    instance->GetDirtyPages(dirty_pages);
+  }
+}
+
+void ParallelBufferPoolManager::FlushOldPages(lsn_t lsn) {
+  for (auto instance : instances_) {
+    instance->FlushOldPages(lsn);
+  }
+}
+
+void ParallelBufferPoolManager::FlushAllPages() {
+  for (auto instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+void ParallelBufferPoolManager::RedoPageWrite(const LogRecord &record, uint32_t index, uint64_t offset) {
+  GetInstance(record.GetPageId(index))->RedoPageWrite(record, index, offset);
+}
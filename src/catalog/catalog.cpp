@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <thread>
+
 #include "catalog/catalog.h"
+#include "page/index_roots_page.h"
 #include<iostream>
 
 void CatalogMeta::SerializeTo(char *buf) const {
@@ -70,9 +74,9 @@ CatalogMeta::CatalogMeta() {}
 
 
 CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
-                               LogManager *log_manager, bool init)
+                               LogManager *log_manager, bool init, VersionStore *version_store)
         : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager),
-          log_manager_(log_manager), heap_(new SimpleMemHeap()) {
+          log_manager_(log_manager), version_store_(version_store), heap_(new SimpleMemHeap()) {
   if(init){
     catalog_meta_ = CatalogMeta::NewInstance(heap_);
     next_index_id_ = 0;
@@ -97,15 +101,15 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
 
     for(auto it=catalog_meta_->index_meta_pages_.begin();it != catalog_meta_->index_meta_pages_.end();it++){
       LoadIndex(it->first,it->second);
-      index_max_id = it->first > table_max_id ? it->first:table_max_id; //记录最大id
+      index_max_id = it->first > index_max_id ? it->first:index_max_id; //记录最大id
     }
     next_index_id_ = index_max_id + 1;
   }
 }
 
 CatalogManager::~CatalogManager() {
-  delete heap_;
   FlushCatalogMetaPage();
+  delete heap_;
 }
 
 dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema,
@@ -116,15 +120,23 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   table_info = TableInfo::Create(heap_);
   page_id_t meta_page_id;
   Page *meta_page;
+  //heap、meta页和catalog meta一起记一条日志，DDL不属于事务
+  buffer_pool_manager_->BeginAtomic();
   TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_,schema,txn,log_manager_,lock_manager_,heap_);
+  table_heap->SetVersionStore(version_store_);
   
 
   meta_page = buffer_pool_manager_->NewPage(meta_page_id);
-  TableMetadata *table_meta = TableMetadata::Create(next_table_id_,table_name,table_heap->GetFirstPageId(),schema,heap_);
+  buffer_pool_manager_->MarkRawPage(meta_page_id);
+  TableMetadata *table_meta = TableMetadata::Create(next_table_id_,table_name,table_heap->GetFirstPageId(),
+                                                    table_heap->GetFirstFreeSpaceMapPageId(),schema,heap_);
   
   table_meta->SerializeTo(meta_page->GetData());
+  buffer_pool_manager_->UnpinPage(meta_page_id, true);
 
   catalog_meta_->table_meta_pages_.insert(std::make_pair((table_id_t)next_table_id_,meta_page_id));
+  FlushCatalogMetaPage();
+  EndDDL();
 
   table_info->Init(table_meta,table_heap);
   table_names_.insert(std::make_pair(table_name,(table_id_t)next_table_id_));
@@ -166,6 +178,11 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
       return DB_COLUMN_NAME_NOT_EXIST;
     key_map.push_back(index_tmp);
   }
+  //编码后的键放不进最大的GenericKey时会被截断，不同的键会变得相等
+  if(KeyEncoder::GetMaxEncodedSize(table_info->GetSchema(),key_map) > MAX_INDEX_KEY_SIZE){
+    std::cerr << "Index key longer than " << MAX_INDEX_KEY_SIZE << " bytes" << std::endl;
+    return DB_FAILED;
+  }
   if(index_names_.find(table_name)==index_names_.end()){ //假设该表未存在索引
     std::unordered_map<std::string, index_id_t> tmp;
     tmp.insert(std::make_pair(index_name,(index_id_t)next_index_id_));
@@ -175,54 +192,145 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
   }
   indexes_.insert(std::make_pair((index_id_t)next_index_id_,index_info));
 
+  buffer_pool_manager_->BeginAtomic();
   meta_page = buffer_pool_manager_->NewPage(meta_page_id);
+  buffer_pool_manager_->MarkRawPage(meta_page_id);
   IndexMetadata *index_metadata = IndexMetadata::Create(next_index_id_,index_name,table_names_.find(table_name)->second,key_map,heap_);
   index_metadata->SerializeTo(meta_page->GetData());
-
-  catalog_meta_->index_meta_pages_.insert(std::make_pair((index_id_t)next_index_id_,meta_page_id));
+  buffer_pool_manager_->UnpinPage(meta_page_id, true);
+  //崩溃前没建完的同id索引可能还留着根，先删掉
+  auto roots_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  bool stale = roots_page->Delete(next_index_id_);
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, stale);
   index_info->Init(index_metadata,table_info,buffer_pool_manager_);
+  buffer_pool_manager_->EndAtomic();
   next_index_id_++;
 
-  [[maybe_unused]] Index *index = index_info->GetIndex();
-  [[maybe_unused]] Schema *schema = table_info->GetSchema();
-  // auto keyt = table_info->GetTableHeap()->Begin(txn);
-  // auto keyt2 = table_info->GetTableHeap()->End();
-  [[maybe_unused]] dberr_t status;
-  for (auto tuple = table_info->GetTableHeap()->Begin(txn); tuple != table_info->GetTableHeap()->End(); tuple++) {
-    // LOG(INFO) << 1;
-    IndexSchema *indSchema = index_info->GetIndexKeySchema();
-    std::vector<int> indexColumns;
-    indexColumns.clear();
-    for (int i = 0; i < (int)indSchema->GetColumnCount(); ++i) {
-      uint32_t ind = 0;
-      if((status = schema->GetColumnIndex(indSchema->GetColumn(i)->GetName(), ind)) != DB_SUCCESS) {
-        return status;
-      }
-      indexColumns.push_back(ind);
+  //建索引的页太多，不能放在一条日志里；索引建好后才登记到catalog meta，崩溃时只漏掉一些页
+  if (PopulateIndex(index_info, nullptr) != DB_SUCCESS) {
+    std::cerr << "Duplicate key" << std::endl;
+    DropIndex(table_name, index_name);
+    return DB_FAILED;
+  }
+  buffer_pool_manager_->BeginAtomic();
+  catalog_meta_->index_meta_pages_.insert(std::make_pair(index_metadata->GetIndexId(),meta_page_id));
+  FlushCatalogMetaPage();
+  EndDDL();
+  return DB_SUCCESS;
+}
+
+dberr_t CatalogManager::PopulateIndex(IndexInfo *index_info, Transaction *txn) {
+  TableHeap *table_heap = index_info->GetTableInfo()->GetTableHeap();
+  const std::vector<page_id_t> page_ids = table_heap->GetPageIds();
+  const std::vector<uint32_t> &key_map = index_info->GetKeyMapping();
+  // every worker scans a contiguous part of the pages, a page holds at least as many rows as fit at full length
+  size_t row_size = 0;
+  for (auto column : index_info->GetTableInfo()->GetSchema()->GetColumns()) {
+    row_size += column->GetLength();
+  }
+  size_t rows_per_page = std::max<size_t>(1, PAGE_SIZE / std::max<size_t>(1, row_size));
+  size_t partition_count = GetBuildPartitionCount(page_ids.size(),
+                                                  (INDEX_BUILD_MIN_ROWS + rows_per_page - 1) / rows_per_page);
+  return index_info->GetIndex()->BulkLoad(partition_count, [&](size_t partition, const Index::EntrySink &sink) {
+    std::vector<Field> fields;
+    for (size_t i = page_ids.size() * partition / partition_count;
+         i < page_ids.size() * (partition + 1) / partition_count; i++) {
+      bool fetched = table_heap->ScanPage(page_ids[i], [&](const Row &row) {
+        fields.clear();
+        for (auto column : key_map) {
+          fields.emplace_back(*row.GetField(column));
+        }
+        Row key(fields);
+        sink(key, row.GetRowId());
+      }, txn);
+      if (!fetched) return false;
     }
-    std::vector<Field> key;
+    return true;
+  }, txn);
+}
+
+size_t CatalogManager::GetBuildPartitionCount(size_t items, size_t min_items) {
+  size_t workers = std::max(1u, std::thread::hardware_concurrency());
+  return std::max<size_t>(1, std::min(workers, items / std::max<size_t>(1, min_items)));
+}
+
+void CatalogManager::ReadKeys(IndexInfo *index_info, const std::vector<RowId> &rids, std::vector<Row> &keys,
+                              Transaction *txn) {
+  TableHeap *table_heap = index_info->GetTableInfo()->GetTableHeap();
+  std::vector<Field> key;
+  keys.clear();
+  keys.reserve(rids.size());
+  for (auto &rid : rids) {
+    Row row(rid);
+    table_heap->GetTuple(&row, txn);
     key.clear();
-    for (int i = 0; i < (int)indSchema->GetColumnCount(); ++i) {
-      key.push_back(*(tuple->GetField(indexColumns[i])));
+    for (auto column : index_info->GetKeyMapping()) {
+      key.emplace_back(*row.GetField(column));
     }
-    Row keyRow(key);
-    //
-    RowId rid = tuple->GetRowId();
-    // std::vector<Field> row;
-    // for (int i = 0; i < (int)key_map.size(); ++i) {
-    //   row.push_back(*(key->GetField(key_map[i])));
-    // }
-    // Row keyRow(row);
-    keyRow.SetRowId(rid);
-    // LOG(INFO) << "rid: " << rid.GetPageId();
-    if (index->InsertEntry(keyRow, rid, txn) != DB_SUCCESS) {
-      // LOG(ERROR) << "InsertEntry failed";
+    keys.emplace_back(key);
+    keys.back().SetRowId(rid);
+  }
+}
+
+dberr_t CatalogManager::CopyFrom(const std::string &table_name, const std::string &path, Transaction *txn,
+                                 uint64_t &row_count) {
+  row_count = 0;
+  TableInfo *table_info = nullptr;
+  if (GetTable(table_name, table_info) != DB_SUCCESS) return DB_TABLE_NOT_EXIST;
+  TableHeap *table_heap = table_info->GetTableHeap();
+  std::vector<RowId> rids;
+  std::string error;
+  if (!table_heap->CopyFrom(path, rids, error, txn)) {
+    std::cerr << error << std::endl;
+    return DB_FAILED;
+  }
+  std::vector<IndexInfo *> indexes;
+  GetTableIndexes(table_name, indexes);
+  for (size_t i = 0; i < indexes.size(); i++) {
+    Index *index = indexes[i]->GetIndex();
+    std::vector<Row> keys;
+    ReadKeys(indexes[i], rids, keys, txn);
+    std::vector<size_t> order;
+    size_t inserted = 0;
+    bool built;
+    if (index->IsEmpty()) {
+      // nothing to merge with, so the tree is built bottom up, a failed build leaves it empty
+      size_t partition_count = GetBuildPartitionCount(keys.size(), INDEX_BUILD_MIN_ROWS);
+      built = index->BulkLoad(partition_count, [&](size_t partition, const Index::EntrySink &sink) {
+        for (size_t k = keys.size() * partition / partition_count; k < keys.size() * (partition + 1) / partition_count;
+             k++) {
+          sink(keys[k], rids[k]);
+        }
+        return true;
+      }, txn) == DB_SUCCESS;
+    } else {
+      order = Index::SortKeys(keys);
+      while (inserted < order.size() &&
+             index->InsertEntry(keys[order[inserted]], rids[order[inserted]], txn) == DB_SUCCESS) {
+        inserted++;
+      }
+      built = inserted == order.size();
+    }
+    if (!built) {
       std::cerr << "Duplicate key" << std::endl;
-      DropIndex(table_name, index_name);
+      // take out only what this load put in, an equal key already in the index stays
+      for (size_t k = 0; k < inserted; k++) {
+        index->RemoveEntry(keys[order[k]], rids[order[k]], txn);
+      }
+      for (size_t k = 0; k < i; k++) {
+        ReadKeys(indexes[k], rids, keys, txn);
+        for (size_t r = 0; r < rids.size(); r++) {
+          indexes[k]->GetIndex()->RemoveEntry(keys[r], rids[r], txn);
+        }
+      }
+      for (auto &rid : rids) {
+        table_heap->MarkDelete(rid, txn);
+        table_heap->ApplyDelete(rid, txn);
+      }
       return DB_FAILED;
     }
   }
-
+  row_count = rids.size();
   return DB_SUCCESS;
 }
 
@@ -237,6 +345,16 @@ dberr_t CatalogManager::GetIndex(const std::string &table_name, const std::strin
   return DB_SUCCESS;
 }
 
+dberr_t CatalogManager::GetIndex(index_id_t index_id, IndexInfo *&index_info) const {
+  auto it = indexes_.find(index_id);
+  if(it == indexes_.end()){
+    index_info = nullptr;
+    return DB_INDEX_NOT_FOUND;
+  }
+  index_info = it->second;
+  return DB_SUCCESS;
+}
+
 dberr_t CatalogManager::GetTableIndexes(const std::string &table_name, std::vector<IndexInfo *> &indexes) const {
   if(table_names_.find(table_name) == table_names_.end()) return DB_TABLE_NOT_EXIST;
   auto it = index_names_.find(table_name);
@@ -251,6 +369,7 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
   auto it = table_names_.find(table_name);
   if(it == table_names_.end()) return DB_TABLE_NOT_EXIST;
   table_id_t id = it->second;
+  buffer_pool_manager_->BeginAtomic();
   table_names_.erase(table_name);
   tables_.erase(id);
   auto it1 = index_names_.find(table_name);
@@ -263,6 +382,8 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
     index_names_.erase(table_name);
   }
   catalog_meta_->table_meta_pages_.erase(id);
+  FlushCatalogMetaPage();
+  EndDDL();
   return DB_SUCCESS;
 }
 
@@ -274,10 +395,13 @@ dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_
   if(it3 == it2.end()) return DB_INDEX_NOT_FOUND;
   else {
     index_id_t index_id = it3->second;
+    buffer_pool_manager_->BeginAtomic();
     indexes_[index_id]->GetIndex()->Destroy();
     indexes_.erase(it3->second);
     catalog_meta_->index_meta_pages_.erase(it3->second);
     it->second.erase(index_name);
+    FlushCatalogMetaPage();
+    EndDDL();
   }
   return DB_SUCCESS;
 }
@@ -292,13 +416,31 @@ dberr_t CatalogManager::FlushCatalogMetaPage() const {
   return DB_SUCCESS;
 }
 
+void CatalogManager::EndDDL() {
+  lsn_t lsn = buffer_pool_manager_->EndAtomic();
+  if(log_manager_ != nullptr && lsn != INVALID_LSN){
+    log_manager_->Flush(lsn);
+  }
+}
+
 dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t page_id) {
+  buffer_pool_manager_->MarkRawPage(page_id);
   Page* meta_page = buffer_pool_manager_->FetchPage(page_id);
   TableMetadata *meta_data;
 
   TableMetadata::DeserializeFrom(meta_page->GetData(),meta_data,heap_);
 
-  TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_,meta_data->GetFirstPageId(),meta_data->GetSchema(),log_manager_,lock_manager_,heap_);
+  TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_,meta_data->GetFirstPageId(),
+                                            meta_data->GetFreeSpaceMapPageId(),meta_data->GetSchema(),
+                                            log_manager_,lock_manager_,heap_);
+  table_heap->SetVersionStore(version_store_);
+  //table from an older file, its free-space map has just been built
+  bool upgraded = meta_data->GetFreeSpaceMapPageId() != table_heap->GetFirstFreeSpaceMapPageId();
+  if(upgraded){
+    meta_data->SetFreeSpaceMapPageId(table_heap->GetFirstFreeSpaceMapPageId());
+    meta_data->SerializeTo(meta_page->GetData());
+  }
+  buffer_pool_manager_->UnpinPage(page_id,upgraded);
   TableInfo *info = TableInfo::Create(heap_);
   info->Init(meta_data,table_heap);
   table_names_.insert(std::make_pair(meta_data->GetTableName(),meta_data->GetTableId()));
@@ -307,13 +449,20 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
 }
 
 dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t page_id) {
+  buffer_pool_manager_->MarkRawPage(page_id);
   Page* meta_page = buffer_pool_manager_->FetchPage(page_id);
   IndexMetadata *meta_data;
   IndexMetadata::DeserializeFrom(meta_page->GetData(),meta_data,heap_);
+  buffer_pool_manager_->UnpinPage(page_id,false);
 
   std::vector<uint32_t> key_map;
   TableInfo *table_info;
   GetTable(meta_data->GetTableId(),table_info);
+  if(KeyEncoder::GetMaxEncodedSize(table_info->GetSchema(),meta_data->GetKeyMapping()) > MAX_INDEX_KEY_SIZE){
+    LOG(ERROR) << "Index key of " << meta_data->GetIndexName() << " is longer than " << MAX_INDEX_KEY_SIZE
+               << " bytes, the index is not loaded";
+    return DB_FAILED;
+  }
   
   auto it = index_names_.find(table_info->GetTableName());
   if(it == index_names_.end()){
@@ -323,9 +472,27 @@ dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t pag
   }else{
     it->second.insert(std::make_pair(meta_data->GetIndexName(),meta_data->GetIndexId()));
   }
+  //index written with the old row-format keys, or with keys which may have been cut off, drop its tree and
+  //rebuild it from the table
+  bool migrate = meta_data->GetKeyEncoding() != IndexMetadata::KEY_ENCODING_MEMCMP;
   IndexInfo *info = IndexInfo::Create(heap_);
+  if(migrate){
+    LOG(INFO) << "Rebuilding index " << meta_data->GetIndexName() << " with memcmp keys";
+    //free the pages of the old tree, its root is dropped from the index roots page too
+    info->DestroyOldTree(meta_data,table_info,buffer_pool_manager_);
+  }
   info->Init(meta_data,table_info,buffer_pool_manager_);
   indexes_.insert(std::make_pair(meta_data->GetIndexId(),info));
+  if(migrate){
+    if(PopulateIndex(info,nullptr) != DB_SUCCESS){
+      LOG(ERROR) << "Failed to rebuild index " << meta_data->GetIndexName();
+      return DB_FAILED;
+    }
+    meta_data->SetKeyEncoding(IndexMetadata::KEY_ENCODING_MEMCMP);
+    meta_page = buffer_pool_manager_->FetchPage(page_id);
+    meta_data->SerializeTo(meta_page->GetData());
+    buffer_pool_manager_->UnpinPage(page_id,true);
+  }
   return DB_SUCCESS;
 }
 
@@ -27,6 +27,8 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
     MACH_WRITE_UINT32(buf + offset, key_map_[i]);
     offset += sizeof(uint32_t);
   }
+  MACH_WRITE_UINT32(buf + offset, key_encoding_);
+  offset += sizeof(uint32_t);
   return offset;
 }
 
@@ -38,6 +40,7 @@ uint32_t IndexMetadata::GetSerializedSize() const {
   offset += 2*sizeof(size_t);
   offset += index_name_.length() * sizeof(char);
   offset += key_map_.size() * sizeof(uint32_t);
+  offset += sizeof(uint32_t);
   return offset;
 }
 
@@ -59,10 +62,7 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta, M
   str_len = MACH_READ_FROM(size_t, buf + offset);
   offset += sizeof(size_t);
 
-  char *name1 = new char[str_len];
-  memcpy(name1, buf+offset, str_len);
-  index_name=name1;
-  delete name1;
+  index_name = std::string(buf + offset, str_len);
   offset += str_len;
 
   table_id = MACH_READ_FROM(table_id_t, buf + offset);
@@ -76,7 +76,10 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta, M
     key_map.push_back(MACH_READ_FROM(uint32_t, buf + offset));
     offset += sizeof(uint32_t);
   }
+  // metadata written before the key encoding was recorded leaves zeros here, i.e. KEY_ENCODING_ROW
+  uint32_t key_encoding = MACH_READ_FROM(uint32_t, buf + offset);
+  offset += sizeof(uint32_t);
 
-  index_meta = ALLOC_P(heap,IndexMetadata)(index_id,index_name,table_id,key_map);
+  index_meta = ALLOC_P(heap,IndexMetadata)(index_id,index_name,table_id,key_map,key_encoding);
   return offset;
 }
\ No newline at end of file
@@ -14,11 +14,13 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
   MACH_WRITE_TO(page_id_t, buf+tot_offset, root_page_id_);
   tot_offset += sizeof(page_id_t);
   tot_offset += schema_->SerializeTo(buf+tot_offset);
+  MACH_WRITE_TO(page_id_t, buf+tot_offset, fsm_page_id_);
+  tot_offset += sizeof(page_id_t);
   return tot_offset;
 }
 
 uint32_t TableMetadata::GetSerializedSize() const {
-  return sizeof(uint32_t)+sizeof(table_id_t)+sizeof(size_t)+table_name_.length()+sizeof(page_id_t)+schema_->GetSerializedSize();
+  return sizeof(uint32_t)+sizeof(table_id_t)+sizeof(size_t)+table_name_.length()+sizeof(page_id_t)+schema_->GetSerializedSize()+sizeof(page_id_t);
 }
 
 /**
@@ -28,6 +30,7 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
   table_id_t table_id;
   std::string table_name;
   page_id_t root_page_id;
+  page_id_t fsm_page_id;
   TableSchema *schema;
   size_t str_len;
   uint32_t tot_offset = 0;
@@ -39,17 +42,19 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
     str_len = MACH_READ_FROM(size_t,buf+tot_offset);
     tot_offset += sizeof(size_t);
 
-    char *name1 = new char[str_len];
-    memcpy(name1, buf+tot_offset, str_len);
-    table_name=name1;
+    table_name = std::string(buf + tot_offset, str_len);
     tot_offset += str_len;
-    delete name1;
 
     root_page_id = MACH_READ_FROM(page_id_t,buf+tot_offset);
     tot_offset += sizeof(page_id_t);
 
     tot_offset += Schema::DeserializeFrom(buf+tot_offset,schema,heap);
-    table_meta = ALLOC_P(heap,TableMetadata)(table_id,table_name,root_page_id,schema);
+    fsm_page_id = MACH_READ_FROM(page_id_t,buf+tot_offset);
+    tot_offset += sizeof(page_id_t);
+    //metadata written before the free-space map existed leaves zeros here,
+    //page 0 is the catalog meta page so it can never be a map page
+    if(fsm_page_id == CATALOG_META_PAGE_ID) fsm_page_id = INVALID_PAGE_ID;
+    table_meta = ALLOC_P(heap,TableMetadata)(table_id,table_name,root_page_id,fsm_page_id,schema);
     return tot_offset;
   }else
   return 0;
@@ -60,12 +65,14 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
  *
  * @param heap Memory heap passed by TableInfo
  */
-TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name,
-                                     page_id_t root_page_id, TableSchema *schema, MemHeap *heap) {
+TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
+                                     page_id_t fsm_page_id, TableSchema *schema, MemHeap *heap) {
   // allocate space for table metadata
   void *buf = heap->Allocate(sizeof(TableMetadata));
-  return new(buf)TableMetadata(table_id, table_name, root_page_id, schema);
+  return new(buf)TableMetadata(table_id, table_name, root_page_id, fsm_page_id, schema);
 }
 
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
-        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema) {}
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id,
+                             page_id_t fsm_page_id, TableSchema *schema)
+        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), fsm_page_id_(fsm_page_id),
+          schema_(schema) {}
@@ -0,0 +1,35 @@
+#include "executor/delete_executor.h"
+#include "glog/logging.h"
+
+DeleteExecutor::DeleteExecutor(std::unique_ptr<AbstractExecutor> child, TableInfo *table_info,
+                               std::vector<IndexInfo *> indexes, Transaction *txn)
+        : child_(std::move(child)),
+          table_info_(table_info),
+          indexes_(std::move(indexes)),
+          txn_(txn) {}
+
+dberr_t DeleteExecutor::Init() {
+  return child_->Init();
+}
+
+dberr_t DeleteExecutor::Next(Row *&row) {
+  dberr_t err = child_->Next(row);
+  if (err != DB_SUCCESS || row == nullptr) {
+    return err;
+  }
+  RowId rid = row->GetRowId();
+  TableHeap *table_heap = table_info_->GetTableHeap();
+  if (!table_heap->MarkDelete(rid, txn_)) {
+    LOG(INFO) << "MarkDelete failed" << std::endl;
+    row = nullptr;
+    return DB_FAILED;
+  }
+  for (auto index_info : indexes_) {
+    Row key = MakeKey(*row, index_info);
+    if (index_info->GetIndex()->RemoveEntry(key, rid, txn_) != DB_SUCCESS) {
+      LOG(INFO) << "RemoveEntry failed" << std::endl;
+    }
+  }
+  table_heap->ApplyDelete(rid, txn_);
+  return DB_SUCCESS;
+}
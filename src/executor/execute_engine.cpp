@@ -1,5 +1,12 @@
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "executor/execute_engine.h"
 #include "glog/logging.h"
+#include "utils/mapped_file.h"
 
 ExecuteEngine::ExecuteEngine() {
   fstream dbs_file;
@@ -30,6 +37,21 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
   context->StartRunning();
   dberr_t ret = DB_FAILED;
   bool affected = true;
+  switch (ast->type_) {
+    case kNodeCreateDB:
+    case kNodeDropDB:
+    case kNodeUseDB:
+    case kNodeCreateTable:
+    case kNodeDropTable:
+    case kNodeCreateIndex:
+    case kNodeDropIndex:
+      // DDL is not transactional, it commits the open transaction first
+      EndTxn(true);
+      break;
+    default:
+      break;
+  }
+  context->txn_ = txn_;
   switch (ast->type_) {
     case kNodeCreateDB:
       ret = ExecuteCreateDatabase(ast, context);
@@ -103,6 +125,10 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
       ret = ExecuteExecfile(ast, context);
       affected = false;
       break;
+    case kNodeCopy:
+      ret = ExecuteCopy(ast, context);
+      affected = true;
+      break;
     case kNodeQuit:
       ret = ExecuteQuit(ast, context);
       affected = true;
@@ -111,6 +137,14 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext *context) {
       ret = DB_FAILED;
       affected = false;
   }
+  // a transaction chosen to break a deadlock, or writing a row changed since it began, is rolled back
+  // right away to release its locks
+  if (txn_ != nullptr && txn_->GetState() == TxnState::kAborted) {
+    LOG(WARNING) << "Transaction " << txn_->GetTxnId() << " aborted, rolled back";
+    EndTxn(false);
+    context->txn_ = nullptr;
+    ret = DB_FAILED;
+  }
   if (ast->type_ != kNodeQuit) context->PrintResult(ret, affected);
   context->StopRunning(ast->type_ != kNodeQuit);
   return ret;
@@ -160,8 +194,11 @@ dberr_t ExecuteEngine::ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *cont
     if (it->first != db_name) dbs_file << it->first << std::endl;
   }
   dbs_file.close();
+  std::string log_file_name = dbs_[db_name]->log_file_name_;
+  delete dbs_[db_name];
   dbs_.erase(db_name);
   remove(db_name.c_str());
+  remove(log_file_name.c_str());
   if (current_db_ == db_name) {
     current_db_ = "";
   }
@@ -295,6 +332,8 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
   IndexInfo *index_info = nullptr;
   dberr_t status;
   if ((status = db->catalog_mgr_->CreateIndex(table_name, "_" + table_name + "_primkey", primary_keys, context->txn_, index_info)) != DB_SUCCESS) {
+    // a table whose primary key cannot be indexed is not created
+    db->catalog_mgr_->DropTable(table_name);
     return status;
   }
   // for (int i = 0; i < (int)columns.size(); ++i) {
@@ -402,38 +441,7 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
   if ((status = db->catalog_mgr_->CreateIndex(table_name, index_name, index_keys, context->txn_, index_info)) != DB_SUCCESS) {
     return status;
   }
-
-  // insert tuples into index
-  /*
-  TableInfo *tableInfo = nullptr;
-  if (db->catalog_mgr_->GetTable(table_name, tableInfo) != DB_SUCCESS) {
-    return DB_FAILED;
-  }
-  std::vector<int> indexColumns;
-  indexColumns.clear();
-  Schema *schema = tableInfo->GetSchema();
-  dberr_t err;
-  for (int i = 0; i < (int)index_keys.size(); ++i) {
-    uint32_t ind = 0;
-    if ((err = schema->GetColumnIndex(index_keys[i], ind)) != DB_SUCCESS) {
-      return err;
-    }
-    indexColumns.push_back(ind);
-  }
-  for (auto it = tableInfo->GetTableHeap()->Begin(context->txn_); it != tableInfo->GetTableHeap()->End(); it ++) {
-    std::vector<Field> row;
-    for (int i = 0; i < (int)indexColumns.size(); ++i) {
-      row.push_back(*it->GetField(indexColumns[i]));
-    }
-    Row keyRow(row);
-    if((err = index_info->GetIndex()->InsertEntry(keyRow, it->GetRowId(), context->txn_)) != DB_SUCCESS) {
-      std::cerr << "Duplicate key" << std::endl;
-      db->catalog_mgr_->DropIndex(table_name, index_name);
-      return err;
-    }
-  }
-  */
-  
+  // the rows already in the table were put into the index by CreateIndex
   context->AddAffectedRows();
   return DB_SUCCESS;
 }
@@ -483,130 +491,67 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext *context) {
   if (db == nullptr) {
     return DB_FAILED;
   }
-  pSyntaxNode select_node = ast->child_;
-  pSyntaxNode from_node = select_node->next_;
-  pSyntaxNode where_node = from_node->next_;
+  Planner planner(db->catalog_mgr_, context->txn_);
+  std::unique_ptr<AbstractExecutor> plan;
+  std::vector<std::string> columns;
   dberr_t status;
-  std::string tableName = std::string(from_node->val_);
-  TableInfo *tableInfo = nullptr;
-  if ((status = db->catalog_mgr_->GetTable(tableName, tableInfo)) != DB_SUCCESS) {
+  if ((status = planner.PlanSelect(ast, plan, columns)) != DB_SUCCESS) {
     return status;
   }
-  std::vector<IndexInfo *> indexes;
-  indexes.clear();
-  if ((status = db->catalog_mgr_->GetTableIndexes(tableName, indexes)) != DB_SUCCESS) {
+  if ((status = plan->Init()) != DB_SUCCESS) {
     return status;
   }
-  std::vector<uint32_t> selectIdx;
-  if (select_node->type_ == kNodeAllColumns) {
-    for (int i = 0; i < (int)tableInfo->GetSchema()->GetColumnCount(); ++i) {
-      selectIdx.push_back(i);
-    }
-  } else if (select_node->type_ == kNodeColumnList) {
-    for (pSyntaxNode select_col_node = select_node->child_; select_col_node != nullptr; select_col_node = select_col_node->next_) {
-      uint32_t ind = 0;
-      if ((status = tableInfo->GetSchema()->GetColumnIndex(std::string(select_col_node->val_), ind)) != DB_SUCCESS) {
-        return status;
-      }
-      selectIdx.push_back(ind);
-    }
-  } else {
-    return DB_FAILED;
+  // rows are streamed to the sink as the plan produces them, the table is read only once
+  std::unique_ptr<ResultSink> sink;
+  if (!context->disablePrint_) {
+    sink = ResultSink::Create(context->format_, context->output_);
+    sink->Begin(columns);
   }
-  IndexInfo *pindex = nullptr;
-  std::vector<Field> keyRow;
-  context->err_ = DB_SUCCESS;
-  bool useIndex = ChooseIndex(tableInfo->GetSchema(), indexes, where_node, context, pindex, keyRow);
-  // LOG(INFO) << "use index: " << useIndex << std::endl;
-  // if(pindex) LOG(INFO) << "index name: " << pindex->GetIndexName() << std::endl;
-  if (context->err_ != DB_SUCCESS) {
-    return context->err_;
-  }
-  if (!useIndex) {
-    std::vector<std::string> columns;
-    columns.clear();
-    for (auto col: selectIdx) {
-      columns.push_back(tableInfo->GetSchema()->GetColumn(col)->GetName());
-    }
-    context->SetHeader(columns);
-    int fieldCnt = columns.size();
-    for (auto it = tableInfo->GetTableHeap()->Begin(context->txn_); it != tableInfo->GetTableHeap()->End(); it ++) {
-      if (where_node != nullptr) {
-        if (!EvaluateWhere(where_node->child_, tableInfo->GetSchema(), &(*it), context)) {
-          continue;
-        }
-      }
-      std::vector<std::string> row;
-      row.clear();
-      for (int i = 0; i < fieldCnt; ++i) {
-        row.push_back((*it).GetField(selectIdx[i])->GetString());
-      }
-      context->PrepareRow(row);
-    }
-    context->PrintHeader();
-    for (auto it = tableInfo->GetTableHeap()->Begin(context->txn_); it != tableInfo->GetTableHeap()->End(); it ++) {
-      if (where_node != nullptr) {
-        context->err_ = DB_SUCCESS;
-        if (!EvaluateWhere(where_node->child_, tableInfo->GetSchema(), &(*it), context)) {
-          if (context->err_ != DB_SUCCESS) {
-            return context->err_;
-          }
-          continue;
-        }
-        if (context->err_ != DB_SUCCESS) {
-          return context->err_;
-        }
-      }
-      std::vector<std::string> row;
-      row.clear();
-      for (int i = 0; i < fieldCnt; ++i) {
-        row.push_back((*it).GetField(selectIdx[i])->GetString());
-      }
-      context->AddNumSelectedRows();
-      context->PrintRow(row);
-    }
-    context->PrintTableDivider();
-    return DB_SUCCESS;
-  } else {
-    std::vector<std::string> columns;
-    columns.clear();
-    for (auto col: selectIdx) {
-      columns.push_back(tableInfo->GetSchema()->GetColumn(col)->GetName());
+  Row *row;
+  while ((status = plan->Next(row)) == DB_SUCCESS && row != nullptr) {
+    context->AddNumSelectedRows();
+    if (sink != nullptr) {
+      sink->Write(*row);
     }
-    context->SetHeader(columns);
-    int fieldCnt = columns.size();
-
-    Row key(keyRow);
-    std::vector<RowId> res;
-    pindex->GetIndex()->ScanKey(key, res, context->txn_);
+  }
+  if (sink != nullptr) {
+    sink->End();
+  }
+  return status;
+}
 
-    std::vector<std::string> prow;
-    prow.clear();
-    
-    for (auto rowId: res) {
-      Row row(rowId);
-      tableInfo->GetTableHeap()->GetTuple(&row, context->txn_);
-      if (where_node != nullptr) {
-        if (!EvaluateWhere(where_node->child_, tableInfo->GetSchema(), &row, context)) {
-          continue;
-        }
-      }
-      prow.clear();
-      for (int i = 0; i < fieldCnt; ++i) {
-        prow.push_back(row.GetField(selectIdx[i])->GetString());
+namespace {
+/**
+ * Runs a statement outside of a transaction as a transaction of its own, which commits when the
+ * statement ends. A failed statement has compensated its changes by then, so it commits as well,
+ * unless it was aborted by a deadlock or a write conflict.
+ */
+class ImplicitTxn {
+public:
+  ImplicitTxn(TxnManager *txn_manager, ExecuteContext *context) : txn_manager_(txn_manager), context_(context) {
+    if (context_->txn_ == nullptr) {
+      txn_ = txn_manager_->Begin();
+      context_->txn_ = txn_;
+    }
+  }
+
+  ~ImplicitTxn() {
+    if (txn_ != nullptr) {
+      context_->txn_ = nullptr;
+      if (txn_->GetState() == TxnState::kAborted) {
+        txn_manager_->Abort(txn_);
+      } else {
+        txn_manager_->Commit(txn_);
       }
-      context->PrepareRow(prow);
-    }
-
-    context->PrintHeader();
-    if (prow.size() > 0) {
-      context->AddNumSelectedRows();
-      context->PrintRow(prow);
     }
-    context->PrintTableDivider();
   }
-  return DB_SUCCESS;
-}
+
+private:
+  TxnManager *txn_manager_;
+  ExecuteContext *context_;
+  Transaction *txn_{nullptr};
+};
+}  // namespace
 
 dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
@@ -619,153 +564,14 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext *context) {
   if (db == nullptr) {
     return DB_FAILED;
   }
-  pSyntaxNode insert_node = ast->child_;
-  pSyntaxNode values_node = insert_node->next_;
-  std::string tableName = std::string(insert_node->val_);
-  TableInfo *tableInfo = nullptr;
+  ImplicitTxn implicit_txn(db->txn_mgr_, context);
+  Planner planner(db->catalog_mgr_, context->txn_);
+  std::unique_ptr<AbstractExecutor> plan;
   dberr_t status;
-  if ((status = db->catalog_mgr_->GetTable(tableName, tableInfo)) != DB_SUCCESS) {
-    LOG(INFO) << "Table not found" << std::endl;
+  if ((status = planner.PlanInsert(ast, plan)) != DB_SUCCESS) {
     return status;
   }
-  Schema *schema = tableInfo->GetSchema();
-  int columnCnt = schema->GetColumnCount();
-  std::vector<Field> columns;
-  columns.clear();
-  pSyntaxNode value_node = values_node->child_;
-  for (int i = 0; i < columnCnt; ++i) {
-    if (value_node == nullptr) {
-      LOG(INFO) << "Number of values incorrect" << std::endl;
-      return DB_FAILED;
-    }
-    TypeId type = schema->GetColumn(i)->GetType();
-    if (value_node->type_ == kNodeNull) {
-      if (schema->GetColumn(i)->IsNullable()) {
-        columns.push_back(Field(type));
-      } else {
-        LOG(INFO) << "Not nullable" << std::endl;
-        return DB_FAILED;
-      }
-    } else if (type == TypeId::kTypeInt) {
-      if (value_node->type_ != kNodeNumber) {
-        std::cerr << "Wrong type" << std::endl;
-        return DB_FAILED;
-      }
-      columns.push_back(Field(type, std::stoi(value_node->val_)));
-    } else if (type == TypeId::kTypeFloat) {
-      if (value_node->type_ != kNodeNumber) {
-        std::cerr << "Wrong type" << std::endl;
-        return DB_FAILED;
-      }
-      columns.push_back(Field(type, std::stof(value_node->val_)));
-    } else if (type == TypeId::kTypeChar) {
-      if (value_node->type_ != kNodeString) {
-        std::cerr << "Wrong type" << std::endl;
-        return DB_FAILED;
-      }
-      if (strlen(value_node->val_) != schema->GetColumn(i)->GetLength()) {
-        LOG(INFO) << "String length incorrect" << std::endl;
-        return DB_FAILED;
-      }
-      columns.push_back(Field(type, value_node->val_, strlen(value_node->val_), true));
-    } else {
-      LOG(INFO) << "Wrong type" << std::endl;
-      return DB_FAILED;
-    }
-    value_node = value_node->next_;
-  }
-  if (value_node != nullptr) {
-    LOG(INFO) << "Number of values incorrect" << std::endl;
-    return DB_FAILED;
-  }
-
-  // judge unique
-  std::vector<IndexInfo *> indexes;
-  indexes.clear();
-  db->catalog_mgr_->GetTableIndexes(tableName, indexes);
-  /*
-  for (int i = 0; i < columnCnt; ++i) {
-    if (schema->GetColumn(i)->IsUnique()) {
-      int hasIndex = 0;
-      for (auto index: indexes) {
-        IndexSchema *indSchema = index->GetIndexKeySchema();
-        if (indSchema->GetColumnCount() == 1 && indSchema->GetColumn(0)->GetName() == schema->GetColumn(i)->GetName()) {
-          hasIndex = 1;
-          break;
-        }
-      }
-      if (hasIndex) continue;
-      // no index
-      for (auto it = tableInfo->GetTableHeap()->Begin(context->txn_); it != tableInfo->GetTableHeap()->End(); it ++) {
-        if (it->GetField(i)->CompareEquals(columns[i])) {
-          std::cerr << "Duplicate key on " << schema->GetColumn(i)->GetName() << std::endl;
-          return DB_FAILED;
-        }
-      }
-    }
-  }
-  */
-
-  // judge unique in index
-  /*
-  for (auto index: indexes) {
-    IndexSchema *indSchema = index->GetIndexKeySchema();
-    std::vector<int> indexColumns;
-    indexColumns.clear();
-    for (int i = 0; i < (int)indSchema->GetColumnCount(); ++i) {
-      uint32_t ind = 0;
-      if((status = schema->GetColumnIndex(indSchema->GetColumn(i)->GetName(), ind)) != DB_SUCCESS) {
-        return status;
-      }
-      indexColumns.push_back(ind);
-    }
-    std::vector<Field> key;
-    key.clear();
-    for (int i = 0; i < (int)indSchema->GetColumnCount(); ++i) {
-      key.push_back(columns[indexColumns[i]]);
-    }
-    Row keyRow(key);
-    std::vector<RowId> res;
-    if (index->GetIndex()->ScanKey(keyRow, res, context->txn_) != DB_KEY_NOT_FOUND) {
-      std::cerr << "Duplicate in index " << index->GetIndexName() << std::endl;
-      return DB_FAILED;
-    }
-  }
-  */
-  Row row(columns);
-  if (!tableInfo->GetTableHeap()->InsertTuple(row, context->txn_)) {
-    // LOG(INFO) << "Insertion failed" << std::endl;
-    return DB_FAILED;
-  }
-
-  // insert into index
-  for (auto index: indexes) {
-    IndexSchema *indSchema = index->GetIndexKeySchema();
-    std::vector<int> indexColumns;
-    indexColumns.clear();
-    for (int i = 0; i < (int)indSchema->GetColumnCount(); ++i) {
-      uint32_t ind = 0;
-      if((status = schema->GetColumnIndex(indSchema->GetColumn(i)->GetName(), ind)) != DB_SUCCESS) {
-        return status;
-      }
-      indexColumns.push_back(ind);
-    }
-    std::vector<Field> key;
-    key.clear();
-    for (int i = 0; i < (int)indSchema->GetColumnCount(); ++i) {
-      key.push_back(columns[indexColumns[i]]);
-    }
-    Row keyRow(key);
-    if ((status = index->GetIndex()->InsertEntry(keyRow, row.GetRowId(), context->txn_)) != DB_SUCCESS) {
-      tableInfo->GetTableHeap()->MarkDelete(row.GetRowId(), context->txn_);
-      tableInfo->GetTableHeap()->ApplyDelete(row.GetRowId(), context->txn_);
-      // std::cout << "Duplicate Key" << std::endl;
-      // LOG(INFO) << "Insertion failed" << std::endl;
-      return status;
-    }
-  }
-  context->AddAffectedRows();
-  return DB_SUCCESS;
+  return ExecutePlan(plan.get(), context);
 }
 
 dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
@@ -779,105 +585,14 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext *context) {
   if (db == nullptr) {
     return DB_FAILED;
   }
-  pSyntaxNode delete_node = ast->child_;
-  pSyntaxNode where_node = delete_node->next_;
-  std::string tableName = delete_node->val_;
+  ImplicitTxn implicit_txn(db->txn_mgr_, context);
+  Planner planner(db->catalog_mgr_, context->txn_);
+  std::unique_ptr<AbstractExecutor> plan;
   dberr_t status;
-  TableInfo *tableInfo = nullptr;
-  if ((status = db->catalog_mgr_->GetTable(tableName, tableInfo)) != DB_SUCCESS) {
-    return status;
-  }
-  std::vector<IndexInfo *> indexes;
-  indexes.clear();
-  if ((status = db->catalog_mgr_->GetTableIndexes(tableName, indexes)) != DB_SUCCESS) {
+  if ((status = planner.PlanDelete(ast, plan)) != DB_SUCCESS) {
     return status;
   }
-  IndexInfo *pindex = nullptr;
-  std::vector<Field> keyRow;
-  context->err_ = DB_SUCCESS;
-  bool useIndex = ChooseIndex(tableInfo->GetSchema(), indexes, where_node, context, pindex, keyRow);
-  // LOG(INFO) << "use index: " << useIndex << std::endl;
-  // if(pindex) LOG(INFO) << "index name: " << pindex->GetIndexName() << std::endl;
-  if (context->err_ != DB_SUCCESS) {
-    return context->err_;
-  }
-  Schema *schema = tableInfo->GetSchema();
-  if (!useIndex) {
-    // int fieldCnt = schema->GetColumnCount();
-    for (auto it = tableInfo->GetTableHeap()->Begin(context->txn_); it != tableInfo->GetTableHeap()->End(); it ++) {
-      if (where_node != nullptr) {
-        if (!EvaluateWhere(where_node->child_, schema, &(*it), context)) {
-          continue;
-        }
-      }
-      if(!tableInfo->GetTableHeap()->MarkDelete(it->GetRowId(), context->txn_)) {
-        LOG(INFO) << "MarkDelete failed" << std::endl;
-      }
-      if (where_node != nullptr) {
-        for (auto indexInfo: indexes) {
-          std::vector<Field> keys;
-          keys.clear();
-          for (int i = 0; i < (int)indexInfo->GetIndexKeySchema()->GetColumnCount(); ++i) {
-            uint32_t ind = 0;
-            if((status = schema->GetColumnIndex(indexInfo->GetIndexKeySchema()->GetColumn(i)->GetName(), ind)) != DB_SUCCESS) {
-              return status;
-            }
-            keys.push_back(*(it->GetField(ind)));
-          }
-          Row keyRow(keys);
-          // keyRow->SetRowId(it->GetRowId());
-          if((status = indexInfo->GetIndex()->RemoveEntry(keyRow, it->GetRowId(), context->txn_)) != DB_SUCCESS) {
-            LOG(INFO) << "RemoveEntry failed" << std::endl;
-          }
-        }
-      }
-      tableInfo->GetTableHeap()->ApplyDelete(it->GetRowId(), context->txn_);
-      context->AddAffectedRows();
-    }
-    if (where_node == nullptr) {
-      for (auto indexInfo: indexes) {
-        if ((status = indexInfo->GetIndex()->Destroy()) != DB_SUCCESS) {
-          return status;
-        }
-      }
-    }
-    return DB_SUCCESS;
-  } else {
-    Row key(keyRow);
-    std::vector<RowId> res;
-    pindex->GetIndex()->ScanKey(key, res, context->txn_);
-    
-    for (auto rowId: res) {
-      Row row(rowId);
-      tableInfo->GetTableHeap()->GetTuple(&row, context->txn_);
-      if (where_node != nullptr) {
-        if (!EvaluateWhere(where_node->child_, schema, &row, context)) {
-          continue;
-        }
-      }
-      if(!tableInfo->GetTableHeap()->MarkDelete(rowId, context->txn_)) {
-        LOG(INFO) << "MarkDelete failed" << std::endl;
-      }
-      for (auto indexInfo: indexes) {
-        std::vector<Field> keys;
-        keys.clear();
-        for (int i = 0; i < (int)indexInfo->GetIndexKeySchema()->GetColumnCount(); ++i) {
-          uint32_t ind = 0;
-          if((status = schema->GetColumnIndex(indexInfo->GetIndexKeySchema()->GetColumn(i)->GetName(), ind)) != DB_SUCCESS) {
-            return status;
-          }
-          keys.push_back(*row.GetField(ind));
-        }
-        Row keyRow(keys);
-        if((status = indexInfo->GetIndex()->RemoveEntry(keyRow, rowId, context->txn_)) != DB_SUCCESS) {
-          LOG(INFO) << "RemoveEntry failed" << std::endl;
-        }
-      }
-      tableInfo->GetTableHeap()->ApplyDelete(rowId, context->txn_);
-      context->AddAffectedRows();
-    }
-  }
-  return DB_SUCCESS;
+  return ExecutePlan(plan.get(), context);
 }
 
 dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext *context) {
@@ -891,239 +606,68 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext *context) {
   if (db == nullptr) {
     return DB_FAILED;
   }
-  pSyntaxNode update_node = ast->child_;
-  pSyntaxNode set_node = update_node->next_;
-  pSyntaxNode where_node = set_node->next_;
-  std::string tableName = update_node->val_;
+  ImplicitTxn implicit_txn(db->txn_mgr_, context);
+  Planner planner(db->catalog_mgr_, context->txn_);
+  std::unique_ptr<AbstractExecutor> plan;
   dberr_t status;
-  TableInfo *tableInfo = nullptr;
-  if ((status = db->catalog_mgr_->GetTable(tableName, tableInfo)) != DB_SUCCESS) {
-    return status;
-  }
-  std::vector<IndexInfo *> indexes;
-  indexes.clear();
-  if ((status = db->catalog_mgr_->GetTableIndexes(tableName, indexes)) != DB_SUCCESS) {
+  if ((status = planner.PlanUpdate(ast, plan)) != DB_SUCCESS) {
     return status;
   }
-  IndexInfo *pindex = nullptr;
-  std::vector<Field> keyRow;
-  context->err_ = DB_SUCCESS;
-  bool useIndex = ChooseIndex(tableInfo->GetSchema(), indexes, where_node, context, pindex, keyRow);
-  LOG(INFO) << "use index: " << useIndex << std::endl;
-  if(pindex) LOG(INFO) << "index name: " << pindex->GetIndexName() << std::endl;
-  if (context->err_ != DB_SUCCESS) {
-    return context->err_;
-  }
-  Schema *schema = tableInfo->GetSchema();
-  if (!useIndex) {
-    // int fieldCnt = schema->GetColumnCount();
-    for (auto it = tableInfo->GetTableHeap()->Begin(context->txn_); it != tableInfo->GetTableHeap()->End(); it ++) {
-      if (where_node != nullptr) {
-        if (!EvaluateWhere(where_node->child_, schema, &(*it), context)) {
-          continue;
-        }
-      }
-      std::vector<Field> newColumns;
-      newColumns.clear();
-      for (int i = 0; i < (int)schema->GetColumnCount(); ++ i) {
-        newColumns.push_back(*(it->GetField(i)));
-      }
-      for (pSyntaxNode set_node_item = set_node->child_; set_node_item != nullptr; set_node_item = set_node_item->next_) {
-        uint32_t ind = 0;
-        pSyntaxNode set_column_node = set_node_item->child_;
-        pSyntaxNode set_value_node = set_column_node->next_;
-        if((status = schema->GetColumnIndex(set_column_node->val_, ind)) != DB_SUCCESS) {
-          return status;
-        }
-        TypeId type = schema->GetColumn(ind)->GetType();
-        if (set_value_node->type_ == kNodeNull) {
-          if (schema->GetColumn(ind)->IsNullable()) {
-            newColumns[ind] = Field(type);
-          } else {
-            return DB_FAILED;
-          }
-        } else {
-          switch (type) {
-            case TypeId::kTypeInt:
-              if (set_value_node->type_ != kNodeNumber) {
-                return DB_FAILED;
-              }
-              newColumns[ind] = Field(type, std::stoi(set_value_node->val_));
-              break;
-            case TypeId::kTypeFloat:
-              if (set_value_node->type_ != kNodeNumber) {
-                return DB_FAILED;
-              }
-              newColumns[ind] = Field(type, std::stof(set_value_node->val_));
-              break;
-            case TypeId::kTypeChar:
-              if (set_value_node->type_ != kNodeString) {
-                return DB_FAILED;
-              }
-              newColumns[ind] = Field(type, set_value_node->val_, strlen(set_value_node->val_), true);
-              break;
-            default:
-              LOG(INFO) << "Unsupported type" << std::endl;
-              return DB_FAILED;
-          }
-        }
-      }
-      Row newRow(newColumns);
-      for (auto indexInfo: indexes) {
-        std::vector<Field> keys;
-        keys.clear();
-        for (int i = 0; i < (int)indexInfo->GetIndexKeySchema()->GetColumnCount(); ++i) {
-          uint32_t ind = 0;
-          if((status = schema->GetColumnIndex(indexInfo->GetIndexKeySchema()->GetColumn(i)->GetName(), ind)) != DB_SUCCESS) {
-            return status;
-          }
-          keys.push_back(*(it->GetField(ind)));
-        }
-        Row keyRow(keys);
-        // keyRow->SetRowId(it->GetRowId());
-        if((status = indexInfo->GetIndex()->RemoveEntry(keyRow, it->GetRowId(), context->txn_)) != DB_SUCCESS) {
-          LOG(INFO) << "RemoveEntry failed" << std::endl;
-        }
-      }
-      if(!tableInfo->GetTableHeap()->UpdateTuple(newRow, it->GetRowId(), context->txn_)) {
-        LOG(INFO) << "UpdateTuple failed" << std::endl;
-      }
-      for (auto indexInfo: indexes) {
-        std::vector<Field> keys;
-        keys.clear();
-        for (int i = 0; i < (int)indexInfo->GetIndexKeySchema()->GetColumnCount(); ++i) {
-          uint32_t ind = 0;
-          if((status = schema->GetColumnIndex(indexInfo->GetIndexKeySchema()->GetColumn(i)->GetName(), ind)) != DB_SUCCESS) {
-            return status;
-          }
-          keys.push_back(newColumns[ind]);
-        }
-        Row keyRow(keys);
-        // keyRow->SetRowId(it->GetRowId());
-        if((status = indexInfo->GetIndex()->InsertEntry(keyRow, it->GetRowId(), context->txn_)) != DB_SUCCESS) {
-          LOG(INFO) << "InsertEntry failed" << std::endl;
-          ASSERT(false, "Update duplicate key");
-        }
-      }
-      context->AddAffectedRows();
-    }
-    return DB_SUCCESS;
-  } else {
-    Row key(keyRow);
-    std::vector<RowId> res;
-    pindex->GetIndex()->ScanKey(key, res, context->txn_);
-    
-    for (auto rowId: res) {
-      Row row(rowId);
-      tableInfo->GetTableHeap()->GetTuple(&row, context->txn_);
-      if (where_node != nullptr) {
-        if (!EvaluateWhere(where_node->child_, schema, &row, context)) {
-          continue;
-        }
-      }
-      std::vector<Field> newColumns;
-      newColumns.clear();
-      for (int i = 0; i < (int)schema->GetColumnCount(); ++ i) {
-        newColumns.push_back(*row.GetField(i));
-      }
-      for (pSyntaxNode set_node_item = set_node->child_; set_node_item != nullptr; set_node_item = set_node_item->next_) {
-        uint32_t ind = 0;
-        pSyntaxNode set_column_node = set_node_item->child_;
-        pSyntaxNode set_value_node = set_column_node->next_;
-        if((status = schema->GetColumnIndex(set_column_node->val_, ind)) != DB_SUCCESS) {
-          return status;
-        }
-        TypeId type = schema->GetColumn(ind)->GetType();
-        if (set_value_node->type_ == kNodeNull) {
-          if (schema->GetColumn(ind)->IsNullable()) {
-            newColumns[ind] = Field(type);
-          } else {
-            return DB_FAILED;
-          }
-        } else {
-          switch (type) {
-            case TypeId::kTypeInt:
-              if (set_value_node->type_ != kNodeNumber) {
-                return DB_FAILED;
-              }
-              newColumns[ind] = Field(type, std::stoi(set_value_node->val_));
-              break;
-            case TypeId::kTypeFloat:
-              if (set_value_node->type_ != kNodeNumber) {
-                return DB_FAILED;
-              }
-              newColumns[ind] = Field(type, std::stof(set_value_node->val_));
-              break;
-            case TypeId::kTypeChar:
-              if (set_value_node->type_ != kNodeString) {
-                return DB_FAILED;
-              }
-              newColumns[ind] = Field(type, set_value_node->val_, strlen(set_value_node->val_), true);
-              break;
-            default:
-              LOG(INFO) << "Unsupported type" << std::endl;
-              return DB_FAILED;
-          }
-        }
-      }
-      Row newRow(newColumns);
-      for (auto indexInfo: indexes) {
-        std::vector<Field> keys;
-        keys.clear();
-        for (int i = 0; i < (int)indexInfo->GetIndexKeySchema()->GetColumnCount(); ++i) {
-          uint32_t ind = 0;
-          if((status = schema->GetColumnIndex(indexInfo->GetIndexKeySchema()->GetColumn(i)->GetName(), ind)) != DB_SUCCESS) {
-            return status;
-          }
-          keys.push_back(*row.GetField(ind));
-        }
-        Row keyRow(keys);
-        if((status = indexInfo->GetIndex()->RemoveEntry(keyRow, rowId, context->txn_)) != DB_SUCCESS) {
-          LOG(INFO) << "RemoveEntry failed" << std::endl;
-        }
-      }
-      tableInfo->GetTableHeap()->UpdateTuple(newRow, rowId, context->txn_);
-      for (auto indexInfo: indexes) {
-        std::vector<Field> keys;
-        keys.clear();
-        for (int i = 0; i < (int)indexInfo->GetIndexKeySchema()->GetColumnCount(); ++i) {
-          uint32_t ind = 0;
-          if((status = schema->GetColumnIndex(indexInfo->GetIndexKeySchema()->GetColumn(i)->GetName(), ind)) != DB_SUCCESS) {
-            return status;
-          }
-          keys.push_back(newColumns[ind]);
-        }
-        Row keyRow(keys);
-        if((status = indexInfo->GetIndex()->InsertEntry(keyRow, rowId, context->txn_)) != DB_SUCCESS) {
-          LOG(INFO) << "InsertEntry failed" << std::endl;
-          ASSERT(false, "Update duplicate key");
-        }
-      }
-      context->AddAffectedRows();
-    }
-  }
-  return DB_SUCCESS;
+  return ExecutePlan(plan.get(), context);
 }
 
 dberr_t ExecuteEngine::ExecuteTrxBegin(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteTrxBegin" << std::endl;
 #endif
-  return DB_FAILED;
+  if (current_db_ == "" || txn_ != nullptr) {
+    return DB_FAILED;
+  }
+  DBStorageEngine *db = dbs_[current_db_];
+  if (db == nullptr) {
+    return DB_FAILED;
+  }
+  txn_ = db->txn_mgr_->Begin();
+  txn_db_ = db;
+  context->txn_ = txn_;
+  return DB_SUCCESS;
 }
 
 dberr_t ExecuteEngine::ExecuteTrxCommit(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteTrxCommit" << std::endl;
 #endif
-  return DB_FAILED;
+  if (txn_ == nullptr) {
+    return DB_FAILED;
+  }
+  EndTxn(true);
+  context->txn_ = nullptr;
+  return DB_SUCCESS;
 }
 
 dberr_t ExecuteEngine::ExecuteTrxRollback(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
   LOG(INFO) << "ExecuteTrxRollback" << std::endl;
 #endif
-  return DB_FAILED;
+  if (txn_ == nullptr) {
+    return DB_FAILED;
+  }
+  EndTxn(false);
+  context->txn_ = nullptr;
+  return DB_SUCCESS;
+}
+
+void ExecuteEngine::EndTxn(bool commit) {
+  if (txn_ == nullptr) {
+    return;
+  }
+  if (commit) {
+    txn_db_->txn_mgr_->Commit(txn_);
+  } else {
+    txn_db_->txn_mgr_->Abort(txn_);
+  }
+  txn_ = nullptr;
+  txn_db_ = nullptr;
 }
 
 
@@ -1134,79 +678,196 @@ int yyparse(void);
 #include "parser/parser.h"
 }
 
-dberr_t ExecuteEngine::ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context) {
-#ifdef ENABLE_EXECUTE_DEBUG
-  LOG(INFO) << "ExecuteExecfile" << std::endl;
-#endif
-  // command buffer
-  const int buf_size = 2048;
-  char cmd[buf_size];
-  // for print syntax tree
-  // TreeFileManagers syntax_tree_file_mgr("syntax_tree_");
-  // [[maybe_unused]] uint32_t syntax_tree_id = 0;
-
-  FILE *fp = fopen(ast->child_->val_, "r");
-  if (fp == nullptr) {
-    LOG(INFO) << "ExecuteExecfile: open file failed" << std::endl;
-    return DB_FAILED;
+namespace {
+/**
+ * A statement parsed ahead of its execution, owning its syntax nodes
+ */
+struct ParsedStatement {
+  pSyntaxNode root_{nullptr};
+  pSyntaxNodeList nodes_{nullptr};
+};
+
+/**
+ * Hands statements from the parsing thread over to the executing one. The queue
+ * is bounded, so that only a window of a long script is kept as syntax trees.
+ */
+class StatementQueue {
+public:
+  explicit StatementQueue(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Block while the queue is full
+   * @return false if the consumer stopped, the statement is not taken
+   */
+  bool Push(const ParsedStatement &stmt) {
+    std::unique_lock<std::mutex> lock(latch_);
+    cv_.wait(lock, [this] { return closed_ || statements_.size() < capacity_; });
+    if (closed_) {
+      return false;
+    }
+    statements_.push_back(stmt);
+    cv_.notify_all();
+    return true;
   }
 
-  // int counter = 0;
-  while (1) {
-    // read from buffer
-    InputCommand(cmd, buf_size, fp);
-    if(strlen(cmd) == 0) {
-      break;
+  /**
+   * Block until the statements pushed so far have all been executed
+   */
+  void WaitIdle() {
+    std::unique_lock<std::mutex> lock(latch_);
+    cv_.wait(lock, [this] { return closed_ || (statements_.empty() && !executing_); });
+  }
+
+  /**
+   * Producer side: no more statements follow
+   */
+  void Finish() {
+    std::lock_guard<std::mutex> lock(latch_);
+    finished_ = true;
+    cv_.notify_all();
+  }
+
+  /**
+   * Block until a statement is available, the previous one counts as executed
+   * @return false once all statements have been taken
+   */
+  bool Pop(ParsedStatement &stmt) {
+    std::unique_lock<std::mutex> lock(latch_);
+    executing_ = false;
+    cv_.notify_all();
+    cv_.wait(lock, [this] { return finished_ || !statements_.empty(); });
+    if (statements_.empty()) {
+      return false;
     }
-    // ++ counter;
-    // if (counter % 100 == 0) {
-    //   LOG(INFO) << counter << std::endl;
-    // }
-    // create buffer for sql input
-    YY_BUFFER_STATE bp = yy_scan_string(cmd);
-    if (bp == nullptr) {
-      LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
-      exit(1);
+    stmt = statements_.front();
+    statements_.pop_front();
+    executing_ = true;
+    cv_.notify_all();
+    return true;
+  }
+
+  /**
+   * Consumer side: stop taking statements, those still queued are freed
+   */
+  void Close() {
+    std::lock_guard<std::mutex> lock(latch_);
+    closed_ = true;
+    for (auto &stmt : statements_) {
+      DestroySyntaxNodeList(stmt.nodes_);
     }
-    yy_switch_to_buffer(bp);
+    statements_.clear();
+    cv_.notify_all();
+  }
 
-    // init parser module
-    MinisqlParserInit();
+private:
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::deque<ParsedStatement> statements_;
+  size_t capacity_;
+  bool executing_{false};
+  bool finished_{false};
+  bool closed_{false};
+};
+}  // namespace
 
-    // parse
-    yyparse();
+dberr_t ExecuteEngine::ExecuteCopy(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteCopy" << std::endl;
+#endif
+  if (current_db_ == "") {
+    return DB_FAILED;
+  }
+  DBStorageEngine *db = dbs_[current_db_];
+  if (db == nullptr) {
+    return DB_FAILED;
+  }
+  std::string table_name = ast->child_->val_;
+  std::string path = ast->child_->next_->val_;
+  auto start_time = std::chrono::high_resolution_clock::now();
+  uint64_t row_count = 0;
+  ImplicitTxn implicit_txn(db->txn_mgr_, context);
+  dberr_t status = db->catalog_mgr_->CopyFrom(table_name, path, context->txn_, row_count);
+  if (status != DB_SUCCESS) {
+    return status;
+  }
+  context->AddAffectedRows(static_cast<int>(row_count));
+  if (!context->disablePrint_ && context->format_ == ResultFormat::kTable) {
+    std::chrono::duration<double> time_span = std::chrono::high_resolution_clock::now() - start_time;
+    double seconds = std::max(time_span.count(), 1e-9);
+    printf("Loaded %lu rows in %.1f ms (%.0f rows/s)\n", static_cast<unsigned long>(row_count), seconds * 1000,
+           row_count / seconds);
+  }
+  return DB_SUCCESS;
+}
 
-    // parse result handle
-    if (MinisqlParserGetError()) {
-      // error
-      printf("%s\n", MinisqlParserGetErrorMessage());
-    } else {
-// #ifdef ENABLE_PARSER_DEBUG
-      // printf("[INFO] Sql syntax parse ok!\n");
-      // SyntaxTreePrinter printer(MinisqlGetParserRootNode());
-      // printer.PrintTree(syntax_tree_file_mgr[syntax_tree_id++]);
-// #endif
+dberr_t ExecuteEngine::ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context) {
+#ifdef ENABLE_EXECUTE_DEBUG
+  LOG(INFO) << "ExecuteExecfile" << std::endl;
+#endif
+  MappedFile script;
+  if (!script.Open(ast->child_->val_)) {
+    LOG(INFO) << "ExecuteExecfile: open file failed" << std::endl;
+    return DB_FAILED;
+  }
+  // the tree of the execfile statement itself stays with the caller, it is
+  // handed back once the script is done
+  pSyntaxNodeList outer_nodes = DetachSyntaxTree();
+  // the whole script is one flex buffer, each yyparse call consumes one statement of it
+  YY_BUFFER_STATE bp = yy_scan_bytes(script.GetSize() > 0 ? script.GetData() : "", script.GetSize());
+  if (bp == nullptr) {
+    LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
+    exit(1);
+  }
+  // parse on a separate thread while the statements parsed so far are executed
+  StatementQueue queue(EXECFILE_PARSE_AHEAD);
+  std::thread parser([&queue, bp]() {
+    while (true) {
+      // a nested execfile switches the scanner to its own buffer
+      yy_switch_to_buffer(bp);
+      MinisqlParserInit();
+      yyparse();
+      ParsedStatement stmt;
+      stmt.root_ = MinisqlGetParserRootNode();
+      stmt.nodes_ = DetachSyntaxTree();
+      if (stmt.root_ == nullptr) {
+        DestroySyntaxNodeList(stmt.nodes_);
+        if (MinisqlParserGetError()) {
+          // the statement with the syntax error has been skipped
+          continue;
+        }
+        break;
+      }
+      bool nested = stmt.root_->type_ == kNodeExecFile;
+      if (!queue.Push(stmt)) {
+        DestroySyntaxNodeList(stmt.nodes_);
+        break;
+      }
+      // the parser is not reentrant, nothing is parsed ahead while a nested script runs
+      if (nested) {
+        queue.WaitIdle();
+      }
     }
+    queue.Finish();
+  });
 
-    ExecuteContext context;
-    context.disablePrint_ = true;
-    this->Execute(MinisqlGetParserRootNode(), &context);
-    // sleep(1);
-
-    // clean memory after parse
-    MinisqlParserFinish();
-    yy_delete_buffer(bp);
-    yylex_destroy();
+  ParsedStatement stmt;
+  while (queue.Pop(stmt)) {
+    ExecuteContext stmt_context;
+    stmt_context.disablePrint_ = true;
+    this->Execute(stmt.root_, &stmt_context);
+    DestroySyntaxNodeList(stmt.nodes_);
 
     // quit condition
-    if (context.flag_quit_) {
+    if (stmt_context.flag_quit_) {
       printf("bye!\n");
+      queue.Close();
       break;
     }
-
   }
+  parser.join();
 
-  fclose(fp);
+  yy_delete_buffer(bp);
+  AttachSyntaxTree(outer_nodes);
 
   return DB_SUCCESS;
 }
@@ -1220,245 +881,14 @@ dberr_t ExecuteEngine::ExecuteQuit(pSyntaxNode ast, ExecuteContext *context) {
   return DB_SUCCESS;
 }
 
-bool ExecuteEngine::ChooseIndex(Schema *schema, std::vector<IndexInfo *> &indexes, pSyntaxNode where_node, ExecuteContext *context, IndexInfo *&pindex, std::vector<Field> &keyRow) {
-  if (where_node == nullptr) {
-    pindex = nullptr;
-    return false;
-  } else {
-    std::vector<int> statusColumns;
-    // 0 - 没出现
-    // 1 - 等值
-    // 2 - 范围 < <= > >=
-    // 4 - 不可用
-    std::vector<Field> conditions;
-    statusColumns.clear();
-    conditions.clear();
-    int attrCount = schema->GetColumnCount();
-    for (int i = 0; i < attrCount; ++ i) {
-      statusColumns.push_back(0);
-      conditions.push_back(Field(schema->GetColumn(i)->GetType()));
-    }
-    EvaluateIndex(where_node->child_, schema, statusColumns, conditions, context);
-    std::vector<int> statusIndexes;
-    // 0 - 不用
-    // 1 - 等值
-    // 2 - 范围
-    statusIndexes.clear();
-    for (int i = 0; i < (int)indexes.size(); ++i) {
-      int res = -1;
-      IndexSchema *indexSchema = indexes[i]->GetIndexKeySchema();
-      for (auto j: indexSchema->GetColumns()) {
-        uint32_t ind = 0;
-        schema->GetColumnIndex(j->GetName(), ind);
-        if (statusColumns[ind] & 4) {
-          res = 0;
-          break;
-        } else if (statusColumns[ind] & 1) {
-          if (res != 2 && res != 0) res = 1;
-          else if (res == 2) {
-            res = 0;
-            break;
-          }
-        } else if (statusColumns[ind] & 2) {
-          if (res != 2 && res != 0) res = 2;
-          else if (res == 2) {
-            res = 0;
-            break;
-          }
-        }
-      }
-      if (res == -1) res = 0;
-      statusIndexes.push_back(res);
-    }
-    for (int i = 0; i < (int)statusIndexes.size(); ++i) {
-      if (statusIndexes[i] == 1) {
-      IndexSchema *indexSchema = indexes[i]->GetIndexKeySchema();
-        pindex = indexes[i];
-        keyRow.clear();
-        for (int j = 0; j < (int)indexSchema->GetColumnCount(); ++j) {
-          uint32_t ind = 0;
-          schema->GetColumnIndex(indexSchema->GetColumn(j)->GetName(), ind);
-          keyRow.push_back(conditions[ind]);
-        }
-        return true;
-      }
-    }
-    pindex = nullptr;
-    return false;
-  }
-}
-
-void ExecuteEngine::EvaluateIndex(pSyntaxNode where_node, Schema *schema, std::vector<int> &statusColumns, std::vector<Field> &conditions, ExecuteContext *context) {
-  if (where_node == nullptr) return;
-  if (where_node->type_ == kNodeConnector) {
-    if (strcmp(where_node->val_, "and") == 0) {
-      EvaluateIndex(where_node->child_, schema, statusColumns, conditions, context);
-      EvaluateIndex(where_node->child_->next_, schema, statusColumns, conditions, context);
-    } else if (strcmp(where_node->val_, "or") == 0) {
-      for (int i = 0; i < (int)statusColumns.size(); ++ i) {
-        statusColumns[i] |= 4;
-      }
-    }
-    return;
-  } else if (where_node->type_ == kNodeCompareOperator) {
-    pSyntaxNode leftNode = where_node->child_;
-    std::string leftName = leftNode->val_;
-    dberr_t err = DB_SUCCESS;
-    uint32_t columnIndex;
-    if ((err = schema->GetColumnIndex(leftName, columnIndex)) != DB_SUCCESS) {
-      context->err_ = err;
-      return;
-    }
-    if (strcmp(where_node->val_, "is") == 0) {
-      statusColumns[columnIndex] |= 4;
-    } else if (strcmp(where_node->val_, "not") == 0) {
-      statusColumns[columnIndex] |= 4;
-    } else if (strcmp(where_node->val_, "=") == 0) {
-      statusColumns[columnIndex] |= 1;
-      pSyntaxNode rightNode = where_node->child_->next_;
-      TypeId type = schema->GetColumn(columnIndex)->GetType();
-      switch (type) {
-        case TypeId::kTypeInt:
-          if (rightNode->type_ != kNodeNumber) {
-            context->err_ = DB_FAILED;
-            return;
-          }
-          conditions[columnIndex] = Field(type, std::stoi(rightNode->val_));
-          break;
-        case TypeId::kTypeFloat:
-          if (rightNode->type_ != kNodeNumber) {
-            context->err_ = DB_FAILED;
-            return;
-          }
-          conditions[columnIndex] = Field(type, std::stof(rightNode->val_));
-          break;
-        case TypeId::kTypeChar:
-          if (rightNode->type_ != kNodeString) {
-            context->err_ = DB_FAILED;
-            return;
-          }
-          conditions[columnIndex] = Field(type, rightNode->val_, strlen(rightNode->val_), true);
-          break;
-        default:
-          context->err_ = DB_FAILED;
-          LOG(INFO) << "Unsupported type" << std::endl;
-          return;
-      }
-    } else if (strcmp(where_node->val_, "<>") == 0) {
-      statusColumns[columnIndex] |= 4;
-    } else if (strcmp(where_node->val_, "<") == 0) {
-      statusColumns[columnIndex] |= 2;
-    } else if (strcmp(where_node->val_, "<=") == 0) {
-      statusColumns[columnIndex] |= 2;
-    } else if (strcmp(where_node->val_, ">") == 0) {
-      statusColumns[columnIndex] |= 2;
-    } else if (strcmp(where_node->val_, ">=") == 0) {
-      statusColumns[columnIndex] |= 2;
-    } else {
-      statusColumns[columnIndex] |= 4;
-      context->err_ = DB_FAILED;
-    }
-    return;
+dberr_t ExecuteEngine::ExecutePlan(AbstractExecutor *plan, ExecuteContext *context) {
+  dberr_t status;
+  if ((status = plan->Init()) != DB_SUCCESS) {
+    return status;
   }
-}
-
-bool ExecuteEngine::EvaluateWhere(pSyntaxNode where_node, const Schema *schema, const Row *row, ExecuteContext *context) {
-  if (where_node == nullptr) {
-    return true;
+  Row *row;
+  while ((status = plan->Next(row)) == DB_SUCCESS && row != nullptr) {
+    context->AddAffectedRows();
   }
-  if (where_node->type_ == kNodeConnector) {
-    if (strcmp(where_node->val_, "and") == 0) {
-      return EvaluateWhere(where_node->child_, schema, row, context)
-        & EvaluateWhere(where_node->child_->next_, schema, row, context);
-    } else if (strcmp(where_node->val_, "or") == 0) {
-      return EvaluateWhere(where_node->child_, schema, row, context)
-        | EvaluateWhere(where_node->child_->next_, schema, row, context);
-    } else {
-      context->err_ = DB_FAILED;
-      return false;
-    }
-  } else if (where_node->type_ == kNodeCompareOperator) {
-    pSyntaxNode leftNode = where_node->child_;
-    pSyntaxNode rightNode = where_node->child_->next_;
-    std::string leftName = leftNode->val_;
-    dberr_t err = DB_SUCCESS;
-    uint32_t columnIndex;
-    if ((err = schema->GetColumnIndex(leftName, columnIndex)) != DB_SUCCESS) {
-      context->err_ = err;
-      return false;
-    }
-    Field *leftField = row->GetField(columnIndex);
-    if (rightNode->type_ == kNodeNull) {
-      if (strcmp(where_node->val_, "is") == 0) {
-        return leftField->IsNull();
-      } else if (strcmp(where_node->val_, "not") == 0) {
-        return !leftField->IsNull();
-      } else {
-        context->err_ = DB_FAILED;
-        return false;
-      }
-    }
-    TypeId type = schema->GetColumn(columnIndex)->GetType();
-    Field *rightField = nullptr;
-    switch (type) {
-      case TypeId::kTypeInt:
-        if (rightNode->type_ != kNodeNumber) {
-          context->err_ = DB_FAILED;
-          return false;
-        }
-        rightField = new Field(type, std::stoi(rightNode->val_));
-        break;
-      case TypeId::kTypeFloat:
-        if (rightNode->type_ != kNodeNumber) {
-          context->err_ = DB_FAILED;
-          return false;
-        }
-        rightField = new Field(type, std::stof(rightNode->val_));
-        break;
-      case TypeId::kTypeChar:
-        if (rightNode->type_ != kNodeString) {
-          context->err_ = DB_FAILED;
-          return false;
-        }
-        rightField = new Field(type, rightNode->val_, strlen(rightNode->val_), true);
-        break;
-      default:
-        context->err_ = DB_FAILED;
-        LOG(INFO) << "Unsupported type" << std::endl;
-        return false;
-    }
-    if (strcmp(where_node->val_, "=") == 0) {
-      return leftField->CompareEquals(*rightField);
-    } else if (strcmp(where_node->val_, "<>") == 0) {
-      return leftField->CompareNotEquals(*rightField);
-    } else if (strcmp(where_node->val_, "<") == 0) {
-      return leftField->CompareLessThan(*rightField);
-    } else if (strcmp(where_node->val_, "<=") == 0) {
-      return leftField->CompareLessThanEquals(*rightField);
-    } else if (strcmp(where_node->val_, ">") == 0) {
-      return leftField->CompareGreaterThan(*rightField);
-    } else if (strcmp(where_node->val_, ">=") == 0) {
-      return leftField->CompareGreaterThanEquals(*rightField);
-    } else {
-      context->err_ = DB_FAILED;
-      return false;
-    }
-    delete rightField;
-  }
-  return false;
+  return status;
 }
-
-void ExecuteEngine::InputCommand(char *input, const int len, FILE* fp) {
-  memset(input, 0, len);
-  int i = 0;
-  char ch;
-  while ((ch = fgetc(fp)) == '\r' || ch == '\n') {
-    continue;
-  }
-  while (ch != ';' && ch != EOF) {
-    input[i++] = ch;
-    ch = fgetc(fp);
-  }
-  if (ch == EOF) return;
-  input[i] = ch;    // ;
-}
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "executor/expression.h"
+#include "glog/logging.h"
+
+dberr_t Expression::Compile(pSyntaxNode condition, const Schema *schema, std::unique_ptr<Expression> &expr) {
+  if (condition == nullptr) {
+    return DB_FAILED;
+  }
+  if (condition->type_ == kNodeConnector) {
+    if (strcmp(condition->val_, "and") == 0) {
+      expr.reset(new Expression(ExpressionType::kAnd));
+    } else if (strcmp(condition->val_, "or") == 0) {
+      expr.reset(new Expression(ExpressionType::kOr));
+    } else {
+      return DB_FAILED;
+    }
+    dberr_t err;
+    if ((err = Compile(condition->child_, schema, expr->left_)) != DB_SUCCESS) {
+      return err;
+    }
+    return Compile(condition->child_->next_, schema, expr->right_);
+  }
+  if (condition->type_ != kNodeCompareOperator) {
+    return DB_FAILED;
+  }
+  pSyntaxNode leftNode = condition->child_;
+  pSyntaxNode rightNode = condition->child_->next_;
+  uint32_t columnIndex;
+  dberr_t err;
+  if ((err = schema->GetColumnIndex(leftNode->val_, columnIndex)) != DB_SUCCESS) {
+    return err;
+  }
+  if (rightNode->type_ == kNodeNull) {
+    if (strcmp(condition->val_, "is") == 0) {
+      expr.reset(new Expression(ExpressionType::kIsNull));
+    } else if (strcmp(condition->val_, "not") == 0) {
+      expr.reset(new Expression(ExpressionType::kIsNotNull));
+    } else {
+      return DB_FAILED;
+    }
+    expr->column_ = columnIndex;
+    return DB_SUCCESS;
+  }
+  CompareType compare;
+  if (strcmp(condition->val_, "=") == 0) {
+    compare = CompareType::kEqual;
+  } else if (strcmp(condition->val_, "<>") == 0) {
+    compare = CompareType::kNotEqual;
+  } else if (strcmp(condition->val_, "<") == 0) {
+    compare = CompareType::kLessThan;
+  } else if (strcmp(condition->val_, "<=") == 0) {
+    compare = CompareType::kLessThanEquals;
+  } else if (strcmp(condition->val_, ">") == 0) {
+    compare = CompareType::kGreaterThan;
+  } else if (strcmp(condition->val_, ">=") == 0) {
+    compare = CompareType::kGreaterThanEquals;
+  } else {
+    return DB_FAILED;
+  }
+  TypeId type = schema->GetColumn(columnIndex)->GetType();
+  auto constant = std::make_unique<Field>(type);
+  if (ParseConstant(type, rightNode, *constant) != DB_SUCCESS) {
+    return DB_FAILED;
+  }
+  expr.reset(new Expression(ExpressionType::kCompare));
+  expr->compare_ = compare;
+  expr->column_ = columnIndex;
+  expr->constant_ = std::move(constant);
+  return DB_SUCCESS;
+}
+
+dberr_t Expression::ParseConstant(TypeId type, pSyntaxNode node, Field &field) {
+  char *end = nullptr;
+  errno = 0;
+  switch (type) {
+    case TypeId::kTypeInt: {
+      if (node->type_ != kNodeNumber) {
+        return DB_FAILED;
+      }
+      long value = strtol(node->val_, &end, 10);
+      if (*end != '\0' || errno == ERANGE || value < INT32_MIN || value > INT32_MAX) {
+        LOG(INFO) << node->val_ << " is not an int" << std::endl;
+        return DB_FAILED;
+      }
+      field = Field(type, static_cast<int32_t>(value));
+      return DB_SUCCESS;
+    }
+    case TypeId::kTypeFloat: {
+      if (node->type_ != kNodeNumber) {
+        return DB_FAILED;
+      }
+      float value = strtof(node->val_, &end);
+      if (*end != '\0' || errno == ERANGE) {
+        LOG(INFO) << node->val_ << " is not a float" << std::endl;
+        return DB_FAILED;
+      }
+      field = Field(type, value);
+      return DB_SUCCESS;
+    }
+    case TypeId::kTypeChar:
+      if (node->type_ != kNodeString) {
+        return DB_FAILED;
+      }
+      field = Field(type, node->val_, strlen(node->val_), true);
+      return DB_SUCCESS;
+    default:
+      LOG(INFO) << "Unsupported type" << std::endl;
+      return DB_FAILED;
+  }
+}
+
+bool Expression::Evaluate(const Row *row) const {
+  switch (type_) {
+    case ExpressionType::kAnd:
+      return left_->Evaluate(row) && right_->Evaluate(row);
+    case ExpressionType::kOr:
+      return left_->Evaluate(row) || right_->Evaluate(row);
+    case ExpressionType::kIsNull:
+      return row->GetField(column_)->IsNull();
+    case ExpressionType::kIsNotNull:
+      return !row->GetField(column_)->IsNull();
+    case ExpressionType::kCompare:
+      break;
+  }
+  const Field *field = row->GetField(column_);
+  CmpBool res;
+  switch (compare_) {
+    case CompareType::kEqual:
+      res = field->CompareEquals(*constant_);
+      break;
+    case CompareType::kNotEqual:
+      res = field->CompareNotEquals(*constant_);
+      break;
+    case CompareType::kLessThan:
+      res = field->CompareLessThan(*constant_);
+      break;
+    case CompareType::kLessThanEquals:
+      res = field->CompareLessThanEquals(*constant_);
+      break;
+    case CompareType::kGreaterThan:
+      res = field->CompareGreaterThan(*constant_);
+      break;
+    case CompareType::kGreaterThanEquals:
+      res = field->CompareGreaterThanEquals(*constant_);
+      break;
+    default:
+      res = CmpBool::kFalse;
+  }
+  return res == CmpBool::kTrue;
+}
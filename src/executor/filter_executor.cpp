@@ -0,0 +1,19 @@
+#include "executor/filter_executor.h"
+
+FilterExecutor::FilterExecutor(std::unique_ptr<AbstractExecutor> child, std::unique_ptr<Expression> predicate)
+        : child_(std::move(child)),
+          predicate_(std::move(predicate)) {}
+
+dberr_t FilterExecutor::Init() {
+  return child_->Init();
+}
+
+dberr_t FilterExecutor::Next(Row *&row) {
+  dberr_t err;
+  while ((err = child_->Next(row)) == DB_SUCCESS && row != nullptr) {
+    if (predicate_->Evaluate(row)) {
+      return DB_SUCCESS;
+    }
+  }
+  return err;
+}
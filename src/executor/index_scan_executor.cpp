@@ -0,0 +1,41 @@
+#include "executor/index_scan_executor.h"
+
+IndexScanExecutor::IndexScanExecutor(TableInfo *table_info, IndexInfo *index_info, IndexScanKey scan_key,
+                                     Transaction *txn)
+        : table_info_(table_info),
+          index_info_(index_info),
+          scan_key_(std::move(scan_key)),
+          txn_(txn) {}
+
+dberr_t IndexScanExecutor::Init() {
+  rids_.clear();
+  cursor_ = 0;
+  Index *index = index_info_->GetIndex();
+  if (!scan_key_.is_range_) {
+    Row key(scan_key_.key_);
+    dberr_t status = index->ScanKey(key, rids_, txn_);
+    return status == DB_KEY_NOT_FOUND ? DB_SUCCESS : status;
+  }
+  std::unique_ptr<Row> low, high;
+  if (!scan_key_.low_.empty()) {
+    low = std::make_unique<Row>(scan_key_.low_);
+  }
+  if (!scan_key_.high_.empty()) {
+    high = std::make_unique<Row>(scan_key_.high_);
+  }
+  return index->ScanRange(low.get(), scan_key_.low_inclusive_, high.get(), scan_key_.high_inclusive_, rids_, txn_);
+}
+
+dberr_t IndexScanExecutor::Next(Row *&row) {
+  while (cursor_ < rids_.size()) {
+    RowId rid = rids_[cursor_++];
+    row_.SetRowId(rid);
+    if (table_info_->GetTableHeap()->GetTuple(&row_, txn_)) {
+      row_.SetRowId(rid);
+      row = &row_;
+      return DB_SUCCESS;
+    }
+  }
+  row = nullptr;
+  return DB_SUCCESS;
+}
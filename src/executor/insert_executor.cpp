@@ -0,0 +1,80 @@
+#include "executor/insert_executor.h"
+
+InsertExecutor::InsertExecutor(TableInfo *table_info, std::vector<IndexInfo *> indexes,
+                               std::vector<std::vector<Field>> rows, Transaction *txn)
+        : table_info_(table_info),
+          indexes_(std::move(indexes)),
+          values_(std::move(rows)),
+          txn_(txn) {}
+
+dberr_t InsertExecutor::Init() {
+  rows_.clear();
+  inserted_ = false;
+  cursor_ = 0;
+  return DB_SUCCESS;
+}
+
+dberr_t InsertExecutor::Next(Row *&row) {
+  row = nullptr;
+  if (!inserted_) {
+    dberr_t status = InsertAll();
+    if (status != DB_SUCCESS) {
+      return status;
+    }
+    inserted_ = true;
+  }
+  if (cursor_ < rows_.size()) {
+    row = &rows_[cursor_++];
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t InsertExecutor::InsertAll() {
+  rows_.reserve(values_.size());
+  for (auto &fields : values_) {
+    rows_.emplace_back(fields);
+  }
+  if (!table_info_->GetTableHeap()->InsertTuples(rows_, txn_)) {
+    Undo(0, 0, {}, {});
+    return DB_FAILED;
+  }
+  for (size_t i = 0; i < indexes_.size(); i++) {
+    std::vector<Row> keys;
+    keys.reserve(rows_.size());
+    for (auto &row : rows_) {
+      keys.push_back(MakeKey(row, indexes_[i]));
+    }
+    // neighbouring keys go to the same leaf, so the tree is walked along instead of all over
+    std::vector<size_t> order = Index::SortKeys(keys);
+    for (size_t j = 0; j < order.size(); j++) {
+      dberr_t status = indexes_[i]->GetIndex()->InsertEntry(keys[order[j]], rows_[order[j]].GetRowId(), txn_);
+      if (status != DB_SUCCESS) {
+        Undo(i, j, keys, order);
+        return status;
+      }
+    }
+  }
+  return DB_SUCCESS;
+}
+
+void InsertExecutor::Undo(size_t index, size_t inserted, const std::vector<Row> &keys,
+                          const std::vector<size_t> &order) {
+  for (size_t j = 0; j < inserted; j++) {
+    indexes_[index]->GetIndex()->RemoveEntry(keys[order[j]], rows_[order[j]].GetRowId(), txn_);
+  }
+  for (size_t i = 0; i < index; i++) {
+    for (auto &row : rows_) {
+      Row key = MakeKey(row, indexes_[i]);
+      indexes_[i]->GetIndex()->RemoveEntry(key, row.GetRowId(), txn_);
+    }
+  }
+  TableHeap *table_heap = table_info_->GetTableHeap();
+  for (auto &row : rows_) {
+    if (row.GetRowId().GetPageId() == INVALID_PAGE_ID) {
+      continue;
+    }
+    table_heap->MarkDelete(row.GetRowId(), txn_);
+    table_heap->ApplyDelete(row.GetRowId(), txn_);
+  }
+  rows_.clear();
+}
@@ -0,0 +1,398 @@
+#include <cstring>
+
+#include "executor/delete_executor.h"
+#include "executor/expression.h"
+#include "executor/filter_executor.h"
+#include "executor/insert_executor.h"
+#include "executor/planner.h"
+#include "executor/projection_executor.h"
+#include "executor/seq_scan_executor.h"
+#include "executor/update_executor.h"
+#include "glog/logging.h"
+
+dberr_t Planner::PlanSelect(pSyntaxNode ast, std::unique_ptr<AbstractExecutor> &plan, std::vector<std::string> &columns) {
+  pSyntaxNode select_node = ast->child_;
+  pSyntaxNode from_node = select_node->next_;
+  pSyntaxNode where_node = from_node->next_;
+  dberr_t status;
+  std::string tableName = std::string(from_node->val_);
+  TableInfo *tableInfo = nullptr;
+  if ((status = catalog_->GetTable(tableName, tableInfo)) != DB_SUCCESS) {
+    return status;
+  }
+  std::vector<IndexInfo *> indexes;
+  if ((status = catalog_->GetTableIndexes(tableName, indexes)) != DB_SUCCESS) {
+    return status;
+  }
+  Schema *schema = tableInfo->GetSchema();
+  std::vector<uint32_t> selectIdx;
+  if (select_node->type_ == kNodeAllColumns) {
+    for (uint32_t i = 0; i < schema->GetColumnCount(); ++i) {
+      selectIdx.push_back(i);
+    }
+  } else if (select_node->type_ == kNodeColumnList) {
+    for (pSyntaxNode select_col_node = select_node->child_; select_col_node != nullptr; select_col_node = select_col_node->next_) {
+      uint32_t ind = 0;
+      if ((status = schema->GetColumnIndex(std::string(select_col_node->val_), ind)) != DB_SUCCESS) {
+        return status;
+      }
+      selectIdx.push_back(ind);
+    }
+  } else {
+    return DB_FAILED;
+  }
+  columns.clear();
+  for (auto col: selectIdx) {
+    columns.push_back(schema->GetColumn(col)->GetName());
+  }
+  std::unique_ptr<AbstractExecutor> scan;
+  if ((status = PlanScan(tableInfo, indexes, where_node, scan)) != DB_SUCCESS) {
+    return status;
+  }
+  plan = std::make_unique<ProjectionExecutor>(std::move(scan), std::move(selectIdx));
+  return DB_SUCCESS;
+}
+
+dberr_t Planner::PlanInsert(pSyntaxNode ast, std::unique_ptr<AbstractExecutor> &plan) {
+  pSyntaxNode insert_node = ast->child_;
+  pSyntaxNode values_node = insert_node->next_;
+  std::string tableName = std::string(insert_node->val_);
+  TableInfo *tableInfo = nullptr;
+  dberr_t status;
+  if ((status = catalog_->GetTable(tableName, tableInfo)) != DB_SUCCESS) {
+    LOG(INFO) << "Table not found" << std::endl;
+    return status;
+  }
+  Schema *schema = tableInfo->GetSchema();
+  uint32_t columnCnt = schema->GetColumnCount();
+  std::vector<std::vector<Field>> rows;
+  // one kNodeColumnValues per tuple
+  for (pSyntaxNode tuple_node = values_node; tuple_node != nullptr; tuple_node = tuple_node->next_) {
+    std::vector<Field> columns;
+    columns.reserve(columnCnt);
+    pSyntaxNode value_node = tuple_node->child_;
+    for (uint32_t i = 0; i < columnCnt; ++i) {
+      if (value_node == nullptr) {
+        LOG(INFO) << "Number of values incorrect" << std::endl;
+        return DB_FAILED;
+      }
+      columns.emplace_back(schema->GetColumn(i)->GetType());
+      if ((status = ParseValue(schema->GetColumn(i), value_node, columns.back(), true)) != DB_SUCCESS) {
+        return status;
+      }
+      value_node = value_node->next_;
+    }
+    if (value_node != nullptr) {
+      LOG(INFO) << "Number of values incorrect" << std::endl;
+      return DB_FAILED;
+    }
+    rows.push_back(std::move(columns));
+  }
+  std::vector<IndexInfo *> indexes;
+  if ((status = catalog_->GetTableIndexes(tableName, indexes)) != DB_SUCCESS) {
+    return status;
+  }
+  plan = std::make_unique<InsertExecutor>(tableInfo, std::move(indexes), std::move(rows), txn_);
+  return DB_SUCCESS;
+}
+
+dberr_t Planner::PlanUpdate(pSyntaxNode ast, std::unique_ptr<AbstractExecutor> &plan) {
+  pSyntaxNode update_node = ast->child_;
+  pSyntaxNode set_node = update_node->next_;
+  pSyntaxNode where_node = set_node->next_;
+  std::string tableName = update_node->val_;
+  dberr_t status;
+  TableInfo *tableInfo = nullptr;
+  if ((status = catalog_->GetTable(tableName, tableInfo)) != DB_SUCCESS) {
+    return status;
+  }
+  std::vector<IndexInfo *> indexes;
+  if ((status = catalog_->GetTableIndexes(tableName, indexes)) != DB_SUCCESS) {
+    return status;
+  }
+  Schema *schema = tableInfo->GetSchema();
+  std::vector<uint32_t> setColumns;
+  std::vector<Field> setValues;
+  for (pSyntaxNode set_node_item = set_node->child_; set_node_item != nullptr; set_node_item = set_node_item->next_) {
+    uint32_t ind = 0;
+    pSyntaxNode set_column_node = set_node_item->child_;
+    pSyntaxNode set_value_node = set_column_node->next_;
+    if ((status = schema->GetColumnIndex(set_column_node->val_, ind)) != DB_SUCCESS) {
+      return status;
+    }
+    setColumns.push_back(ind);
+    setValues.emplace_back(schema->GetColumn(ind)->GetType());
+    if ((status = ParseValue(schema->GetColumn(ind), set_value_node, setValues.back(), false)) != DB_SUCCESS) {
+      return status;
+    }
+  }
+  std::unique_ptr<AbstractExecutor> scan;
+  if ((status = PlanScan(tableInfo, indexes, where_node, scan)) != DB_SUCCESS) {
+    return status;
+  }
+  plan = std::make_unique<UpdateExecutor>(std::move(scan), tableInfo, std::move(indexes), std::move(setColumns),
+                                          std::move(setValues), txn_);
+  return DB_SUCCESS;
+}
+
+dberr_t Planner::PlanDelete(pSyntaxNode ast, std::unique_ptr<AbstractExecutor> &plan) {
+  pSyntaxNode delete_node = ast->child_;
+  pSyntaxNode where_node = delete_node->next_;
+  std::string tableName = delete_node->val_;
+  dberr_t status;
+  TableInfo *tableInfo = nullptr;
+  if ((status = catalog_->GetTable(tableName, tableInfo)) != DB_SUCCESS) {
+    return status;
+  }
+  std::vector<IndexInfo *> indexes;
+  if ((status = catalog_->GetTableIndexes(tableName, indexes)) != DB_SUCCESS) {
+    return status;
+  }
+  std::unique_ptr<AbstractExecutor> scan;
+  if ((status = PlanScan(tableInfo, indexes, where_node, scan)) != DB_SUCCESS) {
+    return status;
+  }
+  plan = std::make_unique<DeleteExecutor>(std::move(scan), tableInfo, std::move(indexes), txn_);
+  return DB_SUCCESS;
+}
+
+dberr_t Planner::PlanScan(TableInfo *table_info, std::vector<IndexInfo *> &indexes, pSyntaxNode where_node,
+                          std::unique_ptr<AbstractExecutor> &plan) {
+  // the condition is bound to the schema once, before any row is read
+  std::unique_ptr<Expression> predicate;
+  dberr_t err;
+  if (where_node != nullptr &&
+      (err = Expression::Compile(where_node->child_, table_info->GetSchema(), predicate)) != DB_SUCCESS) {
+    return err;
+  }
+  IndexInfo *pindex = nullptr;
+  IndexScanKey scanKey;
+  err_ = DB_SUCCESS;
+  bool useIndex = ChooseIndex(table_info->GetSchema(), indexes, where_node, pindex, scanKey);
+  if (err_ != DB_SUCCESS) {
+    return err_;
+  }
+  if (useIndex) {
+    plan = std::make_unique<IndexScanExecutor>(table_info, pindex, std::move(scanKey), txn_);
+  } else {
+    plan = std::make_unique<SeqScanExecutor>(table_info, txn_);
+  }
+  // the index only narrows down the rows, every one of them is still checked against the whole condition
+  if (predicate != nullptr) {
+    plan = std::make_unique<FilterExecutor>(std::move(plan), std::move(predicate));
+  }
+  return DB_SUCCESS;
+}
+
+bool Planner::ChooseIndex(Schema *schema, std::vector<IndexInfo *> &indexes, pSyntaxNode where_node, IndexInfo *&pindex,
+                          IndexScanKey &scanKey) {
+  if (where_node == nullptr) {
+    pindex = nullptr;
+    return false;
+  } else {
+    std::vector<int> statusColumns;
+    // 0 - 没出现
+    // 1 - 等值
+    // 2 - 范围 < <= > >=
+    // 4 - 不可用
+    std::vector<ColumnBound> conditions;
+    statusColumns.clear();
+    conditions.clear();
+    int attrCount = schema->GetColumnCount();
+    conditions.reserve(attrCount);
+    for (int i = 0; i < attrCount; ++ i) {
+      statusColumns.push_back(0);
+      conditions.emplace_back(schema->GetColumn(i)->GetType());
+    }
+    EvaluateIndex(where_node->child_, schema, statusColumns, conditions);
+    std::vector<int> statusIndexes;
+    // 0 - 不用
+    // 1 - 等值
+    // 2 - 范围
+    statusIndexes.clear();
+    for (int i = 0; i < (int)indexes.size(); ++i) {
+      int res = -1;
+      IndexSchema *indexSchema = indexes[i]->GetIndexKeySchema();
+      for (auto j: indexSchema->GetColumns()) {
+        uint32_t ind = 0;
+        schema->GetColumnIndex(j->GetName(), ind);
+        if (statusColumns[ind] & 4) {
+          res = 0;
+          break;
+        } else if (statusColumns[ind] & 1) {
+          if (res != 2 && res != 0) res = 1;
+          else if (res == 2) {
+            res = 0;
+            break;
+          }
+        } else if (statusColumns[ind] & 2) {
+          if (res != 2 && res != 0) res = 2;
+          else if (res == 2) {
+            res = 0;
+            break;
+          }
+        }
+      }
+      if (res == -1) res = 0;
+      statusIndexes.push_back(res);
+    }
+    // 等值查找优先
+    for (int i = 0; i < (int)statusIndexes.size(); ++i) {
+      if (statusIndexes[i] == 1) {
+      IndexSchema *indexSchema = indexes[i]->GetIndexKeySchema();
+        pindex = indexes[i];
+        scanKey.is_range_ = false;
+        scanKey.key_.clear();
+        for (int j = 0; j < (int)indexSchema->GetColumnCount(); ++j) {
+          uint32_t ind = 0;
+          schema->GetColumnIndex(indexSchema->GetColumn(j)->GetName(), ind);
+          scanKey.key_.push_back(conditions[ind].equal_);
+        }
+        return true;
+      }
+    }
+    // 其次是单列索引上的范围扫描，多列索引的键无法只按第一列确定范围
+    for (int i = 0; i < (int)statusIndexes.size(); ++i) {
+      IndexSchema *indexSchema = indexes[i]->GetIndexKeySchema();
+      if (statusIndexes[i] == 2 && indexSchema->GetColumnCount() == 1) {
+        uint32_t ind = 0;
+        schema->GetColumnIndex(indexSchema->GetColumn(0)->GetName(), ind);
+        ColumnBound &bound = conditions[ind];
+        pindex = indexes[i];
+        scanKey.is_range_ = true;
+        scanKey.low_.clear();
+        scanKey.high_.clear();
+        if (bound.has_low_) {
+          scanKey.low_.push_back(bound.low_);
+          scanKey.low_inclusive_ = bound.low_inclusive_;
+        }
+        if (bound.has_high_) {
+          scanKey.high_.push_back(bound.high_);
+          scanKey.high_inclusive_ = bound.high_inclusive_;
+        }
+        return true;
+      }
+    }
+    pindex = nullptr;
+    return false;
+  }
+}
+
+bool Planner::ParseConstant(TypeId type, pSyntaxNode node, Field &field) {
+  // the where condition refuses the same constant when it is compiled
+  if (Expression::ParseConstant(type, node, field) != DB_SUCCESS) {
+    err_ = DB_FAILED;
+    return false;
+  }
+  return true;
+}
+
+void Planner::EvaluateIndex(pSyntaxNode where_node, Schema *schema, std::vector<int> &statusColumns,
+                            std::vector<ColumnBound> &conditions) {
+  if (where_node == nullptr) return;
+  if (where_node->type_ == kNodeConnector) {
+    if (strcmp(where_node->val_, "and") == 0) {
+      EvaluateIndex(where_node->child_, schema, statusColumns, conditions);
+      EvaluateIndex(where_node->child_->next_, schema, statusColumns, conditions);
+    } else if (strcmp(where_node->val_, "or") == 0) {
+      for (int i = 0; i < (int)statusColumns.size(); ++ i) {
+        statusColumns[i] |= 4;
+      }
+    }
+    return;
+  } else if (where_node->type_ == kNodeCompareOperator) {
+    pSyntaxNode leftNode = where_node->child_;
+    std::string leftName = leftNode->val_;
+    dberr_t err = DB_SUCCESS;
+    uint32_t columnIndex;
+    if ((err = schema->GetColumnIndex(leftName, columnIndex)) != DB_SUCCESS) {
+      err_ = err;
+      return;
+    }
+    pSyntaxNode rightNode = where_node->child_->next_;
+    TypeId type = schema->GetColumn(columnIndex)->GetType();
+    ColumnBound &bound = conditions[columnIndex];
+    bool lower = false, upper = false, inclusive = false;
+    if (strcmp(where_node->val_, "is") == 0) {
+      statusColumns[columnIndex] |= 4;
+    } else if (strcmp(where_node->val_, "not") == 0) {
+      statusColumns[columnIndex] |= 4;
+    } else if (strcmp(where_node->val_, "=") == 0) {
+      statusColumns[columnIndex] |= 1;
+      ParseConstant(type, rightNode, bound.equal_);
+    } else if (strcmp(where_node->val_, "<>") == 0) {
+      statusColumns[columnIndex] |= 4;
+    } else if (strcmp(where_node->val_, "<") == 0) {
+      upper = true;
+    } else if (strcmp(where_node->val_, "<=") == 0) {
+      upper = inclusive = true;
+    } else if (strcmp(where_node->val_, ">") == 0) {
+      lower = true;
+    } else if (strcmp(where_node->val_, ">=") == 0) {
+      lower = inclusive = true;
+    } else {
+      statusColumns[columnIndex] |= 4;
+      err_ = DB_FAILED;
+    }
+    if (lower || upper) {
+      Field value(type);
+      // 不是该列类型的常量不作为索引的边界，整个查询报错
+      if (!ParseConstant(type, rightNode, value)) {
+        return;
+      }
+      statusColumns[columnIndex] |= 2;
+      // 同一列上的多个条件取最紧的边界
+      if (lower) {
+        if (!bound.has_low_ || value.CompareGreaterThan(bound.low_) == CmpBool::kTrue ||
+            (value.CompareEquals(bound.low_) == CmpBool::kTrue && !inclusive)) {
+          bound.low_ = Field(value);
+          bound.has_low_ = true;
+          bound.low_inclusive_ = inclusive;
+        }
+      } else {
+        if (!bound.has_high_ || value.CompareLessThan(bound.high_) == CmpBool::kTrue ||
+            (value.CompareEquals(bound.high_) == CmpBool::kTrue && !inclusive)) {
+          bound.high_ = Field(value);
+          bound.has_high_ = true;
+          bound.high_inclusive_ = inclusive;
+        }
+      }
+    }
+    return;
+  }
+}
+
+dberr_t Planner::ParseValue(const Column *column, pSyntaxNode node, Field &field, bool check_length) {
+  TypeId type = column->GetType();
+  if (node->type_ == kNodeNull) {
+    if (!column->IsNullable()) {
+      LOG(INFO) << "Not nullable" << std::endl;
+      return DB_FAILED;
+    }
+    field = Field(type);
+    return DB_SUCCESS;
+  }
+  switch (type) {
+    case TypeId::kTypeInt:
+    case TypeId::kTypeFloat:
+      if (node->type_ != kNodeNumber) {
+        LOG(INFO) << "Wrong type" << std::endl;
+        return DB_FAILED;
+      }
+      return Expression::ParseConstant(type, node, field);
+    case TypeId::kTypeChar:
+      if (node->type_ != kNodeString) {
+        LOG(INFO) << "Wrong type" << std::endl;
+        return DB_FAILED;
+      }
+      if (check_length && strlen(node->val_) != column->GetLength()) {
+        LOG(INFO) << "String length incorrect" << std::endl;
+        return DB_FAILED;
+      }
+      field = Field(type, node->val_, strlen(node->val_), true);
+      return DB_SUCCESS;
+    default:
+      LOG(INFO) << "Unsupported type" << std::endl;
+      return DB_FAILED;
+  }
+}
@@ -0,0 +1,27 @@
+#include "executor/projection_executor.h"
+
+ProjectionExecutor::ProjectionExecutor(std::unique_ptr<AbstractExecutor> child, std::vector<uint32_t> columns)
+        : child_(std::move(child)),
+          columns_(std::move(columns)) {}
+
+dberr_t ProjectionExecutor::Init() {
+  return child_->Init();
+}
+
+dberr_t ProjectionExecutor::Next(Row *&row) {
+  Row *child_row;
+  dberr_t err = child_->Next(child_row);
+  if (err != DB_SUCCESS || child_row == nullptr) {
+    row = nullptr;
+    return err;
+  }
+  std::vector<Field> fields;
+  fields.reserve(columns_.size());
+  for (auto column : columns_) {
+    fields.emplace_back(*child_row->GetField(column));
+  }
+  row_ = std::make_unique<Row>(fields);
+  row_->SetRowId(child_row->GetRowId());
+  row = row_.get();
+  return DB_SUCCESS;
+}
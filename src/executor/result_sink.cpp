@@ -0,0 +1,206 @@
+#include "executor/result_sink.h"
+
+std::unique_ptr<ResultSink> ResultSink::Create(ResultFormat format, FILE *out) {
+  switch (format) {
+    case ResultFormat::kCsv:
+      return std::make_unique<CsvResultSink>(out);
+    case ResultFormat::kBinary:
+      return std::make_unique<BinaryResultSink>(out);
+    case ResultFormat::kTable:
+    default:
+      return std::make_unique<TableResultSink>(out);
+  }
+}
+
+void ResultSink::Flush() {
+  if (!buffer_.empty()) {
+    fwrite(buffer_.data(), 1, buffer_.size(), out_);
+    buffer_.clear();
+  }
+}
+
+/*****************************************************************************
+ * TableResultSink
+ *****************************************************************************/
+void TableResultSink::Begin(const std::vector<std::string> &columns) {
+  header_ = columns;
+  widths_.clear();
+  for (auto &name : header_) {
+    widths_.push_back(name.size());
+  }
+}
+
+void TableResultSink::Write(const Row &row) {
+  std::vector<std::string> values;
+  values.reserve(row.GetFieldCount());
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    values.push_back(row.GetField(i)->GetString());
+  }
+  rows_.push_back(std::move(values));
+  row_count_++;
+  if (rows_.size() >= max_buffered_rows_) {
+    WriteBufferedRows();
+  }
+}
+
+void TableResultSink::End() {
+  WriteBufferedRows();
+  if (!header_.empty()) {
+    WriteDivider();
+  }
+  Flush();
+}
+
+void TableResultSink::WriteBufferedRows() {
+  bool widened = false;
+  for (auto &values : rows_) {
+    for (size_t i = 0; i < values.size() && i < widths_.size(); i++) {
+      if (values[i].size() > widths_[i]) {
+        widths_[i] = values[i].size();
+        widened = true;
+      }
+    }
+  }
+  if (!header_written_) {
+    if (!header_.empty()) {
+      WriteDivider();
+      WriteLine(header_);
+      WriteDivider();
+    }
+    header_written_ = true;
+  } else if (widened) {
+    WriteDivider();
+  }
+  for (auto &values : rows_) {
+    WriteLine(values);
+  }
+  rows_.clear();
+}
+
+void TableResultSink::WriteDivider() {
+  Append('+');
+  for (auto width : widths_) {
+    buffer_.append(width + 2, '-');
+    Append('+');
+  }
+  Append('\n');
+}
+
+void TableResultSink::WriteLine(const std::vector<std::string> &values) {
+  if (values.empty()) {
+    return;
+  }
+  Append('|');
+  for (size_t i = 0; i < values.size(); i++) {
+    Append(' ');
+    buffer_.append(values[i]);
+    if (i < widths_.size() && values[i].size() < widths_[i]) {
+      buffer_.append(widths_[i] - values[i].size(), ' ');
+    }
+    Append(" |", 2);
+  }
+  Append('\n');
+}
+
+/*****************************************************************************
+ * CsvResultSink
+ *****************************************************************************/
+void CsvResultSink::Begin(const std::vector<std::string> &columns) {
+  for (size_t i = 0; i < columns.size(); i++) {
+    if (i > 0) {
+      Append(',');
+    }
+    WriteValue(columns[i].data(), columns[i].size());
+  }
+  Append('\n');
+}
+
+void CsvResultSink::Write(const Row &row) {
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    if (i > 0) {
+      Append(',');
+    }
+    const Field *field = row.GetField(i);
+    if (field->IsNull()) {
+      continue;
+    }
+    if (field->GetTypeId() == TypeId::kTypeChar) {
+      WriteValue(field->GetData(), field->GetLength());
+    } else {
+      Append(field->GetString());
+    }
+  }
+  Append('\n');
+  row_count_++;
+}
+
+void CsvResultSink::End() {
+  Flush();
+}
+
+void CsvResultSink::WriteValue(const char *data, size_t len) {
+  bool quote = len == 0;
+  for (size_t i = 0; i < len && !quote; i++) {
+    quote = data[i] == ',' || data[i] == '"' || data[i] == '\n' || data[i] == '\r';
+  }
+  if (!quote) {
+    Append(data, len);
+    return;
+  }
+  // an empty string is quoted so that it reads back differently from null
+  Append('"');
+  for (size_t i = 0; i < len; i++) {
+    if (data[i] == '"') {
+      Append('"');
+    }
+    Append(data[i]);
+  }
+  Append('"');
+}
+
+/*****************************************************************************
+ * BinaryResultSink
+ *****************************************************************************/
+void BinaryResultSink::Begin(const std::vector<std::string> &columns) {
+  AppendUInt32(columns.size());
+  for (auto &name : columns) {
+    AppendUInt32(name.size());
+    Append(name);
+  }
+}
+
+void BinaryResultSink::Write(const Row &row) {
+  char buf[sizeof(uint32_t) + PAGE_SIZE];
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    const Field *field = row.GetField(i);
+    if (field->IsNull()) {
+      Append(static_cast<char>(TAG_NULL));
+      continue;
+    }
+    switch (field->GetTypeId()) {
+      case TypeId::kTypeInt:
+        Append(static_cast<char>(TAG_INT));
+        break;
+      case TypeId::kTypeFloat:
+        Append(static_cast<char>(TAG_FLOAT));
+        break;
+      default:
+        Append(static_cast<char>(TAG_CHAR));
+        break;
+    }
+    // int and float are written as their 4 bytes, char as its length followed by the bytes
+    Append(buf, field->SerializeTo(buf));
+  }
+  row_count_++;
+}
+
+void BinaryResultSink::End() {
+  Append(static_cast<char>(TAG_END));
+  Flush();
+}
+
+void BinaryResultSink::AppendUInt32(uint32_t val) {
+  char buf[sizeof(uint32_t)];
+  memcpy(buf, &val, sizeof(uint32_t));
+  Append(buf, sizeof(uint32_t));
+}
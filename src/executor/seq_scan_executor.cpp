@@ -0,0 +1,23 @@
+#include "executor/seq_scan_executor.h"
+
+SeqScanExecutor::SeqScanExecutor(TableInfo *table_info, Transaction *txn)
+        : table_info_(table_info),
+          txn_(txn),
+          iter_(table_info->GetTableHeap()->End()),
+          end_(table_info->GetTableHeap()->End()) {}
+
+dberr_t SeqScanExecutor::Init() {
+  iter_ = table_info_->GetTableHeap()->Begin(txn_);
+  started_ = false;
+  return DB_SUCCESS;
+}
+
+dberr_t SeqScanExecutor::Next(Row *&row) {
+  // advance only now, the row produced last time must stay valid until this call
+  if (started_) {
+    ++iter_;
+  }
+  started_ = true;
+  row = iter_ == end_ ? nullptr : iter_.operator->();
+  return DB_SUCCESS;
+}
@@ -0,0 +1,69 @@
+#include "executor/update_executor.h"
+#include "glog/logging.h"
+
+UpdateExecutor::UpdateExecutor(std::unique_ptr<AbstractExecutor> child, TableInfo *table_info,
+                               std::vector<IndexInfo *> indexes, std::vector<uint32_t> columns,
+                               std::vector<Field> values, Transaction *txn)
+        : child_(std::move(child)),
+          table_info_(table_info),
+          indexes_(std::move(indexes)),
+          columns_(std::move(columns)),
+          values_(std::move(values)),
+          txn_(txn) {}
+
+dberr_t UpdateExecutor::Init() {
+  return child_->Init();
+}
+
+dberr_t UpdateExecutor::Next(Row *&row) {
+  Row *old_row;
+  dberr_t err = child_->Next(old_row);
+  row = nullptr;
+  if (err != DB_SUCCESS || old_row == nullptr) {
+    return err;
+  }
+  RowId rid = old_row->GetRowId();
+  std::vector<Field> fields;
+  fields.reserve(old_row->GetFieldCount());
+  for (auto field : old_row->GetFields()) {
+    fields.emplace_back(*field);
+  }
+  for (size_t i = 0; i < columns_.size(); i++) {
+    fields[columns_[i]] = Field(values_[i]);
+  }
+  row_ = std::make_unique<Row>(fields);
+  row_->SetRowId(rid);
+  TableHeap *table_heap = table_info_->GetTableHeap();
+  for (auto index_info : indexes_) {
+    Row key = MakeKey(*old_row, index_info);
+    if (index_info->GetIndex()->RemoveEntry(key, rid, txn_) != DB_SUCCESS) {
+      LOG(INFO) << "RemoveEntry failed" << std::endl;
+    }
+  }
+  bool updated = table_heap->UpdateTuple(*row_, rid, txn_);
+  // a new key which collides puts the old row and all of its keys back
+  const Row &result = updated ? *row_ : *old_row;
+  for (size_t i = 0; i < indexes_.size(); i++) {
+    Row key = MakeKey(result, indexes_[i]);
+    if (indexes_[i]->GetIndex()->InsertEntry(key, rid, txn_) == DB_SUCCESS) {
+      continue;
+    }
+    ASSERT(updated, "Failed to restore the index entry of an old row.");
+    for (size_t j = 0; j < i; j++) {
+      Row inserted = MakeKey(*row_, indexes_[j]);
+      indexes_[j]->GetIndex()->RemoveEntry(inserted, rid, txn_);
+    }
+    table_heap->UpdateTuple(*old_row, rid, txn_);
+    for (auto index_info : indexes_) {
+      Row old_key = MakeKey(*old_row, index_info);
+      index_info->GetIndex()->InsertEntry(old_key, rid, txn_);
+    }
+    return DB_FAILED;
+  }
+  if (!updated) {
+    LOG(INFO) << "UpdateTuple failed" << std::endl;
+    return DB_FAILED;
+  }
+  row = row_.get();
+  return DB_SUCCESS;
+}
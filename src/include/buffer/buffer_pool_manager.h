@@ -1,36 +1,115 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <condition_variable>
+#include <deque>
 #include <list>
 #include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
 #include "page/page.h"
 #include "page/disk_file_meta_page.h"
 #include "storage/disk_manager.h"
+#include "transaction/log_manager.h"
+#include "transaction/transaction.h"
 
 using namespace std;
 
 class BufferPoolManager {
+  friend class ParallelBufferPoolManager;
+
 public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  /**
+   * With a {log_manager}, every change of a page is logged when the page is unpinned dirty, and a
+   * page is written back only after the log up to its last record is on disk (write-ahead logging).
+   */
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
+                             ReplacerType replacer_type = ReplacerType::kLRU, LogManager *log_manager = nullptr);
 
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager();
 
-  Page *FetchPage(page_id_t page_id);
+  virtual Page *FetchPage(page_id_t page_id);
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPage(page_id_t page_id, bool is_dirty);
 
-  bool FlushPage(page_id_t page_id);
+  virtual bool FlushPage(page_id_t page_id);
 
-  Page *NewPage(page_id_t &page_id);
+  virtual Page *NewPage(page_id_t &page_id);
 
-  bool DeletePage(page_id_t page_id);
+  virtual bool DeletePage(page_id_t page_id);
 
   bool IsPageFree(page_id_t page_id);
 
-  bool CheckAllUnpinned();
+  virtual bool CheckAllUnpinned();
+
+  /**
+   * Logged pages get the LSN of their last log record stamped into the LSN slot of the page header.
+   * Pages of other layouts, which use those bytes for data (catalog and index metadata, index roots,
+   * free-space maps), must be marked raw before they are first unpinned dirty.
+   */
+  virtual void MarkRawPage(page_id_t page_id);
+
+  /**
+   * Ask the background I/O thread to read {page_ids} into the pool ahead of time. Pages already
+   * resident are skipped and nothing is pinned; this is only a hint, a page may be dropped if no
+   * frame is available.
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * @return number of pages scans should read ahead of their current page, 0 disables read-ahead
+   */
+  uint32_t GetPrefetchWindow() const { return prefetch_window_; }
+
+  void SetPrefetchWindow(uint32_t prefetch_window) { prefetch_window_ = prefetch_window; }
+
+  /**
+   * Open an atomic section on the calling thread. A page unpinned dirty inside the section keeps its
+   * pin and is logged only when the section ends, together with every other page changed in it, so
+   * the recovery redoes all of them or none. Pages deleted inside the section are freed at its end.
+   * Sections nest, the outermost one decides. Without a log manager sections do nothing.
+   */
+  void BeginAtomic();
+
+  /**
+   * Close the atomic section opened last. When the outermost section closes, its changes are logged
+   * as {record}, or as a plain page write if there is none, and chained to the records of {txn}.
+   * @return LSN of the record, INVALID_LSN if nothing was logged yet
+   */
+  lsn_t EndAtomic(Transaction *txn = nullptr, const LogRecord *record = nullptr);
+
+  /**
+   * Collect the pages changed since they were last written back, for a checkpoint
+   */
+  virtual void GetDirtyPages(std::vector<DirtyPage> &dirty_pages);
+
+  /**
+   * Write back the unpinned pages whose first change since their last write back was logged before {lsn}
+   */
+  virtual void FlushOldPages(lsn_t lsn);
+
+  /**
+   * Write back every dirty page
+   */
+  virtual void FlushAllPages();
+
+  /**
+   * Redo page write {index} of {record}, read at log offset {offset}, unless the page on disk already
+   * has it. The page stays dirty in the pool and is not logged again.
+   */
+  virtual void RedoPageWrite(const LogRecord &record, uint32_t index, uint64_t offset);
+
+protected:
+  /**
+   * For pools that own no frames themselves and only dispatch to other pools
+   */
+  explicit BufferPoolManager(DiskManager *disk_manager, LogManager *log_manager);
 
 private:
   /**
@@ -43,15 +122,100 @@ private:
    */
   void DeallocatePage(page_id_t page_id);
 
+  /**
+   * Take a frame from the free list, or evict a victim from the replacer and write it back if dirty.
+   * The frame is pinned in the replacer and removed from the page table. Caller must hold latch_ through
+   * {lock}, which is released while the victim is written, so the page table may change meanwhile.
+   * @return false if every frame is pinned
+   */
+  bool AcquireFrame(std::unique_lock<std::recursive_mutex> &lock, frame_id_t &frame_id);
+
+  /**
+   * Bring an already allocated, empty page {page_id} into the pool pinned, used by ParallelBufferPoolManager
+   * @return nullptr if every frame is pinned
+   */
+  Page *NewPageAt(page_id_t page_id);
+
+  /**
+   * Map one page-aligned region for all frames, so that every frame suits O_DIRECT I/O
+   */
+  void AllocateFrames();
+
+  void FreeFrames();
+
+  /**
+   * Log the bytes of frame {frame_id} which changed since its last log record, and stamp the LSN of
+   * the record into the page unless it is raw. Pages of an open atomic section are left to the
+   * section. Caller must hold latch_.
+   */
+  void LogChanges(frame_id_t frame_id);
+
+  /**
+   * Add the bytes of frame {frame_id} which changed since its last log record to {record} as one page
+   * write, and take them into the shadow. Caller must hold latch_.
+   * @return false if nothing changed
+   */
+  bool CollectChanges(frame_id_t frame_id, LogRecord &record);
+
+  /**
+   * The changes of frame {frame_id} were logged as record {lsn} at log offset {offset}. Caller must hold latch_.
+   */
+  void StampChanges(frame_id_t frame_id, lsn_t lsn, uint64_t offset);
+
+  /**
+   * Drop page {page_id} from the pool without writing it and give it back to the disk, nothing is logged
+   * @return false if the page is pinned
+   */
+  bool FreePage(page_id_t page_id);
+
+  /**
+   * Write frame {frame_id} to disk after forcing the log up to the last record of the page, unless an
+   * atomic section still holds it. Caller must hold latch_; given {lock}, it is released while waiting for
+   * the log and writing, the frame must be in io_frames_ meanwhile.
+   */
+  void WriteBack(frame_id_t frame_id, std::unique_lock<std::recursive_mutex> *lock = nullptr);
+
+  /**
+   * Write frame {frame_id} back with latch_ released during the I/O, the frame is pinned and in io_frames_
+   * meanwhile. Caller must hold {lock}.
+   */
+  void FlushFrame(frame_id_t frame_id, std::unique_lock<std::recursive_mutex> &lock);
+
+  /**
+   * Body of the background I/O thread, serves prefetch_queue_ until the pool is destroyed
+   */
+  void PrefetchWorker();
+
+  /**
+   * Look up {page_id} in the page table, waiting for the read of a page still being prefetched.
+   * Caller must hold latch_ through {lock}.
+   */
+  std::unordered_map<page_id_t, frame_id_t>::iterator FindPage(std::unique_lock<std::recursive_mutex> &lock,
+                                                               page_id_t page_id);
+
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
 
 private:
   size_t pool_size_;                                        // number of pages in buffer pool
   Page *pages_;                                             // array of pages
+  char *frames_;                                            // data of all pages, page-aligned
+  size_t frames_size_;                                      // mapped size of frames_
   DiskManager *disk_manager_;                               // pointer to the disk manager.
   std::unordered_map<page_id_t, frame_id_t> page_table_;    // to keep track of pages
   Replacer *replacer_;                                      // to find an unpinned page for replacement
   std::list<frame_id_t> free_list_;                         // to find a free page for replacement
   recursive_mutex latch_;                                   // to protect shared data structure
+  uint32_t prefetch_window_{DEFAULT_PREFETCH_WINDOW};       // read-ahead distance of scans
+  std::thread prefetch_thread_;                             // background I/O thread, started on first prefetch
+  std::deque<page_id_t> prefetch_queue_;                    // pages waiting to be prefetched, guarded by latch_
+  std::unordered_set<frame_id_t> io_frames_;                // frames being read or written without holding latch_
+  std::condition_variable_any prefetch_cv_;                 // signals prefetch_queue_ and shutdown
+  std::condition_variable_any io_cv_;                       // signals the end of I/O on io_frames_
+  bool shutdown_{false};
+  LogManager *log_manager_;                                 // nullptr if changes are not logged
+  char *shadows_{nullptr};                                  // every frame as of its last log record
+  std::unordered_set<page_id_t> raw_pages_;                 // pages without an LSN slot
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
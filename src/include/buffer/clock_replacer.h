@@ -0,0 +1,41 @@
+#ifndef MINISQL_CLOCK_REPLACER_H
+#define MINISQL_CLOCK_REPLACER_H
+
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+/**
+ * ClockReplacer implements the CLOCK (second chance) replacement policy.
+ *
+ * Unpinning a frame sets its reference bit. Victim sweeps a clock hand over the
+ * frames, clearing reference bits, and evicts the first unpinned frame whose bit
+ * is already clear. Pin and Unpin are O(1) and touch no shared list.
+ */
+class ClockReplacer : public Replacer {
+public:
+  /**
+   * Create a new ClockReplacer.
+   * @param num_pages the maximum number of pages the ClockReplacer will be required to store
+   */
+  explicit ClockReplacer(size_t num_pages);
+
+  ~ClockReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+private:
+  std::vector<bool> in_replacer_;
+  std::vector<bool> ref_bit_;
+  size_t hand_{0};
+  size_t size_{0};
+};
+
+#endif  // MINISQL_CLOCK_REPLACER_H
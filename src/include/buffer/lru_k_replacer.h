@@ -0,0 +1,55 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <deque>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Pin counts as one access to the frame. The victim is the unpinned frame
+ * whose K-th most recent access is the oldest; frames accessed fewer than K times
+ * have an infinite backward distance and are evicted first, oldest access first.
+ * A single sequential scan therefore can not flush frames which are hit repeatedly.
+ */
+class LRUKReplacer : public Replacer {
+public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k number of accesses remembered per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = DEFAULT_K);
+
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  static constexpr size_t DEFAULT_K = 2;
+
+private:
+  // (has K accesses, K-th most recent access or the earliest one); smaller is evicted first
+  using EvictKey = std::pair<bool, uint64_t>;
+
+  EvictKey GetEvictKey(frame_id_t frame_id) const;
+
+private:
+  size_t k_;
+  uint64_t current_timestamp_{0};
+  std::vector<std::deque<uint64_t>> history_;
+  std::vector<bool> evictable_;
+  std::set<std::pair<EvictKey, frame_id_t>> evict_set_;
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
@@ -14,6 +14,9 @@ using namespace std;
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * Unpinned frames are kept in an intrusive doubly linked list threaded through
+ * arrays indexed by frame id, so Victim, Pin and Unpin are all O(1).
  */
 class LRUReplacer : public Replacer {
 public:
@@ -37,10 +40,15 @@ public:
   size_t Size() override;
 
 private:
-  // add your own private member variables here
-  vector<frame_id_t> lru_list;
-  size_t max_supported_list_size;
+  void Unlink(frame_id_t frame_id);
 
+private:
+  // prev_/next_ of slot num_pages is the list head: next_ is the most recently unpinned frame
+  vector<frame_id_t> prev_;
+  vector<frame_id_t> next_;
+  vector<bool> in_list_;
+  frame_id_t head_;
+  size_t size_;
 };
 
 #endif  // MINISQL_LRU_REPLACER_H
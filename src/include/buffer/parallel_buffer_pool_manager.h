@@ -0,0 +1,62 @@
+#ifndef MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+#define MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * ParallelBufferPoolManager splits the buffer pool into independent instances, each with
+ * its own page table, free list, replacer and latch. A page always lives in instance
+ * page_id % num_instances, so threads working on different pages rarely contend on a latch.
+ *
+ * It can be used anywhere a BufferPoolManager is expected.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+public:
+  /**
+   * @param num_instances number of buffer pool instances
+   * @param pool_size number of frames in each instance
+   */
+  explicit ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                                     ReplacerType replacer_type = ReplacerType::kLRU,
+                                     LogManager *log_manager = nullptr);
+
+  ~ParallelBufferPoolManager() override;
+
+  Page *FetchPage(page_id_t page_id) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  Page *NewPage(page_id_t &page_id) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  bool CheckAllUnpinned() override;
+
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  void MarkRawPage(page_id_t page_id) override;
+
+  void GetDirtyPages(std::vector<DirtyPage> &dirty_pages) override;
+
+  void FlushOldPages(lsn_t lsn) override;
+
+  void FlushAllPages() override;
+
+  void RedoPageWrite(const LogRecord &record, uint32_t index, uint64_t offset) override;
+
+  size_t GetNumInstances() const { return instances_.size(); }
+
+private:
+  BufferPoolManager *GetInstance(page_id_t page_id) const {
+    return instances_[static_cast<size_t>(page_id) % instances_.size()];
+  }
+
+private:
+  std::vector<BufferPoolManager *> instances_;
+};
+
+#endif  // MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
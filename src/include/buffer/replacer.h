@@ -4,6 +4,15 @@
 #include <cstdio>
 #include "common/config.h"
 
+/**
+ * Replacement policies a BufferPoolManager can be built with
+ */
+enum class ReplacerType {
+  kLRU,     // least recently used
+  kLRUK,    // LRU-K, resists sequential scans
+  kClock    // second chance
+};
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -13,6 +13,7 @@
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 #include "transaction/transaction.h"
+#include "transaction/version_store.h"
 
 class CatalogMeta {
   friend class CatalogManager;
@@ -66,8 +67,11 @@ private:
  */
 class CatalogManager {
 public:
+  /**
+   * @param version_store versions the tables keep for snapshot reads, nullptr for none
+   */
   explicit CatalogManager(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager,
-                          LogManager *log_manager, bool init);
+                          LogManager *log_manager, bool init, VersionStore *version_store = nullptr);
 
   ~CatalogManager();
 
@@ -83,25 +87,62 @@ public:
 
   dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info) const;
 
+  /**
+   * Find an index by its id, used to undo logged index changes
+   */
+  dberr_t GetIndex(index_id_t index_id, IndexInfo *&index_info) const;
+
   dberr_t GetTableIndexes(const std::string &table_name, std::vector<IndexInfo *> &indexes) const;
 
   dberr_t DropTable(const std::string &table_name);
 
   dberr_t DropIndex(const std::string &table_name, const std::string &index_name);
 
+  /**
+   * Bulk load a csv file into a table. The rows go straight into new heap pages and the indexes of
+   * the table are built from the loaded keys afterwards instead of being maintained row by row.
+   * Nothing of the file is kept if a line is malformed or a key is duplicated.
+   * @param[out] row_count number of rows loaded
+   */
+  dberr_t CopyFrom(const std::string &table_name, const std::string &path, Transaction *txn, uint64_t &row_count);
+
 private:
   dberr_t FlushCatalogMetaPage() const;
 
+  /**
+   * Close the atomic section of a DDL statement and wait until its record is on disk. DDL is atomic
+   * and durable but not part of a transaction, it is never undone.
+   */
+  void EndDDL();
+
   dberr_t LoadTable(const table_id_t table_id, const page_id_t page_id);
 
   dberr_t LoadIndex(const index_id_t index_id, const page_id_t page_id);
 
+  /**
+   * Build a freshly created index from the keys of every row in the table, the pages of the table
+   * are scanned by several workers in parallel
+   */
+  dberr_t PopulateIndex(IndexInfo *index_info, Transaction *txn);
+
+  /**
+   * @return how many workers build an index from {items} pages or keys, one per core as long as every
+   * worker gets {min_items} of them, a worker started for a few rows costs more than it saves
+   */
+  static size_t GetBuildPartitionCount(size_t items, size_t min_items);
+
+  /**
+   * Read the index keys of the rows {rids} back from the table heap
+   */
+  void ReadKeys(IndexInfo *index_info, const std::vector<RowId> &rids, std::vector<Row> &keys, Transaction *txn);
+
   dberr_t GetTable(const table_id_t table_id, TableInfo *&table_info);
 
 private:
   [[maybe_unused]] BufferPoolManager *buffer_pool_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
+  VersionStore *version_store_;
   [[maybe_unused]] CatalogMeta *catalog_meta_;
   [[maybe_unused]] std::atomic<table_id_t> next_table_id_;
   [[maybe_unused]] std::atomic<index_id_t> next_index_id_;
@@ -3,6 +3,7 @@
 
 #define ALLOC_P(Heap, Type) new(Heap->Allocate(sizeof(Type)))Type
 
+#include <algorithm>
 #include <memory>
 
 #include "catalog/table.h"
@@ -34,12 +35,25 @@ public:
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  inline uint32_t GetKeyEncoding() const { return key_encoding_; }
+
+  inline void SetKeyEncoding(uint32_t key_encoding) { key_encoding_ = key_encoding; }
+
+  /** Indexes written before keys became memcmp-able, their trees have to be rebuilt */
+  static constexpr uint32_t KEY_ENCODING_ROW = 0;
+  /** Keys produced by KeyEncoder into a key type sized without the 0x00 escapes, they may have been cut off */
+  static constexpr uint32_t KEY_ENCODING_MEMCMP_UNESCAPED = 1;
+  /** Keys produced by KeyEncoder */
+  static constexpr uint32_t KEY_ENCODING_MEMCMP = 2;
+
 private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name,
-                         const table_id_t table_id, const std::vector<uint32_t> &key_map) 
-                         :index_id_(index_id),index_name_(index_name),table_id_(table_id),key_map_(key_map){}
+                         const table_id_t table_id, const std::vector<uint32_t> &key_map,
+                         const uint32_t key_encoding = KEY_ENCODING_MEMCMP)
+                         :index_id_(index_id),index_name_(index_name),table_id_(table_id),key_map_(key_map),
+                          key_encoding_(key_encoding){}
 
 private:
   static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
@@ -47,6 +61,7 @@ private:
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_;  /** The mapping of index key to tuple key */
+  uint32_t key_encoding_;          /** Format of the keys stored in the tree */
 };
 
 /**
@@ -71,7 +86,30 @@ public:
     // Step2: mapping index key to key schema
     key_schema_ = Schema::ShallowCopySchema(table_info_->GetSchema(), meta_data_->GetKeyMapping(), heap_);
     // Step3: call CreateIndex to create the index
-    index_ = CreateIndex(buffer_pool_manager);
+    index_ = CreateIndex(buffer_pool_manager, KeyEncoder::GetMaxEncodedSize(key_schema_));
+  }
+
+  /**
+   * Free the pages of the tree of {meta_data} written with an older key encoding, so that Init builds a new
+   * one from scratch. The key size is worked out the way the encoding sized it then.
+   */
+  void DestroyOldTree(IndexMetadata *meta_data, TableInfo *table_info, BufferPoolManager *buffer_pool_manager) {
+    meta_data_ = meta_data;
+    table_info_ = table_info;
+    key_schema_ = Schema::ShallowCopySchema(table_info_->GetSchema(), meta_data_->GetKeyMapping(), heap_);
+    uint32_t key_size = 0;
+    if (meta_data_->GetKeyEncoding() == IndexMetadata::KEY_ENCODING_ROW) {
+      // rows of fewer than 4, 8, 16, 32 bytes, anything longer went into 64 bytes
+      key_size = std::min(key_schema_->GetSerializedSize() + 1, 64u);
+    } else {
+      for (auto column : key_schema_->GetColumns()) {
+        key_size += 1 + (column->GetType() == TypeId::kTypeChar ? column->GetLength() + 2 : sizeof(uint32_t));
+      }
+      key_size = std::min(key_size, 64u);
+    }
+    Index *index = CreateIndex(buffer_pool_manager, key_size);
+    index->Destroy();
+    index->~Index();
   }
 
   inline Index *GetIndex() { return index_; }
@@ -80,6 +118,11 @@ public:
 
   inline IndexSchema *GetIndexKeySchema() { return key_schema_; }
 
+  /**
+   * @return the table columns the index key is made of, in key order
+   */
+  inline const std::vector<uint32_t> &GetKeyMapping() const { return meta_data_->GetKeyMapping(); }
+
   inline MemHeap *GetMemHeap() const { return heap_; }
 
   inline TableInfo *GetTableInfo() const { return table_info_; }
@@ -88,38 +131,51 @@ private:
   explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, table_info_{nullptr},
                          key_schema_{nullptr}, heap_(new SimpleMemHeap()) {}
 
-  Index *CreateIndex(BufferPoolManager *buffer_pool_manager) {
-    unsigned int serialized_size = key_schema_->GetSerializedSize();
-    if (serialized_size < 4) {
+  Index *CreateIndex(BufferPoolManager *buffer_pool_manager, unsigned int key_size) {
+    if (key_size <= 4) {
       void *buf = heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<4>, RowId, GenericComparator<4> >));
       BPlusTreeIndex<GenericKey<4>, RowId, GenericComparator<4> > *index = 
         new(buf)BPlusTreeIndex<GenericKey<4>, RowId, GenericComparator<4> >
         (meta_data_->GetIndexId(), key_schema_, buffer_pool_manager);
         return index;
-    } else if (serialized_size < 8) {
+    } else if (key_size <= 8) {
       void *buf = heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<8>, RowId, GenericComparator<8> >));
       BPlusTreeIndex<GenericKey<8>, RowId, GenericComparator<8> > *index = 
         new(buf)BPlusTreeIndex<GenericKey<8>, RowId, GenericComparator<8> >
         (meta_data_->GetIndexId(), key_schema_, buffer_pool_manager);
         return index;
-    } else if (serialized_size < 16) {
+    } else if (key_size <= 16) {
       void *buf = heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<16>, RowId, GenericComparator<16> >));
       BPlusTreeIndex<GenericKey<16>, RowId, GenericComparator<16> > *index = 
         new(buf)BPlusTreeIndex<GenericKey<16>, RowId, GenericComparator<16> >
         (meta_data_->GetIndexId(), key_schema_, buffer_pool_manager);
         return index;
-    } else if (serialized_size < 32) {
+    } else if (key_size <= 32) {
       void *buf = heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32> >));
       BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32> > *index = 
         new(buf)BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32> >
         (meta_data_->GetIndexId(), key_schema_, buffer_pool_manager);
         return index;
-    } else {
+    } else if (key_size <= 64) {
       void *buf = heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64> >));
       BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64> > *index = 
         new(buf)BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64> >
         (meta_data_->GetIndexId(), key_schema_, buffer_pool_manager);
         return index;
+    } else if (key_size <= 128) {
+      void *buf = heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<128>, RowId, GenericComparator<128> >));
+      BPlusTreeIndex<GenericKey<128>, RowId, GenericComparator<128> > *index = 
+        new(buf)BPlusTreeIndex<GenericKey<128>, RowId, GenericComparator<128> >
+        (meta_data_->GetIndexId(), key_schema_, buffer_pool_manager);
+        return index;
+    } else {
+      // the catalog takes no index with longer keys, they would be cut off
+      ASSERT(key_size <= MAX_INDEX_KEY_SIZE, "Index key size exceed max key size.");
+      void *buf = heap_->Allocate(sizeof(BPlusTreeIndex<GenericKey<256>, RowId, GenericComparator<256> >));
+      BPlusTreeIndex<GenericKey<256>, RowId, GenericComparator<256> > *index = 
+        new(buf)BPlusTreeIndex<GenericKey<256>, RowId, GenericComparator<256> >
+        (meta_data_->GetIndexId(), key_schema_, buffer_pool_manager);
+        return index;
     }
   }
 
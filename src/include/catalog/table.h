@@ -17,8 +17,8 @@ public:
 
   static uint32_t DeserializeFrom(char *buf, TableMetadata *&table_meta, MemHeap *heap);
 
-  static TableMetadata *Create(table_id_t table_id, std::string table_name,
-                               page_id_t root_page_id, TableSchema *schema, MemHeap *heap);
+  static TableMetadata *Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
+                               page_id_t fsm_page_id, TableSchema *schema, MemHeap *heap);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -26,19 +26,25 @@ public:
 
   inline uint32_t GetFirstPageId() const { return root_page_id_; }
 
+  inline page_id_t GetFreeSpaceMapPageId() const { return fsm_page_id_; }
+
+  inline void SetFreeSpaceMapPageId(page_id_t fsm_page_id) { fsm_page_id_ = fsm_page_id; }
+
   inline Schema *GetSchema() const { return schema_; }
 
 
 private:
   TableMetadata() = delete;
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, page_id_t fsm_page_id,
+                TableSchema *schema);
 
 private:
   static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
   table_id_t table_id_;
   std::string table_name_;
   page_id_t root_page_id_;
+  page_id_t fsm_page_id_;
   Schema *schema_;
 };
 
@@ -59,6 +65,7 @@ public:
   void Init(TableMetadata *table_meta, TableHeap *table_heap) {
     table_meta_ = table_meta;
     table_heap_ = table_heap;
+    table_heap_->SetTableId(table_meta->table_id_);
   }
 
   inline TableHeap *GetTableHeap() const { return table_heap_; }
@@ -8,6 +8,7 @@ static constexpr int INVALID_PAGE_ID = -1;           // invalid page id
 static constexpr int INVALID_FRAME_ID = -1;          // invalid transaction id
 static constexpr int INVALID_TXN_ID = -1;            // invalid transaction id
 static constexpr int INVALID_LSN = -1;               // invalid log sequence number
+static constexpr uint64_t INVALID_TS = UINT64_MAX;   // commit timestamp of a change not committed yet
 
 static constexpr int META_PAGE_ID = 0;               // physical page id of the disk file meta info
 static constexpr int CATALOG_META_PAGE_ID = 0;       // logical page id of the catalog meta data
@@ -15,6 +16,19 @@ static constexpr int INDEX_ROOTS_PAGE_ID = 1;        // logical page id of the i
 
 static constexpr int PAGE_SIZE = 4096;               // size of a data page in byte
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 1024;// default size of buffer pool
+static constexpr size_t BUFFER_POOL_INSTANCES = 4;   // independently latched parts of the buffer pool
+static constexpr size_t MIN_BUFFER_POOL_INSTANCE_SIZE = 64; // frames below which the pool is not split further
+static constexpr bool BUFFER_POOL_HUGE_PAGES = false; // back buffer pool frames with huge pages when available
+static constexpr uint32_t DEFAULT_PREFETCH_WINDOW = 8; // pages scans read ahead, 0 disables read-ahead
+static constexpr uint32_t MAX_INDEX_KEY_SIZE = 256;  // bytes of the largest encoded key an index takes
+static constexpr double INDEX_FILL_FACTOR = 0.9;      // how full bulk loading packs the b+ tree pages
+static constexpr size_t INDEX_BUILD_MIN_ROWS = 16384; // rows a worker building an index takes at least
+static constexpr size_t INDEX_SORT_MEMORY = 64 << 20; // bytes of keys sorted in memory before runs spill to disk
+static constexpr size_t LOG_BUFFER_SIZE = 4 << 20;    // bytes of log records buffered in memory
+static constexpr uint32_t LOG_FLUSH_INTERVAL = 10;    // ms before the log flusher writes a partly filled buffer
+static constexpr size_t CHECKPOINT_INTERVAL = 32 << 20; // bytes of log between two checkpoints, bounds the restart
+static constexpr size_t LOCK_TABLE_PARTITIONS = 16;   // independently latched parts of the lock table
+static constexpr uint32_t DEADLOCK_DETECTION_INTERVAL = 50; // ms between two runs of the deadlock detector
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;    // max length of varchar
@@ -25,6 +39,7 @@ using page_id_t = int32_t;
 using frame_id_t = int32_t;
 using txn_id_t = int32_t;
 using lsn_t = int32_t;
+using timestamp_t = uint64_t;
 using column_id_t = uint32_t;
 using index_id_t = uint32_t;
 using table_id_t = uint32_t;
@@ -1,28 +1,44 @@
 #ifndef MINISQL_INSTANCE_H
 #define MINISQL_INSTANCE_H
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "catalog/catalog.h"
 #include "common/config.h"
 #include "common/dberr.h"
 #include "storage/disk_manager.h"
+#include "transaction/checkpoint_manager.h"
+#include "transaction/lock_manager.h"
+#include "transaction/log_manager.h"
+#include "transaction/recovery_manager.h"
+#include "transaction/txn_manager.h"
+#include "transaction/version_store.h"
 
 class DBStorageEngine {
 public:
   explicit DBStorageEngine(std::string db_name, bool init = true,
                            uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE)
-          : db_file_name_(std::move(db_name)), init_(init) {
+          : db_file_name_(std::move(db_name)), log_file_name_(db_file_name_ + ".log"), init_(init) {
     // Init database file if needed
     if (init_) {
       remove(db_file_name_.c_str());
+      remove(log_file_name_.c_str());
     }
     // Initialize components
     disk_mgr_ = new DiskManager(db_file_name_);
-    bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
-    catalog_mgr_ = new CatalogManager(bpm_, nullptr, nullptr, init);
+    // the log is read from the last checkpoint on, the records before it are not needed
+    log_mgr_ = new LogManager(log_file_name_, disk_mgr_->GetCheckpointOffset());
+    disk_mgr_->SetLogManager(log_mgr_);
+    // a page always lives in the same instance, small pools stay whole so that no instance runs out of frames
+    size_t num_instances = std::max<size_t>(1, std::min(BUFFER_POOL_INSTANCES,
+                                                        buffer_pool_size / MIN_BUFFER_POOL_INSTANCE_SIZE));
+    bpm_ = new ParallelBufferPoolManager(num_instances, buffer_pool_size / num_instances, disk_mgr_,
+                                         ReplacerType::kLRU, log_mgr_);
+    bpm_->MarkRawPage(CATALOG_META_PAGE_ID);
+    bpm_->MarkRawPage(INDEX_ROOTS_PAGE_ID);
     // Allocate static page for db storage engine
     if (init) {
       ASSERT(bpm_->IsPageFree(CATALOG_META_PAGE_ID), "Catalog meta page not free.");
@@ -33,25 +49,57 @@ public:
       ASSERT(page != nullptr && id == CATALOG_META_PAGE_ID, "Failed to allocate catalog meta page.");
       page = bpm_->NewPage(id);
       ASSERT(page != nullptr && id == INDEX_ROOTS_PAGE_ID, "Failed to allocate header page.");
-      bpm_->UnpinPage(CATALOG_META_PAGE_ID, false);
-      bpm_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
-    } else {
+      // logged as new pages, so they are there after a crash before the first write back
+      bpm_->UnpinPage(CATALOG_META_PAGE_ID, true);
+      bpm_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+    }
+    lock_mgr_ = new LockManager();
+    version_store_ = new VersionStore();
+    txn_mgr_ = new TxnManager(bpm_, log_mgr_, lock_mgr_, version_store_);
+    RecoveryManager recovery_mgr(disk_mgr_, log_mgr_, bpm_);
+    if (!init) {
+      // repeat history before the catalog reads its pages
+      recovery_mgr.Redo();
       ASSERT(!bpm_->IsPageFree(CATALOG_META_PAGE_ID), "Invalid catalog meta page.");
       ASSERT(!bpm_->IsPageFree(INDEX_ROOTS_PAGE_ID), "Invalid header page.");
     }
+    catalog_mgr_ = new CatalogManager(bpm_, lock_mgr_, log_mgr_, init, version_store_);
+    if (!init) {
+      recovery_mgr.Undo(catalog_mgr_);
+      txn_mgr_->SetNextTxnId(recovery_mgr.GetNextTxnId());
+    }
+    checkpoint_mgr_ = new CheckpointManager(disk_mgr_, log_mgr_, bpm_, txn_mgr_);
+    checkpoint_mgr_->Checkpoint();
+    checkpoint_mgr_->Start();
   }
 
   ~DBStorageEngine() {
+    checkpoint_mgr_->Stop();
     delete catalog_mgr_;
+    // pages are written back under the write-ahead rule, so the log goes after the pool
+    bpm_->FlushAllPages();
+    checkpoint_mgr_->Checkpoint();
+    delete checkpoint_mgr_;
+    delete txn_mgr_;
+    delete lock_mgr_;
+    delete version_store_;
     delete bpm_;
+    disk_mgr_->SetLogManager(nullptr);
+    delete log_mgr_;
     delete disk_mgr_;
   }
 
 public:
   DiskManager *disk_mgr_;
+  LogManager *log_mgr_;
   BufferPoolManager *bpm_;
   CatalogManager *catalog_mgr_;
+  LockManager *lock_mgr_;
+  VersionStore *version_store_;
+  TxnManager *txn_mgr_;
+  CheckpointManager *checkpoint_mgr_;
   std::string db_file_name_;
+  std::string log_file_name_;
   bool init_;
 };
 
@@ -0,0 +1,41 @@
+#ifndef MINISQL_ABSTRACT_EXECUTOR_H
+#define MINISQL_ABSTRACT_EXECUTOR_H
+
+#include <memory>
+#include <vector>
+
+#include "catalog/indexes.h"
+#include "common/dberr.h"
+#include "record/row.h"
+
+/**
+ * A physical operator of a query plan. Operators form a tree and pull rows from
+ * their children one at a time: Init() prepares the operator together with its
+ * children, then each Next() produces one row until the input is exhausted.
+ */
+class AbstractExecutor {
+public:
+  virtual ~AbstractExecutor() = default;
+
+  virtual dberr_t Init() = 0;
+
+  /**
+   * Produce the next row. The row is owned by the operator and stays valid until the next call.
+   * @param[out] row the next row, nullptr once all rows have been produced
+   */
+  virtual dberr_t Next(Row *&row) = 0;
+
+protected:
+  /**
+   * Build the key {index_info} stores for {row}, a row of the indexed table
+   */
+  static Row MakeKey(const Row &row, IndexInfo *index_info) {
+    std::vector<Field> fields;
+    for (auto column : index_info->GetKeyMapping()) {
+      fields.push_back(*row.GetField(column));
+    }
+    return Row(fields);
+  }
+};
+
+#endif  // MINISQL_ABSTRACT_EXECUTOR_H
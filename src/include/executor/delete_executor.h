@@ -0,0 +1,28 @@
+#ifndef MINISQL_DELETE_EXECUTOR_H
+#define MINISQL_DELETE_EXECUTOR_H
+
+#include "catalog/indexes.h"
+#include "catalog/table.h"
+#include "executor/abstract_executor.h"
+
+/**
+ * Delete the rows produced by the child from the table and all of its indexes,
+ * producing every row once it is deleted
+ */
+class DeleteExecutor : public AbstractExecutor {
+public:
+  DeleteExecutor(std::unique_ptr<AbstractExecutor> child, TableInfo *table_info, std::vector<IndexInfo *> indexes,
+                 Transaction *txn);
+
+  dberr_t Init() override;
+
+  dberr_t Next(Row *&row) override;
+
+private:
+  std::unique_ptr<AbstractExecutor> child_;
+  TableInfo *table_info_;
+  std::vector<IndexInfo *> indexes_;
+  Transaction *txn_;
+};
+
+#endif  // MINISQL_DELETE_EXECUTOR_H
@@ -1,10 +1,13 @@
 #ifndef MINISQL_EXECUTE_ENGINE_H
 #define MINISQL_EXECUTE_ENGINE_H
 
+#include <fstream>
 #include <string>
 #include <unordered_map>
 #include "common/dberr.h"
 #include "common/instance.h"
+#include "executor/planner.h"
+#include "executor/result_sink.h"
 #include "transaction/transaction.h"
 #include <chrono>
 
@@ -25,8 +28,8 @@ struct ExecuteContext {
   bool running;
   int numAffectedRows;
   int numSelectedRows;
-  std::vector<std::string> header_;
-  std::vector<int> columnLengths_;
+  ResultFormat format_{ResultFormat::kTable};  /** how select writes its rows */
+  FILE *output_{stdout};
   dberr_t err_;
   bool disablePrint_;
 
@@ -45,7 +48,7 @@ struct ExecuteContext {
   }
 
   void StopRunning(bool printTime = true) {
-    if (running && printTime && !disablePrint_) {
+    if (running && printTime && !disablePrint_ && format_ == ResultFormat::kTable) {
       auto end_time = std::chrono::high_resolution_clock::now();
       auto time_span =
           std::chrono::duration_cast<std::chrono::duration<double>>(end_time - start_time_);
@@ -78,75 +81,13 @@ struct ExecuteContext {
     putchar('\n');
   }
 
-  void PrintTableDivider() const {
-    if (disablePrint_) return;
-    putchar('+');
-    for (int len: columnLengths_) {
-      for (int i = 0; i < len + 2; ++ i) {
-        putchar('-');
-      }
-      putchar('+');
-    }
-    putchar('\n');
-  }
-
-  void PrintField(const std::string &str, const int &id) const {
-    if (disablePrint_) return;
-    putchar(' ');
-    printf("%s", str.c_str());
-    for (int i = str.size(); i < columnLengths_[id]; ++i) {
-      putchar(' ');
-    }
-    printf(" |");
-  }
-
-  void SetHeader(const std::vector<std::string> &header) {
-    if (disablePrint_) return;
-    header_.clear();
-    columnLengths_.clear();
-    for (int i = 0; i < (int)header.size(); ++ i) {
-      header_.push_back(header[i]);
-      columnLengths_.push_back(header[i].size());
-    }
-  }
-
-  void PrepareRow(const std::vector<std::string> &row) {
-    if (disablePrint_) return;
-    for (int i = 0; i < (int)row.size(); ++ i) {
-      if ((int)row[i].size() > columnLengths_[i]) {
-        columnLengths_[i] = row[i].size();
-      }
-    }
-  }
-
-  void PrintHeader() const {
-    if (disablePrint_) return;
-    if (header_.empty()) {
-      return;
-    }
-    PrintTableDivider();
-    putchar('|');
-    for (int i = 0; i < (int)header_.size(); ++ i) {
-      PrintField(header_[i], i);
-    }
-    putchar('\n');
-    PrintTableDivider();
-  }
-
-  void PrintRow(const std::vector<std::string> &row) const {
+  void PrintResult(const dberr_t &err, bool affected) const {
     if (disablePrint_) return;
-    if (row.empty()) {
+    // csv and binary results are read by programs, only failures are reported and on stderr
+    if (format_ != ResultFormat::kTable) {
+      if (err != DB_SUCCESS) fprintf(stderr, "Failed.\n");
       return;
     }
-    putchar('|');
-    for (int i = 0; i < (int)row.size(); ++ i) {
-      PrintField(row[i], i);
-    }
-    putchar('\n');
-  }
-
-  void PrintResult(const dberr_t &err, bool affected) const {
-    if (disablePrint_) return;
     if (err == DB_SUCCESS) {
       if (affected) printf("OK, %d rows affected.\n", numAffectedRows);
       else printf("%d rows in total.\n", numSelectedRows);
@@ -162,6 +103,8 @@ public:
   ExecuteEngine();
 
   ~ExecuteEngine() {
+    // a transaction still open when the session ends is rolled back
+    EndTxn(false);
     for (auto it : dbs_) {
       delete it.second;
     }
@@ -209,19 +152,30 @@ private:
 
   dberr_t ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteCopy(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteQuit(pSyntaxNode ast, ExecuteContext *context);
 
 private:
   [[maybe_unused]] std::unordered_map<std::string, DBStorageEngine *> dbs_;  /** all opened databases */
   [[maybe_unused]] std::string current_db_;  /** current database */
+  Transaction *txn_{nullptr};  /** transaction opened by BEGIN, statements run in it until COMMIT or ROLLBACK */
+  DBStorageEngine *txn_db_{nullptr};  /** database of the open transaction */
 
-  bool ChooseIndex(Schema *schema, std::vector<IndexInfo *> &indexes, pSyntaxNode where_node, ExecuteContext *context, IndexInfo *&pindex, std::vector<Field> &keyRow);
-
-  void EvaluateIndex(pSyntaxNode where_node, Schema *schema, std::vector<int> &statusColumns, std::vector<Field> &conditions, ExecuteContext *context);
+  /**
+   * Commit or roll back the open transaction, if there is one
+   */
+  void EndTxn(bool commit);
 
-  bool EvaluateWhere(pSyntaxNode where_node, const Schema *schema, const Row *row, ExecuteContext *context);
+  /**
+   * Drain {plan}, counting every row it produces as affected
+   */
+  dberr_t ExecutePlan(AbstractExecutor *plan, ExecuteContext *context);
 
-  void InputCommand(char *input, const int len, FILE* fp);
+  /**
+   * How many statements of a script may be parsed ahead of the one being executed
+   */
+  static constexpr size_t EXECFILE_PARSE_AHEAD = 64;
 };
 
 #endif //MINISQL_EXECUTE_ENGINE_H
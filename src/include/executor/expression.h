@@ -0,0 +1,56 @@
+#ifndef MINISQL_EXPRESSION_H
+#define MINISQL_EXPRESSION_H
+
+#include <memory>
+
+#include "common/dberr.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+extern "C" {
+#include "parser/syntax_tree.h"
+};
+
+enum class ExpressionType { kAnd, kOr, kCompare, kIsNull, kIsNotNull };
+
+enum class CompareType { kEqual, kNotEqual, kLessThan, kLessThanEquals, kGreaterThan, kGreaterThanEquals };
+
+/**
+ * A where condition bound to the schema of the rows it is evaluated on.
+ * Column names, constants and operators are resolved once by Compile(), so
+ * evaluating a row only reads the referenced field and compares it.
+ */
+class Expression {
+public:
+  /**
+   * Bind {condition}, the condition under the where node of the syntax tree, to {schema}
+   * @param[out] expr the compiled condition
+   */
+  static dberr_t Compile(pSyntaxNode condition, const Schema *schema, std::unique_ptr<Expression> &expr);
+
+  /**
+   * Convert the literal {node} into a field of {type}, the whole literal has to be a value of that type
+   * @return DB_FAILED if the literal has another type, is a fraction for an int, or is out of range
+   */
+  static dberr_t ParseConstant(TypeId type, pSyntaxNode node, Field &field);
+
+  /**
+   * Only a comparison which is known to be true matches, comparing with null never does.
+   * and/or stop as soon as the result is decided.
+   */
+  bool Evaluate(const Row *row) const;
+
+  ExpressionType GetType() const { return type_; }
+
+private:
+  explicit Expression(ExpressionType type) : type_(type) {}
+
+  ExpressionType type_;
+  CompareType compare_{CompareType::kEqual};
+  uint32_t column_{0};                  // ordinal of the compared column in the row
+  std::unique_ptr<Field> constant_;     // constant the column is compared with, in the type of the column
+  std::unique_ptr<Expression> left_;
+  std::unique_ptr<Expression> right_;
+};
+
+#endif  // MINISQL_EXPRESSION_H
@@ -0,0 +1,26 @@
+#ifndef MINISQL_FILTER_EXECUTOR_H
+#define MINISQL_FILTER_EXECUTOR_H
+
+#include "executor/abstract_executor.h"
+#include "executor/expression.h"
+
+/**
+ * Pass on the rows of the child which satisfy a where condition
+ */
+class FilterExecutor : public AbstractExecutor {
+public:
+  /**
+   * @param predicate the where condition compiled against the schema of the rows produced by {child}
+   */
+  FilterExecutor(std::unique_ptr<AbstractExecutor> child, std::unique_ptr<Expression> predicate);
+
+  dberr_t Init() override;
+
+  dberr_t Next(Row *&row) override;
+
+private:
+  std::unique_ptr<AbstractExecutor> child_;
+  std::unique_ptr<Expression> predicate_;
+};
+
+#endif  // MINISQL_FILTER_EXECUTOR_H
@@ -0,0 +1,46 @@
+#ifndef MINISQL_INDEX_SCAN_EXECUTOR_H
+#define MINISQL_INDEX_SCAN_EXECUTOR_H
+
+#include "catalog/indexes.h"
+#include "catalog/table.h"
+#include "executor/abstract_executor.h"
+
+/**
+ * How an index is probed: a point lookup on key_, or a scan of the keys between
+ * low_ and high_. An empty bound leaves that side of the range open.
+ */
+struct IndexScanKey {
+  bool is_range_{false};
+  std::vector<Field> key_;
+  std::vector<Field> low_;
+  std::vector<Field> high_;
+  bool low_inclusive_{true};
+  bool high_inclusive_{true};
+};
+
+/**
+ * Produce the rows of a table whose keys in an index match an IndexScanKey, in key order
+ */
+class IndexScanExecutor : public AbstractExecutor {
+public:
+  IndexScanExecutor(TableInfo *table_info, IndexInfo *index_info, IndexScanKey scan_key, Transaction *txn);
+
+  /**
+   * Probe the index and collect the matching row ids, so later changes to the index
+   * made by parent operators do not disturb the scan
+   */
+  dberr_t Init() override;
+
+  dberr_t Next(Row *&row) override;
+
+private:
+  TableInfo *table_info_;
+  IndexInfo *index_info_;
+  IndexScanKey scan_key_;
+  Transaction *txn_;
+  std::vector<RowId> rids_;
+  size_t cursor_{0};
+  Row row_{INVALID_ROWID};
+};
+
+#endif  // MINISQL_INDEX_SCAN_EXECUTOR_H
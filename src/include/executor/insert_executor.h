@@ -0,0 +1,44 @@
+#ifndef MINISQL_INSERT_EXECUTOR_H
+#define MINISQL_INSERT_EXECUTOR_H
+
+#include "catalog/indexes.h"
+#include "catalog/table.h"
+#include "executor/abstract_executor.h"
+
+/**
+ * Insert rows into a table and all of its indexes, producing every row once it is inserted.
+ * All rows of the statement are written as one batch: the heap is filled page by page
+ * and the entries of each index are inserted in key order.
+ */
+class InsertExecutor : public AbstractExecutor {
+public:
+  InsertExecutor(TableInfo *table_info, std::vector<IndexInfo *> indexes, std::vector<std::vector<Field>> rows,
+                 Transaction *txn);
+
+  dberr_t Init() override;
+
+  /**
+   * If a key already exists in one of the indexes, or appears twice among the rows, none of
+   * the rows is inserted: everything the batch wrote is taken back out and the error is returned
+   */
+  dberr_t Next(Row *&row) override;
+
+private:
+  dberr_t InsertAll();
+
+  /**
+   * Take every row back out, together with its entries in the first {index} indexes and the
+   * first {inserted} entries of index {index}, whose keys are {keys} inserted in {order}
+   */
+  void Undo(size_t index, size_t inserted, const std::vector<Row> &keys, const std::vector<size_t> &order);
+
+  TableInfo *table_info_;
+  std::vector<IndexInfo *> indexes_;
+  std::vector<std::vector<Field>> values_;
+  Transaction *txn_;
+  std::vector<Row> rows_;
+  bool inserted_{false};
+  size_t cursor_{0};
+};
+
+#endif  // MINISQL_INSERT_EXECUTOR_H
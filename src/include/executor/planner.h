@@ -0,0 +1,82 @@
+#ifndef MINISQL_PLANNER_H
+#define MINISQL_PLANNER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "executor/abstract_executor.h"
+#include "executor/index_scan_executor.h"
+
+extern "C" {
+#include "parser/syntax_tree.h"
+};
+
+/**
+ * Constants which the where clause compares one column with, collected to pick an index
+ */
+struct ColumnBound {
+  explicit ColumnBound(TypeId type) : equal_(type), low_(type), high_(type) {}
+
+  Field equal_;
+  Field low_;
+  Field high_;
+  bool has_low_{false};
+  bool low_inclusive_{false};
+  bool has_high_{false};
+  bool high_inclusive_{false};
+};
+
+/**
+ * Lowers the syntax tree of a DML statement into a tree of physical operators.
+ * The rows are read by an IndexScan when the where clause pins down an index key
+ * or a range of it, by a SeqScan otherwise, and always pass a Filter with the
+ * whole where clause.
+ */
+class Planner {
+public:
+  Planner(CatalogManager *catalog, Transaction *txn) : catalog_(catalog), txn_(txn) {}
+
+  /**
+   * @param[out] columns names of the columns the plan produces
+   */
+  dberr_t PlanSelect(pSyntaxNode ast, std::unique_ptr<AbstractExecutor> &plan, std::vector<std::string> &columns);
+
+  dberr_t PlanInsert(pSyntaxNode ast, std::unique_ptr<AbstractExecutor> &plan);
+
+  dberr_t PlanUpdate(pSyntaxNode ast, std::unique_ptr<AbstractExecutor> &plan);
+
+  dberr_t PlanDelete(pSyntaxNode ast, std::unique_ptr<AbstractExecutor> &plan);
+
+private:
+  /**
+   * Plan the operators which produce the rows of {table_info} satisfying {where_node}
+   */
+  dberr_t PlanScan(TableInfo *table_info, std::vector<IndexInfo *> &indexes, pSyntaxNode where_node,
+                   std::unique_ptr<AbstractExecutor> &plan);
+
+  bool ChooseIndex(Schema *schema, std::vector<IndexInfo *> &indexes, pSyntaxNode where_node, IndexInfo *&pindex,
+                   IndexScanKey &scanKey);
+
+  void EvaluateIndex(pSyntaxNode where_node, Schema *schema, std::vector<int> &statusColumns,
+                     std::vector<ColumnBound> &conditions);
+
+  /**
+   * Convert the constant {node} compared with a column of {type}.
+   * @return false, with err_ set, if the constant is not a value of {type}, e.g. a fraction compared with an int column
+   */
+  bool ParseConstant(TypeId type, pSyntaxNode node, Field &field);
+
+  /**
+   * Convert the value {node} assigned to {column} by an insert or update.
+   * @param check_length whether a string must fill the column exactly, as inserts require
+   */
+  static dberr_t ParseValue(const Column *column, pSyntaxNode node, Field &field, bool check_length);
+
+  CatalogManager *catalog_;
+  Transaction *txn_;
+  dberr_t err_{DB_SUCCESS};     // first error met while looking at the where clause
+};
+
+#endif  // MINISQL_PLANNER_H
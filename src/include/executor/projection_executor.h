@@ -0,0 +1,23 @@
+#ifndef MINISQL_PROJECTION_EXECUTOR_H
+#define MINISQL_PROJECTION_EXECUTOR_H
+
+#include "executor/abstract_executor.h"
+
+/**
+ * Keep only the selected columns of the child rows, in the order they are selected
+ */
+class ProjectionExecutor : public AbstractExecutor {
+public:
+  ProjectionExecutor(std::unique_ptr<AbstractExecutor> child, std::vector<uint32_t> columns);
+
+  dberr_t Init() override;
+
+  dberr_t Next(Row *&row) override;
+
+private:
+  std::unique_ptr<AbstractExecutor> child_;
+  std::vector<uint32_t> columns_;
+  std::unique_ptr<Row> row_;
+};
+
+#endif  // MINISQL_PROJECTION_EXECUTOR_H
@@ -0,0 +1,141 @@
+#ifndef MINISQL_RESULT_SINK_H
+#define MINISQL_RESULT_SINK_H
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "record/row.h"
+
+enum class ResultFormat { kTable, kCsv, kBinary };
+
+/**
+ * Receives the rows of a query as they are produced and writes them to a file.
+ * Output is collected in a buffer and handed to stdio in large chunks.
+ * Usage: Begin() once, Write() for every row, then End().
+ */
+class ResultSink {
+public:
+  explicit ResultSink(FILE *out) : out_(out) {}
+
+  virtual ~ResultSink() { Flush(); }
+
+  /**
+   * Create the sink writing {format} to {out}
+   */
+  static std::unique_ptr<ResultSink> Create(ResultFormat format, FILE *out);
+
+  /**
+   * @param columns names of the result columns
+   */
+  virtual void Begin(const std::vector<std::string> &columns) = 0;
+
+  virtual void Write(const Row &row) = 0;
+
+  virtual void End() = 0;
+
+  uint32_t GetRowCount() const { return row_count_; }
+
+  static constexpr size_t FLUSH_BYTES = 64 * 1024;
+
+protected:
+  void Append(const char *data, size_t len) {
+    buffer_.append(data, len);
+    if (buffer_.size() >= FLUSH_BYTES) {
+      Flush();
+    }
+  }
+
+  void Append(const std::string &str) { Append(str.data(), str.size()); }
+
+  void Append(char ch) { Append(&ch, 1); }
+
+  void Flush();
+
+  FILE *out_;
+  std::string buffer_;
+  uint32_t row_count_{0};
+};
+
+/**
+ * The boxed table of the interactive shell. Column widths are sized from a
+ * bounded batch of rows; a later batch which needs wider columns widens them
+ * and is set apart by a divider.
+ */
+class TableResultSink : public ResultSink {
+public:
+  explicit TableResultSink(FILE *out, size_t max_buffered_rows = DEFAULT_BUFFERED_ROWS)
+          : ResultSink(out), max_buffered_rows_(max_buffered_rows) {}
+
+  void Begin(const std::vector<std::string> &columns) override;
+
+  void Write(const Row &row) override;
+
+  void End() override;
+
+  static constexpr size_t DEFAULT_BUFFERED_ROWS = 1024;
+
+private:
+  void WriteBufferedRows();
+
+  void WriteDivider();
+
+  void WriteLine(const std::vector<std::string> &values);
+
+  size_t max_buffered_rows_;
+  bool header_written_{false};
+  std::vector<std::string> header_;
+  std::vector<size_t> widths_;
+  std::vector<std::vector<std::string>> rows_;
+};
+
+/**
+ * Comma separated values with a header line, null is written as an empty field
+ */
+class CsvResultSink : public ResultSink {
+public:
+  explicit CsvResultSink(FILE *out) : ResultSink(out) {}
+
+  void Begin(const std::vector<std::string> &columns) override;
+
+  void Write(const Row &row) override;
+
+  void End() override;
+
+private:
+  void WriteValue(const char *data, size_t len);
+};
+
+/**
+ * Length-prefixed binary rows for programs reading the result.
+ *
+ * Format (all integers little endian):
+ *  | ColumnCount (4) | NameLen (4) | Name | ... |
+ * followed by one record per row:
+ *  | Tag (1) | Value | ... |
+ * where Tag is 0 for null, 1 for an int (4 bytes), 2 for a float (4 bytes) and
+ * 3 for a char (4-byte length followed by the bytes). The result ends with a
+ * single 0xFF byte.
+ */
+class BinaryResultSink : public ResultSink {
+public:
+  explicit BinaryResultSink(FILE *out) : ResultSink(out) {}
+
+  void Begin(const std::vector<std::string> &columns) override;
+
+  void Write(const Row &row) override;
+
+  void End() override;
+
+  static constexpr uint8_t TAG_NULL = 0;
+  static constexpr uint8_t TAG_INT = 1;
+  static constexpr uint8_t TAG_FLOAT = 2;
+  static constexpr uint8_t TAG_CHAR = 3;
+  static constexpr uint8_t TAG_END = 0xFF;
+
+private:
+  void AppendUInt32(uint32_t val);
+};
+
+#endif  // MINISQL_RESULT_SINK_H
@@ -0,0 +1,26 @@
+#ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
+#define MINISQL_SEQ_SCAN_EXECUTOR_H
+
+#include "catalog/table.h"
+#include "executor/abstract_executor.h"
+
+/**
+ * Produce every row of a table in heap order
+ */
+class SeqScanExecutor : public AbstractExecutor {
+public:
+  SeqScanExecutor(TableInfo *table_info, Transaction *txn);
+
+  dberr_t Init() override;
+
+  dberr_t Next(Row *&row) override;
+
+private:
+  TableInfo *table_info_;
+  Transaction *txn_;
+  TableIterator iter_;
+  TableIterator end_;
+  bool started_{false};     // whether iter_ points at a row which was already produced
+};
+
+#endif  // MINISQL_SEQ_SCAN_EXECUTOR_H
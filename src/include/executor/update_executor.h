@@ -0,0 +1,35 @@
+#ifndef MINISQL_UPDATE_EXECUTOR_H
+#define MINISQL_UPDATE_EXECUTOR_H
+
+#include "catalog/indexes.h"
+#include "catalog/table.h"
+#include "executor/abstract_executor.h"
+
+/**
+ * Assign new values to some columns of the rows produced by the child, keeping the
+ * indexes of the table in step. Produces every row after it is updated.
+ */
+class UpdateExecutor : public AbstractExecutor {
+public:
+  UpdateExecutor(std::unique_ptr<AbstractExecutor> child, TableInfo *table_info, std::vector<IndexInfo *> indexes,
+                 std::vector<uint32_t> columns, std::vector<Field> values, Transaction *txn);
+
+  dberr_t Init() override;
+
+  /**
+   * A row whose new key already exists in one of the indexes is restored together with
+   * its index entries, then the error is returned
+   */
+  dberr_t Next(Row *&row) override;
+
+private:
+  std::unique_ptr<AbstractExecutor> child_;
+  TableInfo *table_info_;
+  std::vector<IndexInfo *> indexes_;
+  std::vector<uint32_t> columns_;
+  std::vector<Field> values_;
+  Transaction *txn_;
+  std::unique_ptr<Row> row_;
+};
+
+#endif  // MINISQL_UPDATE_EXECUTOR_H
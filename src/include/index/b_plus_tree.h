@@ -1,6 +1,8 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <fstream>
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
@@ -41,6 +43,16 @@ public:
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
+  /**
+   * Build an empty tree bottom up from {count} entries handed out by {next} in strictly increasing
+   * key order. Leaves and then internal pages are packed left to right with {fill_factor} of their
+   * max size, and the root is recorded in the index roots page once at the end.
+   * @return false if the tree is not empty, a key repeats or is out of order, or pages run out.
+   * The tree is left empty then
+   */
+  bool BulkLoad(size_t count, const std::function<bool(std::pair<KeyType, ValueType> &)> &next,
+                double fill_factor = INDEX_FILL_FACTOR);
+
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction = nullptr);
 
@@ -56,21 +68,45 @@ public:
   // used to check whether all pages are unpinned
   bool Check();
 
-  // destroy the b plus tree
+  // destroy the b plus tree, its pages are deleted and its root is dropped from the index roots page
   void Destroy();
 
+  // drop every entry, the tree is left empty but still registered in the index roots page
+  void Clear();
+
   void PrintTree(std::ofstream &out) {
     if (IsEmpty()) {
       return;
     }
     out << "digraph G {" << std::endl;
     Page *root_page = buffer_pool_manager_->FetchPage(root_page_id_);
-    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(root_page);
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
     ToGraph(node, buffer_pool_manager_, out);
     out << "}" << std::endl;
   }
 
 private:
+  /**
+   * The page being filled on one level of a bulk load, and how the entries of the level are
+   * spread over its pages
+   */
+  struct BulkLevel {
+    size_t entries_;
+    size_t pages_;
+    size_t page_index_{0};
+    Page *page_{nullptr};
+
+    // pages of one level differ by at most one entry
+    int PageSize() const { return entries_ / pages_ + (page_index_ < entries_ % pages_ ? 1 : 0); }
+  };
+
+  /**
+   * Append an entry to the page being filled on level {level}, starting the next page of the level
+   * (and adding it to the level above) when that one is full
+   */
+  bool BulkAppend(std::vector<BulkLevel> &levels, size_t level, const KeyType &key, const ValueType &value,
+                  page_id_t child, std::vector<page_id_t> &allocated);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
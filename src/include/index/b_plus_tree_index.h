@@ -17,8 +17,18 @@ public:
 
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) override;
 
+  dberr_t ScanRange(const Row *low_key, bool low_inclusive, const Row *high_key, bool high_inclusive,
+                    std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t BulkLoad(size_t partition_count, const std::function<bool(size_t partition, const EntrySink &sink)> &scan,
+                   Transaction *txn) override;
+
+  bool IsEmpty() const override;
+
   dberr_t Destroy() override;
 
+  dberr_t Clear() override;
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
@@ -26,6 +36,12 @@ public:
   INDEXITERATOR_TYPE GetEndIterator();
 
 protected:
+  /**
+   * Close the atomic section of one change, logging {type} with {key} and {row_id} to undo it if {txn} is given
+   */
+  void EndAtomic(LogRecordType type, const Row &key, RowId row_id, Transaction *txn);
+
+  BufferPoolManager *buffer_pool_manager_;
   // comparator for key
   KeyComparator comparator_;
   // container
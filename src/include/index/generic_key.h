@@ -2,26 +2,118 @@
 #define MINISQL_GENERIC_KEY_H
 
 #include <cstring>
+#include <vector>
 
 #include "record/row.h"
 #include "record/field.h"
 
+/**
+ * Order-preserving (memcomparable) key encoding. Every key column is written as a
+ * null flag byte (0x00 for null so that nulls sort first, 0x01 otherwise) followed by
+ *  - int:   4 bytes big-endian with the sign bit flipped
+ *  - float: 4 bytes big-endian, sign bit flipped for positives and all bits flipped for negatives
+ *  - char:  the bytes with 0x00 escaped as 0x00 0xff, terminated by 0x00 0x00
+ * Bytes after the last column are zero, so two keys compare with one memcmp.
+ */
+class KeyEncoder {
+public:
+  /**
+   * Write at most {capacity} bytes of the encoded key into {buf}
+   * @return full encoded size of {key}
+   */
+  static uint32_t Encode(const Row &key, Schema *schema, char *buf, uint32_t capacity) {
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      const Field *field = key.GetField(i);
+      if (field->IsNull()) {
+        PutByte(buf, capacity, offset, 0x00);
+        continue;
+      }
+      PutByte(buf, capacity, offset, 0x01);
+      switch (schema->GetColumn(i)->GetType()) {
+        case TypeId::kTypeInt: {
+          char raw[sizeof(int32_t)];
+          field->SerializeTo(raw);
+          PutUint32(buf, capacity, offset, MACH_READ_FROM(uint32_t, raw) ^ SIGN_BIT);
+          break;
+        }
+        case TypeId::kTypeFloat: {
+          char raw[sizeof(float)];
+          field->SerializeTo(raw);
+          uint32_t bits = MACH_READ_FROM(uint32_t, raw);
+          // -0.0 equals 0.0, so both must encode to the same bytes
+          if (bits == SIGN_BIT) bits = 0;
+          PutUint32(buf, capacity, offset, (bits & SIGN_BIT) ? ~bits : bits ^ SIGN_BIT);
+          break;
+        }
+        case TypeId::kTypeChar: {
+          const char *data = field->GetData();
+          for (uint32_t j = 0; j < field->GetLength(); j++) {
+            PutByte(buf, capacity, offset, data[j]);
+            if (data[j] == 0x00) PutByte(buf, capacity, offset, static_cast<char>(0xff));
+          }
+          PutByte(buf, capacity, offset, 0x00);
+          PutByte(buf, capacity, offset, 0x00);
+          break;
+        }
+        default:
+          ASSERT(false, "Unsupported key type.");
+      }
+    }
+    return offset;
+  }
+
+  /**
+   * @return the largest encoded size of a key of {schema}
+   */
+  static uint32_t GetMaxEncodedSize(const Schema *schema) {
+    uint32_t size = 0;
+    for (auto column : schema->GetColumns()) {
+      size += GetMaxEncodedSize(column);
+    }
+    return size;
+  }
+
+  /**
+   * @return the largest encoded size of a key made of columns {key_map} of {schema}
+   */
+  static uint32_t GetMaxEncodedSize(const Schema *schema, const std::vector<uint32_t> &key_map) {
+    uint32_t size = 0;
+    for (auto column_index : key_map) {
+      size += GetMaxEncodedSize(schema->GetColumn(column_index));
+    }
+    return size;
+  }
+
+private:
+  static uint32_t GetMaxEncodedSize(const Column *column) {
+    // a char of nothing but 0x00 writes every byte twice
+    return 1 + (column->GetType() == TypeId::kTypeChar ? 2 * column->GetLength() + 2 : sizeof(uint32_t));
+  }
+
+  static inline void PutByte(char *buf, uint32_t capacity, uint32_t &offset, char byte) {
+    if (offset < capacity) buf[offset] = byte;
+    offset++;
+  }
+
+  static inline void PutUint32(char *buf, uint32_t capacity, uint32_t &offset, uint32_t val) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      PutByte(buf, capacity, offset, static_cast<char>((val >> shift) & 0xff));
+    }
+  }
+
+  static constexpr uint32_t SIGN_BIT = 0x80000000u;
+};
+
 template<size_t KeySize>
 class GenericKey {
 public:
   inline void SerializeFromKey(const Row &key, Schema *schema) {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= KeySize, "Index key size exceed max key size.");
+    // initialize to 0
     memset(data, 0, KeySize);
-    key.SerializeTo(data, schema);
-  }
-
-  inline void DeserializeToKey(Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(data), schema);
-    ASSERT(ofs <= KeySize, "Index key size exceed max key size.");
-    return;
+    [[maybe_unused]] uint32_t size = KeyEncoder::Encode(key, schema, data, KeySize);
+    ASSERT(size <= KeySize, "Index key size exceed max key size.");
   }
 
   // compare
@@ -32,7 +124,9 @@ public:
   // NOTE: for test purpose only
   // interpret the first 8 bytes as int64_t from data vector
   inline int64_t ToString() const {
-    return *reinterpret_cast<int64_t *>(const_cast<char *>(data));
+    int64_t val = 0;
+    memcpy(&val, data, KeySize < sizeof(int64_t) ? KeySize : sizeof(int64_t));
+    return val;
   }
 
   // NOTE: for test purpose only
@@ -48,30 +142,14 @@ public:
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ * Keys are memcomparable (see KeyEncoder), so no deserialization is needed
  */
 template<size_t KeySize>
 class GenericComparator {
 public:
   inline int operator()(const GenericKey<KeySize> &lhs,
                         const GenericKey<KeySize> &rhs) const {
-    int column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    lhs.DeserializeToKey(lhs_key, key_schema_);
-    rhs.DeserializeToKey(rhs_key, key_schema_);
-
-    for (int i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue)
-        return -1;
-
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue)
-        return 1;
-    }
-    // equals
-    return 0;
+    return memcmp(lhs.data, rhs.data, KeySize);
   }
 
   GenericComparator(const GenericComparator &other) {
@@ -82,7 +160,7 @@ public:
   GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
 
 private:
-  Schema *key_schema_;
+  [[maybe_unused]] Schema *key_schema_;
 };
 
 #endif  // MINISQL_GENERIC_KEY_H
@@ -1,6 +1,8 @@
 #ifndef MINISQL_INDEX_H
 #define MINISQL_INDEX_H
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 
 #include "common/dberr.h"
@@ -20,8 +22,66 @@ public:
 
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) = 0;
 
+  /**
+   * Collect the row ids of all keys between {low_key} and {high_key} in key order.
+   * A null bound leaves that side of the range open.
+   */
+  virtual dberr_t ScanRange(const Row *low_key, bool low_inclusive, const Row *high_key, bool high_inclusive,
+                            std::vector<RowId> &result, Transaction *txn) = 0;
+
+  /**
+   * Takes the key and row id of one entry, the key is only read during the call
+   */
+  using EntrySink = std::function<void(const Row &key, RowId row_id)>;
+
+  /**
+   * Build an empty index bottom up instead of inserting entry by entry. The entries are split into
+   * {partition_count} partitions and {scan} hands every entry of one partition to the sink, in any
+   * order. The partitions are scanned and sorted in parallel, one worker thread each, and their
+   * sorted entries are merged into the tree.
+   * @return DB_FAILED if the index is not empty, a scan fails or a key repeats, the index stays empty then
+   */
+  virtual dberr_t BulkLoad(size_t partition_count,
+                           const std::function<bool(size_t partition, const EntrySink &sink)> &scan,
+                           Transaction *txn) = 0;
+
+  /**
+   * @return whether the index has no entries, so that it can be bulk loaded
+   */
+  virtual bool IsEmpty() const = 0;
+
   virtual dberr_t Destroy() = 0;
 
+  /**
+   * Drop every entry at once, undoes a bulk load of an empty index
+   */
+  virtual dberr_t Clear() = 0;
+
+  /**
+   * @return positions of {keys} sorted by key, equal keys keep their order. Inserting a batch in
+   * this order walks the tree along its leaves instead of all over it
+   */
+  static std::vector<size_t> SortKeys(const std::vector<Row> &keys) {
+    std::vector<size_t> order(keys.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) {
+      for (uint32_t k = 0; k < keys[a].GetFieldCount(); k++) {
+        const Field *left = keys[a].GetField(k);
+        const Field *right = keys[b].GetField(k);
+        if (left->CompareLessThan(*right) == CmpBool::kTrue) {
+          return true;
+        }
+        if (left->CompareGreaterThan(*right) == CmpBool::kTrue) {
+          return false;
+        }
+      }
+      return false;
+    });
+    return order;
+  }
+
 protected:
   index_id_t index_id_;
   IndexSchema *key_schema_;
@@ -25,6 +25,12 @@ public:
   /** Return whether two iterators are not equal. */
   bool operator!=(const IndexIterator &itr) const;
 
+private:
+  /**
+   * Read ahead the leaves which follow {leaf} under the same parent, up to the prefetch window of the pool
+   */
+  void PrefetchSiblings(const BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf);
+
 private:
   // add your own private member variables here
   page_id_t page_id_;
@@ -0,0 +1,128 @@
+#ifndef MINISQL_KEY_SEARCH_H
+#define MINISQL_KEY_SEARCH_H
+
+#include <cstdint>
+#include <cstring>
+
+#include "index/basic_comparator.h"
+#include "index/generic_key.h"
+
+/**
+ * Maps a key to a plain integer with the same ordering as its comparator.
+ * Only specialized for fixed-size keys that fit in a machine word; those are
+ * searched by the branch-free kernel in KeySearch.
+ */
+template<typename KeyType, typename KeyComparator>
+struct OrderedKey {
+  static constexpr bool enabled = false;
+};
+
+template<>
+struct OrderedKey<int, BasicComparator<int>> {
+  static constexpr bool enabled = true;
+  using Type = int;
+
+  static inline Type Extract(const int &key) { return key; }
+};
+
+// GenericKey bytes are memcomparable (see KeyEncoder), so a big-endian load orders them like memcmp
+template<>
+struct OrderedKey<GenericKey<4>, GenericComparator<4>> {
+  static constexpr bool enabled = true;
+  using Type = uint32_t;
+
+  static inline Type Extract(const GenericKey<4> &key) {
+    uint32_t val;
+    memcpy(&val, key.data, sizeof(val));
+    return __builtin_bswap32(val);
+  }
+};
+
+template<>
+struct OrderedKey<GenericKey<8>, GenericComparator<8>> {
+  static constexpr bool enabled = true;
+  using Type = uint64_t;
+
+  static inline Type Extract(const GenericKey<8> &key) {
+    uint64_t val;
+    memcpy(&val, key.data, sizeof(val));
+    return __builtin_bswap64(val);
+  }
+};
+
+/**
+ * Binary search over the sorted (key, value) array of a B+ tree page.
+ * Both bounds search the range [begin, end) and return end if no key qualifies.
+ */
+template<typename KeyType, typename KeyComparator>
+class KeySearch {
+public:
+  /**
+   * @return the first index i in [begin, end) so that array[i].first >= key
+   */
+  template<typename PairType>
+  static int LowerBound(const PairType *array, int begin, int end, const KeyType &key,
+                        const KeyComparator &comparator) {
+    if constexpr (OrderedKey<KeyType, KeyComparator>::enabled) {
+      return BranchFreeSearch<PairType, false>(array, begin, end, key);
+    } else {
+      while (begin < end) {
+        int mid = begin + (end - begin) / 2;
+        if (comparator(array[mid].first, key) < 0) {
+          begin = mid + 1;
+        } else {
+          end = mid;
+        }
+      }
+      return begin;
+    }
+  }
+
+  /**
+   * @return the first index i in [begin, end) so that array[i].first > key
+   */
+  template<typename PairType>
+  static int UpperBound(const PairType *array, int begin, int end, const KeyType &key,
+                        const KeyComparator &comparator) {
+    if constexpr (OrderedKey<KeyType, KeyComparator>::enabled) {
+      return BranchFreeSearch<PairType, true>(array, begin, end, key);
+    } else {
+      while (begin < end) {
+        int mid = begin + (end - begin) / 2;
+        if (comparator(array[mid].first, key) <= 0) {
+          begin = mid + 1;
+        } else {
+          end = mid;
+        }
+      }
+      return begin;
+    }
+  }
+
+private:
+  /**
+   * The window only shrinks by halves and the probe result selects the next base
+   * with a conditional move, so the loop runs log2(n) iterations without any
+   * data-dependent branch to mispredict.
+   */
+  template<typename PairType, bool upper>
+  static int BranchFreeSearch(const PairType *array, int begin, int end, const KeyType &key) {
+    using Key = OrderedKey<KeyType, KeyComparator>;
+    int n = end - begin;
+    if (n <= 0) {
+      return begin;
+    }
+    const typename Key::Type target = Key::Extract(key);
+    const PairType *base = array + begin;
+    while (n > 1) {
+      int half = n / 2;
+      typename Key::Type probe = Key::Extract(base[half].first);
+      base = (upper ? probe <= target : probe < target) ? base + half : base;
+      n -= half;
+    }
+    typename Key::Type last = Key::Extract(base->first);
+    return static_cast<int>(base - array) + (upper ? last <= target : last < target);
+  }
+};
+
+#endif  // MINISQL_KEY_SEARCH_H
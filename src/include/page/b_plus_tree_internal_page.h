@@ -55,11 +55,12 @@ public:
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                          BufferPoolManager *buffer_pool_manager);
 
+  // Bulk load appends entries in key order
+  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+
 private:
   void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
 
-  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
 
   MappingType array_[0];
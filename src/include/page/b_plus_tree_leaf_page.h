@@ -64,11 +64,12 @@ public:
 
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
+  // Bulk load appends entries in key order
+  void CopyLastFrom(const MappingType &item);
+
 private:
   void CopyNFrom(MappingType *items, int size);
 
-  void CopyLastFrom(const MappingType &item);
-
   void CopyFirstFrom(const MappingType &item);
 
   page_id_t next_page_id_;
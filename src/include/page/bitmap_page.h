@@ -20,6 +20,12 @@ public:
    */
   bool AllocatePage(uint32_t &page_offset);
 
+  /**
+   * Allocate the page at {page_offset}, used to redo an allocation from the log.
+   * @return false if the page is allocated already.
+   */
+  bool AllocatePageAt(uint32_t page_offset);
+
   /**
    * @return true if successfully de-allocate a page.
    */
@@ -30,6 +36,11 @@ public:
    */
   bool IsPageFree(uint32_t page_offset) const;
 
+  /**
+   * @return number of allocated pages in the extent
+   */
+  uint32_t GetAllocatedPages() const { return page_allocated_; }
+
 private:
   /**
    * check a bit(byte_index, bit_index) in bytes is free(value 0).
@@ -40,12 +51,21 @@ private:
    */
   bool IsPageFreeLow(uint32_t byte_index, uint8_t bit_index) const;
 
+  /**
+   * @return the lowest free page offset in words [begin_word, end_word), or MAX_CHARS * 8 if there is none
+   */
+  uint32_t FindFreePage(uint32_t begin_word, uint32_t end_word) const;
+
   /** Note: need to update if modify page structure. */
   static constexpr size_t MAX_CHARS = PageSize - 2 * sizeof(uint32_t);
+  /** Allocation scans the bitmap one 64-bit word at a time */
+  static constexpr size_t MAX_WORDS = MAX_CHARS / sizeof(uint64_t);
+  static_assert(MAX_CHARS % sizeof(uint64_t) == 0, "bitmap must consist of whole words");
 
 private:
   /** The space occupied by all members of the class should be equal to the PageSize */
   [[maybe_unused]] uint32_t page_allocated_ = 0;
+  // hint: every page below it is normally allocated, so the search starts from here
   [[maybe_unused]] uint32_t next_free_page_ = 0;
   [[maybe_unused]] unsigned char bytes[MAX_CHARS];
 };
@@ -2,10 +2,12 @@
 #define MINISQL_DISK_FILE_META_PAGE_H
 
 #include <cstdint>
+#include <cstring>
 
 #include "page/bitmap_page.h"
 
-static constexpr page_id_t MAX_VALID_PAGE_ID = (PAGE_SIZE - 8) / 4 * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+// the last 8 bytes of the meta page hold the checkpoint offset, the extent counters end before them
+static constexpr page_id_t MAX_VALID_PAGE_ID = (PAGE_SIZE - 16) / 4 * BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
 
 class DiskFileMetaPage {
 public:
@@ -24,6 +26,21 @@ public:
     return extent_used_page_[extent_id];
   }
 
+  /**
+   * @return log offset of the last complete checkpoint, where the recovery starts, 0 if there is none
+   */
+  uint64_t GetCheckpointOffset() {
+    uint64_t offset;
+    memcpy(&offset, reinterpret_cast<char *>(this) + OFFSET_CHECKPOINT, sizeof(uint64_t));
+    return offset;
+  }
+
+  void SetCheckpointOffset(uint64_t offset) {
+    memcpy(reinterpret_cast<char *>(this) + OFFSET_CHECKPOINT, &offset, sizeof(uint64_t));
+  }
+
+  static constexpr size_t OFFSET_CHECKPOINT = PAGE_SIZE - sizeof(uint64_t);
+
 public:
   uint32_t num_allocated_pages_{0};
   uint32_t num_extents_{0};   // each extent consists with a bit map and BIT_MAP_SIZE pages
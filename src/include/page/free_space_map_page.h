@@ -0,0 +1,74 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <utility>
+
+#include "common/config.h"
+
+/**
+ * Free-space map page of a table heap. Every table page of the heap owns one
+ * entry which records how many bytes are still free in it, quantized into
+ * buckets of BUCKET_BYTES. Map pages of the same heap are chained by NextPageId,
+ * entries are appended in the same order as the table pages are chained.
+ *
+ * Format (size in byte):
+ *  ------------------------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | Page_1 id (4) | Page_1 bucket (4) | ... |
+ *  ------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+public:
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetEntryCount() const { return count_; }
+
+  bool IsFull() const { return count_ >= MAX_ENTRY_COUNT; }
+
+  /**
+   * Append an entry for table page {page_id}
+   * @return false if there is no room left in this map page
+   */
+  bool Append(const page_id_t page_id, const uint32_t bucket, uint32_t *slot);
+
+  page_id_t GetTablePageId(const uint32_t slot) const { return entries_[slot].first; }
+
+  uint32_t GetBucket(const uint32_t slot) const { return entries_[slot].second; }
+
+  void SetBucket(const uint32_t slot, const uint32_t bucket) { entries_[slot].second = bucket; }
+
+  /**
+   * @return the first slot whose bucket is no smaller than {min_bucket}, -1 if not found
+   */
+  int FindSlot(const uint32_t min_bucket) const;
+
+  uint32_t GetMaxBucket() const;
+
+  /**
+   * Bucket recorded for a page with {free_bytes} left, rounded down so a page never looks roomier than it is
+   */
+  static uint32_t ToBucket(const uint32_t free_bytes) { return free_bytes / BUCKET_BYTES; }
+
+  /**
+   * Smallest bucket which guarantees {required_bytes} of free space, rounded up
+   */
+  static uint32_t ToRequiredBucket(const uint32_t required_bytes) {
+    return (required_bytes + BUCKET_BYTES - 1) / BUCKET_BYTES;
+  }
+
+  static constexpr uint32_t BUCKET_BYTES = PAGE_SIZE / 128;
+  static constexpr uint32_t MAX_ENTRY_COUNT = (PAGE_SIZE - 8) / 8;
+
+private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  std::pair<page_id_t, uint32_t> entries_[0];
+};
+
+#endif //MINISQL_FREE_SPACE_MAP_PAGE_H
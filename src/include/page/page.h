@@ -20,11 +20,15 @@ class Page {
 public:
   DISALLOW_COPY(Page)
 
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor for a page living outside the buffer pool, owns a zeroed buffer. */
+  Page() : data_(new char[PAGE_SIZE]), owns_data_(true) { ResetMemory(); }
 
-  /** Default destructor. */
-  ~Page() = default;
+  /** Destructor. Frames of the buffer pool do not own their data. */
+  ~Page() {
+    if (owns_data_) {
+      delete[] data_;
+    }
+  }
 
   /** @return the actual data contained within this page */
   inline char *GetData() { return data_; }
@@ -65,17 +69,31 @@ protected:
   static constexpr size_t OFFSET_LSN = 4;
 
 private:
+  /** Constructor for a buffer pool frame, {data} points into the pool's page-aligned frame region. */
+  explicit Page(char *data) : data_(data), owns_data_(false) {}
+
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The actual data that is stored within a page, PAGE_SIZE bytes. */
+  char *data_;
+  /** True if data_ was allocated by this page. */
+  bool owns_data_;
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
   /** The pin count of this page. */
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
+  /** LSN of the last log record of this page, kept for pages without an LSN slot as well. */
+  lsn_t last_lsn_ = INVALID_LSN;
+  /** True if the page was created zeroed and has not been logged since. */
+  bool is_new_ = false;
+  /** LSN and log offset of the first record since the page was last written back, INVALID_LSN if it is clean. */
+  lsn_t rec_lsn_ = INVALID_LSN;
+  uint64_t rec_offset_ = 0;
+  /** Number of open atomic sections holding changes of this page, each of them keeps a pin. */
+  int section_count_ = 0;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -18,6 +18,7 @@
  **/
 
 #include <cstring>
+#include <string>
 #include "common/macros.h"
 #include "common/rowid.h"
 #include "page/page.h"
@@ -51,16 +52,55 @@ public:
   bool UpdateTuple(const Row &new_row, Row *old_row, Schema *schema,
                    Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
+  /**
+   * Put {old_row} back into the slot of {rid} to undo an update, the slot keeps at least the bytes it holds now
+   * @return false if the slot holds no live tuple or the page has no room left
+   */
+  bool RollbackUpdate(const Row &old_row, const RowId &rid, Schema *schema);
+
+  /**
+   * Cut the slot of {rid} down to the size of its row, giving back the bytes an update kept for its rollback
+   */
+  void ReleaseTupleSpace(const RowId &rid, Schema *schema);
+
   void ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
 
   void RollbackDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
 
   bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
 
+  /**
+   * Copy out the bytes of the tuple at {rid}, whether it is marked deleted or not
+   * @return false if the slot holds no tuple
+   */
+  bool GetTupleData(const RowId &rid, std::string &data);
+
+  /**
+   * Copy out the bytes of the tuple at {rid} if it is there and not marked deleted
+   * @return false if the slot holds no such tuple
+   */
+  bool GetLiveTupleData(const RowId &rid, std::string &data);
+
+  /**
+   * Put {size} bytes of a tuple back into the slot of {rid}, in place of whatever the slot holds now.
+   * Undoes a delete or an update, the row id stays the same.
+   * @return false if the slot does not exist or the page has no room left
+   */
+  bool RestoreTuple(const RowId &rid, const char *data, uint32_t size);
+
   bool GetFirstTupleRid(RowId *first_rid);
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
+  /**
+   * @return number of slots, a slot of a tuple deleted holds nothing
+   */
+  uint32_t GetSlotCount() { return GetTupleCount(); }
+
+  uint32_t GetFreeSpaceRemaining() {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
 private:
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
@@ -72,10 +112,6 @@ private:
 
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
   }
@@ -92,6 +128,11 @@ private:
     memcpy(GetData() + OFFSET_TUPLE_SIZE + SIZE_TUPLE * slot_num, &size, sizeof(uint32_t));
   }
 
+  /**
+   * Write {row} into slot {slot_num}, resized to {slot_size} bytes with zeros after the row
+   */
+  void WriteTuple(uint32_t slot_num, const Row &row, uint32_t slot_size, Schema *schema);
+
   static bool IsDeleted(uint32_t tuple_size) { return static_cast<bool>(tuple_size & DELETE_MASK) || tuple_size == 0; }
 
   static uint32_t SetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size | DELETE_MASK); }
@@ -102,7 +143,6 @@ private:
   static_assert(sizeof(page_id_t) == 4);
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
   static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
-  static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
@@ -111,6 +151,7 @@ private:
   static constexpr size_t OFFSET_TUPLE_SIZE = 28;
 
 public:
+  static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
 };
 
@@ -1,5 +1,6 @@
 %{
   #include <stdio.h>
+  #include <strings.h>
   #include "parser/parser.h"
 
   extern char *yytext;
@@ -7,6 +8,8 @@
   int yyerror(char* error);
 %}
 
+%define api.header.include {"parser/minisql_yacc.h"}
+
 %union {
 	pSyntaxNode syntax_node;
 }
@@ -26,15 +29,31 @@
 %type <syntax_node> sql_trx_begin sql_trx_commit sql_trx_rollback
 %type <syntax_node> sql_select select_columns column_values column_value operator
 %type <syntax_node> connector where_conditions where_condition
-%type <syntax_node> sql_insert sql_delete sql_update update_values update_value
-%type <syntax_node> sql_quit sql_exec_file
+%type <syntax_node> sql_insert value_tuples value_tuple sql_delete sql_update update_values update_value
+%type <syntax_node> sql_quit sql_exec_file sql_copy
 
 %%
 
+/*
+ * One statement is parsed per call of yyparse, so that a buffer holding a whole
+ * script is parsed by calling it repeatedly. The parser returns right after the
+ * ';' and never reads ahead into the next statement. A statement with a syntax
+ * error is skipped up to its ';', and the end of input gives a NULL root.
+ */
 start:
   sql ';' {
     $$ = $1;
     MinisqlParserSetRoot($$);
+    YYACCEPT;
+  }
+  | error ';' {
+    $$ = NULL;
+    MinisqlParserSetRoot($$);
+    YYACCEPT;
+  }
+  | %empty {
+    $$ = NULL;
+    MinisqlParserSetRoot($$);
   }
   ;
 
@@ -58,6 +77,7 @@ sql:
   | sql_trx_rollback { $$ = $1; }
   | sql_quit { $$ = $1; }
   | sql_exec_file { $$ = $1; }
+  | sql_copy { $$ = $1; }
   ;
 
 sql_create_database:
@@ -289,12 +309,37 @@ operator:
   ;
 
 sql_insert:
-  INSERT INTO IDENTIFIER VALUES '(' column_values ')' {
+  INSERT INTO IDENTIFIER VALUES value_tuples {
     $$ = CreateSyntaxNode(kNodeInsert, NULL);
     SyntaxNodeAddChildren($$, $3);
-    pSyntaxNode col_val_node = CreateSyntaxNode(kNodeColumnValues, NULL);
-    SyntaxNodeAddChildren(col_val_node, $6);
-    SyntaxNodeAddChildren($$, col_val_node);
+    // value_tuples come in reverse order
+    pSyntaxNode tuples = NULL;
+    pSyntaxNode p = $5;
+    while (p != NULL) {
+      pSyntaxNode next = p->next_;
+      p->next_ = tuples;
+      tuples = p;
+      p = next;
+    }
+    SyntaxNodeAddChildren($$, tuples);
+  }
+  ;
+
+value_tuples:
+  value_tuple {
+    $$ = $1;
+  }
+  | value_tuples ',' value_tuple {
+    // left recursive and prepended, so that many tuples neither deepen the parser stack nor walk the list
+    $$ = $3;
+    $$->next_ = $1;
+  }
+  ;
+
+value_tuple:
+  '(' column_values ')' {
+    $$ = CreateSyntaxNode(kNodeColumnValues, NULL);
+    SyntaxNodeAddChildren($$, $2);
   }
   ;
 
@@ -393,6 +438,19 @@ sql_exec_file:
   }
   ;
 
+/* copy is not a keyword of the scanner, so it arrives as an identifier */
+sql_copy:
+  IDENTIFIER IDENTIFIER FROM STRING {
+    if (strcasecmp($1->val_, "copy") != 0) {
+      yyerror("syntax error");
+      YYERROR;
+    }
+    $$ = CreateSyntaxNode(kNodeCopy, NULL);
+    SyntaxNodeAddChildren($$, $2);
+    SyntaxNodeAddChildren($$, $4);
+  }
+  ;
+
 %%
 int yyerror(char* error) {
 	MinisqlParserSetError(error);
@@ -43,7 +43,8 @@ typedef enum {
   kNodeIndexType, /** type of index */
   kNodeTrxBegin, /** begin transaction command */
   kNodeTrxCommit, /** commit transaction command */
-  kNodeTrxRollback /** rollback transaction command */
+  kNodeTrxRollback, /** rollback transaction command */
+  kNodeCopy /** copy command, bulk loads a csv file into a table */
 } SyntaxNodeType;
 
 /**
@@ -63,7 +64,7 @@ typedef struct SyntaxNode *pSyntaxNode;
 pSyntaxNode CreateSyntaxNode(SyntaxNodeType type, char *val);
 
 /**
- * Free a syntax node and its attribute value, only called by DestroySyntaxTree
+ * Free a syntax node and its attribute value, only called by DestroySyntaxNodeList
  */
 void FreeSyntaxNode(pSyntaxNode node);
 
@@ -87,5 +88,20 @@ struct SyntaxNodeList {
 };
 typedef struct SyntaxNodeList *pSyntaxNodeList;
 
+/**
+ * Take over all syntax nodes allocated so far, they are no longer freed by DestroySyntaxTree.
+ * Used to keep the trees of several parsed statements alive at the same time.
+ */
+pSyntaxNodeList DetachSyntaxTree();
+
+/**
+ * Hand nodes taken over by DetachSyntaxTree back, to be freed by the next DestroySyntaxTree
+ */
+void AttachSyntaxTree(pSyntaxNodeList list);
+
+/**
+ * Free the nodes taken over by DetachSyntaxTree
+ */
+void DestroySyntaxNodeList(pSyntaxNodeList list);
 
 #endif //MINISQL_SYNTAX_TREE_H
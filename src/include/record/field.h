@@ -2,6 +2,7 @@
 #define MINISQL_FIELD_H
 
 #include <cstring>
+#include <string>
 
 #include "common/config.h"
 #include "common/macros.h"
@@ -87,6 +88,10 @@ public:
     return *this;
   }
 
+  inline TypeId GetTypeId() const {
+    return type_id_;
+  }
+
   inline bool IsNull() const {
     return is_null_;
   }
@@ -164,7 +169,7 @@ protected:
     int32_t integer_;
     float float_;
     char *chars_;
-  } value_;
+  } value_{};
   TypeId type_id_;
   uint32_t len_;
   bool is_null_{false};
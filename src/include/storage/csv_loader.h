@@ -0,0 +1,89 @@
+#ifndef MINISQL_CSV_LOADER_H
+#define MINISQL_CSV_LOADER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "record/row.h"
+#include "record/schema.h"
+#include "utils/mapped_file.h"
+
+/**
+ * Parse a csv file into rows of a table.
+ *
+ * The mapped file is cut into chunks at line ends, the chunks are parsed by a pool of worker
+ * threads and handed back in file order. Fields are separated by ',' and may be quoted with '"',
+ * a quote inside a quoted field is written twice. An empty unquoted field is null, while "" is an
+ * empty string. A first line holding exactly the column names is skipped as a header, so the
+ * output of `--format csv` loads back as it is.
+ */
+class CsvLoader {
+public:
+  explicit CsvLoader(const Schema *schema, uint32_t worker_count = 0);
+
+  /**
+   * @return false if the file can not be opened or mapped
+   */
+  bool Open(const std::string &path);
+
+  /**
+   * Parse the whole file. {consumer} is called on the calling thread with the rows of one chunk at a
+   * time in file order, it may take the rows away. Parsing stops at the first malformed line or
+   * when the consumer returns false.
+   * @return true iff every line is parsed and consumed
+   */
+  bool Load(const std::function<bool(std::vector<Row> &)> &consumer);
+
+  /**
+   * @return why Open or Load failed, with the line number for malformed lines
+   */
+  const std::string &GetError() const { return error_; }
+
+  /**
+   * Bytes of the file handed to one worker at a time
+   */
+  static constexpr size_t CHUNK_SIZE = 4 << 20;
+
+private:
+  struct Chunk {
+    size_t begin_;
+    size_t end_;
+    std::vector<Row> rows_;
+    size_t lines_{0};        // lines in this chunk, to number the lines of the whole file
+    bool done_{false};
+    bool ok_{true};
+    size_t error_line_{0};   // line in this chunk
+    std::string error_;
+  };
+
+  /**
+   * Cut the file after the header into chunks of about CHUNK_SIZE which end at a line end
+   */
+  void SplitChunks(size_t begin, std::vector<Chunk> &chunks) const;
+
+  /**
+   * @return the offset where the data starts, after the header line if there is one
+   */
+  size_t SkipHeader() const;
+
+  void ParseChunk(Chunk &chunk) const;
+
+  /**
+   * Parse one line into fields of the schema
+   * @param[in/out] pos the start of the line, moved past its end
+   * @param[out] fields empty if the line is blank
+   */
+  bool ParseLine(size_t &pos, size_t end, std::vector<Field> &fields, std::string &scratch,
+                 std::string &error) const;
+
+  bool MakeField(const Column *column, const std::string &value, bool quoted, std::vector<Field> &fields,
+                 std::string &error) const;
+
+  const Schema *schema_;
+  uint32_t worker_count_;
+  MappedFile file_;
+  std::string error_;
+};
+
+#endif  // MINISQL_CSV_LOADER_H
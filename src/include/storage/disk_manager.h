@@ -2,14 +2,16 @@
 #define DISK_MGR_H
 
 #include <atomic>
-#include <fstream>
 #include <iostream>
 #include <mutex>
+#include <memory>
 #include <string>
+#include <vector>
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "transaction/log_manager.h"
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
@@ -32,6 +34,7 @@ public:
   /**
    * Read page from specific page_id
    * Note: page_id = 0 is reserved for disk meta page
+   * Page reads and writes take no latch, callers must not access the same page concurrently
    */
   void ReadPage(page_id_t logical_page_id, char *page_data);
 
@@ -47,6 +50,11 @@ public:
    */
   page_id_t AllocatePage();
 
+  /**
+   * Mark {logical_page_id} allocated if it is free, used by the recovery to redo an allocation
+   */
+  void AllocatePageAt(page_id_t logical_page_id);
+
   /**
    * Free this page and reset bit map
    */
@@ -57,6 +65,31 @@ public:
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * Write back dirty bitmap pages and the disk meta page, then force everything written so far to stable storage.
+   * Allocation state is kept in memory between two syncs.
+   * Page writes only reach the OS page cache, call this where durability is required.
+   */
+  void Sync();
+
+  /**
+   * Make every page written so far durable, then record {offset} in the meta page as the log offset
+   * the next recovery starts from. The meta page is written only after everything else is synced,
+   * so it never points at a checkpoint whose pages did not reach the disk.
+   */
+  void Checkpoint(uint64_t offset);
+
+  /**
+   * @return log offset of the last checkpoint, 0 if there is none
+   */
+  uint64_t GetCheckpointOffset();
+
+  /**
+   * With a {log_manager}, the log is flushed before the bitmaps are written, so a page never shows
+   * up free on disk before the log record which frees it
+   */
+  void SetLogManager(LogManager *log_manager) { log_manager_ = log_manager; }
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
@@ -74,9 +107,9 @@ public:
 
 private:
   /**
-   * Helper function to get disk file size
+   * Helper function to get disk file size from the file system
    */
-  int GetFileSize(const std::string &file_name);
+  size_t GetFileSize();
 
   /**
    * Read physical page from disk
@@ -93,14 +126,35 @@ private:
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
+  /**
+   * Resident bitmap page of an extent, a zeroed one is created for a new extent. Caller must hold db_io_latch_.
+   */
+  BitmapPage<PAGE_SIZE> *GetBitmap(uint32_t extent_id);
+
+  /**
+   * Read all bitmap pages at startup and rebuild the meta page counters from them
+   */
+  void LoadBitmaps();
+
+  /**
+   * Write back dirty bitmap pages, after flushing the log. Caller must hold db_io_latch_.
+   */
+  void WriteBitmaps();
+
 private:
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of db file, pages are accessed by positioned pread/pwrite
+  int db_fd_{-1};
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
+  // cached file size, only grows
+  std::atomic<size_t> file_size_{0};
+  // with multiple buffer pool instances, need to protect page allocation (meta page and bitmaps)
   std::recursive_mutex db_io_latch_;
   bool closed{false};
   char meta_data_[PAGE_SIZE];
+  // bitmap page of every extent, resident for the lifetime of the disk manager
+  std::vector<std::unique_ptr<char[]>> bitmaps_;
+  std::vector<bool> bitmap_dirty_;
+  LogManager *log_manager_{nullptr};
 };
 
 #endif
\ No newline at end of file
@@ -1,11 +1,18 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "page/free_space_map_page.h"
 #include "page/table_page.h"
 #include "storage/table_iterator.h"
 #include "transaction/log_manager.h"
 #include "transaction/lock_manager.h"
+#include "transaction/version_store.h"
 
 class TableHeap {
   friend class TableIterator;
@@ -17,10 +24,12 @@ public:
     return new(buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
   }
 
-  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
+  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id,
+                           page_id_t first_fsm_page_id, Schema *schema,
                            LogManager *log_manager, LockManager *lock_manager, MemHeap *heap) {
     void *buf = heap->Allocate(sizeof(TableHeap));
-    return new(buf) TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+    return new(buf) TableHeap(buffer_pool_manager, first_page_id, first_fsm_page_id, schema, log_manager,
+                              lock_manager);
   }
 
   ~TableHeap() {}
@@ -33,6 +42,23 @@ public:
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Insert a batch of tuples by appending them to the tail of the heap. Each page is
+   * latched once and filled with as many rows as fit before the next one is linked.
+   * @param[in/out] rows Tuple Rows to insert, the rid of every inserted tuple is wrapped in its row
+   * @return false if a row can not be inserted, the rows before it stay inserted
+   */
+  bool InsertTuples(std::vector<Row> &rows, Transaction *txn);
+
+  /**
+   * Bulk load the rows of a csv file, see CsvLoader for the format. The file is parsed by a pool of
+   * worker threads while the rows are appended to new pages at the tail of the heap.
+   * @param[out] rids Row ids of the loaded tuples in file order
+   * @param[out] error Why the load failed, nothing of the file is left in the heap then
+   * @return true iff every line of the file is loaded
+   */
+  bool CopyFrom(const std::string &path, std::vector<RowId> &rids, std::string &error, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -50,8 +76,24 @@ public:
    */
   bool UpdateTuple(const Row &row, const RowId &rid, Transaction *txn);
 
+  /**
+   * Called on abort to put the tuple an update replaced back in place.
+   * An update keeps the bytes of the old tuple until the transaction is over, so this only fails on a broken page.
+   * @param[in] row The tuple before the update.
+   * @param[in] rid Rid of the updated tuple.
+   * @return true if the tuple is back.
+   */
+  bool RollbackUpdate(const Row &row, const RowId &rid);
+
+  /**
+   * Called on Commit/Abort to give back the bytes an update kept for its rollback.
+   * @param[in] rid Rid of the updated tuple.
+   */
+  void ReleaseTupleSpace(const RowId &rid);
+
   /**
    * Called on Commit/Abort to actually delete a tuple or rollback an insert.
+   * A growing transaction keeps the tuple marked, it is deleted when the transaction commits.
    * @param rid Rid of the tuple to delete
    * @param txn Transaction performing the delete.
    */
@@ -65,20 +107,27 @@ public:
   void RollbackDelete(const RowId &rid, Transaction *txn);
 
   /**
-   * Read a tuple from the table.
+   * Read a tuple from the table, as the snapshot of {txn} sees it. Nothing is locked.
    * @param[in/out] row Output variable for the tuple, row id of the tuple is wrapped in row
    * @param[in] txn transaction performing the read
    * @return true if the read was successful (i.e. the tuple exists)
    */
   bool GetTuple(Row *row, Transaction *txn);
 
+  /**
+   * Call {visit} with every tuple of one page, so that a scan can be split by pages over threads
+   * @return false if the page can not be fetched
+   */
+  bool ScanPage(page_id_t page_id, const std::function<void(const Row &row)> &visit, Transaction *txn);
+
   /**
    * Free table heap and release storage in disk file
    */
   void FreeHeap();
 
   /**
-   * @return the begin iterator of this table
+   * @return the begin iterator of this table, it reads the snapshot of {txn} without locking anything,
+   * and the tuples as they are now without a transaction
    */
   TableIterator Begin(Transaction *txn);
 
@@ -87,11 +136,31 @@ public:
    */
   TableIterator End();
 
+  /**
+   * Set the id of the table, the locks of its rows are taken under it
+   */
+  inline void SetTableId(table_id_t table_id) { table_id_ = table_id; }
+
+  /**
+   * Set where the versions of the tuples changed are kept, nullptr if transactions read the tuples as they are
+   */
+  inline void SetVersionStore(VersionStore *version_store) { version_store_ = version_store; }
+
   /**
    * @return the id of the first page of this table
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return the id of the first free-space map page of this table
+   */
+  inline page_id_t GetFirstFreeSpaceMapPageId() const { return first_fsm_page_id_; }
+
+  /**
+   * @return the ids of all pages of this table
+   */
+  inline const std::vector<page_id_t> &GetPageIds() const { return table_page_ids_; }
+
 private:
   /**
    * create table heap and initialize first page
@@ -104,26 +173,118 @@ private:
           lock_manager_(lock_manager) {
     TablePage *page = nullptr;
     page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_));
+    buffer_pool_manager_->BeginAtomic();
     page->Init(first_page_id_,INVALID_PAGE_ID,log_manager,txn);
+    uint32_t free_space = page->GetFreeSpaceRemaining();
+    buffer_pool_manager_->UnpinPage(first_page_id_, true);
+    last_page_id_ = first_page_id_;
+    AppendFreeSpaceEntry(first_page_id_, free_space);
+    buffer_pool_manager_->EndAtomic();
   };
 
   /**
-   * load existing table heap by first_page_id
+   * load existing table heap by first_page_id, the free-space map is rebuilt from the page chain
+   * if first_fsm_page_id is invalid (tables created before the map existed)
    */
-  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, page_id_t first_fsm_page_id,
+                     Schema *schema, LogManager *log_manager, LockManager *lock_manager)
           : buffer_pool_manager_(buffer_pool_manager),
             first_page_id_(first_page_id),
+            first_fsm_page_id_(first_fsm_page_id),
             schema_(schema),
             log_manager_(log_manager),
-            lock_manager_(lock_manager) {}
+            lock_manager_(lock_manager) {
+    LoadFreeSpaceMap();
+  }
+
+  /**
+   * Try to insert the row into a specific page, the map entry of that page is refreshed either way
+   */
+  bool InsertIntoPage(page_id_t page_id, Row &row, Transaction *txn);
+
+  /**
+   * Close the atomic section of one change, keeping {record} to undo it if {txn} is given and the
+   * change was made; a record of kInvalid type means there is nothing to undo. The change goes into
+   * the write set of {txn} as well, {old_row} is the tuple before an update.
+   */
+  void EndAtomic(Transaction *txn, const LogRecord &record, const Row *old_row = nullptr);
+
+  /**
+   * Lock {rid} in {mode} for {txn}, nothing is locked without a transaction or a lock manager.
+   * Never called holding a page latch, the lock may have to wait for another transaction.
+   * @return false if {txn} is chosen to abort
+   */
+  bool LockRow(Transaction *txn, LockMode mode, const RowId &rid);
+
+  /**
+   * Lock the whole table in {mode} for {txn}, see LockRow
+   */
+  bool LockTable(Transaction *txn, LockMode mode);
+
+  /**
+   * Lock {rid} exclusively for {txn} to change it. A transaction may not change a tuple changed by
+   * another one committed after it began, its snapshot would lose that change.
+   * @return false if {txn} has to abort, it is marked aborted then
+   */
+  bool LockForWrite(Transaction *txn, const RowId &rid);
+
+  /**
+   * Keep the tuple at {rid} before {txn} changes it, under the latch of its page, see VersionStore::Record
+   */
+  void RecordVersion(Transaction *txn, const RowId &rid, const std::string *before);
+
+  /**
+   * Copy out the tuple at {rid} as the snapshot of {txn} sees it, {page} is latched
+   * @return false if the snapshot has no tuple there
+   */
+  bool ReadVersion(TablePage *page, const RowId &rid, Transaction *txn, std::string &data);
+
+  /**
+   * Link a new empty page to the tail of the heap
+   * @return the id of the new page, INVALID_PAGE_ID if the buffer pool is out of frames
+   */
+  page_id_t AppendPage(Transaction *txn);
+
+  /**
+   * @return a page which has at least {required_bytes} free according to the free-space map,
+   * INVALID_PAGE_ID if there is none
+   */
+  page_id_t FindFreePage(uint32_t required_bytes);
+
+  /**
+   * Record the free space of a table page in the free-space map
+   */
+  void UpdateFreeSpace(page_id_t page_id, uint32_t free_bytes);
+
+  /**
+   * Add a map entry for a table page newly linked to the tail of the heap
+   */
+  void AppendFreeSpaceEntry(page_id_t page_id, uint32_t free_bytes);
+
+  /**
+   * Ask the buffer pool to read ahead the pages which follow {page_id} in the page chain
+   */
+  void PrefetchAfter(page_id_t page_id);
+
+  /**
+   * Read the map chain into memory, or build the map from the page chain if it does not exist yet
+   */
+  void LoadFreeSpaceMap();
 
 private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
+  page_id_t first_fsm_page_id_{INVALID_PAGE_ID};
+  page_id_t last_page_id_{INVALID_PAGE_ID};                  // tail of the page chain, tried first on insert
+  std::vector<page_id_t> fsm_page_ids_;                       // map pages in chain order
+  std::vector<uint32_t> fsm_max_buckets_;                     // upper bound of the buckets in each map page
+  std::unordered_map<page_id_t, uint32_t> fsm_entries_;       // table page -> entry index in the whole map
+  std::vector<page_id_t> table_page_ids_;                     // entry index in the whole map -> table page
   Schema *schema_;
+  table_id_t table_id_{0};
   [[maybe_unused]] LogManager *log_manager_;
-  [[maybe_unused]] LockManager *lock_manager_;
+  LockManager *lock_manager_;
+  VersionStore *version_store_{nullptr};
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
@@ -1,21 +1,37 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "common/rowid.h"
+#include "page/table_page.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
 
 
 class TableHeap;
 
+/**
+ * Iterator over the tuples of a table heap. The page of the current tuple stays
+ * pinned until the iterator moves to another page, and the current tuple is
+ * deserialized once on first access and cached until the iterator advances.
+ *
+ * An iterator of a transaction reads its snapshot: entering a page, it copies out the version of every
+ * tuple of the page the transaction sees, so it neither waits for the writers nor holds them up.
+ */
 class TableIterator {
+  friend class TableHeap;
 
 public:
   // you may define your own constructor based on your member variables
- TableIterator(RowId id,TableHeap *table_heap_);
+ TableIterator(RowId id, TableHeap *table_heap_, Transaction *txn = nullptr);
 
  TableIterator(const TableIterator &other);
 
+ TableIterator &operator=(const TableIterator &other);
+
   virtual ~TableIterator();
 
   // inline bool operator==(const TableIterator &itr) const;
@@ -38,11 +54,37 @@ public:
 
   TableIterator operator++(int);
 
+private:
+  /**
+   * Position the iterator at the first tuple of {page_id} or of the pages after it, pinning that page.
+   * The iterator becomes End() if no tuple is left.
+   */
+  void SeekFrom(page_id_t page_id);
+
+  void ReleasePage();
+
+  /**
+   * @return true if the iterator reads a snapshot
+   */
+  bool IsSnapshot() const;
+
+  /**
+   * Copy out the tuples of {page} the snapshot sees
+   */
+  void LoadVersions(TablePage *page);
+
 public:
   // add your own private member variables here
   RowId id;
   Row row;
   TableHeap *table_heap_;
+
+private:
+  TablePage *page_{nullptr};    // page of the current tuple, pinned while the iterator points into it
+  Transaction *txn_{nullptr};
+  bool row_loaded_{false};      // whether row holds the tuple at id
+  std::vector<std::pair<RowId, std::string>> versions_;   // tuples of the page the snapshot sees
+  size_t version_pos_{0};       // index of the current tuple in versions_
 };
 
 #endif //MINISQL_TABLE_ITERATOR_H
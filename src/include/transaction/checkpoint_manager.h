@@ -0,0 +1,67 @@
+#ifndef MINISQL_CHECKPOINT_MANAGER_H
+#define MINISQL_CHECKPOINT_MANAGER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+#include "transaction/log_manager.h"
+#include "transaction/txn_manager.h"
+
+/**
+ * CheckpointManager takes fuzzy checkpoints in a background thread, each time the log has grown by
+ * CHECKPOINT_INTERVAL bytes.
+ *
+ * A checkpoint does not stop the database. It first writes back the pages dirty since before the
+ * previous checkpoint, then logs the dirty pages and running transactions left, and records the
+ * position of the checkpoint record in the disk file meta page. Log records recovery will not read
+ * any more are given back to the file system.
+ */
+class CheckpointManager {
+public:
+  CheckpointManager(DiskManager *disk_manager, LogManager *log_manager, BufferPoolManager *buffer_pool_manager,
+                    TxnManager *txn_manager)
+          : disk_manager_(disk_manager), log_manager_(log_manager), buffer_pool_manager_(buffer_pool_manager),
+            txn_manager_(txn_manager) {}
+
+  ~CheckpointManager() { Stop(); }
+
+  DISALLOW_COPY(CheckpointManager)
+
+  /**
+   * Start the background thread
+   */
+  void Start();
+
+  /**
+   * Stop the background thread, waiting for a running checkpoint
+   */
+  void Stop();
+
+  /**
+   * Take a checkpoint now
+   */
+  void Checkpoint();
+
+private:
+  /**
+   * Body of the checkpoint thread
+   */
+  void CheckpointWorker();
+
+  DiskManager *disk_manager_;
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  TxnManager *txn_manager_;
+  std::mutex checkpoint_latch_;             // one checkpoint at a time, protects the two below
+  lsn_t begin_lsn_{INVALID_LSN};            // begin LSN of the last checkpoint
+  uint64_t checkpoint_offset_{0};           // log offset of the last checkpoint record
+  std::mutex latch_;                        // protects shutdown_
+  bool shutdown_{false};
+  std::condition_variable shutdown_cv_;
+  std::thread checkpoint_thread_;
+};
+
+#endif  // MINISQL_CHECKPOINT_MANAGER_H
@@ -1,13 +1,145 @@
 #ifndef MINISQL_LOCK_MANAGER_H
 #define MINISQL_LOCK_MANAGER_H
 
+#include <array>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "transaction/transaction.h"
+
 /**
  * LockManager handles transactions asking for locks on records.
  *
- * Implemented by student self.
+ * Rows are locked shared or exclusive, tables in any of the five modes of multiple granularity locking.
+ * A row lock needs an intention lock on its table, which LockRow takes if the transaction does not hold
+ * one yet. Locks are held until the transaction ends (strict two-phase locking), a transaction asking
+ * again for a lock it holds in a weaker mode upgrades it.
+ *
+ * Requests on a lock are granted in the order they arrive, except that an upgrade goes before every
+ * waiting request. The lock table is split into LOCK_TABLE_PARTITIONS parts, each with its own latch.
+ *
+ * A background thread looks for cycles in the waits-for graph every DEADLOCK_DETECTION_INTERVAL ms and
+ * aborts the youngest transaction of each: its request fails, and it has to be rolled back.
  */
 class LockManager {
+public:
+  /**
+   * @param detect_deadlocks whether to start the detector thread, see DetectDeadlocks
+   */
+  explicit LockManager(bool detect_deadlocks = true);
+
+  ~LockManager();
+
+  DISALLOW_COPY(LockManager)
+
+  /**
+   * Lock table {table_id} in {mode}, or upgrade the lock held to cover {mode}
+   * @return false if {txn} is aborted, before or while waiting
+   */
+  bool LockTable(Transaction *txn, LockMode mode, table_id_t table_id);
+
+  /**
+   * Lock row {rid} of table {table_id} in shared or exclusive {mode}, or upgrade the lock held
+   * @return false if {txn} is aborted, before or while waiting
+   */
+  bool LockRow(Transaction *txn, LockMode mode, table_id_t table_id, const RowId &rid);
+
+  /**
+   * Release every lock of {txn}, when it commits or aborts
+   */
+  void ReleaseAll(Transaction *txn);
+
+  /**
+   * Build the waits-for graph and abort the youngest transaction of every cycle in it
+   * @return number of transactions aborted
+   */
+  size_t DetectDeadlocks();
+
+  /**
+   * @return true if a transaction holding {held} may be granted {requested} as well
+   */
+  static bool Compatible(LockMode held, LockMode requested);
+
+private:
+  /**
+   * A lock on a table or on a row
+   */
+  struct LockKey {
+    bool is_table_;
+    int64_t id_;
+
+    bool operator==(const LockKey &other) const { return is_table_ == other.is_table_ && id_ == other.id_; }
+  };
+
+  struct LockKeyHash {
+    size_t operator()(const LockKey &key) const {
+      // row ids of a page differ in the low bits only, mix them into the bits the partition is picked by
+      return static_cast<size_t>((static_cast<uint64_t>(key.id_) * 0x9E3779B97F4A7C15ULL) >> 32) ^ key.is_table_;
+    }
+  };
+
+  struct LockRequest {
+    Transaction *txn_;
+    LockMode mode_;
+    bool granted_;
+  };
+
+  /**
+   * Requests on one lock, the granted ones first
+   */
+  struct RequestQueue {
+    std::list<LockRequest> requests_;
+    std::condition_variable cv_;
+    bool upgrading_{false};                   // an upgrade is waiting, a second one would deadlock
+  };
+
+  struct Partition {
+    std::mutex latch_;                        // protects the queues and the state of their waiting transactions
+    std::unordered_map<LockKey, RequestQueue, LockKeyHash> queues_;
+  };
+
+  /**
+   * Lock {key} in {mode} for {txn}, {held} is the mode it holds the lock in, nullptr if none.
+   * A failed upgrade leaves the lock held as it was.
+   * @return false if {txn} is aborted
+   */
+  bool Lock(Transaction *txn, const LockKey &key, LockMode mode, const LockMode *held);
+
+  void Unlock(Transaction *txn, const LockKey &key);
+
+  /**
+   * @return true if every request before {request} is granted and compatible with it
+   */
+  static bool Grantable(const RequestQueue &queue, std::list<LockRequest>::iterator request);
+
+  /**
+   * @return true if {held} is at least as strong as {requested}
+   */
+  static bool Covers(LockMode held, LockMode requested);
+
+  /**
+   * @return the weakest mode covering both {a} and {b}
+   */
+  static LockMode Combine(LockMode a, LockMode b);
+
+  Partition &GetPartition(const LockKey &key) { return partitions_[LockKeyHash()(key) % LOCK_TABLE_PARTITIONS]; }
+
+  /**
+   * Body of the detector thread
+   */
+  void DetectionWorker();
 
+  std::array<Partition, LOCK_TABLE_PARTITIONS> partitions_;
+  std::mutex detection_latch_;                // protects shutdown_
+  bool shutdown_{false};
+  std::condition_variable shutdown_cv_;
+  std::thread detection_thread_;
 };
 
 #endif //MINISQL_LOCK_MANAGER_H
@@ -1,15 +1,111 @@
 #ifndef MINISQL_LOG_MANAGER_H
 #define MINISQL_LOG_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "transaction/log_record.h"
+
 /**
  * LogManager maintains a separate thread that is awakened whenever the
  * log buffer is full or whenever a timeout happens.
  * When the thread is awakened, the log buffer's content is written into the disk log file.
  *
- * Implemented by student self
+ * Records are appended to an in-memory log buffer and get increasing LSNs starting from 1. The
+ * flusher swaps the log buffer with a second one, so appends go on while it writes and syncs the
+ * records taken. Everyone waiting in Flush when the flusher starts is covered by the same write
+ * and fsync, which commits many transactions at the cost of one sync (group commit).
  */
 class LogManager {
+public:
+  /**
+   * Open or create {log_file} and look for its end from the record at {start_offset}, usually the last
+   * checkpoint, so opening does not read the whole log. Records after the last whole, valid record are
+   * cut off, they are left by a crash during a write.
+   */
+  explicit LogManager(const std::string &log_file, uint64_t start_offset = 0);
+
+  ~LogManager();
+
+  DISALLOW_COPY(LogManager)
+
+  /**
+   * Assign the next LSN to {log_record} and copy it into the log buffer, waiting while the buffer is full
+   * @param[out] offset file offset the record is written at
+   * @return LSN of the record
+   */
+  lsn_t AppendLogRecord(LogRecord &log_record, uint64_t *offset = nullptr);
+
+  /**
+   * Block until every record up to {lsn} is on disk
+   */
+  void Flush(lsn_t lsn);
+
+  /**
+   * Block until every record appended so far is on disk
+   */
+  void Flush();
+
+  /**
+   * @return LSN of the last record on disk, INVALID_LSN if there is none
+   */
+  lsn_t GetPersistentLSN() const { return persistent_lsn_.load(); }
+
+  lsn_t GetNextLSN() const;
+
+  /**
+   * @param[out] next_lsn LSN of the next record appended
+   * @param[out] offset file offset of the next record appended
+   */
+  void GetAppendPosition(lsn_t &next_lsn, uint64_t &offset) const;
+
+  /**
+   * Give the disk space of the records before file offset {offset} back to the file system, they are
+   * not needed by the recovery any more. Offsets of the records behind stay the same.
+   */
+  void Truncate(uint64_t offset);
+
+  /**
+   * @return number of times the log file has been synced, each sync may cover many commits
+   */
+  uint64_t GetSyncCount() const { return sync_count_.load(); }
+
+  /**
+   * Read the records on disk in order starting at file offset {offset}, until {visit} returns false
+   * or the log ends
+   * @return offset after the last record visited
+   */
+  uint64_t ReadLog(uint64_t offset, const std::function<bool(const LogRecord &record, uint64_t offset)> &visit) const;
+
+private:
+  /**
+   * Body of the flusher thread. An error writing or syncing the log stops the process: the records
+   * cannot be told durable, and appending behind them would leave a gap recovery stops at
+   */
+  void FlushWorker();
 
+  int log_fd_{-1};
+  uint64_t file_size_{0};                   // end of the valid log, only the flusher moves it
+  mutable std::mutex latch_;                // protects everything below
+  std::vector<char> log_buffer_;            // records appended since the last swap
+  std::vector<char> flush_buffer_;          // records being written by the flusher
+  lsn_t next_lsn_{1};
+  uint64_t append_offset_{0};               // file offset of the next record appended
+  std::atomic<lsn_t> persistent_lsn_{INVALID_LSN};
+  std::atomic<uint64_t> sync_count_{0};
+  bool flush_requested_{false};
+  bool shutdown_{false};
+  std::condition_variable flush_cv_;        // wakes the flusher
+  std::condition_variable persisted_cv_;    // signals a finished sync to Flush
+  std::condition_variable space_cv_;        // signals room in the log buffer
+  std::thread flush_thread_;
 };
 
 #endif //MINISQL_LOG_MANAGER_H
@@ -0,0 +1,204 @@
+#ifndef MINISQL_LOG_RECORD_H
+#define MINISQL_LOG_RECORD_H
+
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rowid.h"
+
+enum class LogRecordType {
+  kInvalid = 0,
+  kPageWrite,       // bytes of pages changed, nothing to undo
+  kBegin,
+  kCommit,
+  kAbort,
+  kInsertTuples,    // tuples inserted, undone by deleting them
+  kMarkDelete,      // tuple marked deleted, undone by clearing the mark
+  kRollbackDelete,  // delete mark cleared, undone by marking the tuple again
+  kApplyDelete,     // tuple removed, undone by putting its bytes back
+  kUpdateTuple,     // tuple replaced, undone by putting its old bytes back
+  kInsertKey,       // index entry inserted, undone by removing it
+  kRemoveKey,       // index entry removed, undone by inserting it again
+  kBulkLoad,        // empty index bulk loaded, undone by emptying it again
+  kCompensate,      // undo of an earlier record of the transaction (CLR)
+  kCheckpoint,
+};
+
+/**
+ * A page which is dirty in the buffer pool when a checkpoint is taken, its changes since the
+ * record at {rec_lsn_} (file offset {rec_offset_}) may not be on disk.
+ */
+struct DirtyPage {
+  page_id_t page_id_;
+  lsn_t rec_lsn_;
+  uint64_t rec_offset_;
+};
+
+/**
+ * A transaction which is running when a checkpoint is taken, its records start at file offset {first_offset_}.
+ */
+struct ActiveTxn {
+  txn_id_t txn_id_;
+  uint64_t first_offset_;
+};
+
+/**
+ * One record of the write-ahead log.
+ *
+ * Format (size in byte):
+ *  -----------------------------------------------------------------------------------------------------------
+ * | Size (4) | Checksum (4) | LSN (4) | TxnId (4) | PrevLSN (4) | Type (4) | PagesSize (4) | PageCount (4) |
+ *  -----------------------------------------------------------------------------------------------------------
+ * | Page_1 ... | Page_2 ... | ... | Body ... |
+ *  -----------------------------------------------------------------------------------------------------------
+ * Size counts the whole record and Checksum covers everything after it, so a record torn by a
+ * crash while it was written is recognized and ends the log.
+ *
+ * A record may carry the writes of many pages, which are redone all together or not at all:
+ *  ---------------------------------------------------------------------------------------------
+ * | PageId (4) | Flags (4) | RunCount (4) | Run_1 offset (2) | Run_1 length (2) | Run_1 data | ... |
+ *  ---------------------------------------------------------------------------------------------
+ * Redoing one zeroes the page first if it was just created, copies every run into the page, and
+ * writes the LSN of the record into the page header if the page has an LSN slot. A freed page has
+ * no runs, redoing it frees the page again.
+ *
+ * The body holds what it takes to undo the record, by type:
+ *  kInsertTuples                | RowCount (4) | RowId (8) ... |
+ *  kMarkDelete, kRollbackDelete | RowId (8) |
+ *  kApplyDelete, kUpdateTuple   | RowId (8) | old tuple bytes |
+ *  kInsertKey, kRemoveKey       | IndexId (4) | RowId (8) | key row bytes |
+ *  kBulkLoad                    | IndexId (4) |
+ *  kCompensate                  | UndoNextLSN (4) |
+ *  kCheckpoint                  | BeginLSN (4) | BeginOffset (8) | NextTxnId (4) | DirtyPageCount (4) |
+ *                               | dirty pages ... | TxnCount (4) | active transactions ... |
+ */
+class LogRecord {
+public:
+  LogRecord() = default;
+
+  explicit LogRecord(LogRecordType type) : type_(type) {}
+
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType type)
+          : txn_id_(txn_id), prev_lsn_(prev_lsn), type_(type) {}
+
+  /**
+   * Start the write of {page_id}, runs are added to it with AddRun
+   */
+  void AddPage(page_id_t page_id, bool lsn_slot, bool new_page);
+
+  /**
+   * Add a run to the page added last
+   */
+  void AddRun(uint16_t offset, const char *data, uint16_t length);
+
+  void AddFreedPage(page_id_t page_id);
+
+  static LogRecord InsertTuples(const std::vector<RowId> &rids);
+
+  /**
+   * A record of {type} about one tuple, with the {size} bytes of the tuple before the change if it takes them to undo
+   */
+  static LogRecord TupleWrite(LogRecordType type, const RowId &rid, const char *tuple = nullptr, uint32_t size = 0);
+
+  static LogRecord KeyWrite(LogRecordType type, index_id_t index_id, const RowId &rid, const std::string &key);
+
+  static LogRecord BulkLoad(index_id_t index_id);
+
+  static LogRecord Compensate(lsn_t undo_next_lsn);
+
+  static LogRecord Checkpoint(lsn_t begin_lsn, uint64_t begin_offset, txn_id_t next_txn_id,
+                              const std::vector<DirtyPage> &dirty_pages, const std::vector<ActiveTxn> &active_txns);
+
+  lsn_t GetLSN() const { return lsn_; }
+
+  void SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+  txn_id_t GetTxnId() const { return txn_id_; }
+
+  void SetTxnId(txn_id_t txn_id) { txn_id_ = txn_id; }
+
+  lsn_t GetPrevLSN() const { return prev_lsn_; }
+
+  void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
+
+  LogRecordType GetType() const { return type_; }
+
+  uint32_t GetSize() const { return HEADER_SIZE + pages_.size() + body_.size(); }
+
+  uint32_t GetPageCount() const { return page_offsets_.size(); }
+
+  page_id_t GetPageId(uint32_t index) const;
+
+  bool HasLSNSlot(uint32_t index) const;
+
+  bool IsNewPage(uint32_t index) const;
+
+  bool IsFreedPage(uint32_t index) const;
+
+  uint32_t GetRunCount(uint32_t index) const;
+
+  /**
+   * Redo the write of page {index} on {page_data}
+   */
+  void ApplyTo(uint32_t index, char *page_data) const;
+
+  /**
+   * Drop the page writes and keep what it takes to undo the record
+   */
+  void ClearPages();
+
+  const std::string &GetBody() const { return body_; }
+
+  std::vector<RowId> GetRowIds() const;
+
+  RowId GetRowId() const;
+
+  /**
+   * @return the bytes behind the row id of a tuple or key write
+   */
+  std::string GetData() const;
+
+  index_id_t GetIndexId() const;
+
+  lsn_t GetUndoNextLSN() const;
+
+  void GetCheckpoint(lsn_t &begin_lsn, uint64_t &begin_offset, txn_id_t &next_txn_id,
+                     std::vector<DirtyPage> &dirty_pages, std::vector<ActiveTxn> &active_txns) const;
+
+  /**
+   * @param buf at least GetSize() bytes
+   */
+  void SerializeTo(char *buf) const;
+
+  /**
+   * @return size of the record read from {buf}, 0 if {size} bytes do not hold a whole valid record
+   */
+  static uint32_t DeserializeFrom(const char *buf, size_t size, LogRecord &record);
+
+  static constexpr uint32_t HEADER_SIZE = 32;
+
+private:
+  static uint32_t Checksum(const char *data, size_t size);
+
+  template<typename T>
+  void AppendToBody(const T &value) {
+    body_.append(reinterpret_cast<const char *>(&value), sizeof(T));
+  }
+
+  static constexpr size_t PAGE_WRITE_HEADER_SIZE = 12;
+  static constexpr uint32_t PAGE_LSN_SLOT = 1;
+  static constexpr uint32_t PAGE_NEW = 2;
+  static constexpr uint32_t PAGE_FREED = 4;
+  static constexpr size_t RUN_HEADER_SIZE = 4;
+
+  lsn_t lsn_{INVALID_LSN};
+  txn_id_t txn_id_{INVALID_TXN_ID};
+  lsn_t prev_lsn_{INVALID_LSN};
+  LogRecordType type_{LogRecordType::kInvalid};
+  std::string pages_;                     // page writes one after another
+  std::vector<uint32_t> page_offsets_;    // where every page write starts in pages_
+  std::string body_;
+};
+
+#endif  // MINISQL_LOG_RECORD_H
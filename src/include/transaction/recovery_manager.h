@@ -0,0 +1,69 @@
+#ifndef MINISQL_RECOVERY_MANAGER_H
+#define MINISQL_RECOVERY_MANAGER_H
+
+#include <map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/disk_manager.h"
+#include "transaction/log_manager.h"
+
+class CatalogManager;
+
+/**
+ * RecoveryManager brings the database back to a consistent state when it is opened after a crash,
+ * in the way of ARIES.
+ *
+ * Redo reads the log from the last checkpoint on, or from further back if a page dirty or a
+ * transaction running at the checkpoint needs it, and repeats every page write the disk may miss.
+ * Records before the checkpoint are redone only for the pages of its dirty-page table, and a page
+ * whose LSN shows that it already has a record is skipped. The same pass finds the transactions
+ * which neither committed nor aborted (losers).
+ *
+ * Undo then rolls back the losers logically, newest record first, through the heap pages and the
+ * indexes. Every undone record is followed by a compensation record, so a crash during the undo
+ * never undoes a record twice. Restart time is bounded by the checkpoint interval, not by the size
+ * of the database.
+ */
+class RecoveryManager {
+public:
+  RecoveryManager(DiskManager *disk_manager, LogManager *log_manager, BufferPoolManager *buffer_pool_manager)
+          : disk_manager_(disk_manager), log_manager_(log_manager), buffer_pool_manager_(buffer_pool_manager) {}
+
+  /**
+   * Repeat history up to the end of the log, before the catalog is loaded
+   */
+  void Redo();
+
+  /**
+   * Roll back the losers found by Redo and log their abort, once the catalog is loaded
+   */
+  void Undo(CatalogManager *catalog);
+
+  /**
+   * @return id for the next transaction, above every id in the log read
+   */
+  txn_id_t GetNextTxnId() const { return next_txn_id_; }
+
+  /**
+   * Undo the change of one logged record. Undo is tolerant: a change which is not there any more is skipped.
+   */
+  static void UndoRecord(const LogRecord &record, BufferPoolManager *buffer_pool_manager, CatalogManager *catalog);
+
+private:
+  /**
+   * A transaction without a commit or abort record so far, with the records left to undo
+   */
+  struct LoserTxn {
+    lsn_t last_lsn_{INVALID_LSN};
+    std::vector<LogRecord> records_;
+  };
+
+  DiskManager *disk_manager_;
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  std::map<txn_id_t, LoserTxn> losers_;
+  txn_id_t next_txn_id_{0};
+};
+
+#endif  // MINISQL_RECOVERY_MANAGER_H
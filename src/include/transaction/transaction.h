@@ -1,13 +1,132 @@
 #ifndef MINISQL_TRANSACTION_H
 #define MINISQL_TRANSACTION_H
 
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rowid.h"
+#include "record/row.h"
+
+class Index;
+class TableHeap;
+
+/**
+ * Transaction states
+ */
+enum class TxnState { kGrowing, kCommitted, kAborted };
+
+/**
+ * Lock modes, see LockManager
+ */
+enum class LockMode { kIntentionShared, kIntentionExclusive, kShared, kSharedIntentionExclusive, kExclusive };
+
+/**
+ * Kinds of changes in a write set
+ */
+enum class WType { kInsert, kDelete, kUpdate, kBulkLoad };
+
+/**
+ * WriteRecord remembers a change of a transaction, to undo it if the transaction rolls back. It is a change to
+ * a table if table_heap_ is set, and to an index otherwise. Every write record is logged as one log record,
+ * whose compensation record points at undo_next_lsn_.
+ *
+ *  table kInsert  | rows inserted, undone by ApplyDelete
+ *  table kDelete  | row marked as deleted, undone by RollbackDelete, applied when the transaction commits
+ *  table kUpdate  | row updated and the tuple before, undone by updating it back
+ *  index kInsert  | key and row of the entry inserted, undone by removing it
+ *  index kDelete  | key and row of the entry removed, undone by inserting it again
+ *  index kBulkLoad| entries loaded into the empty index, undone by clearing it
+ */
+struct WriteRecord {
+  WriteRecord(TableHeap *table_heap, WType wtype, std::vector<RowId> rids, lsn_t undo_next_lsn,
+              const Row &old_row = Row(INVALID_ROWID))
+          : wtype_(wtype), table_heap_(table_heap), rids_(std::move(rids)), row_(old_row),
+            undo_next_lsn_(undo_next_lsn) {}
+
+  WriteRecord(Index *index, WType wtype, const RowId &rid, const Row &key, lsn_t undo_next_lsn)
+          : wtype_(wtype), index_(index), rids_{rid}, row_(key), undo_next_lsn_(undo_next_lsn) {}
+
+  WType wtype_;
+  TableHeap *table_heap_{nullptr};
+  Index *index_{nullptr};
+  std::vector<RowId> rids_;
+  Row row_;                               // tuple before an update, or key of an index entry
+  lsn_t undo_next_lsn_;
+};
+
 /**
  * Transaction tracks information related to a transaction.
  *
- * Implemented by student self
-*/
+ * Every record a transaction logs points back at the one before, so that the recovery finds all of
+ * them from the last one. A transaction with an invalid id logs nothing that is ever undone.
+ *
+ * Until it commits, the changes of a transaction are kept in its write set, in the order of their
+ * log records, and the tuples it deletes stay marked. The locks it holds are released when it ends.
+ *
+ * A transaction reads the rows committed before it began, see VersionStore.
+ */
 class Transaction {
+public:
+  explicit Transaction(txn_id_t txn_id = INVALID_TXN_ID) : txn_id_(txn_id) {}
+
+  txn_id_t GetTxnId() const { return txn_id_; }
+
+  TxnState GetState() const { return state_; }
+
+  void SetState(TxnState state) { state_ = state; }
+
+  /**
+   * @return true if the changes of the transaction are remembered to roll it back, a transaction chosen
+   * to abort goes on remembering them until it is rolled back
+   */
+  bool IsUndoable() const { return txn_id_ != INVALID_TXN_ID && state_ != TxnState::kCommitted; }
+
+  std::deque<WriteRecord> &GetWriteSet() { return write_set_; }
+
+  /**
+   * @return mode of every table lock held, by table id
+   */
+  std::unordered_map<table_id_t, LockMode> &GetTableLocks() { return table_locks_; }
+
+  /**
+   * @return mode of every row lock held, by RowId::Get()
+   */
+  std::unordered_map<int64_t, LockMode> &GetRowLocks() { return row_locks_; }
+
+  /**
+   * @return timestamp of the snapshot the transaction reads, the last commit before it began
+   */
+  timestamp_t GetReadTs() const { return read_ts_; }
+
+  void SetReadTs(timestamp_t read_ts) { read_ts_ = read_ts; }
+
+  /**
+   * @return LSN of the last record of the transaction
+   */
+  lsn_t GetPrevLSN() const { return prev_lsn_; }
+
+  void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
+
+  /**
+   * @return log offset of the begin record, the recovery reads the log from there to undo the transaction
+   */
+  uint64_t GetFirstOffset() const { return first_offset_; }
+
+  void SetFirstOffset(uint64_t first_offset) { first_offset_ = first_offset; }
 
+private:
+  txn_id_t txn_id_;
+  TxnState state_{TxnState::kGrowing};
+  std::deque<WriteRecord> write_set_;
+  std::unordered_map<table_id_t, LockMode> table_locks_;
+  std::unordered_map<int64_t, LockMode> row_locks_;
+  timestamp_t read_ts_{0};
+  lsn_t prev_lsn_{INVALID_LSN};
+  uint64_t first_offset_{0};
 };
 
 #endif  // MINISQL_TRANSACTION_H
@@ -0,0 +1,96 @@
+#ifndef MINISQL_TXN_MANAGER_H
+#define MINISQL_TXN_MANAGER_H
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "transaction/lock_manager.h"
+#include "transaction/log_manager.h"
+#include "transaction/transaction.h"
+#include "transaction/version_store.h"
+
+/**
+ * TxnManager starts, commits and rolls back transactions and knows which ones are running, for checkpoints.
+ *
+ * A commit first deletes the tuples the transaction marked, then waits until its commit record is on disk.
+ * Commits arriving while the log is being synced share the next sync (group commit), so a commit costs far
+ * less than an fsync of its own.
+ *
+ * A rollback undoes the write set in reverse order. Every change undone is logged as a compensation record,
+ * so the recovery never undoes it again.
+ *
+ * Locks are held until the transaction ends (strict two-phase locking). A commit releases them once its
+ * record is appended, before waiting for the sync: a transaction reading the changes commits after it.
+ *
+ * A transaction reads the snapshot of the last commit before it began. A commit is given the next
+ * timestamp, and then drops the versions older than the oldest snapshot still running.
+ */
+class TxnManager {
+public:
+  /**
+   * @param lock_manager locks of the transactions, released when they end, nullptr if nothing is locked
+   * @param version_store versions of the rows the transactions change, nullptr if rows are read as they are
+   * @param next_txn_id id of the first transaction started, above every id in the log
+   */
+  explicit TxnManager(BufferPoolManager *buffer_pool_manager, LogManager *log_manager,
+                      LockManager *lock_manager = nullptr, VersionStore *version_store = nullptr,
+                      txn_id_t next_txn_id = 0)
+          : buffer_pool_manager_(buffer_pool_manager), log_manager_(log_manager), lock_manager_(lock_manager),
+            version_store_(version_store), next_txn_id_(next_txn_id) {}
+
+  ~TxnManager();
+
+  DISALLOW_COPY(TxnManager)
+
+  /**
+   * Start a transaction, it is owned by the manager until it commits
+   */
+  Transaction *Begin();
+
+  /**
+   * Commit {txn} once its changes are all logged, and free it
+   */
+  void Commit(Transaction *txn);
+
+  /**
+   * Roll back every change of {txn}, and free it
+   */
+  void Abort(Transaction *txn);
+
+  /**
+   * Collect the running transactions, for a checkpoint
+   */
+  void GetActiveTxns(std::vector<ActiveTxn> &active_txns);
+
+  /**
+   * @return id of the next transaction started, kept in checkpoints so ids are never reused
+   */
+  txn_id_t GetNextTxnId();
+
+  void SetNextTxnId(txn_id_t next_txn_id);
+
+  /**
+   * @return snapshot of the oldest transaction running, the last commit if none is
+   */
+  timestamp_t GetOldestReadTs();
+
+private:
+  /**
+   * Log the end of {txn} and forget it
+   * @return LSN of the end record
+   */
+  lsn_t End(Transaction *txn, LogRecordType type);
+
+  BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
+  LockManager *lock_manager_;
+  VersionStore *version_store_;
+  std::mutex latch_;                                      // protects everything below
+  txn_id_t next_txn_id_;
+  timestamp_t last_commit_ts_{0};
+  std::unordered_map<txn_id_t, Transaction *> txns_;      // running transactions
+};
+
+#endif  // MINISQL_TXN_MANAGER_H
@@ -0,0 +1,104 @@
+#ifndef MINISQL_VERSION_STORE_H
+#define MINISQL_VERSION_STORE_H
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "transaction/transaction.h"
+
+/**
+ * VersionStore keeps the tuples transactions overwrite, so that a transaction reads the rows of a table
+ * as they were committed when it began (snapshot isolation), without locking them.
+ *
+ * Every tuple changed is given a chain of undo versions, newest last: a version holds the tuple as it
+ * was before the change of its writer, or nothing if it was inserted, and the commit timestamp of the
+ * writer once it commits. A reader whose snapshot is older than a change walks the chain back to the
+ * version it may see. The page holds the newest version, and only the chains live in memory: after a
+ * restart no snapshot is left to need them.
+ *
+ * A version is garbage once every running snapshot sees the change after it, TxnManager collects them
+ * when a transaction commits.
+ */
+class VersionStore {
+public:
+  VersionStore() = default;
+
+  DISALLOW_COPY(VersionStore)
+
+  /**
+   * Remember the tuple at {rid} before {txn} changes it, the page is latched meanwhile so that no reader
+   * sees the change without the version
+   * @param before tuple before the change, nullptr if there is none (the change is an insert)
+   */
+  void Record(Transaction *txn, const RowId &rid, const std::string *before);
+
+  /**
+   * Find the version of the tuple at {rid} which {txn} sees, the page is latched meanwhile
+   * @param[out] exists whether the tuple existed in that version
+   * @param[out] data the tuple of that version if it existed
+   * @return false if {txn} sees the tuple on the page, exists and data are left alone then
+   */
+  bool Read(Transaction *txn, const RowId &rid, bool &exists, std::string &data);
+
+  /**
+   * @return true if the tuple at {rid} has been changed by a transaction committed after {txn} began,
+   * {txn} must not write it then (first committer wins)
+   */
+  bool Conflicts(Transaction *txn, const RowId &rid);
+
+  /**
+   * Make the changes of {txn_id} visible to the snapshots taken at {commit_ts} and after
+   */
+  void Commit(txn_id_t txn_id, timestamp_t commit_ts);
+
+  /**
+   * Drop the versions of {txn_id}, its changes have been rolled back
+   */
+  void Abort(txn_id_t txn_id);
+
+  /**
+   * Drop the versions no snapshot taken at {oldest_read_ts} or after can see
+   * @return number of versions dropped
+   */
+  size_t CollectGarbage(timestamp_t oldest_read_ts);
+
+  /**
+   * @return number of versions kept
+   */
+  size_t GetVersionCount();
+
+private:
+  struct Version {
+    txn_id_t writer_;
+    timestamp_t commit_ts_;                 // INVALID_TS until the writer commits
+    bool existed_;                          // whether there was a tuple before the change
+    std::string before_;
+  };
+
+  /**
+   * Rows a transaction changed, from its commit on
+   */
+  struct CommittedTxn {
+    timestamp_t commit_ts_;
+    std::vector<int64_t> rids_;
+  };
+
+  /**
+   * @return the version {txn_id} put into {chain}
+   */
+  static std::vector<Version>::iterator Find(std::vector<Version> &chain, txn_id_t txn_id);
+
+  std::mutex latch_;                                                  // protects everything below
+  std::unordered_map<int64_t, std::vector<Version>> versions_;        // by RowId::Get(), oldest first
+  std::unordered_map<txn_id_t, std::vector<int64_t>> running_;        // rows of every transaction running
+  std::deque<CommittedTxn> committed_;                                // in commit order, until collected
+  size_t version_count_{0};
+};
+
+#endif  // MINISQL_VERSION_STORE_H
@@ -0,0 +1,165 @@
+#ifndef MINISQL_EXTERNAL_SORTER_H
+#define MINISQL_EXTERNAL_SORTER_H
+
+#include <algorithm>
+#include <cstdio>
+#include <queue>
+#include <vector>
+
+/**
+ * Sort items which may not fit in memory.
+ *
+ * Items are collected in memory until {memory_limit} bytes are used, then that batch is sorted
+ * and written to a temporary file as a run. Once all items are added, the runs are merged while
+ * they are read back. Items are written to the runs byte by byte, so T must be a plain value
+ * without pointers. {Less} compares two items like std::less.
+ */
+template<typename T, typename Less>
+class ExternalSorter {
+public:
+  ExternalSorter(Less less, size_t memory_limit)
+          : less_(less), batch_capacity_(std::max<size_t>(memory_limit / sizeof(T), 1)) {}
+
+  ~ExternalSorter() {
+    for (auto &run : runs_) {
+      fclose(run.file_);
+    }
+  }
+
+  ExternalSorter(const ExternalSorter &) = delete;
+
+  ExternalSorter &operator=(const ExternalSorter &) = delete;
+
+  /**
+   * @return false if a full batch can not be written to a run
+   */
+  bool Add(const T &item) {
+    if (batch_.size() >= batch_capacity_ && !SpillRun()) {
+      return false;
+    }
+    batch_.push_back(item);
+    count_++;
+    return true;
+  }
+
+  /**
+   * Sort everything added so far, the items are then read in order with Next
+   * @return false if the last batch can not be written to a run
+   */
+  bool Sort() {
+    if (runs_.empty()) {
+      std::sort(batch_.begin(), batch_.end(), less_);
+      return true;
+    }
+    if (!batch_.empty() && !SpillRun()) {
+      return false;
+    }
+    std::vector<T>().swap(batch_);
+    // every run reads back through a buffer of its share of the memory
+    size_t buffer_items = std::max<size_t>(batch_capacity_ / runs_.size(), 1);
+    for (size_t i = 0; i < runs_.size(); i++) {
+      rewind(runs_[i].file_);
+      runs_[i].buffer_.reserve(buffer_items);
+      if (Fill(runs_[i], buffer_items)) {
+        heads_.push(i);
+      }
+    }
+    return true;
+  }
+
+  /**
+   * @return false when all items have been read
+   */
+  bool Next(T &item) {
+    if (runs_.empty()) {
+      if (pos_ >= batch_.size()) {
+        return false;
+      }
+      item = batch_[pos_++];
+      return true;
+    }
+    if (heads_.empty()) {
+      return false;
+    }
+    size_t index = heads_.top();
+    heads_.pop();
+    Run &run = runs_[index];
+    item = run.buffer_[run.pos_++];
+    if (run.pos_ < run.buffer_.size() || Fill(run, run.buffer_.capacity())) {
+      heads_.push(index);
+    }
+    return true;
+  }
+
+  /**
+   * @return number of items added
+   */
+  size_t GetCount() const { return count_; }
+
+  /**
+   * @return number of runs written to disk, 0 if everything was sorted in memory
+   */
+  size_t GetRunCount() const { return runs_.size(); }
+
+private:
+  struct Run {
+    FILE *file_;
+    size_t remaining_;           // items of the run not read into the buffer yet
+    std::vector<T> buffer_;
+    size_t pos_{0};
+  };
+
+  /**
+   * Order the heap of runs by their current head, the smallest on top
+   */
+  struct HeadGreater {
+    const ExternalSorter *sorter_;
+
+    bool operator()(size_t a, size_t b) const {
+      const Run &left = sorter_->runs_[a];
+      const Run &right = sorter_->runs_[b];
+      return sorter_->less_(right.buffer_[right.pos_], left.buffer_[left.pos_]);
+    }
+  };
+
+  bool SpillRun() {
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+      return false;
+    }
+    std::sort(batch_.begin(), batch_.end(), less_);
+    if (fwrite(batch_.data(), sizeof(T), batch_.size(), file) != batch_.size()) {
+      fclose(file);
+      return false;
+    }
+    runs_.push_back(Run{file, batch_.size(), {}, 0});
+    batch_.clear();
+    return true;
+  }
+
+  /**
+   * Read the next part of a run into its buffer
+   * @return false if the run is used up
+   */
+  bool Fill(Run &run, size_t buffer_items) {
+    size_t items = std::min(run.remaining_, buffer_items);
+    run.buffer_.resize(items);
+    run.pos_ = 0;
+    if (items == 0 || fread(run.buffer_.data(), sizeof(T), items, run.file_) != items) {
+      run.remaining_ = 0;
+      return false;
+    }
+    run.remaining_ -= items;
+    return true;
+  }
+
+  Less less_;
+  size_t batch_capacity_;
+  std::vector<T> batch_;
+  size_t count_{0};
+  size_t pos_{0};
+  std::vector<Run> runs_;
+  std::priority_queue<size_t, std::vector<size_t>, HeadGreater> heads_{HeadGreater{this}};
+};
+
+#endif  // MINISQL_EXTERNAL_SORTER_H
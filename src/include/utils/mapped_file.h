@@ -0,0 +1,70 @@
+#ifndef MINISQL_MAPPED_FILE_H
+#define MINISQL_MAPPED_FILE_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+
+/**
+ * A whole file mapped read-only into memory, unmapped on destruction
+ */
+class MappedFile {
+public:
+  MappedFile() = default;
+
+  ~MappedFile() { Close(); }
+
+  MappedFile(const MappedFile &) = delete;
+
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /**
+   * @return false if the file can not be opened or mapped
+   */
+  bool Open(const std::string &path) {
+    Close();
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      return false;
+    }
+    // an empty file can not be mapped, it simply has no content
+    if (st.st_size > 0) {
+      void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        close(fd);
+        return false;
+      }
+      madvise(addr, st.st_size, MADV_SEQUENTIAL);
+      data_ = static_cast<const char *>(addr);
+      size_ = static_cast<size_t>(st.st_size);
+    }
+    close(fd);
+    return true;
+  }
+
+  void Close() {
+    if (data_ != nullptr) {
+      munmap(const_cast<char *>(data_), size_);
+      data_ = nullptr;
+      size_ = 0;
+    }
+  }
+
+  const char *GetData() const { return data_; }
+
+  size_t GetSize() const { return size_; }
+
+private:
+  const char *data_{nullptr};
+  size_t size_{0};
+};
+
+#endif  // MINISQL_MAPPED_FILE_H
@@ -47,6 +47,7 @@ public:
     auto iter = allocated_.find(ptr);
     if (iter != allocated_.end()) {
       allocated_.erase(iter);
+      free(ptr);
     }
   }
 
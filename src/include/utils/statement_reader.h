@@ -0,0 +1,57 @@
+#ifndef MINISQL_STATEMENT_READER_H
+#define MINISQL_STATEMENT_READER_H
+
+#include <cstdio>
+#include <string>
+
+#include "utils/mapped_file.h"
+
+/**
+ * Splits sql input into statements, each ending with a ';' outside of a
+ * string literal. Input comes from a string, a file mapped into memory as a
+ * whole, or a stream read on demand (stdin), so a statement is not limited
+ * by the size of any fixed buffer.
+ */
+class StatementReader {
+public:
+  StatementReader() = default;
+
+  explicit StatementReader(std::string text);
+
+  /**
+   * Read statements from {in} as they are typed or piped
+   */
+  explicit StatementReader(FILE *in);
+
+  StatementReader(const StatementReader &) = delete;
+
+  StatementReader &operator=(const StatementReader &) = delete;
+
+  /**
+   * Map the script at {path} into memory
+   * @return false if the file can not be opened
+   */
+  bool Open(const std::string &path);
+
+  /**
+   * @param[out] statement the next statement including its ';', leading blanks skipped.
+   *                       Trailing text without a ';' at the end of input is returned as is.
+   * @return false once the input is exhausted
+   */
+  bool Next(std::string &statement);
+
+private:
+  /**
+   * Length of the statement starting at {pos}, up to and including its ';'
+   */
+  size_t ScanStatement(size_t pos) const;
+
+  FILE *in_{nullptr};            // stream input, nullptr for in-memory input
+  std::string text_;             // owned in-memory input
+  const char *data_{nullptr};    // in-memory input, either text_ or the mapped file
+  size_t size_{0};
+  size_t pos_{0};
+  MappedFile file_;
+};
+
+#endif  // MINISQL_STATEMENT_READER_H
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 #include "glog/logging.h"
 #include "index/b_plus_tree.h"
@@ -26,10 +27,24 @@ BPLUSTREE_TYPE::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_ma
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Destroy() {
-  // while(!IsEmpty()) {
-  //   Remove((*Begin()).first);
-  // }
-  // sleep(1);
+  // give every page back to the disk, the children of an internal page are read before it goes
+  std::queue<page_id_t> pages;
+  if (root_page_id_ != INVALID_PAGE_ID) pages.push(root_page_id_);
+  while (!pages.empty()) {
+    page_id_t page_id = pages.front();
+    pages.pop();
+    auto *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) continue;
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (!node->IsLeafPage()) {
+      auto *internal = reinterpret_cast<InternalPage *>(node);
+      for (int i = 0; i < internal->GetSize(); i++) {
+        pages.push(internal->ValueAt(i));
+      }
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+  }
   root_page_id_ = INVALID_PAGE_ID;
   auto *roots_page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
   IndexRootsPage *roots_node = reinterpret_cast<IndexRootsPage *>(roots_page->GetData());
@@ -37,6 +52,12 @@ void BPLUSTREE_TYPE::Destroy() {
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Clear() {
+  root_page_id_ = INVALID_PAGE_ID;
+  UpdateRootPageId(0);
+}
+
 /*
  * Helper function to decide whether current b+tree is empty
  */
@@ -286,6 +307,90 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
                                       Transaction *transaction) {
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(size_t count, const std::function<bool(std::pair<KeyType, ValueType> &)> &next,
+                              double fill_factor) {
+  if (!IsEmpty()) return false;
+  if (count == 0) return true;
+  // below half full the pages would be merged again by the first remove
+  fill_factor = std::min(1.0, std::max(0.5, fill_factor));
+  // plan the levels from the leaves up, the root level has one page
+  std::vector<BulkLevel> levels;
+  size_t entries = count;
+  size_t capacity = std::max(1, static_cast<int>(leaf_max_size_ * fill_factor));
+  while (true) {
+    size_t pages = (entries + capacity - 1) / capacity;
+    levels.push_back(BulkLevel{entries, pages});
+    if (pages == 1) break;
+    entries = pages;
+    capacity = std::max(2, static_cast<int>(internal_max_size_ * fill_factor));
+  }
+  std::vector<page_id_t> allocated;
+  std::pair<KeyType, ValueType> entry;
+  KeyType last_key;
+  bool ok = true;
+  for (size_t i = 0; i < count && ok; i++) {
+    ok = next(entry) && (i == 0 || comparator_(last_key, entry.first) < 0) &&
+         BulkAppend(levels, 0, entry.first, entry.second, INVALID_PAGE_ID, allocated);
+    last_key = entry.first;
+  }
+  page_id_t root_page_id = levels.back().page_ == nullptr ? INVALID_PAGE_ID : levels.back().page_->GetPageId();
+  for (auto &level : levels) {
+    if (level.page_ != nullptr) buffer_pool_manager_->UnpinPage(level.page_->GetPageId(), true);
+  }
+  if (!ok) {
+    for (auto page_id : allocated) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    return false;
+  }
+  root_page_id_ = root_page_id;
+  UpdateRootPageId(0);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkAppend(std::vector<BulkLevel> &levels, size_t level, const KeyType &key,
+                                const ValueType &value, page_id_t child, std::vector<page_id_t> &allocated) {
+  BulkLevel &cur = levels[level];
+  auto *node = cur.page_ == nullptr ? nullptr : reinterpret_cast<BPlusTreePage *>(cur.page_->GetData());
+  if (node == nullptr || node->GetSize() == cur.PageSize()) {
+    page_id_t new_page_id = INVALID_PAGE_ID;
+    auto *new_page = buffer_pool_manager_->NewPage(new_page_id);
+    if (new_page == nullptr) {
+      LOG(WARNING) << "Bulk load of index " << index_id_ << " ran out of buffer pool frames";
+      return false;
+    }
+    allocated.push_back(new_page_id);
+    if (level == 0) {
+      reinterpret_cast<LeafPage *>(new_page->GetData())->Init(new_page_id, INVALID_PAGE_ID, leaf_max_size_);
+    } else {
+      reinterpret_cast<InternalPage *>(new_page->GetData())->Init(new_page_id, INVALID_PAGE_ID, internal_max_size_);
+    }
+    if (node != nullptr) {
+      if (level == 0) reinterpret_cast<LeafPage *>(node)->SetNextPageId(new_page_id);
+      buffer_pool_manager_->UnpinPage(node->GetPageId(), true);
+      cur.page_index_++;
+    }
+    cur.page_ = new_page;
+    // the first key of the new page separates it from its left neighbour in the parent
+    if (level + 1 < levels.size() && !BulkAppend(levels, level + 1, key, value, new_page_id, allocated)) {
+      return false;
+    }
+  }
+  if (level == 0) {
+    reinterpret_cast<LeafPage *>(cur.page_->GetData())->CopyLastFrom(std::make_pair(key, value));
+  } else {
+    // adopting the child sets its parent page id
+    reinterpret_cast<InternalPage *>(cur.page_->GetData())->CopyLastFrom(std::make_pair(key, child),
+                                                                          buffer_pool_manager_);
+  }
+  return true;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -370,6 +475,7 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
     if (mindex == 0) {
       CoalesceOrRedistribute(parent_node, transaction);
     }
+    buffer_pool_manager_->UnpinPage(parent_id, true);
     return false;
   }
   // try to redistribute
@@ -433,9 +539,10 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
     if (Coalesce(&sibling_node, &node, &parent_node, 0, transaction) || mindex == 0) {
       flag = CoalesceOrRedistribute(parent_node, transaction);
     }
-    buffer_pool_manager_->UnpinPage(sibling_node->GetPageId(), true);
+    page_id_t merged_id = sibling_node->GetPageId();
+    buffer_pool_manager_->UnpinPage(merged_id, true);
     buffer_pool_manager_->UnpinPage(parent_id, true);
-    buffer_pool_manager_->DeletePage(sibling_node->GetPageId());
+    buffer_pool_manager_->DeletePage(merged_id);
       // buffer_pool_manager_->UnpinPage(cur_id, true);
     if (flag) buffer_pool_manager_->DeletePage(parent_id);
     return false;
@@ -626,13 +733,24 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
     BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
     if (node->IsLeafPage()) {
       LeafPage *inode = reinterpret_cast<LeafPage *>(page->GetData());
-      INDEXITERATOR_TYPE it(root, inode->KeyIndex(key, comparator_), comparator_, buffer_pool_manager_);
+      // read everything needed while the leaf is pinned, the frame may hold another page after the unpin
+      int index = inode->KeyIndex(key, comparator_);
+      int size = inode->GetSize();
+      page_id_t next_page_id = inode->GetNextPageId();
       buffer_pool_manager_->UnpinPage(root, false);
-      return it;
+      if (index < size) {
+        return INDEXITERATOR_TYPE(root, index, comparator_, buffer_pool_manager_);
+      }
+      // every key of this leaf is smaller, the first greater one starts the next leaf
+      if (next_page_id == INVALID_PAGE_ID) {
+        return End();
+      }
+      return INDEXITERATOR_TYPE(next_page_id, 0, comparator_, buffer_pool_manager_);
     } else {
       InternalPage *inode = reinterpret_cast<InternalPage *>(page->GetData());
+      page_id_t page_id = root;
       root = inode->Lookup(key, comparator_);
-      buffer_pool_manager_->UnpinPage(inode->GetPageId(), false);
+      buffer_pool_manager_->UnpinPage(page_id, false);
     }
   }
 }
@@ -839,3 +957,9 @@ class BPlusTree<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
 class BPlusTree<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class BPlusTree<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class BPlusTree<GenericKey<256>, RowId, GenericComparator<256>>;
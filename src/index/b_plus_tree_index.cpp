@@ -1,10 +1,15 @@
+#include <queue>
+#include <thread>
+
 #include "index/b_plus_tree_index.h"
 #include "index/generic_key.h"
+#include "utils/external_sorter.h"
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema,
                                      BufferPoolManager *buffer_pool_manager)
         : Index(index_id, key_schema),
+          buffer_pool_manager_(buffer_pool_manager),
           comparator_(key_schema_),
           container_(index_id, buffer_pool_manager, comparator_) {
 
@@ -16,7 +21,10 @@ dberr_t BPLUSTREE_INDEX_TYPE::InsertEntry(const Row &key, RowId row_id, Transact
   KeyType index_key;
   index_key.SerializeFromKey(key, key_schema_);
 
+  // a split touches several pages, they are logged as one record
+  buffer_pool_manager_->BeginAtomic();
   bool status = container_.Insert(index_key, row_id, txn);
+  EndAtomic(status ? LogRecordType::kInsertKey : LogRecordType::kInvalid, key, row_id, txn);
 
   if (!status) {
     return DB_FAILED;
@@ -29,10 +37,35 @@ dberr_t BPLUSTREE_INDEX_TYPE::RemoveEntry(const Row &key, RowId row_id, Transact
   KeyType index_key;
   index_key.SerializeFromKey(key, key_schema_);
 
+  // the entry removed is looked up first, it is logged to undo the remove
+  std::vector<RowId> removed;
+  if (txn != nullptr) {
+    container_.GetValue(index_key, removed, txn);
+  }
+  buffer_pool_manager_->BeginAtomic();
   container_.Remove(index_key, txn);
+  EndAtomic(removed.empty() ? LogRecordType::kInvalid : LogRecordType::kRemoveKey, key,
+            removed.empty() ? row_id : removed[0], txn);
   return DB_SUCCESS;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::EndAtomic(LogRecordType type, const Row &key, RowId row_id, Transaction *txn) {
+  if (txn == nullptr || type == LogRecordType::kInvalid) {
+    buffer_pool_manager_->EndAtomic();
+    return;
+  }
+  std::string data(key.GetSerializedSize(key_schema_), '\0');
+  key.SerializeTo(&data[0], key_schema_);
+  LogRecord record = LogRecord::KeyWrite(type, index_id_, row_id, data);
+  lsn_t undo_next_lsn = txn->GetPrevLSN();
+  buffer_pool_manager_->EndAtomic(txn, &record);
+  if (txn->IsUndoable()) {
+    txn->GetWriteSet().emplace_back(this, type == LogRecordType::kInsertKey ? WType::kInsert : WType::kDelete, row_id,
+                                    key, undo_next_lsn);
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn) {
   KeyType index_key;
@@ -43,12 +76,138 @@ dberr_t BPLUSTREE_INDEX_TYPE::ScanKey(const Row &key, vector<RowId> &result, Tra
   return DB_KEY_NOT_FOUND;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::ScanRange(const Row *low_key, bool low_inclusive, const Row *high_key,
+                                        bool high_inclusive, vector<RowId> &result, Transaction *txn) {
+  if (container_.IsEmpty()) {
+    return DB_SUCCESS;
+  }
+  KeyType low, high;
+  if (low_key != nullptr) {
+    low.SerializeFromKey(*low_key, key_schema_);
+  }
+  if (high_key != nullptr) {
+    high.SerializeFromKey(*high_key, key_schema_);
+  }
+  // seek to the lower bound, then walk the leaves until the upper bound is passed
+  auto end = container_.End();
+  for (auto iter = low_key != nullptr ? container_.Begin(low) : container_.Begin(); iter != end; ++iter) {
+    const KeyType &key = (*iter).first;
+    if (low_key != nullptr && !low_inclusive && comparator_(key, low) == 0) {
+      continue;
+    }
+    if (high_key != nullptr) {
+      int cmp = comparator_(key, high);
+      if (cmp > 0 || (cmp == 0 && !high_inclusive)) {
+        break;
+      }
+    }
+    result.push_back((*iter).second);
+  }
+  return DB_SUCCESS;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::Destroy() {
   container_.Destroy();
   return DB_SUCCESS;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::Clear() {
+  buffer_pool_manager_->BeginAtomic();
+  container_.Clear();
+  buffer_pool_manager_->EndAtomic();
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::BulkLoad(size_t partition_count,
+                                       const std::function<bool(size_t partition, const EntrySink &sink)> &scan,
+                                       Transaction *txn) {
+  if (!container_.IsEmpty()) {
+    return DB_FAILED;
+  }
+  if (txn != nullptr) {
+    // too many pages for one record, undo just empties the index again
+    LogRecord record = LogRecord::BulkLoad(index_id_);
+    lsn_t undo_next_lsn = txn->GetPrevLSN();
+    buffer_pool_manager_->BeginAtomic();
+    buffer_pool_manager_->EndAtomic(txn, &record);
+    if (txn->IsUndoable()) {
+      txn->GetWriteSet().emplace_back(this, WType::kBulkLoad, INVALID_ROWID, Row(INVALID_ROWID), undo_next_lsn);
+    }
+  }
+  partition_count = std::max<size_t>(partition_count, 1);
+  using Entry = std::pair<KeyType, ValueType>;
+  KeyComparator comparator = comparator_;
+  auto less = [comparator](const Entry &a, const Entry &b) { return comparator(a.first, b.first) < 0; };
+  using Sorter = ExternalSorter<Entry, decltype(less)>;
+  // every partition is extracted and sorted on its own worker, into its own share of the memory
+  std::vector<std::unique_ptr<Sorter>> sorters;
+  for (size_t i = 0; i < partition_count; i++) {
+    sorters.push_back(std::make_unique<Sorter>(less, INDEX_SORT_MEMORY / partition_count));
+  }
+  std::vector<char> sorted(partition_count, false);
+  auto work = [&](size_t partition) {
+    Sorter &sorter = *sorters[partition];
+    Entry entry;
+    bool added = true;
+    bool scanned = scan(partition, [&](const Row &key, RowId row_id) {
+      if (!added) return;
+      entry.first.SerializeFromKey(key, key_schema_);
+      entry.second = row_id;
+      added = sorter.Add(entry);
+    });
+    sorted[partition] = scanned && added && sorter.Sort();
+  };
+  if (partition_count == 1) {
+    work(0);
+  } else {
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < partition_count; i++) {
+      workers.emplace_back(work, i);
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+  size_t count = 0;
+  for (size_t i = 0; i < partition_count; i++) {
+    if (!sorted[i]) {
+      return DB_FAILED;
+    }
+    count += sorters[i]->GetCount();
+  }
+  // merge the sorted partitions while the tree is packed
+  std::vector<Entry> heads(partition_count);
+  auto head_greater = [&heads, &less](size_t a, size_t b) { return less(heads[b], heads[a]); };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(head_greater)> merge(head_greater);
+  for (size_t i = 0; i < partition_count; i++) {
+    if (sorters[i]->Next(heads[i])) {
+      merge.push(i);
+    }
+  }
+  bool built = container_.BulkLoad(count, [&](Entry &item) {
+    if (merge.empty()) {
+      return false;
+    }
+    size_t partition = merge.top();
+    merge.pop();
+    item = heads[partition];
+    if (sorters[partition]->Next(heads[partition])) {
+      merge.push(partition);
+    }
+    return true;
+  });
+  return built ? DB_SUCCESS : DB_FAILED;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::IsEmpty() const {
+  return container_.IsEmpty();
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() {
   return container_.Begin();
@@ -78,4 +237,10 @@ template
 class BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
-class BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64>>;
\ No newline at end of file
+class BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class BPlusTreeIndex<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class BPlusTreeIndex<GenericKey<256>, RowId, GenericComparator<256>>;
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
 #include "index/index_iterator.h"
+#include "page/b_plus_tree_internal_page.h"
 
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(page_id_t page_id, unsigned int index, const KeyComparator &comparator,
                                                            BufferPoolManager *buffer_pool_manager)
@@ -38,11 +39,31 @@ INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
     if (page == nullptr) return *this;
     BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *node = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *>(page->GetData());
     value_ = node->GetItem(0);
+    PrefetchSiblings(node);
     buffer_pool_manager_->UnpinPage(next_id, false);
   }
   return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::PrefetchSiblings(const BPlusTreeLeafPage<KeyType, ValueType, KeyComparator> *leaf) {
+  uint32_t window = buffer_pool_manager_->GetPrefetchWindow();
+  if (window == 0 || leaf->GetParentPageId() == INVALID_PAGE_ID) return;
+  // leaves are only linked one way, but the parent lists the next ones in order
+  auto *page = buffer_pool_manager_->FetchPage(leaf->GetParentPageId());
+  if (page == nullptr) return;
+  auto *parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(page->GetData());
+  int index = parent->ValueIndex(leaf->GetPageId());
+  std::vector<page_id_t> page_ids;
+  for (int i = index + 1; index >= 0 && i < parent->GetSize() && page_ids.size() < window; i++) {
+    page_ids.push_back(parent->ValueAt(i));
+  }
+  buffer_pool_manager_->UnpinPage(leaf->GetParentPageId(), false);
+  if (!page_ids.empty()) {
+    buffer_pool_manager_->PrefetchPages(page_ids);
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const {
   return (page_id_ == itr.page_id_) && comparator_(value_.first, itr.value_.first) == 0 && (value_.second == itr.value_.second);
@@ -70,3 +91,9 @@ class IndexIterator<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
 class IndexIterator<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class IndexIterator<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class IndexIterator<GenericKey<256>, RowId, GenericComparator<256>>;
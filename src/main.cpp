@@ -1,7 +1,9 @@
 #include <cstdio>
+#include <unistd.h>
 #include "executor/execute_engine.h"
 #include "glog/logging.h"
 #include "parser/syntax_tree_printer.h"
+#include "utils/statement_reader.h"
 #include "utils/tree_file_mgr.h"
 
 extern "C" {
@@ -17,74 +19,130 @@ void InitGoogleLog(char *argv) {
   google::InitGoogleLogging(argv);
 }
 
-void InputCommand(char *input, const int len) {
-  memset(input, 0, len);
-  printf("minisql > ");
-  int i = 0;
-  char ch;
-  while ((ch = getchar()) != ';') {
-    input[i++] = ch;
+void PrintUsage(const char *name) {
+  fprintf(stderr,
+          "Usage: %s [--format table|csv|binary] [-f script.sql] [-e \"statement;\"]\n"
+          "  -f  execute the statements of a script file\n"
+          "  -e  execute the given statements\n"
+          "Without -f or -e statements are read from stdin, interactively when it is a terminal.\n",
+          name);
+}
+
+/**
+ * Parse and execute one statement
+ * @param interactive whether to dump the syntax tree and pace the shell as before
+ * @return whether the statement asked to quit
+ */
+bool RunStatement(ExecuteEngine &engine, const std::string &sql, ResultFormat format, bool interactive,
+                  TreeFileManagers &syntax_tree_file_mgr, uint32_t &syntax_tree_id) {
+  // create buffer for sql input
+  YY_BUFFER_STATE bp = yy_scan_bytes(sql.data(), sql.size());
+  if (bp == nullptr) {
+    LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
+    exit(1);
+  }
+  yy_switch_to_buffer(bp);
+
+  // init parser module
+  MinisqlParserInit();
+
+  // parse
+  yyparse();
+
+  // parse result handle
+  if (MinisqlParserGetError()) {
+    // error, kept off stdout when the results there are csv or binary
+    fprintf(format == ResultFormat::kTable ? stdout : stderr, "%s\n", MinisqlParserGetErrorMessage());
+  } else if (interactive) {
+// #ifdef ENABLE_PARSER_DEBUG
+    printf("[INFO] Sql syntax parse ok!\n");
+    SyntaxTreePrinter printer(MinisqlGetParserRootNode());
+    printer.PrintTree(syntax_tree_file_mgr[syntax_tree_id++]);
+// #endif
   }
-  input[i] = ch;    // ;
-  getchar();        // remove enter
+
+  ExecuteContext context;
+  context.disablePrint_ = false;
+  context.format_ = format;
+  engine.Execute(MinisqlGetParserRootNode(), &context);
+  if (interactive) {
+    sleep(1);
+  }
+
+  // clean memory after parse
+  MinisqlParserFinish();
+  yy_delete_buffer(bp);
+  yylex_destroy();
+
+  return context.flag_quit_;
 }
 
 int main(int argc, char **argv) {
   InitGoogleLog(argv[0]);
-  // command buffer
-  const int buf_size = 1024;
-  char cmd[buf_size];
+  // output format of select
+  ResultFormat format = ResultFormat::kTable;
+  std::string script_file;
+  std::string statements;
+  bool has_statements = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+      std::string name = argv[++i];
+      if (name == "table") {
+        format = ResultFormat::kTable;
+      } else if (name == "csv") {
+        format = ResultFormat::kCsv;
+      } else if (name == "binary") {
+        format = ResultFormat::kBinary;
+      } else {
+        fprintf(stderr, "Unknown format %s, expected table, csv or binary.\n", name.c_str());
+        return 1;
+      }
+    } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      script_file = argv[++i];
+    } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      statements = argv[++i];
+      has_statements = true;
+    } else {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+  // batch mode runs without prompts, syntax tree dumps or the pause after each statement
+  std::unique_ptr<StatementReader> reader;
+  bool interactive = false;
+  if (!script_file.empty()) {
+    reader = std::make_unique<StatementReader>();
+    if (!reader->Open(script_file)) {
+      fprintf(stderr, "Can not open %s.\n", script_file.c_str());
+      return 1;
+    }
+  } else if (has_statements) {
+    reader = std::make_unique<StatementReader>(statements);
+  } else {
+    reader = std::make_unique<StatementReader>(stdin);
+    interactive = isatty(fileno(stdin));
+  }
   // execute engine
   ExecuteEngine engine;
   // for print syntax tree
   TreeFileManagers syntax_tree_file_mgr("syntax_tree_");
   [[maybe_unused]] uint32_t syntax_tree_id = 0;
 
+  std::string sql;
   while (1) {
     // read from buffer
-    InputCommand(cmd, buf_size);
-    // create buffer for sql input
-    YY_BUFFER_STATE bp = yy_scan_string(cmd);
-    if (bp == nullptr) {
-      LOG(ERROR) << "Failed to create yy buffer state." << std::endl;
-      exit(1);
+    if (interactive) {
+      printf("minisql > ");
+      fflush(stdout);
     }
-    yy_switch_to_buffer(bp);
-
-    // init parser module
-    MinisqlParserInit();
-
-    // parse
-    yyparse();
-
-    // parse result handle
-    if (MinisqlParserGetError()) {
-      // error
-      printf("%s\n", MinisqlParserGetErrorMessage());
-    } else {
-// #ifdef ENABLE_PARSER_DEBUG
-      printf("[INFO] Sql syntax parse ok!\n");
-      SyntaxTreePrinter printer(MinisqlGetParserRootNode());
-      printer.PrintTree(syntax_tree_file_mgr[syntax_tree_id++]);
-// #endif
+    if (!reader->Next(sql)) {
+      break;
     }
-
-    ExecuteContext context;
-    context.disablePrint_ = false;
-    engine.Execute(MinisqlGetParserRootNode(), &context);
-    sleep(1);
-
-    // clean memory after parse
-    MinisqlParserFinish();
-    yy_delete_buffer(bp);
-    yylex_destroy();
-
     // quit condition
-    if (context.flag_quit_) {
-      printf("bye!\n");
+    if (RunStatement(engine, sql, format, interactive, syntax_tree_file_mgr, syntax_tree_id)) {
+      fprintf(format == ResultFormat::kTable ? stdout : stderr, "bye!\n");
       break;
     }
-
   }
   return 0;
-}
\ No newline at end of file
+}
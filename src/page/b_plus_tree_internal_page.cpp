@@ -1,5 +1,6 @@
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
+#include "index/key_search.h"
 #include "page/b_plus_tree_internal_page.h"
 
 /*****************************************************************************
@@ -76,14 +77,9 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  // replace with your own code
-  int size = GetSize();
-  for (int i = 1; i < size; ++ i) {
-    if (comparator(key, array_[i].first) < 0) {
-      return array_[i - 1].second;
-    }
-  }
-  return array_[size - 1].second;
+  // the first key is invalid, find the first valid key greater than {key} and step back
+  int index = KeySearch<KeyType, KeyComparator>::UpperBound(array_, 1, GetSize(), key, comparator);
+  return array_[index - 1].second;
 }
 
 /*****************************************************************************
@@ -331,4 +327,10 @@ template
 class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 
 template
-class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
\ No newline at end of file
+class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+
+template
+class BPlusTreeInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>>;
+
+template
+class BPlusTreeInternalPage<GenericKey<256>, page_id_t, GenericComparator<256>>;
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include <algorithm>
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
+#include "index/key_search.h"
 #include "page/b_plus_tree_leaf_page.h"
 
 /*****************************************************************************
@@ -41,13 +42,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
-  int size = GetSize();
-  for (int i = 0; i < size; ++ i) {
-    if (comparator(array_[i].first, key) >= 0) {
-      return i;
-    }
-  }
-  return size;
+  return KeySearch<KeyType, KeyComparator>::LowerBound(array_, 0, GetSize(), key, comparator);
 }
 
 /*
@@ -86,16 +81,11 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
   int size = GetSize();
-  for (int i = size - 1; i >= 0; -- i) {
-    if (comparator(array_[i].first, key) > 0) {
-      array_[i + 1] = array_[i];
-    } else {
-      array_[i + 1] = std::make_pair(key, value);
-      SetSize(size + 1);
-      return (size + 1);
-    }
+  int index = KeySearch<KeyType, KeyComparator>::UpperBound(array_, 0, size, key, comparator);
+  for (int i = size - 1; i >= index; -- i) {
+    array_[i + 1] = array_[i];
   }
-  array_[0] = std::make_pair(key, value);
+  array_[index] = std::make_pair(key, value);
   SetSize(size + 1);
   return (size + 1);
 }
@@ -134,12 +124,10 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value, const KeyComparator &comparator) const {
-  int size = GetSize();
-  for (int i = 0; i < size; ++ i) {
-    if (comparator(key, array_[i].first) == 0) {
-      value = array_[i].second;
-      return true;
-    }
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(key, array_[index].first) == 0) {
+    value = array_[index].second;
+    return true;
   }
   return false;
 }
@@ -155,19 +143,16 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value, co
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
-  int flag = 0;
   int size = GetSize();
-  for (int i = 0; i < size; ++ i) {
-    if (comparator(key, array_[i].first) == 0) {
-      flag = 1;
-    } else if(flag) {
-      array_[i - 1] = array_[i];
-    }
+  int index = KeyIndex(key, comparator);
+  if (index >= size || comparator(key, array_[index].first) != 0) {
+    return size;
   }
-  if (flag) {
-    -- size;
-    SetSize(size);
+  for (int i = index + 1; i < size; ++ i) {
+    array_[i - 1] = array_[i];
   }
+  -- size;
+  SetSize(size);
   return size;
 }
 
@@ -261,4 +246,10 @@ template
 class BPlusTreeLeafPage<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
-class BPlusTreeLeafPage<GenericKey<64>, RowId, GenericComparator<64>>;
\ No newline at end of file
+class BPlusTreeLeafPage<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class BPlusTreeLeafPage<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class BPlusTreeLeafPage<GenericKey<256>, RowId, GenericComparator<256>>;
\ No newline at end of file
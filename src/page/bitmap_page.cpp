@@ -1,30 +1,52 @@
+#include <cstring>
+
 #include "page/bitmap_page.h"
 
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "FindFreePage assumes little-endian words");
+
 template<size_t PageSize>
 bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
   if(page_allocated_ < 8 * MAX_CHARS){ //if have space
-    for( next_free_page_ = 0 ; next_free_page_ < 8 * MAX_CHARS ;next_free_page_++ ){ 
-      if( IsPageFree(next_free_page_) ) break;
-    }
-    uint32_t byte_index = next_free_page_ / 8;
-    uint8_t bit_index = next_free_page_ % 8;
-    uint8_t num;
-    num = 1 << bit_index;
-    bytes[byte_index] += num; //set the bytes array
-    page_offset = next_free_page_;
-    page_allocated_++;
+    uint32_t hint_word = next_free_page_ / 64;
+    if( hint_word >= MAX_WORDS ) hint_word = 0;
+    uint32_t free_page = FindFreePage(hint_word, MAX_WORDS);
     /*
-     * search begin with next_free_page_
-     * because if a smaller index page is deleted
-     * next_free_page would change
+     * pages below the hint are normally all allocated, wrap around only in case
+     * the hint was left stale (e.g. by an older version of this page)
      */
+    if( free_page >= 8 * MAX_CHARS ) free_page = FindFreePage(0, hint_word);
+    ASSERT(free_page < 8 * MAX_CHARS, "Bitmap page count is inconsistent with its bits.");
+    bytes[free_page / 8] |= 1 << (free_page % 8); //set the bytes array
+    page_offset = free_page;
+    next_free_page_ = free_page + 1;
+    page_allocated_++;
     return true;
   } else return false;
 }
 
+template<size_t PageSize>
+bool BitmapPage<PageSize>::AllocatePageAt(uint32_t page_offset) {
+  if( page_offset >= 8 * MAX_CHARS || !IsPageFree(page_offset) ) return false;
+  bytes[page_offset / 8] |= 1 << (page_offset % 8);
+  page_allocated_++;
+  // the hint may now point at this page, allocation skips allocated pages anyway
+  return true;
+}
+
+template<size_t PageSize>
+uint32_t BitmapPage<PageSize>::FindFreePage(uint32_t begin_word, uint32_t end_word) const {
+  for( uint32_t word_index = begin_word ; word_index < end_word ; word_index++ ){
+    uint64_t word;
+    memcpy(&word, bytes + word_index * sizeof(uint64_t), sizeof(uint64_t));
+    // byte i of the word holds pages 8i..8i+7 on little-endian machines, so bit k is page 64 * word_index + k
+    if( ~word != 0 ) return word_index * 64 + __builtin_ctzll(~word);
+  }
+  return 8 * MAX_CHARS;
+}
+
 template<size_t PageSize>
 bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset) {
-  if( page_offset >= 8 * MAX_CHARS || page_offset < 0 ) return false;
+  if( page_offset >= 8 * MAX_CHARS ) return false;
   if( IsPageFree(page_offset) ) return false;
   else{
     uint32_t byte_index = page_offset / 8;
@@ -33,6 +55,7 @@ bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset) {
     num = 1 << bit_index;
     bytes[byte_index] -= num; //set the bytes array
     page_allocated_--;
+    if( page_offset < next_free_page_ ) next_free_page_ = page_offset;
     return true;
   }
   return true;
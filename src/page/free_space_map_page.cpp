@@ -0,0 +1,31 @@
+#include "page/free_space_map_page.h"
+
+bool FreeSpaceMapPage::Append(const page_id_t page_id, const uint32_t bucket, uint32_t *slot) {
+  if (IsFull()) {
+    return false;
+  }
+  entries_[count_].first = page_id;
+  entries_[count_].second = bucket;
+  *slot = count_;
+  count_++;
+  return true;
+}
+
+int FreeSpaceMapPage::FindSlot(const uint32_t min_bucket) const {
+  for (uint32_t i = 0; i < count_; i++) {
+    if (entries_[i].second >= min_bucket) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+uint32_t FreeSpaceMapPage::GetMaxBucket() const {
+  uint32_t max_bucket = 0;
+  for (uint32_t i = 0; i < count_; i++) {
+    if (entries_[i].second > max_bucket) {
+      max_bucket = entries_[i].second;
+    }
+  }
+  return max_bucket;
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <vector>
+
 #include "page/table_page.h"
 
 void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Transaction *txn) {
@@ -83,23 +86,73 @@ bool TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema,
   // Copy out the old value.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t __attribute__((unused)) read_bytes = old_row->DeserializeFrom(GetData() + tuple_offset, schema);
-  ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+  ASSERT(read_bytes <= tuple_size, "Unexpected behavior in tuple deserialize.");
+  // An open transaction keeps the bytes a smaller tuple frees, so its rollback always finds room for the old one.
+  // ReleaseTupleSpace gives them back when the transaction is over.
+  uint32_t slot_size = serialized_size;
+  if (txn != nullptr && txn->IsUndoable()) {
+    slot_size = std::max(tuple_size, serialized_size);
+  }
+  WriteTuple(slot_num, new_row, slot_size, schema);
+  return true;
+}
+
+bool TablePage::RollbackUpdate(const Row &old_row, const RowId &rid, Schema *schema) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount()) {
+    return false;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  if (IsDeleted(tuple_size)) {
+    return false;
+  }
+  // The slot is not cut down, an earlier update of the same transaction may still have to go back in.
+  uint32_t slot_size = std::max(tuple_size, old_row.GetSerializedSize(schema));
+  if (GetFreeSpaceRemaining() + tuple_size < slot_size) {
+    return false;
+  }
+  WriteTuple(slot_num, old_row, slot_size, schema);
+  return true;
+}
+
+void TablePage::ReleaseTupleSpace(const RowId &rid, Schema *schema) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount()) {
+    return;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  // An empty slot has nothing to give back, a marked one is left to ApplyDelete.
+  if (IsDeleted(tuple_size)) {
+    return;
+  }
+  Row row(rid);
+  uint32_t read_bytes = row.DeserializeFrom(GetData() + GetTupleOffsetAtSlot(slot_num), schema);
+  if (read_bytes < tuple_size) {
+    WriteTuple(slot_num, row, read_bytes, schema);
+  }
+}
+
+void TablePage::WriteTuple(uint32_t slot_num, const Row &row, uint32_t slot_size, Schema *schema) {
+  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  uint32_t tuple_size = GetTupleSize(slot_num);
   uint32_t free_space_pointer = GetFreeSpacePointer();
   ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
-  memmove(GetData() + free_space_pointer + tuple_size - serialized_size, GetData() + free_space_pointer,
+  // Serialize first, shifting the tuples in front of the slot may overwrite the row being written.
+  std::vector<char> data(slot_size, 0);
+  row.SerializeTo(data.data(), schema);
+  memmove(GetData() + free_space_pointer + tuple_size - slot_size, GetData() + free_space_pointer,
           tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size - serialized_size);
-  new_row.SerializeTo(GetData() + tuple_offset + tuple_size - serialized_size, schema);
-  SetTupleSize(slot_num, serialized_size);
+  SetFreeSpacePointer(free_space_pointer + tuple_size - slot_size);
+  SetTupleSize(slot_num, slot_size);
 
   // Update all tuple offsets.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
     uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
     if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
+      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - slot_size);
     }
   }
-  return true;
+  memcpy(GetData() + GetTupleOffsetAtSlot(slot_num), data.data(), slot_size);
 }
 
 void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_manager) {
@@ -159,7 +212,49 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager
   // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t __attribute__((unused)) read_bytes = row->DeserializeFrom(GetData() + tuple_offset, schema);
-  ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+  // An update in an open transaction may leave the slot bigger than the row.
+  ASSERT(read_bytes <= tuple_size, "Unexpected behavior in tuple deserialize.");
+  return true;
+}
+
+bool TablePage::GetTupleData(const RowId &rid, std::string &data) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount()) {
+    return false;
+  }
+  uint32_t tuple_size = UnsetDeletedFlag(GetTupleSize(slot_num));
+  if (tuple_size == 0) {
+    return false;
+  }
+  data.assign(GetData() + GetTupleOffsetAtSlot(slot_num), tuple_size);
+  return true;
+}
+
+bool TablePage::GetLiveTupleData(const RowId &rid, std::string &data) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || IsDeleted(GetTupleSize(slot_num))) {
+    return false;
+  }
+  data.assign(GetData() + GetTupleOffsetAtSlot(slot_num), GetTupleSize(slot_num));
+  return true;
+}
+
+bool TablePage::RestoreTuple(const RowId &rid, const char *data, uint32_t size) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount()) {
+    return false;
+  }
+  // Drop what the slot holds now, tuples stay packed behind the free space pointer.
+  if (GetTupleSize(slot_num) != 0) {
+    ApplyDelete(rid, nullptr, nullptr);
+  }
+  if (GetFreeSpaceRemaining() < size) {
+    return false;
+  }
+  SetFreeSpacePointer(GetFreeSpacePointer() - size);
+  memcpy(GetData() + GetFreeSpacePointer(), data, size);
+  SetTupleOffsetAtSlot(slot_num, GetFreeSpacePointer());
+  SetTupleSize(slot_num, size);
   return true;
 }
 
@@ -39,10 +39,10 @@ void MinisqlParserSetError(char *msg) {
   }
   minisql_parser_error_ = 1;
   if (minisql_parser_error_message_ != NULL) {
-    printf("minisql parse error message not null in MinisqlParserSetError.\n");
+    fprintf(stderr, "minisql parse error message not null in MinisqlParserSetError.\n");
   }
-  printf("Minisql parse error at line %d, col %d, message: %s\n", minisql_parser_line_no_, minisql_parser_column_no_,
-         msg);
+  fprintf(stderr, "Minisql parse error at line %d, col %d, message: %s\n", minisql_parser_line_no_,
+          minisql_parser_column_no_, msg);
   minisql_parser_error_message_ = msg;
 }
 
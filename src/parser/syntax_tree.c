@@ -61,13 +61,35 @@ void FreeSyntaxNode(pSyntaxNode node) {
 }
 
 void DestroySyntaxTree() {
-  pSyntaxNodeList p = minisql_parser_syntax_node_list_;
+  DestroySyntaxNodeList(DetachSyntaxTree());
+}
+
+pSyntaxNodeList DetachSyntaxTree() {
+  pSyntaxNodeList list = minisql_parser_syntax_node_list_;
+  minisql_parser_syntax_node_list_ = NULL;
+  return list;
+}
+
+void AttachSyntaxTree(pSyntaxNodeList list) {
+  if (list == NULL) {
+    return;
+  }
+  pSyntaxNodeList tail = list;
+  while (tail->next_ != NULL) {
+    tail = tail->next_;
+  }
+  tail->next_ = minisql_parser_syntax_node_list_;
+  minisql_parser_syntax_node_list_ = list;
+}
+
+void DestroySyntaxNodeList(pSyntaxNodeList list) {
+  pSyntaxNodeList p = list;
   while (p != NULL) {
     pSyntaxNodeList next = p->next_;
     FreeSyntaxNode(p->node_);
+    free(p);
     p = next;
   }
-  minisql_parser_syntax_node_list_ = NULL;
 }
 
 void SyntaxNodeAddChildren(pSyntaxNode parent, pSyntaxNode child) {
@@ -169,6 +191,8 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeTrxCommit";
     case kNodeTrxRollback:
       return "kNodeTrxRollback";
+    case kNodeCopy:
+      return "kNodeCopy";
     default:
       return "error type";
   }
@@ -72,11 +72,7 @@ uint32_t Column::DeserializeFrom(char *buf, Column *&column, MemHeap *heap) {
     size_t str_len = MACH_READ_FROM(size_t, buf + tot_offset);
     tot_offset += sizeof(size_t);
     
-    std::string name;
-    char *name1 = new char[str_len];
-    memcpy(name1, buf+tot_offset, str_len);
-    name=name1;
-    delete name1;
+    std::string name(buf + tot_offset, str_len);
     tot_offset += str_len;
     if(type == kTypeChar)
       column = ALLOC_P(heap, Column)(name,type,len,table_ind,nullable,unique);
@@ -28,7 +28,7 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
   for(size_t i = 0;i < this->fields_.size();i++){
     tot_offset += this->fields_[i]->SerializeTo(buf + tot_offset);
   }
-  delete bitmap;
+  delete[] bitmap;
   return tot_offset;
 }
 
@@ -52,6 +52,11 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
     tot_offset += size_of_bitmap;
 
     Field *tmp;
+    // a reused row (e.g. the one cached by TableIterator) gives back the fields it decoded before
+    for (auto field : this->fields_) {
+      field->~Field();
+      this->heap_->Free(field);
+    }
     this->fields_.clear();
     for(size_t i = 0; i < size_of_fields; i++){
       uint32_t byte_index = i / 8;
@@ -67,7 +72,7 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
       this->fields_.push_back(tmp);
     }
     this->rid_ = row_id;
-    delete bitmap;
+    delete[] bitmap;
     return tot_offset;
   }else
   return 0;
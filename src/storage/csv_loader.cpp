@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "storage/csv_loader.h"
+
+CsvLoader::CsvLoader(const Schema *schema, uint32_t worker_count) : schema_(schema), worker_count_(worker_count) {
+  if (worker_count_ == 0) {
+    worker_count_ = std::max(1u, std::thread::hardware_concurrency());
+  }
+}
+
+bool CsvLoader::Open(const std::string &path) {
+  error_.clear();
+  if (!file_.Open(path)) {
+    error_ = "can not open " + path;
+    return false;
+  }
+  return true;
+}
+
+bool CsvLoader::Load(const std::function<bool(std::vector<Row> &)> &consumer) {
+  error_.clear();
+  size_t begin = SkipHeader();
+  std::vector<Chunk> chunks;
+  SplitChunks(begin, chunks);
+  if (chunks.empty()) {
+    return true;
+  }
+  // workers run at most {window} chunks ahead of the consumer, so only that many chunks of
+  // parsed rows are held in memory however large the file is
+  size_t worker_count = std::min<size_t>(worker_count_, chunks.size());
+  size_t window = 2 * worker_count;
+  std::mutex latch;
+  std::condition_variable parsed;
+  std::condition_variable consumed_more;
+  size_t next = 0;
+  size_t consumed = 0;
+  bool stop = false;
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < worker_count; i++) {
+    workers.emplace_back([&]() {
+      while (true) {
+        size_t index;
+        {
+          std::unique_lock<std::mutex> lock(latch);
+          consumed_more.wait(lock, [&]() { return stop || next >= chunks.size() || next < consumed + window; });
+          if (stop || next >= chunks.size()) {
+            return;
+          }
+          index = next++;
+        }
+        ParseChunk(chunks[index]);
+        std::lock_guard<std::mutex> lock(latch);
+        chunks[index].done_ = true;
+        parsed.notify_all();
+      }
+    });
+  }
+  // the header is line 1 when there is one
+  size_t line = begin > 0 ? 1 : 0;
+  bool ok = true;
+  for (size_t i = 0; i < chunks.size() && ok; i++) {
+    Chunk &chunk = chunks[i];
+    {
+      std::unique_lock<std::mutex> lock(latch);
+      parsed.wait(lock, [&chunk]() { return chunk.done_; });
+    }
+    if (!chunk.ok_) {
+      error_ = "line " + std::to_string(line + chunk.error_line_) + ": " + chunk.error_;
+      ok = false;
+    } else if (!consumer(chunk.rows_)) {
+      error_ = "the rows from line " + std::to_string(line + 1) + " on can not be stored";
+      ok = false;
+    }
+    line += chunk.lines_;
+    std::vector<Row>().swap(chunk.rows_);
+    std::lock_guard<std::mutex> lock(latch);
+    consumed = i + 1;
+    stop = !ok;
+    consumed_more.notify_all();
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  return ok;
+}
+
+size_t CsvLoader::SkipHeader() const {
+  const char *data = file_.GetData();
+  size_t size = file_.GetSize();
+  const char *line_end = data == nullptr ? nullptr : static_cast<const char *>(memchr(data, '\n', size));
+  size_t len = line_end == nullptr ? size : line_end - data;
+  size_t next = line_end == nullptr ? size : len + 1;
+  if (len > 0 && data[len - 1] == '\r') {
+    len--;
+  }
+  std::string header;
+  for (auto column : schema_->GetColumns()) {
+    if (!header.empty()) {
+      header.push_back(',');
+    }
+    header += column->GetName();
+  }
+  if (len == header.size() && memcmp(data, header.data(), len) == 0) {
+    return next;
+  }
+  return 0;
+}
+
+void CsvLoader::SplitChunks(size_t begin, std::vector<Chunk> &chunks) const {
+  const char *data = file_.GetData();
+  size_t size = file_.GetSize();
+  size_t pos = begin;
+  while (pos < size) {
+    size_t end = size;
+    if (size - pos > CHUNK_SIZE) {
+      // count the quotes before the cut, an odd number means it falls into a quoted field
+      size_t cut = pos + CHUNK_SIZE;
+      bool quoted = false;
+      const char *quote = data + pos;
+      while ((quote = static_cast<const char *>(memchr(quote, '"', data + cut - quote))) != nullptr) {
+        quoted = !quoted;
+        quote++;
+      }
+      for (size_t i = cut; i < size; i++) {
+        if (data[i] == '"') {
+          quoted = !quoted;
+        } else if (data[i] == '\n' && !quoted) {
+          end = i + 1;
+          break;
+        }
+      }
+    }
+    Chunk chunk;
+    chunk.begin_ = pos;
+    chunk.end_ = end;
+    chunks.push_back(std::move(chunk));
+    pos = end;
+  }
+}
+
+void CsvLoader::ParseChunk(Chunk &chunk) const {
+  std::vector<Field> fields;
+  fields.reserve(schema_->GetColumnCount());
+  std::string scratch;
+  size_t pos = chunk.begin_;
+  while (pos < chunk.end_) {
+    chunk.lines_++;
+    if (!ParseLine(pos, chunk.end_, fields, scratch, chunk.error_)) {
+      chunk.ok_ = false;
+      chunk.error_line_ = chunk.lines_;
+      chunk.rows_.clear();
+      return;
+    }
+    if (!fields.empty()) {
+      chunk.rows_.emplace_back(fields);
+    }
+  }
+}
+
+bool CsvLoader::ParseLine(size_t &pos, size_t end, std::vector<Field> &fields, std::string &scratch,
+                          std::string &error) const {
+  const char *data = file_.GetData();
+  fields.clear();
+  // blank lines are skipped
+  if (data[pos] == '\n' || (data[pos] == '\r' && pos + 1 < end && data[pos + 1] == '\n')) {
+    pos += data[pos] == '\n' ? 1 : 2;
+    return true;
+  }
+  uint32_t column_count = schema_->GetColumnCount();
+  while (true) {
+    bool quoted = pos < end && data[pos] == '"';
+    scratch.clear();
+    if (quoted) {
+      pos++;
+      while (true) {
+        if (pos >= end) {
+          error = "unterminated quoted field";
+          return false;
+        }
+        char ch = data[pos++];
+        if (ch != '"') {
+          scratch.push_back(ch);
+        } else if (pos < end && data[pos] == '"') {
+          scratch.push_back('"');
+          pos++;
+        } else {
+          break;
+        }
+      }
+      if (pos + 1 < end && data[pos] == '\r' && data[pos + 1] == '\n') {
+        pos++;
+      }
+      if (pos < end && data[pos] != ',' && data[pos] != '\n') {
+        error = "unexpected character after a quoted field";
+        return false;
+      }
+    } else {
+      size_t start = pos;
+      while (pos < end && data[pos] != ',' && data[pos] != '\n') {
+        if (data[pos] == '"') {
+          error = "a quote in an unquoted field";
+          return false;
+        }
+        pos++;
+      }
+      size_t len = pos - start;
+      if ((pos >= end || data[pos] == '\n') && len > 0 && data[pos - 1] == '\r') {
+        len--;
+      }
+      scratch.assign(data + start, len);
+    }
+    if (fields.size() >= column_count) {
+      error = "more than " + std::to_string(column_count) + " fields";
+      return false;
+    }
+    if (!MakeField(schema_->GetColumn(fields.size()), scratch, quoted, fields, error)) {
+      return false;
+    }
+    if (pos < end && data[pos] == ',') {
+      pos++;
+      continue;
+    }
+    if (pos < end) {
+      // the line end
+      pos++;
+    }
+    break;
+  }
+  if (fields.size() != column_count) {
+    error = "expected " + std::to_string(column_count) + " fields, got " + std::to_string(fields.size());
+    return false;
+  }
+  return true;
+}
+
+bool CsvLoader::MakeField(const Column *column, const std::string &value, bool quoted, std::vector<Field> &fields,
+                          std::string &error) const {
+  TypeId type = column->GetType();
+  if (value.empty() && !quoted) {
+    if (!column->IsNullable()) {
+      error = "null in column " + column->GetName();
+      return false;
+    }
+    fields.emplace_back(type);
+    return true;
+  }
+  char *end = nullptr;
+  errno = 0;
+  switch (type) {
+    case TypeId::kTypeInt: {
+      long number = strtol(value.c_str(), &end, 10);
+      if (value.empty() || *end != '\0' || errno != 0 || number < INT32_MIN || number > INT32_MAX) {
+        error = "invalid int " + value + " in column " + column->GetName();
+        return false;
+      }
+      fields.emplace_back(type, static_cast<int32_t>(number));
+      return true;
+    }
+    case TypeId::kTypeFloat: {
+      float number = strtof(value.c_str(), &end);
+      if (value.empty() || *end != '\0' || errno != 0) {
+        error = "invalid float " + value + " in column " + column->GetName();
+        return false;
+      }
+      fields.emplace_back(type, number);
+      return true;
+    }
+    case TypeId::kTypeChar:
+      // same rule as insert
+      if (value.size() != column->GetLength()) {
+        error = "length of " + value + " does not match column " + column->GetName();
+        return false;
+      }
+      fields.emplace_back(type, const_cast<char *>(value.data()), static_cast<uint32_t>(value.size()), true);
+      return true;
+    default:
+      error = "unsupported type of column " + column->GetName();
+      return false;
+  }
+}
@@ -1,5 +1,9 @@
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
 #include <stdexcept>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
@@ -7,26 +11,68 @@
 
 DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw std::exception();
-    }
+  // create the file if it does not exist
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    throw std::exception();
   }
+  file_size_ = GetFileSize();
   ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  LoadBitmaps();
+}
+
+void DiskManager::Sync() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (closed) {
+    return;
+  }
+  WriteBitmaps();
+  WritePhysicalPage(META_PAGE_ID, meta_data_);
+  if (fsync(db_fd_) != 0) {
+    LOG(ERROR) << "I/O error while syncing";
+  }
+}
+
+void DiskManager::Checkpoint(uint64_t offset) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (closed) {
+    return;
+  }
+  WriteBitmaps();
+  if (fsync(db_fd_) != 0) {
+    LOG(ERROR) << "I/O error while syncing";
+    return;
+  }
+  reinterpret_cast<DiskFileMetaPage *>(meta_data_)->SetCheckpointOffset(offset);
+  WritePhysicalPage(META_PAGE_ID, meta_data_);
+  if (fsync(db_fd_) != 0) {
+    LOG(ERROR) << "I/O error while syncing";
+  }
+}
+
+uint64_t DiskManager::GetCheckpointOffset() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  return reinterpret_cast<DiskFileMetaPage *>(meta_data_)->GetCheckpointOffset();
+}
+
+void DiskManager::WriteBitmaps() {
+  // a page is freed only after its free is logged, and freeing waits for db_io_latch_, so this covers every free
+  if (log_manager_ != nullptr) {
+    log_manager_->Flush();
+  }
+  for (uint32_t extent_id = 0; extent_id < bitmaps_.size(); extent_id++) {
+    if (bitmap_dirty_[extent_id]) {
+      WritePhysicalPage(extent_id * (BITMAP_SIZE + 1) + 1, bitmaps_[extent_id].get());
+      bitmap_dirty_[extent_id] = false;
+    }
+  }
 }
 
 void DiskManager::Close() {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if (!closed) {
-    db_io_.close();
+    Sync();
+    close(db_fd_);
     closed = true;
   }
 }
@@ -42,90 +88,152 @@ void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
 }
 
 page_id_t DiskManager::AllocatePage() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(this->GetMetaData());
+  if( meta_page->num_allocated_pages_ >= MAX_VALID_PAGE_ID ) return INVALID_PAGE_ID;
+  // first extent with a free page, open a new one if all are full
+  uint32_t extent_id = 0;
+  while( extent_id < meta_page->num_extents_ && meta_page->extent_used_page_[extent_id] >= BITMAP_SIZE ) extent_id++;
+  if( extent_id == meta_page->num_extents_ ) {
+    meta_page->extent_used_page_[extent_id] = 0;
+    meta_page->num_extents_++;
+  }
+  uint32_t allo_page_id_in_bitmap = 0;
+  if( !GetBitmap(extent_id)->AllocatePage(allo_page_id_in_bitmap) ) return INVALID_PAGE_ID;
+  bitmap_dirty_[extent_id] = true;
+  meta_page->num_allocated_pages_++;
+  meta_page->extent_used_page_[extent_id]++;
+  return extent_id * BITMAP_SIZE + allo_page_id_in_bitmap;
+}
+
+void DiskManager::AllocatePageAt(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if( logical_page_id < 0 || logical_page_id >= MAX_VALID_PAGE_ID ) return;
   DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(this->GetMetaData());
-  if( meta_page->num_allocated_pages_ < MAX_VALID_PAGE_ID ){
-    if( (meta_page->num_extents_ == 0) || 
-        (meta_page->extent_used_page_[meta_page->num_extents_ - 1] >= BITMAP_SIZE) ){ meta_page->num_extents_++;}
-    char bitmap_data[PAGE_SIZE];
-    memset(bitmap_data, 0, PAGE_SIZE);
-    uint32_t allo_page_id_in_bitmap = 0;
-    ReadPhysicalPage( (meta_page->num_extents_-1) * (BITMAP_SIZE + 1) + 1, bitmap_data);
-    BitmapPage<PAGE_SIZE> *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmap_data);
-    bitmap->AllocatePage(allo_page_id_in_bitmap);
-    meta_page->num_allocated_pages_++;
-    meta_page->extent_used_page_[meta_page->num_extents_ - 1]++;
-    WritePhysicalPage((meta_page->num_extents_-1) * (BITMAP_SIZE + 1) + 1, bitmap_data);
-    return (meta_page->num_extents_-1) * BITMAP_SIZE + allo_page_id_in_bitmap;
-  }else return INVALID_PAGE_ID;
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  // open every extent up to the page's, the ones skipped stay empty
+  while( meta_page->num_extents_ <= extent_id ) {
+    meta_page->extent_used_page_[meta_page->num_extents_] = 0;
+    meta_page->num_extents_++;
+  }
+  if( !GetBitmap(extent_id)->AllocatePageAt(logical_page_id % BITMAP_SIZE) ) return;
+  bitmap_dirty_[extent_id] = true;
+  meta_page->num_allocated_pages_++;
+  meta_page->extent_used_page_[extent_id]++;
 }
 
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if(logical_page_id < 0) return;
   if(!IsPageFree(logical_page_id)){
     DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(this->GetMetaData());
-    char bitmap_data[PAGE_SIZE];
-    memset(bitmap_data, 0, PAGE_SIZE);
-    ReadPhysicalPage((logical_page_id / BITMAP_SIZE ) * (BITMAP_SIZE + 1) + 1, bitmap_data);
-    BitmapPage<PAGE_SIZE> *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmap_data);
-    bitmap->DeAllocatePage(logical_page_id % BITMAP_SIZE);
+    uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+    GetBitmap(extent_id)->DeAllocatePage(logical_page_id % BITMAP_SIZE);
+    bitmap_dirty_[extent_id] = true;
     meta_page->num_allocated_pages_--;
-    meta_page->extent_used_page_[logical_page_id / BITMAP_SIZE]--;
-    WritePhysicalPage((logical_page_id / BITMAP_SIZE ) * (BITMAP_SIZE + 1) + 1, bitmap_data);
+    meta_page->extent_used_page_[extent_id]--;
   }
 }
 
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if(logical_page_id < 0) return false;
-  char bitmap_data[PAGE_SIZE];
-  memset(bitmap_data, 0, PAGE_SIZE);
-  ReadPhysicalPage((logical_page_id / BITMAP_SIZE) * (BITMAP_SIZE + 1) + 1, bitmap_data);
-  BitmapPage<PAGE_SIZE> *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmap_data);
-  return bitmap->IsPageFree(logical_page_id % BITMAP_SIZE);
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  // pages of extents never opened are all free
+  if(extent_id >= bitmaps_.size()) return true;
+  return GetBitmap(extent_id)->IsPageFree(logical_page_id % BITMAP_SIZE);
+}
+
+BitmapPage<PAGE_SIZE> *DiskManager::GetBitmap(uint32_t extent_id) {
+  while( bitmaps_.size() <= extent_id ) {
+    // a brand new extent, its bitmap reaches disk at the next Sync
+    bitmaps_.emplace_back(new char[PAGE_SIZE]);
+    memset(bitmaps_.back().get(), 0, PAGE_SIZE);
+    bitmap_dirty_.push_back(true);
+  }
+  return reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmaps_[extent_id].get());
+}
+
+void DiskManager::LoadBitmaps() {
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(this->GetMetaData());
+  // count extents present in the file as well, older files never persisted the meta page
+  size_t num_physical_pages = file_size_.load() / PAGE_SIZE;
+  uint32_t num_extents = num_physical_pages <= 1 ? 0 : (num_physical_pages - 2) / (BITMAP_SIZE + 1) + 1;
+  num_extents = std::max(num_extents, meta_page->num_extents_);
+  meta_page->num_allocated_pages_ = 0;
+  for( uint32_t extent_id = 0; extent_id < num_extents; extent_id++ ) {
+    bitmaps_.emplace_back(new char[PAGE_SIZE]);
+    bitmap_dirty_.push_back(false);
+    ReadPhysicalPage(extent_id * (BITMAP_SIZE + 1) + 1, bitmaps_.back().get());
+    // rebuild the usage counters from the bitmaps, which are the ground truth
+    uint32_t used = GetBitmap(extent_id)->GetAllocatedPages();
+    meta_page->extent_used_page_[extent_id] = used;
+    meta_page->num_allocated_pages_ += used;
+  }
+  meta_page->num_extents_ = num_extents;
 }
 
 page_id_t DiskManager::MapPageId(page_id_t logical_page_id) {
   return logical_page_id/BITMAP_SIZE + 2 + logical_page_id;
 }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
+size_t DiskManager::GetFileSize() {
   struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? stat_buf.st_size : -1;
+  int rc = fstat(db_fd_, &stat_buf);
+  return rc == 0 ? static_cast<size_t>(stat_buf.st_size) : 0;
 }
 
 void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
+  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+  if (offset >= file_size_.load()) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
     memset(page_data, 0, PAGE_SIZE);
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    return;
+  }
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t ret = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret <= 0) {
+      if (ret < 0) {
+        LOG(ERROR) << "I/O error while reading";
+      }
+      break;
+    }
+    read_count += ret;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
+    LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
   }
 }
 
 void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG(ERROR) << "I/O error while writing";
-    return;
+  size_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t ret = pwrite(db_fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (ret <= 0) {
+      LOG(ERROR) << "I/O error while writing";
+      return;
+    }
+    write_count += ret;
+  }
+  // grow the cached size, concurrent writers may race to extend the file
+  size_t end = offset + PAGE_SIZE;
+  size_t cur = file_size_.load();
+  while (cur < end && !file_size_.compare_exchange_weak(cur, end)) {
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
-}
\ No newline at end of file
+}
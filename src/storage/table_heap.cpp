@@ -1,49 +1,321 @@
+#include "storage/csv_loader.h"
 #include "storage/table_heap.h"
 
 bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
-  if(sizeof(row) > PAGE_SIZE) return false;
-  auto iter = first_page_id_;
-  page_id_t last_page_id = INVALID_PAGE_ID ,insert_page_id;
-  TablePage *last_page;
-  TablePage *page = nullptr;
-  //find a page to insert
-  for(iter = first_page_id_; iter != INVALID_PAGE_ID; iter = page->GetNextPageId()){
-    page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(iter));
+  uint32_t tuple_size = row.GetSerializedSize(schema_);
+  if (tuple_size > TablePage::SIZE_MAX_ROW) return false;
+  if (!LockTable(txn, LockMode::kIntentionExclusive)) return false;
+  //the tuple, the map entry and a new tail page are logged as one record
+  buffer_pool_manager_->BeginAtomic();
+  //tail appends usually fit in the last page
+  bool inserted = InsertIntoPage(last_page_id_, row, txn);
+  //ask the free-space map for a page with enough room
+  uint32_t required_bytes = tuple_size + TablePage::SIZE_TUPLE;
+  for (page_id_t page_id = inserted ? INVALID_PAGE_ID : FindFreePage(required_bytes); page_id != INVALID_PAGE_ID;
+       page_id = FindFreePage(required_bytes)) {
+    //a failed try refreshes the stale entry, so the same page won't be returned again
+    if (InsertIntoPage(page_id, row, txn)) {
+      inserted = true;
+      break;
+    }
+  }
+  if (!inserted) {
+    //no free page
+    //try to allocate a new page, a failed allocation means no memory
+    page_id_t insert_page_id = AppendPage(txn);
+    inserted = insert_page_id != INVALID_PAGE_ID && InsertIntoPage(insert_page_id, row, txn);
+  }
+  EndAtomic(txn, inserted ? LogRecord::InsertTuples({row.GetRowId()}) : LogRecord());
+  //snapshots do not see the new tuple until the commit, so nobody writes it before it is locked
+  return inserted && LockRow(txn, LockMode::kExclusive, row.GetRowId());
+}
+
+bool TableHeap::InsertTuples(std::vector<Row> &rows, Transaction *txn) {
+  if (!LockTable(txn, LockMode::kIntentionExclusive)) return false;
+  size_t next = 0;
+  page_id_t page_id = last_page_id_;
+  bool appended = false;
+  while (next < rows.size()) {
+    if (rows[next].GetSerializedSize(schema_) > TablePage::SIZE_MAX_ROW) return false;
+    //fill the page with as many rows as it takes under one latch
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) return false;
+    size_t first = next;
+    //every page of the batch is logged as one record
+    buffer_pool_manager_->BeginAtomic();
     page->WLatch();
-    
-    if( page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_) ){
-      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-      page->WUnlatch();
-      
-      return true;
+    while (next < rows.size() && page->InsertTuple(rows[next], schema_, txn, lock_manager_, log_manager_)) {
+      RecordVersion(txn, rows[next].GetRowId(), nullptr);
+      next++;
     }
+    uint32_t free_space = page->GetFreeSpaceRemaining();
     page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-    last_page_id = iter;
+    buffer_pool_manager_->UnpinPage(page_id, next > first);
+    UpdateFreeSpace(page_id, free_space);
+    std::vector<RowId> rids;
+    for (size_t i = first; i < next && txn != nullptr; i++) {
+      rids.push_back(rows[i].GetRowId());
+    }
+    EndAtomic(txn, next > first ? LogRecord::InsertTuples(rids) : LogRecord());
+    for (auto &rid : rids) {
+      if (!LockRow(txn, LockMode::kExclusive, rid)) return false;
+    }
+    if (next == rows.size()) break;
+    //a fresh page that takes no row would loop forever
+    if (appended && next == first) return false;
+    //the page is full, reuse space freed elsewhere before growing the heap
+    page_id = FindFreePage(rows[next].GetSerializedSize(schema_) + TablePage::SIZE_TUPLE);
+    appended = page_id == INVALID_PAGE_ID;
+    if (appended && (page_id = AppendPage(txn)) == INVALID_PAGE_ID) return false;
   }
-  
-  //no free page
-  //try to allocate a new page
-  page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(insert_page_id));
-  if(page == nullptr) return false; //allocate failed, no memory
+  return true;
+}
+
+bool TableHeap::CopyFrom(const std::string &path, std::vector<RowId> &rids, std::string &error, Transaction *txn) {
+  rids.clear();
+  CsvLoader loader(schema_);
+  if (!loader.Open(path)) {
+    error = loader.GetError();
+    return false;
+  }
+  bool loaded = loader.Load([this, &rids, txn](std::vector<Row> &rows) {
+    bool inserted = InsertTuples(rows, txn);
+    for (auto &row : rows) {
+      if (row.GetRowId().GetPageId() != INVALID_PAGE_ID) rids.push_back(row.GetRowId());
+    }
+    return inserted;
+  });
+  if (!loaded) {
+    error = loader.GetError();
+    for (auto &rid : rids) {
+      MarkDelete(rid, txn);
+      ApplyDelete(rid, txn);
+    }
+    rids.clear();
+  }
+  return loaded;
+}
+
+page_id_t TableHeap::AppendPage(Transaction *txn) {
+  page_id_t new_page_id;
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+  if (page == nullptr) return INVALID_PAGE_ID;
+  //the link, the new page and its map entry are logged as one record
+  buffer_pool_manager_->BeginAtomic();
   //modify last page
-  last_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id));
-  if(last_page != nullptr){
+  auto last_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  if (last_page != nullptr) {
     last_page->WLatch();
+    last_page->SetNextPageId(new_page_id);
     last_page->WUnlatch();
-    last_page->SetNextPageId(insert_page_id);
-    buffer_pool_manager_->UnpinPage(last_page_id, true);
+    buffer_pool_manager_->UnpinPage(last_page_id_, true);
   }
   //modify this page
   page->WLatch();
-  page->Init(insert_page_id,last_page_id,log_manager_,txn);
-  page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_);
+  page->Init(new_page_id, last_page_id_, log_manager_, txn);
+  uint32_t free_space = page->GetFreeSpaceRemaining();
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(insert_page_id, true);
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  last_page_id_ = new_page_id;
+  AppendFreeSpaceEntry(new_page_id, free_space);
+  buffer_pool_manager_->EndAtomic();
+  return new_page_id;
+}
+
+void TableHeap::EndAtomic(Transaction *txn, const LogRecord &record, const Row *old_row) {
+  //a record is kept only if there is something to undo
+  bool undoable = txn != nullptr && record.GetType() != LogRecordType::kInvalid;
+  lsn_t undo_next_lsn = undoable ? txn->GetPrevLSN() : INVALID_LSN;
+  buffer_pool_manager_->EndAtomic(txn, undoable ? &record : nullptr);
+  if (!undoable || !txn->IsUndoable()) return;
+  //the write set follows the log, so a rollback compensates the records in reverse order
+  switch (record.GetType()) {
+    case LogRecordType::kInsertTuples:
+      txn->GetWriteSet().emplace_back(this, WType::kInsert, record.GetRowIds(), undo_next_lsn);
+      break;
+    case LogRecordType::kMarkDelete:
+      txn->GetWriteSet().emplace_back(this, WType::kDelete, std::vector<RowId>{record.GetRowId()}, undo_next_lsn);
+      break;
+    case LogRecordType::kUpdateTuple:
+      txn->GetWriteSet().emplace_back(this, WType::kUpdate, std::vector<RowId>{record.GetRowId()}, undo_next_lsn,
+                                      *old_row);
+      break;
+    default:
+      break;
+  }
+}
+
+bool TableHeap::LockRow(Transaction *txn, LockMode mode, const RowId &rid) {
+  return txn == nullptr || lock_manager_ == nullptr || lock_manager_->LockRow(txn, mode, table_id_, rid);
+}
+
+bool TableHeap::LockTable(Transaction *txn, LockMode mode) {
+  return txn == nullptr || lock_manager_ == nullptr || lock_manager_->LockTable(txn, mode, table_id_);
+}
+
+bool TableHeap::LockForWrite(Transaction *txn, const RowId &rid) {
+  if (!LockRow(txn, LockMode::kExclusive, rid)) return false;
+  if (txn != nullptr && version_store_ != nullptr && version_store_->Conflicts(txn, rid)) {
+    txn->SetState(TxnState::kAborted);
+    return false;
+  }
   return true;
 }
 
+void TableHeap::RecordVersion(Transaction *txn, const RowId &rid, const std::string *before) {
+  if (txn != nullptr && version_store_ != nullptr) {
+    version_store_->Record(txn, rid, before);
+  }
+}
+
+bool TableHeap::ReadVersion(TablePage *page, const RowId &rid, Transaction *txn, std::string &data) {
+  bool exists;
+  if (txn != nullptr && version_store_ != nullptr && version_store_->Read(txn, rid, exists, data)) {
+    return exists;
+  }
+  return page->GetLiveTupleData(rid, data);
+}
+
+bool TableHeap::InsertIntoPage(page_id_t page_id, Row &row, Transaction *txn) {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) return false;
+  page->WLatch();
+  bool inserted = page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_);
+  if (inserted) {
+    RecordVersion(txn, row.GetRowId(), nullptr);
+  }
+  uint32_t free_space = page->GetFreeSpaceRemaining();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, inserted);
+  UpdateFreeSpace(page_id, free_space);
+  return inserted;
+}
+
+page_id_t TableHeap::FindFreePage(uint32_t required_bytes) {
+  uint32_t required_bucket = FreeSpaceMapPage::ToRequiredBucket(required_bytes);
+  for (size_t i = 0; i < fsm_page_ids_.size(); i++) {
+    if (fsm_max_buckets_[i] < required_bucket) continue;
+    auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_ids_[i])->GetData());
+    int slot = fsm_page->FindSlot(required_bucket);
+    page_id_t page_id = INVALID_PAGE_ID;
+    if (slot != -1) {
+      page_id = fsm_page->GetTablePageId(slot);
+    } else {
+      //the cached bound was loose, tighten it so this map page is skipped next time
+      fsm_max_buckets_[i] = fsm_page->GetMaxBucket();
+    }
+    buffer_pool_manager_->UnpinPage(fsm_page_ids_[i], false);
+    if (page_id != INVALID_PAGE_ID) return page_id;
+  }
+  return INVALID_PAGE_ID;
+}
+
+void TableHeap::UpdateFreeSpace(page_id_t page_id, uint32_t free_bytes) {
+  auto iter = fsm_entries_.find(page_id);
+  if (iter == fsm_entries_.end()) return;
+  uint32_t fsm_index = iter->second / FreeSpaceMapPage::MAX_ENTRY_COUNT;
+  uint32_t slot = iter->second % FreeSpaceMapPage::MAX_ENTRY_COUNT;
+  uint32_t bucket = FreeSpaceMapPage::ToBucket(free_bytes);
+  page_id_t fsm_page_id = fsm_page_ids_[fsm_index];
+  auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id)->GetData());
+  bool changed = fsm_page->GetBucket(slot) != bucket;
+  if (changed) {
+    fsm_page->SetBucket(slot, bucket);
+  }
+  buffer_pool_manager_->UnpinPage(fsm_page_id, changed);
+  if (bucket > fsm_max_buckets_[fsm_index]) {
+    fsm_max_buckets_[fsm_index] = bucket;
+  }
+}
+
+void TableHeap::AppendFreeSpaceEntry(page_id_t page_id, uint32_t free_bytes) {
+  FreeSpaceMapPage *fsm_page = nullptr;
+  page_id_t fsm_page_id = INVALID_PAGE_ID;
+  if (!fsm_page_ids_.empty()) {
+    fsm_page_id = fsm_page_ids_.back();
+    fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id)->GetData());
+  }
+  if (fsm_page == nullptr || fsm_page->IsFull()) {
+    //the last map page is full, chain a new one
+    page_id_t new_fsm_page_id;
+    auto new_page = buffer_pool_manager_->NewPage(new_fsm_page_id);
+    ASSERT(new_page != nullptr, "Failed to allocate free-space map page.");
+    buffer_pool_manager_->MarkRawPage(new_fsm_page_id);
+    auto new_fsm_page = reinterpret_cast<FreeSpaceMapPage *>(new_page->GetData());
+    new_fsm_page->Init();
+    if (fsm_page != nullptr) {
+      fsm_page->SetNextPageId(new_fsm_page_id);
+      buffer_pool_manager_->UnpinPage(fsm_page_id, true);
+    } else {
+      first_fsm_page_id_ = new_fsm_page_id;
+    }
+    fsm_page = new_fsm_page;
+    fsm_page_id = new_fsm_page_id;
+    fsm_page_ids_.push_back(fsm_page_id);
+    fsm_max_buckets_.push_back(0);
+  }
+  uint32_t slot;
+  uint32_t bucket = FreeSpaceMapPage::ToBucket(free_bytes);
+  fsm_page->Append(page_id, bucket, &slot);
+  buffer_pool_manager_->UnpinPage(fsm_page_id, true);
+  uint32_t fsm_index = fsm_page_ids_.size() - 1;
+  fsm_entries_[page_id] = fsm_index * FreeSpaceMapPage::MAX_ENTRY_COUNT + slot;
+  table_page_ids_.push_back(page_id);
+  if (bucket > fsm_max_buckets_[fsm_index]) {
+    fsm_max_buckets_[fsm_index] = bucket;
+  }
+}
+
+void TableHeap::PrefetchAfter(page_id_t page_id) {
+  uint32_t window = buffer_pool_manager_->GetPrefetchWindow();
+  auto iter = fsm_entries_.find(page_id);
+  if (window == 0 || iter == fsm_entries_.end()) return;
+  //map entries follow the page chain, so the next entries are the next pages of a scan
+  std::vector<page_id_t> page_ids;
+  for (uint32_t index = iter->second + 1; index <= iter->second + window && index < table_page_ids_.size(); index++) {
+    page_ids.push_back(table_page_ids_[index]);
+  }
+  if (!page_ids.empty()) {
+    buffer_pool_manager_->PrefetchPages(page_ids);
+  }
+}
+
+void TableHeap::LoadFreeSpaceMap() {
+  if (first_fsm_page_id_ == INVALID_PAGE_ID) {
+    //the map does not exist yet, build it by walking the page chain once
+    for (page_id_t page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+      auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+      uint32_t free_space = page->GetFreeSpaceRemaining();
+      page_id_t next_page_id = page->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      AppendFreeSpaceEntry(page_id, free_space);
+      last_page_id_ = page_id;
+      page_id = next_page_id;
+    }
+    return;
+  }
+  for (page_id_t fsm_page_id = first_fsm_page_id_; fsm_page_id != INVALID_PAGE_ID;) {
+    buffer_pool_manager_->MarkRawPage(fsm_page_id);
+    auto fsm_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id)->GetData());
+    uint32_t fsm_index = fsm_page_ids_.size();
+    for (uint32_t slot = 0; slot < fsm_page->GetEntryCount(); slot++) {
+      fsm_entries_[fsm_page->GetTablePageId(slot)] = fsm_index * FreeSpaceMapPage::MAX_ENTRY_COUNT + slot;
+      table_page_ids_.push_back(fsm_page->GetTablePageId(slot));
+      //entries follow the page chain, so the last one is the tail
+      last_page_id_ = fsm_page->GetTablePageId(slot);
+    }
+    fsm_page_ids_.push_back(fsm_page_id);
+    fsm_max_buckets_.push_back(fsm_page->GetMaxBucket());
+    page_id_t next_fsm_page_id = fsm_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(fsm_page_id, false);
+    fsm_page_id = next_fsm_page_id;
+  }
+}
+
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
+  if (!LockForWrite(txn, rid)) {
+    return false;
+  }
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -51,15 +323,23 @@ bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
     return false;
   }
   // Otherwise, mark the tuple as deleted.
+  buffer_pool_manager_->BeginAtomic();
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  std::string old_data;
+  page->GetTupleData(rid, old_data);
+  bool marked = page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  if (marked) {
+    RecordVersion(txn, rid, &old_data);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  EndAtomic(txn, marked ? LogRecord::TupleWrite(LogRecordType::kMarkDelete, rid) : LogRecord());
   return true;
 }
 
 bool TableHeap::UpdateTuple(const Row &row, const RowId &rid, Transaction *txn) {
   if(sizeof(row) > PAGE_SIZE) return false;
+  if (!LockForWrite(txn, rid)) return false;
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   if (page == nullptr) {
     return false;
@@ -67,25 +347,75 @@ bool TableHeap::UpdateTuple(const Row &row, const RowId &rid, Transaction *txn)
   Row old_row(rid);
   if(page->GetTuple(&old_row,schema_,txn,lock_manager_)){
     old_row.SetRowId(rid);
+    //the old bytes are logged to undo the update
+    std::string old_data;
     page->WLatch();
+    page->GetTupleData(rid, old_data);
+    buffer_pool_manager_->BeginAtomic();
     if(page->UpdateTuple(row,&old_row,schema_,txn,lock_manager_,log_manager_)){
+      RecordVersion(txn, rid, &old_data);
+      uint32_t free_space = page->GetFreeSpaceRemaining();
       page->WUnlatch();
       buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+      UpdateFreeSpace(rid.GetPageId(), free_space);
+      EndAtomic(txn, LogRecord::TupleWrite(LogRecordType::kUpdateTuple, rid, old_data.data(), old_data.size()),
+                &old_row);
       return true;
     }
+    buffer_pool_manager_->EndAtomic();
+    page->WUnlatch();
   }
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
   return false;
 }
 
+bool TableHeap::RollbackUpdate(const Row &row, const RowId &rid) {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page == nullptr) return false;
+  buffer_pool_manager_->BeginAtomic();
+  page->WLatch();
+  bool restored = page->RollbackUpdate(row, rid, schema_);
+  uint32_t free_space = page->GetFreeSpaceRemaining();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), restored);
+  UpdateFreeSpace(rid.GetPageId(), free_space);
+  buffer_pool_manager_->EndAtomic();
+  return restored;
+}
+
+void TableHeap::ReleaseTupleSpace(const RowId &rid) {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if (page == nullptr) return;
+  //nothing to undo, the slot only gets smaller
+  buffer_pool_manager_->BeginAtomic();
+  page->WLatch();
+  page->ReleaseTupleSpace(rid, schema_);
+  uint32_t free_space = page->GetFreeSpaceRemaining();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  UpdateFreeSpace(rid.GetPageId(), free_space);
+  buffer_pool_manager_->EndAtomic();
+}
+
 void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
+  //the tuple stays marked until the transaction commits, see TxnManager::Commit
+  if (txn != nullptr && txn->IsUndoable()) return;
   // Step1: Find the page which contains the tuple.
   // Step2: Delete the tuple from the page.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page != nullptr);
+  //the removed bytes are logged to undo the delete
+  std::string old_data;
+  buffer_pool_manager_->BeginAtomic();
   page->WLatch();
+  bool found = page->GetTupleData(rid, old_data);
   page->ApplyDelete(rid,txn,log_manager_);
+  uint32_t free_space = page->GetFreeSpaceRemaining();
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  UpdateFreeSpace(rid.GetPageId(), free_space);
+  EndAtomic(txn, found ? LogRecord::TupleWrite(LogRecordType::kApplyDelete, rid, old_data.data(), old_data.size())
+                       : LogRecord());
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
@@ -93,10 +423,38 @@ void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page != nullptr);
   // Rollback the delete.
+  buffer_pool_manager_->BeginAtomic();
   page->WLatch();
+  //only a tuple which is there and marked is really changed
+  Row row(rid);
+  std::string data;
+  bool marked = page->GetTupleData(rid, data) && !page->GetTuple(&row, schema_, txn, lock_manager_);
   page->RollbackDelete(rid, txn, log_manager_);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  EndAtomic(txn, marked ? LogRecord::TupleWrite(LogRecordType::kRollbackDelete, rid) : LogRecord());
+}
+
+bool TableHeap::ScanPage(page_id_t page_id, const std::function<void(const Row &row)> &visit, Transaction *txn) {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) return false;
+  page->RLatch();
+  RowId rid;
+  bool found = page->GetFirstTupleRid(&rid);
+  while (found) {
+    Row row(rid);
+    // a slot left empty or deleted holds no row
+    if (page->GetTuple(&row, schema_, txn, lock_manager_)) {
+      row.SetRowId(rid);
+      visit(row);
+    }
+    RowId next_rid;
+    found = page->GetNextTupleRid(rid, &next_rid);
+    rid = next_rid;
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return true;
 }
 
 void TableHeap::FreeHeap() {
@@ -109,16 +467,28 @@ bool TableHeap::GetTuple(Row *row, Transaction *txn) {
     row = nullptr;
     return false;
   }
+  if (txn != nullptr && version_store_ != nullptr) {
+    RowId rid = row->GetRowId();
+    std::string data;
+    page->RLatch();
+    bool found = ReadVersion(page, rid, txn, data);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    if (found) {
+      row->DeserializeFrom(&data[0], schema_);
+      row->SetRowId(rid);
+    }
+    return found;
+  }
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
   return page->GetTuple(row,schema_,txn,lock_manager_);
 }
 
 TableIterator TableHeap::Begin(Transaction *txn) {
-  RowId first_row_id_;
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  page->GetFirstTupleRid(&first_row_id_);
-  buffer_pool_manager_->UnpinPage(first_page_id_,false);
-  return TableIterator(first_row_id_,this);
+  // the first pages may hold no tuple at all, SeekFrom walks on to the first one which does
+  TableIterator iter(INVALID_ROWID, this, txn);
+  iter.SeekFrom(first_page_id_);
+  return iter;
 }
 
 TableIterator TableHeap::End() {
@@ -2,70 +2,88 @@
 #include "storage/table_iterator.h"
 #include "storage/table_heap.h"
 
-TableIterator::TableIterator(RowId id,TableHeap *table_heap_) :row(INVALID_ROWID)
+TableIterator::TableIterator(RowId id, TableHeap *table_heap_, Transaction *txn) :row(INVALID_ROWID)
 {
   this->id = id;
   this->table_heap_ = table_heap_;
+  this->txn_ = txn;
+  if (id.GetPageId() != INVALID_PAGE_ID) {
+    page_ = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(id.GetPageId()));
+    if (page_ == nullptr) {
+      LOG(INFO) << "CAN'T FIND PAGE IN TableIterator CONSTRUCTOR";
+      this->id = INVALID_ROWID;
+    }
+  }
 }
 
-TableIterator::TableIterator(const TableIterator &other) :row(INVALID_ROWID)
-{
+TableIterator::TableIterator(const TableIterator &other) :TableIterator(other.id, other.table_heap_, other.txn_) {
+  versions_ = other.versions_;
+  version_pos_ = other.version_pos_;
+}
+
+TableIterator &TableIterator::operator=(const TableIterator &other) {
+  if (this == &other) {
+    return *this;
+  }
+  ReleasePage();
+  //拷贝出的迭代器自己持有一次pin，缓存的row不拷贝，用到时再解析
   this->id = other.id;
   this->table_heap_ = other.table_heap_;
+  this->txn_ = other.txn_;
+  row_loaded_ = false;
+  versions_ = other.versions_;
+  version_pos_ = other.version_pos_;
+  if (other.page_ != nullptr) {
+    page_ = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(id.GetPageId()));
+  }
+  return *this;
 }
 
 TableIterator::~TableIterator() {
-  
+  ReleasePage();
 }
 
 const Row &TableIterator::operator*() {
-  this->row.SetRowId(id);
-  table_heap_->GetTuple(&this->row,nullptr);
-  this->row.SetRowId(id);
+  ASSERT(page_ != nullptr, "Dereference an end iterator.");
+  //同一条tuple只解析一次，直到迭代器前进
+  if (!row_loaded_) {
+    this->row.SetRowId(id);
+    if (IsSnapshot()) {
+      this->row.DeserializeFrom(&versions_[version_pos_].second[0], table_heap_->schema_);
+    } else {
+      page_->GetTuple(&this->row, table_heap_->schema_, txn_, table_heap_->lock_manager_);
+    }
+    this->row.SetRowId(id);
+    row_loaded_ = true;
+  }
   return this->row;
 }
 
 Row *TableIterator::operator->() {
-  this->row.SetRowId(id);
-  table_heap_->GetTuple(&this->row,nullptr);
-  this->row.SetRowId(id);
-  return &this->row;
+  return const_cast<Row *>(&**this);
 }
 
 TableIterator &TableIterator::operator++() {
-  RowId next_row_id;
-  auto page = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(id.GetPageId()));
-  //1.判断给出的rid是否能找到page
-  if(!page) {
-    LOG(INFO) << "CAN'T FIND PAGE IN TableIterator::operator++ FUNCTION";
+  row_loaded_ = false;
+  if (page_ == nullptr) {
     id = INVALID_ROWID;
     return *this;
   }
-  //2.根据page找到下一条tuple
-  //2.1 是否能在当前页找到
-  if(page->GetNextTupleRid(id,&next_row_id)){//在这页找到了下一条tuple
-    id = next_row_id;
-    table_heap_->buffer_pool_manager_->UnpinPage(page->GetPageId(),false);
-  }
-  //2.2 当前页找不到，需要去下一页找  
-  else {
-    page_id_t next_page_id = page->GetNextPageId();
-    table_heap_->buffer_pool_manager_->UnpinPage(page->GetPageId(),false);//需要去下一页，先释放本页
-    page = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(next_page_id));//找下一页
-    while(page != nullptr){ //如果下一页存在
-      if(page->GetFirstTupleRid(&next_row_id)){ //如果下一页存在一条记录
-        id = next_row_id;
-        break;
-      }else{
-        page_id_t next_page_id = page->GetNextPageId();
-        table_heap_->buffer_pool_manager_->UnpinPage(page->GetPageId(),false);
-        page = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(next_page_id));//找下一页
-      }
+  RowId next_row_id;
+  //1.当前页已被pin住，直接在这页找下一条tuple
+  if (IsSnapshot()) {
+    if (++version_pos_ < versions_.size()) {
+      id = versions_[version_pos_].first;
+      return *this;
     }
-    // std::cerr<<"+"<<std::endl;
-    if (page != nullptr) table_heap_->buffer_pool_manager_->UnpinPage(page->GetPageId(),false);//把下一页释放
-    else id = INVALID_ROWID;
+  } else if (page_->GetNextTupleRid(id, &next_row_id)) {
+    id = next_row_id;
+    return *this;
   }
+  //2.当前页找不到，释放本页，去后面的页找
+  page_id_t next_page_id = page_->GetNextPageId();
+  ReleasePage();
+  SeekFrom(next_page_id);
   return *this;
 }
 
@@ -74,3 +92,55 @@ TableIterator TableIterator::operator++(int) {
   ++(*this);//更改当前数据
   return result;//返回更改前的数据
 }
+
+void TableIterator::SeekFrom(page_id_t page_id) {
+  row_loaded_ = false;
+  auto bpm = table_heap_->buffer_pool_manager_;
+  auto page = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id));
+  //进入新的一页时，预读其后的若干页
+  if (page != nullptr) table_heap_->PrefetchAfter(page_id);
+  while (page != nullptr) {
+    if (IsSnapshot()) {
+      //快照读先把这页可见的版本都拷出来
+      LoadVersions(page);
+      if (!versions_.empty()) {
+        id = versions_[0].first;
+        page_ = page;
+        return;
+      }
+    } else if (page->GetFirstTupleRid(&id)) { //这页存在一条记录，保持pin直到离开这页
+      page_ = page;
+      return;
+    }
+    page_id_t next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page->GetTablePageId(), false);
+    page = reinterpret_cast<TablePage *>(bpm->FetchPage(next_page_id));
+  }
+  id = INVALID_ROWID;
+}
+
+void TableIterator::ReleasePage() {
+  if (page_ != nullptr) {
+    table_heap_->buffer_pool_manager_->UnpinPage(page_->GetTablePageId(), false);
+    page_ = nullptr;
+  }
+}
+
+bool TableIterator::IsSnapshot() const {
+  return txn_ != nullptr && table_heap_->version_store_ != nullptr;
+}
+
+void TableIterator::LoadVersions(TablePage *page) {
+  versions_.clear();
+  version_pos_ = 0;
+  //整页在读锁下拷出，一个tuple的新旧版本不会读到一半
+  page->RLatch();
+  std::string data;
+  for (uint32_t slot = 0; slot < page->GetSlotCount(); slot++) {
+    RowId rid(page->GetTablePageId(), slot);
+    if (table_heap_->ReadVersion(page, rid, txn_, data)) {
+      versions_.emplace_back(rid, data);
+    }
+  }
+  page->RUnlatch();
+}
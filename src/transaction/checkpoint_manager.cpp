@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <chrono>
+
+#include "glog/logging.h"
+#include "transaction/checkpoint_manager.h"
+
+void CheckpointManager::Start() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (checkpoint_thread_.joinable()) {
+    return;
+  }
+  shutdown_ = false;
+  checkpoint_thread_ = std::thread(&CheckpointManager::CheckpointWorker, this);
+}
+
+void CheckpointManager::Stop() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    shutdown_ = true;
+  }
+  shutdown_cv_.notify_one();
+  if (checkpoint_thread_.joinable()) {
+    checkpoint_thread_.join();
+  }
+}
+
+void CheckpointManager::Checkpoint() {
+  std::scoped_lock<std::mutex> lock(checkpoint_latch_);
+  // pages dirty since before the last checkpoint would hold the scan start back, write them now
+  if (begin_lsn_ != INVALID_LSN) {
+    buffer_pool_manager_->FlushOldPages(begin_lsn_);
+  }
+  lsn_t begin_lsn;
+  uint64_t begin_offset;
+  log_manager_->GetAppendPosition(begin_lsn, begin_offset);
+  std::vector<DirtyPage> dirty_pages;
+  std::vector<ActiveTxn> active_txns;
+  buffer_pool_manager_->GetDirtyPages(dirty_pages);
+  txn_manager_->GetActiveTxns(active_txns);
+  uint64_t scan_offset = begin_offset;
+  for (auto &dirty_page : dirty_pages) {
+    scan_offset = std::min(scan_offset, dirty_page.rec_offset_);
+  }
+  for (auto &active_txn : active_txns) {
+    scan_offset = std::min(scan_offset, active_txn.first_offset_);
+  }
+  LogRecord record =
+          LogRecord::Checkpoint(begin_lsn, begin_offset, txn_manager_->GetNextTxnId(), dirty_pages, active_txns);
+  uint64_t offset;
+  log_manager_->AppendLogRecord(record, &offset);
+  log_manager_->Flush();
+  // from now on recovery starts at this checkpoint, the log before its scan start is garbage
+  disk_manager_->Checkpoint(offset);
+  log_manager_->Truncate(scan_offset);
+  begin_lsn_ = begin_lsn;
+  checkpoint_offset_ = offset;
+}
+
+void CheckpointManager::CheckpointWorker() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (!shutdown_) {
+    shutdown_cv_.wait_for(lock, std::chrono::seconds(1), [this] { return shutdown_; });
+    if (shutdown_) {
+      break;
+    }
+    lsn_t next_lsn;
+    uint64_t offset;
+    log_manager_->GetAppendPosition(next_lsn, offset);
+    uint64_t checkpoint_offset;
+    {
+      std::scoped_lock<std::mutex> checkpoint_lock(checkpoint_latch_);
+      checkpoint_offset = checkpoint_offset_;
+    }
+    if (offset >= checkpoint_offset + CHECKPOINT_INTERVAL) {
+      lock.unlock();
+      Checkpoint();
+      lock.lock();
+    }
+  }
+}
@@ -0,0 +1,270 @@
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <set>
+
+#include "glog/logging.h"
+#include "transaction/lock_manager.h"
+
+LockManager::LockManager(bool detect_deadlocks) {
+  if (detect_deadlocks) {
+    detection_thread_ = std::thread(&LockManager::DetectionWorker, this);
+  }
+}
+
+LockManager::~LockManager() {
+  {
+    std::scoped_lock<std::mutex> lock(detection_latch_);
+    shutdown_ = true;
+  }
+  shutdown_cv_.notify_one();
+  if (detection_thread_.joinable()) {
+    detection_thread_.join();
+  }
+}
+
+bool LockManager::LockTable(Transaction *txn, LockMode mode, table_id_t table_id) {
+  auto &table_locks = txn->GetTableLocks();
+  auto held = table_locks.find(table_id);
+  if (held != table_locks.end() && Covers(held->second, mode)) {
+    return true;
+  }
+  LockMode target = held == table_locks.end() ? mode : Combine(held->second, mode);
+  if (!Lock(txn, LockKey{true, table_id}, target, held == table_locks.end() ? nullptr : &held->second)) {
+    return false;
+  }
+  table_locks[table_id] = target;
+  return true;
+}
+
+bool LockManager::LockRow(Transaction *txn, LockMode mode, table_id_t table_id, const RowId &rid) {
+  ASSERT(mode == LockMode::kShared || mode == LockMode::kExclusive, "Rows are locked shared or exclusive.");
+  LockMode intention = mode == LockMode::kShared ? LockMode::kIntentionShared : LockMode::kIntentionExclusive;
+  if (!LockTable(txn, intention, table_id)) {
+    return false;
+  }
+  // a table lock in S or X covers its rows as well
+  LockMode table_mode = txn->GetTableLocks()[table_id];
+  if (table_mode == LockMode::kExclusive || (mode == LockMode::kShared && Covers(table_mode, LockMode::kShared))) {
+    return true;
+  }
+  auto &row_locks = txn->GetRowLocks();
+  auto held = row_locks.find(rid.Get());
+  if (held != row_locks.end() && Covers(held->second, mode)) {
+    return true;
+  }
+  if (!Lock(txn, LockKey{false, rid.Get()}, mode, held == row_locks.end() ? nullptr : &held->second)) {
+    return false;
+  }
+  row_locks[rid.Get()] = mode;
+  return true;
+}
+
+void LockManager::ReleaseAll(Transaction *txn) {
+  for (auto &row_lock : txn->GetRowLocks()) {
+    Unlock(txn, LockKey{false, row_lock.first});
+  }
+  for (auto &table_lock : txn->GetTableLocks()) {
+    Unlock(txn, LockKey{true, table_lock.first});
+  }
+  txn->GetRowLocks().clear();
+  txn->GetTableLocks().clear();
+}
+
+bool LockManager::Lock(Transaction *txn, const LockKey &key, LockMode mode, const LockMode *held) {
+  auto &partition = GetPartition(key);
+  std::unique_lock<std::mutex> lock(partition.latch_);
+  if (txn->GetState() == TxnState::kAborted) {
+    return false;
+  }
+  RequestQueue &queue = partition.queues_[key];
+  auto first_waiting = std::find_if(queue.requests_.begin(), queue.requests_.end(),
+                                    [](const LockRequest &request) { return !request.granted_; });
+  std::list<LockRequest>::iterator request;
+  if (held != nullptr) {
+    // two upgrades each wait for the other to give its lock up
+    if (queue.upgrading_) {
+      txn->SetState(TxnState::kAborted);
+      return false;
+    }
+    auto granted = std::find_if(queue.requests_.begin(), first_waiting,
+                                [txn](const LockRequest &request) { return request.txn_ == txn; });
+    ASSERT(granted != first_waiting, "Upgrading a lock not held.");
+    queue.requests_.erase(granted);
+    request = queue.requests_.insert(first_waiting, LockRequest{txn, mode, false});
+    queue.upgrading_ = true;
+  } else {
+    request = queue.requests_.insert(queue.requests_.end(), LockRequest{txn, mode, false});
+  }
+  queue.cv_.wait(lock, [&] { return txn->GetState() == TxnState::kAborted || Grantable(queue, request); });
+  if (held != nullptr) {
+    queue.upgrading_ = false;
+  }
+  bool granted = txn->GetState() != TxnState::kAborted;
+  if (granted) {
+    request->granted_ = true;
+  } else if (held != nullptr) {
+    // still holds what it had, until the rollback releases it
+    request->mode_ = *held;
+    request->granted_ = true;
+  } else {
+    queue.requests_.erase(request);
+  }
+  // requests behind may be grantable now, together with this one or after it left
+  queue.cv_.notify_all();
+  return granted;
+}
+
+void LockManager::Unlock(Transaction *txn, const LockKey &key) {
+  auto &partition = GetPartition(key);
+  std::scoped_lock<std::mutex> lock(partition.latch_);
+  auto queue = partition.queues_.find(key);
+  if (queue == partition.queues_.end()) {
+    return;
+  }
+  auto &requests = queue->second.requests_;
+  requests.remove_if([txn](const LockRequest &request) { return request.txn_ == txn; });
+  if (requests.empty()) {
+    partition.queues_.erase(queue);
+  } else {
+    queue->second.cv_.notify_all();
+  }
+}
+
+bool LockManager::Grantable(const RequestQueue &queue, std::list<LockRequest>::iterator request) {
+  for (auto it = queue.requests_.begin(); it != request; ++it) {
+    if (!it->granted_ || !Compatible(it->mode_, request->mode_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LockManager::Compatible(LockMode held, LockMode requested) {
+  switch (held) {
+    case LockMode::kIntentionShared:
+      return requested != LockMode::kExclusive;
+    case LockMode::kIntentionExclusive:
+      return requested == LockMode::kIntentionShared || requested == LockMode::kIntentionExclusive;
+    case LockMode::kShared:
+      return requested == LockMode::kIntentionShared || requested == LockMode::kShared;
+    case LockMode::kSharedIntentionExclusive:
+      return requested == LockMode::kIntentionShared;
+    default:
+      return false;
+  }
+}
+
+bool LockManager::Covers(LockMode held, LockMode requested) {
+  if (held == requested || requested == LockMode::kIntentionShared) {
+    return true;
+  }
+  switch (held) {
+    case LockMode::kSharedIntentionExclusive:
+      return requested != LockMode::kExclusive;
+    case LockMode::kExclusive:
+      return true;
+    default:
+      return false;
+  }
+}
+
+LockMode LockManager::Combine(LockMode a, LockMode b) {
+  if (Covers(a, b)) {
+    return a;
+  }
+  if (Covers(b, a)) {
+    return b;
+  }
+  // IX and S
+  return LockMode::kSharedIntentionExclusive;
+}
+
+size_t LockManager::DetectDeadlocks() {
+  // a transaction waits for one lock at a time, latching every partition gives a consistent graph
+  std::vector<std::unique_lock<std::mutex>> locks;
+  for (auto &partition : partitions_) {
+    locks.emplace_back(partition.latch_);
+  }
+  std::map<txn_id_t, std::set<txn_id_t>> waits_for;
+  std::unordered_map<txn_id_t, std::pair<Transaction *, RequestQueue *>> waiting;
+  for (auto &partition : partitions_) {
+    for (auto &queue : partition.queues_) {
+      auto &requests = queue.second.requests_;
+      for (auto waiter = requests.begin(); waiter != requests.end(); ++waiter) {
+        if (waiter->granted_ || waiter->txn_->GetState() == TxnState::kAborted) {
+          continue;
+        }
+        txn_id_t waiter_id = waiter->txn_->GetTxnId();
+        waiting[waiter_id] = {waiter->txn_, &queue.second};
+        // granting is FIFO, a waiter waits for every request ahead of it still waiting as well, even a
+        // compatible one
+        for (auto it = requests.begin(); it != waiter; ++it) {
+          if (it->txn_ != waiter->txn_ && (!it->granted_ || !Compatible(it->mode_, waiter->mode_))) {
+            waits_for[waiter_id].insert(it->txn_->GetTxnId());
+          }
+        }
+      }
+    }
+  }
+  size_t aborted = 0;
+  while (true) {
+    // depth first search, the path on the stack is closed into a cycle by an edge back into it
+    std::vector<txn_id_t> cycle;
+    std::set<txn_id_t> visited;
+    std::vector<txn_id_t> path;
+    std::function<bool(txn_id_t)> visit = [&](txn_id_t txn_id) {
+      visited.insert(txn_id);
+      path.push_back(txn_id);
+      auto edges = waits_for.find(txn_id);
+      if (edges != waits_for.end()) {
+        for (txn_id_t next : edges->second) {
+          auto on_path = std::find(path.begin(), path.end(), next);
+          if (on_path != path.end()) {
+            cycle.assign(on_path, path.end());
+            return true;
+          }
+          if (visited.count(next) == 0 && visit(next)) {
+            return true;
+          }
+        }
+      }
+      path.pop_back();
+      return false;
+    };
+    for (auto &edges : waits_for) {
+      if (visited.count(edges.first) == 0 && visit(edges.first)) {
+        break;
+      }
+    }
+    if (cycle.empty()) {
+      break;
+    }
+    // the youngest transaction has done the least work to roll back
+    txn_id_t victim = *std::max_element(cycle.begin(), cycle.end());
+    LOG(INFO) << "Deadlock, aborting transaction " << victim;
+    auto &waiter = waiting[victim];
+    waiter.first->SetState(TxnState::kAborted);
+    waiter.second->cv_.notify_all();
+    waits_for.erase(victim);
+    for (auto &edges : waits_for) {
+      edges.second.erase(victim);
+    }
+    aborted++;
+  }
+  return aborted;
+}
+
+void LockManager::DetectionWorker() {
+  std::unique_lock<std::mutex> lock(detection_latch_);
+  while (!shutdown_) {
+    shutdown_cv_.wait_for(lock, std::chrono::milliseconds(DEADLOCK_DETECTION_INTERVAL), [this] { return shutdown_; });
+    if (shutdown_) {
+      break;
+    }
+    lock.unlock();
+    DetectDeadlocks();
+    lock.lock();
+  }
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/falloc.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "glog/logging.h"
+#include "transaction/log_manager.h"
+
+LogManager::LogManager(const std::string &log_file, uint64_t start_offset) {
+  log_fd_ = open(log_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (log_fd_ < 0) {
+    throw std::exception();
+  }
+  lsn_t last_lsn = INVALID_LSN;
+  file_size_ = ReadLog(start_offset, [&last_lsn](const LogRecord &record, uint64_t) {
+    last_lsn = record.GetLSN();
+    return true;
+  });
+  struct stat stat_buf;
+  if (fstat(log_fd_, &stat_buf) == 0 && static_cast<uint64_t>(stat_buf.st_size) > file_size_) {
+    LOG(WARNING) << "Cut " << stat_buf.st_size - file_size_ << " bytes of torn records off the log";
+    if (ftruncate(log_fd_, file_size_) != 0) {
+      LOG(ERROR) << "I/O error while truncating the log";
+    }
+  }
+  append_offset_ = file_size_;
+  next_lsn_ = last_lsn == INVALID_LSN ? 1 : last_lsn + 1;
+  persistent_lsn_ = last_lsn;
+  log_buffer_.reserve(LOG_BUFFER_SIZE);
+  flush_buffer_.reserve(LOG_BUFFER_SIZE);
+  flush_thread_ = std::thread(&LogManager::FlushWorker, this);
+}
+
+LogManager::~LogManager() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    shutdown_ = true;
+  }
+  flush_cv_.notify_one();
+  flush_thread_.join();
+  close(log_fd_);
+}
+
+lsn_t LogManager::AppendLogRecord(LogRecord &log_record, uint64_t *offset) {
+  uint32_t size = log_record.GetSize();
+  ASSERT(size <= LOG_BUFFER_SIZE, "Log record larger than the log buffer.");
+  std::unique_lock<std::mutex> lock(latch_);
+  while (log_buffer_.size() + size > LOG_BUFFER_SIZE) {
+    flush_requested_ = true;
+    flush_cv_.notify_one();
+    space_cv_.wait(lock);
+  }
+  log_record.SetLSN(next_lsn_++);
+  if (offset != nullptr) {
+    *offset = append_offset_;
+  }
+  append_offset_ += size;
+  size_t pos = log_buffer_.size();
+  log_buffer_.resize(pos + size);
+  log_record.SerializeTo(log_buffer_.data() + pos);
+  // wake the flusher early once half of the buffer is used, appends need not wait for it then
+  if (log_buffer_.size() >= LOG_BUFFER_SIZE / 2) {
+    flush_cv_.notify_one();
+  }
+  return log_record.GetLSN();
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock<std::mutex> lock(latch_);
+  lsn = std::min(lsn, next_lsn_ - 1);
+  while (persistent_lsn_.load() < lsn) {
+    flush_requested_ = true;
+    flush_cv_.notify_one();
+    persisted_cv_.wait(lock);
+  }
+}
+
+void LogManager::Flush() {
+  Flush(GetNextLSN() - 1);
+}
+
+lsn_t LogManager::GetNextLSN() const {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return next_lsn_;
+}
+
+void LogManager::GetAppendPosition(lsn_t &next_lsn, uint64_t &offset) const {
+  std::scoped_lock<std::mutex> lock(latch_);
+  next_lsn = next_lsn_;
+  offset = append_offset_;
+}
+
+void LogManager::Truncate(uint64_t offset) {
+  // whole blocks only, the hole reads back as zeros
+  off_t length = static_cast<off_t>(offset / 4096 * 4096);
+  if (length > 0 && fallocate(log_fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, 0, length) != 0) {
+    LOG(WARNING) << "Failed to truncate the log, the file system may not support punching holes";
+  }
+}
+
+void LogManager::FlushWorker() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    flush_cv_.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL), [this] {
+      return shutdown_ || flush_requested_ || log_buffer_.size() >= LOG_BUFFER_SIZE / 2;
+    });
+    flush_requested_ = false;
+    if (log_buffer_.empty()) {
+      if (shutdown_) {
+        return;
+      }
+      continue;
+    }
+    // take every record appended so far, later appends go to the other buffer
+    log_buffer_.swap(flush_buffer_);
+    lsn_t flush_lsn = next_lsn_ - 1;
+    space_cv_.notify_all();
+    lock.unlock();
+    // a short write goes on from where it stopped, the records are on disk only once written and synced
+    size_t write_count = 0;
+    while (write_count < flush_buffer_.size()) {
+      ssize_t ret = pwrite(log_fd_, flush_buffer_.data() + write_count, flush_buffer_.size() - write_count,
+                           file_size_ + write_count);
+      if (ret < 0 && (errno == EINTR || errno == EAGAIN)) {
+        continue;
+      }
+      // committers wait for these records, none of them may be told its transaction is durable
+      if (ret <= 0) {
+        LOG(FATAL) << "I/O error while writing the log at offset " << file_size_ + write_count << ": "
+                   << strerror(errno);
+      }
+      write_count += ret;
+    }
+    // after a failed sync the kernel may drop the dirty pages, a second sync would succeed without them
+    if (fdatasync(log_fd_) != 0) {
+      LOG(FATAL) << "I/O error while syncing the log: " << strerror(errno);
+    }
+    file_size_ += write_count;
+    sync_count_++;
+    flush_buffer_.clear();
+    lock.lock();
+    persistent_lsn_ = flush_lsn;
+    persisted_cv_.notify_all();
+  }
+}
+
+uint64_t LogManager::ReadLog(uint64_t offset,
+                             const std::function<bool(const LogRecord &record, uint64_t offset)> &visit) const {
+  // records never span more than LOG_BUFFER_SIZE, read twice that much at a time
+  std::vector<char> buffer(2 * LOG_BUFFER_SIZE);
+  size_t begin = 0;
+  size_t end = 0;
+  bool eof = false;
+  LogRecord record;
+  while (true) {
+    uint32_t size = LogRecord::DeserializeFrom(buffer.data() + begin, end - begin, record);
+    if (size == 0) {
+      // a record that does not fit in a full buffer is garbage as well
+      if (eof || (begin == 0 && end == buffer.size())) {
+        return offset;
+      }
+      // move the partial record to the front and read more behind it
+      memmove(buffer.data(), buffer.data() + begin, end - begin);
+      end -= begin;
+      begin = 0;
+      while (end < buffer.size()) {
+        ssize_t ret = pread(log_fd_, buffer.data() + end, buffer.size() - end, offset + end);
+        if (ret < 0 && errno == EINTR) {
+          continue;
+        }
+        if (ret <= 0) {
+          eof = true;
+          break;
+        }
+        end += ret;
+      }
+      continue;
+    }
+    if (!visit(record, offset)) {
+      return offset + size;
+    }
+    begin += size;
+    offset += size;
+  }
+}
@@ -0,0 +1,233 @@
+#include "common/macros.h"
+#include "transaction/log_record.h"
+
+void LogRecord::AddPage(page_id_t page_id, bool lsn_slot, bool new_page) {
+  page_offsets_.push_back(pages_.size());
+  pages_.resize(pages_.size() + PAGE_WRITE_HEADER_SIZE);
+  char *entry = &pages_[page_offsets_.back()];
+  MACH_WRITE_TO(page_id_t, entry, page_id);
+  MACH_WRITE_UINT32(entry + 4, (lsn_slot ? PAGE_LSN_SLOT : 0) | (new_page ? PAGE_NEW : 0));
+  MACH_WRITE_UINT32(entry + 8, 0);
+}
+
+void LogRecord::AddRun(uint16_t offset, const char *data, uint16_t length) {
+  ASSERT(!page_offsets_.empty(), "Runs only belong to page writes.");
+  uint32_t index = GetPageCount() - 1;
+  size_t pos = pages_.size();
+  pages_.resize(pos + RUN_HEADER_SIZE + length);
+  MACH_WRITE_TO(uint16_t, &pages_[pos], offset);
+  MACH_WRITE_TO(uint16_t, &pages_[pos + 2], length);
+  memcpy(&pages_[pos + RUN_HEADER_SIZE], data, length);
+  MACH_WRITE_UINT32(&pages_[page_offsets_[index] + 8], GetRunCount(index) + 1);
+}
+
+void LogRecord::AddFreedPage(page_id_t page_id) {
+  AddPage(page_id, false, false);
+  MACH_WRITE_UINT32(&pages_[page_offsets_.back() + 4], PAGE_FREED);
+}
+
+LogRecord LogRecord::InsertTuples(const std::vector<RowId> &rids) {
+  LogRecord record(LogRecordType::kInsertTuples);
+  record.AppendToBody(static_cast<uint32_t>(rids.size()));
+  for (auto &rid : rids) {
+    record.AppendToBody(rid.Get());
+  }
+  return record;
+}
+
+LogRecord LogRecord::TupleWrite(LogRecordType type, const RowId &rid, const char *tuple, uint32_t size) {
+  LogRecord record(type);
+  record.AppendToBody(rid.Get());
+  if (size > 0) {
+    record.body_.append(tuple, size);
+  }
+  return record;
+}
+
+LogRecord LogRecord::KeyWrite(LogRecordType type, index_id_t index_id, const RowId &rid, const std::string &key) {
+  LogRecord record(type);
+  record.AppendToBody(index_id);
+  record.AppendToBody(rid.Get());
+  record.body_.append(key);
+  return record;
+}
+
+LogRecord LogRecord::BulkLoad(index_id_t index_id) {
+  LogRecord record(LogRecordType::kBulkLoad);
+  record.AppendToBody(index_id);
+  return record;
+}
+
+LogRecord LogRecord::Compensate(lsn_t undo_next_lsn) {
+  LogRecord record(LogRecordType::kCompensate);
+  record.AppendToBody(undo_next_lsn);
+  return record;
+}
+
+LogRecord LogRecord::Checkpoint(lsn_t begin_lsn, uint64_t begin_offset, txn_id_t next_txn_id,
+                                const std::vector<DirtyPage> &dirty_pages, const std::vector<ActiveTxn> &active_txns) {
+  LogRecord record(LogRecordType::kCheckpoint);
+  record.AppendToBody(begin_lsn);
+  record.AppendToBody(begin_offset);
+  record.AppendToBody(next_txn_id);
+  record.AppendToBody(static_cast<uint32_t>(dirty_pages.size()));
+  for (auto &dirty_page : dirty_pages) {
+    record.AppendToBody(dirty_page.page_id_);
+    record.AppendToBody(dirty_page.rec_lsn_);
+    record.AppendToBody(dirty_page.rec_offset_);
+  }
+  record.AppendToBody(static_cast<uint32_t>(active_txns.size()));
+  for (auto &active_txn : active_txns) {
+    record.AppendToBody(active_txn.txn_id_);
+    record.AppendToBody(active_txn.first_offset_);
+  }
+  return record;
+}
+
+page_id_t LogRecord::GetPageId(uint32_t index) const {
+  return MACH_READ_FROM(page_id_t, pages_.data() + page_offsets_[index]);
+}
+
+bool LogRecord::HasLSNSlot(uint32_t index) const {
+  return (MACH_READ_UINT32(pages_.data() + page_offsets_[index] + 4) & PAGE_LSN_SLOT) != 0;
+}
+
+bool LogRecord::IsNewPage(uint32_t index) const {
+  return (MACH_READ_UINT32(pages_.data() + page_offsets_[index] + 4) & PAGE_NEW) != 0;
+}
+
+bool LogRecord::IsFreedPage(uint32_t index) const {
+  return (MACH_READ_UINT32(pages_.data() + page_offsets_[index] + 4) & PAGE_FREED) != 0;
+}
+
+uint32_t LogRecord::GetRunCount(uint32_t index) const {
+  return MACH_READ_UINT32(pages_.data() + page_offsets_[index] + 8);
+}
+
+void LogRecord::ApplyTo(uint32_t index, char *page_data) const {
+  if (IsNewPage(index)) {
+    // the disk may still hold a page freed earlier
+    memset(page_data, 0, PAGE_SIZE);
+  }
+  size_t pos = page_offsets_[index] + PAGE_WRITE_HEADER_SIZE;
+  for (uint32_t i = 0; i < GetRunCount(index); i++) {
+    uint16_t offset = MACH_READ_FROM(uint16_t, pages_.data() + pos);
+    uint16_t length = MACH_READ_FROM(uint16_t, pages_.data() + pos + 2);
+    memcpy(page_data + offset, pages_.data() + pos + RUN_HEADER_SIZE, length);
+    pos += RUN_HEADER_SIZE + length;
+  }
+  if (HasLSNSlot(index)) {
+    // same slot as Page::SetLSN
+    MACH_WRITE_TO(lsn_t, page_data + 4, lsn_);
+  }
+}
+
+void LogRecord::ClearPages() {
+  std::string().swap(pages_);
+  std::vector<uint32_t>().swap(page_offsets_);
+}
+
+std::vector<RowId> LogRecord::GetRowIds() const {
+  std::vector<RowId> rids(MACH_READ_UINT32(body_.data()));
+  for (size_t i = 0; i < rids.size(); i++) {
+    rids[i] = RowId(MACH_READ_FROM(int64_t, body_.data() + 4 + i * sizeof(int64_t)));
+  }
+  return rids;
+}
+
+RowId LogRecord::GetRowId() const {
+  size_t pos = type_ == LogRecordType::kInsertKey || type_ == LogRecordType::kRemoveKey ? sizeof(index_id_t) : 0;
+  return RowId(MACH_READ_FROM(int64_t, body_.data() + pos));
+}
+
+std::string LogRecord::GetData() const {
+  size_t pos = type_ == LogRecordType::kInsertKey || type_ == LogRecordType::kRemoveKey ? sizeof(index_id_t) : 0;
+  return body_.substr(pos + sizeof(int64_t));
+}
+
+index_id_t LogRecord::GetIndexId() const {
+  return MACH_READ_FROM(index_id_t, body_.data());
+}
+
+lsn_t LogRecord::GetUndoNextLSN() const {
+  return MACH_READ_FROM(lsn_t, body_.data());
+}
+
+void LogRecord::GetCheckpoint(lsn_t &begin_lsn, uint64_t &begin_offset, txn_id_t &next_txn_id,
+                              std::vector<DirtyPage> &dirty_pages, std::vector<ActiveTxn> &active_txns) const {
+  const char *pos = body_.data();
+  begin_lsn = MACH_READ_FROM(lsn_t, pos);
+  begin_offset = MACH_READ_FROM(uint64_t, pos + 4);
+  next_txn_id = MACH_READ_FROM(txn_id_t, pos + 12);
+  pos += 16;
+  dirty_pages.resize(MACH_READ_UINT32(pos));
+  pos += 4;
+  for (auto &dirty_page : dirty_pages) {
+    dirty_page.page_id_ = MACH_READ_FROM(page_id_t, pos);
+    dirty_page.rec_lsn_ = MACH_READ_FROM(lsn_t, pos + 4);
+    dirty_page.rec_offset_ = MACH_READ_FROM(uint64_t, pos + 8);
+    pos += 16;
+  }
+  active_txns.resize(MACH_READ_UINT32(pos));
+  pos += 4;
+  for (auto &active_txn : active_txns) {
+    active_txn.txn_id_ = MACH_READ_FROM(txn_id_t, pos);
+    active_txn.first_offset_ = MACH_READ_FROM(uint64_t, pos + 4);
+    pos += 12;
+  }
+}
+
+void LogRecord::SerializeTo(char *buf) const {
+  MACH_WRITE_UINT32(buf, GetSize());
+  MACH_WRITE_TO(lsn_t, buf + 8, lsn_);
+  MACH_WRITE_TO(txn_id_t, buf + 12, txn_id_);
+  MACH_WRITE_TO(lsn_t, buf + 16, prev_lsn_);
+  MACH_WRITE_UINT32(buf + 20, static_cast<uint32_t>(type_));
+  MACH_WRITE_UINT32(buf + 24, pages_.size());
+  MACH_WRITE_UINT32(buf + 28, GetPageCount());
+  memcpy(buf + HEADER_SIZE, pages_.data(), pages_.size());
+  memcpy(buf + HEADER_SIZE + pages_.size(), body_.data(), body_.size());
+  MACH_WRITE_UINT32(buf + 4, Checksum(buf + 8, GetSize() - 8));
+}
+
+uint32_t LogRecord::DeserializeFrom(const char *buf, size_t size, LogRecord &record) {
+  if (size < HEADER_SIZE) {
+    return 0;
+  }
+  uint32_t record_size = MACH_READ_UINT32(buf);
+  if (record_size < HEADER_SIZE || record_size > size ||
+      MACH_READ_UINT32(buf + 4) != Checksum(buf + 8, record_size - 8)) {
+    return 0;
+  }
+  uint32_t pages_size = MACH_READ_UINT32(buf + 24);
+  if (pages_size > record_size - HEADER_SIZE) {
+    return 0;
+  }
+  record.lsn_ = MACH_READ_FROM(lsn_t, buf + 8);
+  record.txn_id_ = MACH_READ_FROM(txn_id_t, buf + 12);
+  record.prev_lsn_ = MACH_READ_FROM(lsn_t, buf + 16);
+  record.type_ = static_cast<LogRecordType>(MACH_READ_UINT32(buf + 20));
+  record.pages_.assign(buf + HEADER_SIZE, pages_size);
+  record.body_.assign(buf + HEADER_SIZE + pages_size, record_size - HEADER_SIZE - pages_size);
+  // find where every page write starts
+  record.page_offsets_.resize(MACH_READ_UINT32(buf + 28));
+  size_t pos = 0;
+  for (auto &page_offset : record.page_offsets_) {
+    page_offset = pos;
+    uint32_t run_count = MACH_READ_UINT32(record.pages_.data() + pos + 8);
+    pos += PAGE_WRITE_HEADER_SIZE;
+    for (uint32_t i = 0; i < run_count; i++) {
+      pos += RUN_HEADER_SIZE + MACH_READ_FROM(uint16_t, record.pages_.data() + pos + 2);
+    }
+  }
+  return record_size;
+}
+
+uint32_t LogRecord::Checksum(const char *data, size_t size) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * 16777619u;
+  }
+  return hash;
+}
@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+#include "catalog/catalog.h"
+#include "glog/logging.h"
+#include "page/table_page.h"
+#include "transaction/recovery_manager.h"
+
+void RecoveryManager::Redo() {
+  // the record at the checkpoint offset tells where the log has to be read from
+  uint64_t checkpoint_offset = disk_manager_->GetCheckpointOffset();
+  LogRecord checkpoint;
+  log_manager_->ReadLog(checkpoint_offset, [&checkpoint](const LogRecord &record, uint64_t) {
+    checkpoint = record;
+    return false;
+  });
+  lsn_t begin_lsn = INVALID_LSN;
+  uint64_t scan_offset = 0;
+  std::unordered_map<page_id_t, lsn_t> dirty_pages;
+  if (checkpoint.GetType() == LogRecordType::kCheckpoint) {
+    std::vector<DirtyPage> dirty_page_table;
+    std::vector<ActiveTxn> active_txns;
+    checkpoint.GetCheckpoint(begin_lsn, scan_offset, next_txn_id_, dirty_page_table, active_txns);
+    for (auto &dirty_page : dirty_page_table) {
+      dirty_pages[dirty_page.page_id_] = dirty_page.rec_lsn_;
+      scan_offset = std::min(scan_offset, dirty_page.rec_offset_);
+    }
+    for (auto &active_txn : active_txns) {
+      scan_offset = std::min(scan_offset, active_txn.first_offset_);
+    }
+  }
+  size_t redo_count = 0;
+  log_manager_->ReadLog(scan_offset, [&](const LogRecord &record, uint64_t offset) {
+    lsn_t lsn = record.GetLSN();
+    for (uint32_t i = 0; i < record.GetPageCount(); i++) {
+      if (lsn < begin_lsn) {
+        // the disk has every earlier change of a page which was clean at the checkpoint
+        auto iter = dirty_pages.find(record.GetPageId(i));
+        if (iter == dirty_pages.end() || lsn < iter->second) {
+          continue;
+        }
+      }
+      buffer_pool_manager_->RedoPageWrite(record, i, offset);
+      redo_count++;
+    }
+    txn_id_t txn_id = record.GetTxnId();
+    if (txn_id == INVALID_TXN_ID) {
+      return true;
+    }
+    next_txn_id_ = std::max(next_txn_id_, txn_id + 1);
+    switch (record.GetType()) {
+      case LogRecordType::kCommit:
+      case LogRecordType::kAbort:
+        losers_.erase(txn_id);
+        break;
+      case LogRecordType::kCompensate: {
+        // the records after the undo-next one are undone already
+        LoserTxn &loser = losers_[txn_id];
+        loser.last_lsn_ = lsn;
+        while (!loser.records_.empty() && loser.records_.back().GetLSN() > record.GetUndoNextLSN()) {
+          loser.records_.pop_back();
+        }
+        break;
+      }
+      case LogRecordType::kInsertTuples:
+      case LogRecordType::kMarkDelete:
+      case LogRecordType::kRollbackDelete:
+      case LogRecordType::kApplyDelete:
+      case LogRecordType::kUpdateTuple:
+      case LogRecordType::kInsertKey:
+      case LogRecordType::kRemoveKey:
+      case LogRecordType::kBulkLoad: {
+        LoserTxn &loser = losers_[txn_id];
+        loser.last_lsn_ = lsn;
+        loser.records_.push_back(record);
+        loser.records_.back().ClearPages();
+        break;
+      }
+      default:
+        losers_[txn_id].last_lsn_ = lsn;
+        break;
+    }
+    return true;
+  });
+  LOG(INFO) << "Redid " << redo_count << " page writes, " << losers_.size() << " transactions to roll back";
+}
+
+void RecoveryManager::Undo(CatalogManager *catalog) {
+  // roll back all losers together, newest record first
+  std::vector<std::pair<lsn_t, txn_id_t>> order;
+  std::unordered_map<txn_id_t, Transaction> txns;
+  for (auto &loser : losers_) {
+    for (auto &record : loser.second.records_) {
+      order.emplace_back(record.GetLSN(), loser.first);
+    }
+    Transaction txn(loser.first);
+    txn.SetPrevLSN(loser.second.last_lsn_);
+    txns.emplace(loser.first, txn);
+  }
+  std::sort(order.begin(), order.end(), std::greater<>());
+  for (auto &entry : order) {
+    LoserTxn &loser = losers_[entry.second];
+    const LogRecord &record = loser.records_.back();
+    // the undo and its compensation record are redone together or not at all
+    buffer_pool_manager_->BeginAtomic();
+    UndoRecord(record, buffer_pool_manager_, catalog);
+    LogRecord compensate = LogRecord::Compensate(record.GetPrevLSN());
+    buffer_pool_manager_->EndAtomic(&txns.at(entry.second), &compensate);
+    loser.records_.pop_back();
+  }
+  for (auto &txn : txns) {
+    LogRecord record(txn.first, txn.second.GetPrevLSN(), LogRecordType::kAbort);
+    log_manager_->AppendLogRecord(record);
+  }
+  log_manager_->Flush();
+  if (!losers_.empty()) {
+    LOG(INFO) << "Rolled back " << losers_.size() << " transactions";
+  }
+  losers_.clear();
+}
+
+void RecoveryManager::UndoRecord(const LogRecord &record, BufferPoolManager *buffer_pool_manager,
+                                 CatalogManager *catalog) {
+  // heap changes are undone on their page, the free-space map is left to correct itself on the next insert
+  auto undo_tuple = [buffer_pool_manager](const RowId &rid, const std::function<void(TablePage *page)> &undo) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(rid.GetPageId()));
+    if (page == nullptr) {
+      LOG(WARNING) << "Page " << rid.GetPageId() << " to undo is gone";
+      return;
+    }
+    page->WLatch();
+    undo(page);
+    page->WUnlatch();
+    buffer_pool_manager->UnpinPage(rid.GetPageId(), true);
+  };
+  std::string data;
+  switch (record.GetType()) {
+    case LogRecordType::kInsertTuples:
+      for (auto &rid : record.GetRowIds()) {
+        undo_tuple(rid, [&](TablePage *page) {
+          if (page->GetTupleData(rid, data)) {
+            page->ApplyDelete(rid, nullptr, nullptr);
+          }
+        });
+      }
+      break;
+    case LogRecordType::kMarkDelete:
+      undo_tuple(record.GetRowId(), [&](TablePage *page) {
+        if (page->GetTupleData(record.GetRowId(), data)) {
+          page->RollbackDelete(record.GetRowId(), nullptr, nullptr);
+        }
+      });
+      break;
+    case LogRecordType::kRollbackDelete:
+      undo_tuple(record.GetRowId(), [&](TablePage *page) {
+        if (page->GetTupleData(record.GetRowId(), data)) {
+          page->MarkDelete(record.GetRowId(), nullptr, nullptr, nullptr);
+        }
+      });
+      break;
+    case LogRecordType::kApplyDelete:
+    case LogRecordType::kUpdateTuple:
+      data = record.GetData();
+      undo_tuple(record.GetRowId(), [&](TablePage *page) {
+        // the transaction kept the bytes of the old tuple until its end, failing here means the page is broken
+        if (!page->RestoreTuple(record.GetRowId(), data.data(), data.size())) {
+          LOG(FATAL) << "Cannot put tuple " << record.GetRowId().Get() << " back, the recovery is incomplete";
+        }
+      });
+      break;
+    case LogRecordType::kInsertKey:
+    case LogRecordType::kRemoveKey:
+    case LogRecordType::kBulkLoad: {
+      IndexInfo *index_info = nullptr;
+      if (catalog == nullptr || catalog->GetIndex(record.GetIndexId(), index_info) != DB_SUCCESS) {
+        // the index was dropped since, or never made it into the catalog
+        break;
+      }
+      Index *index = index_info->GetIndex();
+      if (record.GetType() == LogRecordType::kBulkLoad) {
+        index->Clear();
+        break;
+      }
+      data = record.GetData();
+      Row key(INVALID_ROWID);
+      key.DeserializeFrom(&data[0], index_info->GetIndexKeySchema());
+      RowId rid = record.GetRowId();
+      if (record.GetType() == LogRecordType::kRemoveKey) {
+        index->InsertEntry(key, rid, nullptr);
+        break;
+      }
+      // remove the entry only if the key still leads to this row
+      std::vector<RowId> rids;
+      index->ScanKey(key, rids, nullptr);
+      if (std::find(rids.begin(), rids.end(), rid) != rids.end()) {
+        index->RemoveEntry(key, rid, nullptr);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
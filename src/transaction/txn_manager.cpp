@@ -0,0 +1,164 @@
+#include <algorithm>
+
+#include "glog/logging.h"
+#include "index/index.h"
+#include "storage/table_heap.h"
+#include "transaction/txn_manager.h"
+
+TxnManager::~TxnManager() {
+  for (auto &txn : txns_) {
+    delete txn.second;
+  }
+}
+
+Transaction *TxnManager::Begin() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto *txn = new Transaction(next_txn_id_++);
+  txn->SetReadTs(last_commit_ts_);
+  if (log_manager_ != nullptr) {
+    // appended under the latch, so a checkpoint either sees the transaction or comes before its begin
+    LogRecord record(txn->GetTxnId(), INVALID_LSN, LogRecordType::kBegin);
+    uint64_t offset;
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(record, &offset));
+    txn->SetFirstOffset(offset);
+  }
+  txns_.emplace(txn->GetTxnId(), txn);
+  return txn;
+}
+
+void TxnManager::Commit(Transaction *txn) {
+  // the deletes are applied before the commit record, a crash in between rolls them back with the rest
+  txn->SetState(TxnState::kCommitted);
+  std::vector<std::pair<TableHeap *, RowId>> updated;
+  for (auto &write : txn->GetWriteSet()) {
+    if (write.table_heap_ != nullptr && write.wtype_ == WType::kDelete) {
+      write.table_heap_->ApplyDelete(write.rids_[0], txn);
+    } else if (write.table_heap_ != nullptr && write.wtype_ == WType::kUpdate) {
+      updated.emplace_back(write.table_heap_, write.rids_[0]);
+    }
+  }
+  txn->GetWriteSet().clear();
+  lsn_t lsn = End(txn, LogRecordType::kCommit);
+  // the space kept for the rollback of the updates is given back only after the commit record
+  for (auto &update : updated) {
+    update.first->ReleaseTupleSpace(update.second);
+  }
+  {
+    // stamped under the latch, a transaction beginning sees all of the commit or none of it
+    std::scoped_lock<std::mutex> lock(latch_);
+    last_commit_ts_++;
+    if (version_store_ != nullptr) {
+      version_store_->Commit(txn->GetTxnId(), last_commit_ts_);
+    }
+  }
+  if (lock_manager_ != nullptr) {
+    lock_manager_->ReleaseAll(txn);
+  }
+  if (version_store_ != nullptr) {
+    version_store_->CollectGarbage(GetOldestReadTs());
+  }
+  if (lsn != INVALID_LSN) {
+    log_manager_->Flush(lsn);
+  }
+  delete txn;
+}
+
+void TxnManager::Abort(Transaction *txn) {
+  txn->SetState(TxnState::kAborted);
+  auto &write_set = txn->GetWriteSet();
+  std::vector<std::pair<TableHeap *, RowId>> updated;
+  while (!write_set.empty()) {
+    WriteRecord &write = write_set.back();
+    // the undo is made without the transaction, so it is not remembered again, and logged as one compensation
+    buffer_pool_manager_->BeginAtomic();
+    if (write.table_heap_ != nullptr) {
+      TableHeap *table_heap = write.table_heap_;
+      switch (write.wtype_) {
+        case WType::kInsert:
+          for (auto rid = write.rids_.rbegin(); rid != write.rids_.rend(); ++rid) {
+            table_heap->ApplyDelete(*rid, nullptr);
+          }
+          break;
+        case WType::kDelete:
+          table_heap->RollbackDelete(write.rids_[0], nullptr);
+          break;
+        case WType::kUpdate:
+          // the update kept the bytes of the old tuple, failing here means the page is broken
+          if (!table_heap->RollbackUpdate(write.row_, write.rids_[0])) {
+            LOG(FATAL) << "Cannot put tuple " << write.rids_[0].Get() << " back, the abort is incomplete";
+          }
+          updated.emplace_back(table_heap, write.rids_[0]);
+          break;
+        default:
+          break;
+      }
+    } else {
+      Index *index = write.index_;
+      switch (write.wtype_) {
+        case WType::kInsert:
+          index->RemoveEntry(write.row_, write.rids_[0], nullptr);
+          break;
+        case WType::kDelete:
+          index->InsertEntry(write.row_, write.rids_[0], nullptr);
+          break;
+        case WType::kBulkLoad:
+          index->Clear();
+          break;
+        default:
+          break;
+      }
+    }
+    LogRecord record = LogRecord::Compensate(write.undo_next_lsn_);
+    buffer_pool_manager_->EndAtomic(txn, &record);
+    write_set.pop_back();
+  }
+  // an abort need not be on disk, without its record the recovery finds nothing left to undo
+  End(txn, LogRecordType::kAbort);
+  for (auto &update : updated) {
+    update.first->ReleaseTupleSpace(update.second);
+  }
+  if (version_store_ != nullptr) {
+    version_store_->Abort(txn->GetTxnId());
+  }
+  if (lock_manager_ != nullptr) {
+    lock_manager_->ReleaseAll(txn);
+  }
+  delete txn;
+}
+
+lsn_t TxnManager::End(Transaction *txn, LogRecordType type) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  lsn_t lsn = INVALID_LSN;
+  if (log_manager_ != nullptr) {
+    LogRecord record(txn->GetTxnId(), txn->GetPrevLSN(), type);
+    lsn = log_manager_->AppendLogRecord(record);
+  }
+  txns_.erase(txn->GetTxnId());
+  return lsn;
+}
+
+void TxnManager::GetActiveTxns(std::vector<ActiveTxn> &active_txns) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto &txn : txns_) {
+    active_txns.push_back(ActiveTxn{txn.first, txn.second->GetFirstOffset()});
+  }
+}
+
+txn_id_t TxnManager::GetNextTxnId() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return next_txn_id_;
+}
+
+void TxnManager::SetNextTxnId(txn_id_t next_txn_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  next_txn_id_ = next_txn_id;
+}
+
+timestamp_t TxnManager::GetOldestReadTs() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  timestamp_t oldest_read_ts = last_commit_ts_;
+  for (auto &txn : txns_) {
+    oldest_read_ts = std::min(oldest_read_ts, txn.second->GetReadTs());
+  }
+  return oldest_read_ts;
+}
@@ -0,0 +1,118 @@
+#include "transaction/version_store.h"
+
+void VersionStore::Record(Transaction *txn, const RowId &rid, const std::string *before) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &chain = versions_[rid.Get()];
+  // the tuple before the first change of a transaction is all others may need
+  if (!chain.empty() && chain.back().writer_ == txn->GetTxnId()) {
+    return;
+  }
+  chain.push_back(Version{txn->GetTxnId(), INVALID_TS, before != nullptr, before != nullptr ? *before : ""});
+  running_[txn->GetTxnId()].push_back(rid.Get());
+  version_count_++;
+}
+
+bool VersionStore::Read(Transaction *txn, const RowId &rid, bool &exists, std::string &data) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto chain = versions_.find(rid.Get());
+  if (chain == versions_.end()) {
+    return false;
+  }
+  // undo the changes the snapshot does not see, newest first
+  const Version *visible = nullptr;
+  for (auto version = chain->second.rbegin(); version != chain->second.rend(); ++version) {
+    if (version->writer_ == txn->GetTxnId() || version->commit_ts_ <= txn->GetReadTs()) {
+      break;
+    }
+    visible = &*version;
+  }
+  if (visible == nullptr) {
+    return false;
+  }
+  exists = visible->existed_;
+  if (exists) {
+    data = visible->before_;
+  }
+  return true;
+}
+
+bool VersionStore::Conflicts(Transaction *txn, const RowId &rid) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto chain = versions_.find(rid.Get());
+  if (chain == versions_.end() || chain->second.empty()) {
+    return false;
+  }
+  const Version &newest = chain->second.back();
+  return newest.writer_ != txn->GetTxnId() && newest.commit_ts_ > txn->GetReadTs();
+}
+
+void VersionStore::Commit(txn_id_t txn_id, timestamp_t commit_ts) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto running = running_.find(txn_id);
+  if (running == running_.end()) {
+    return;
+  }
+  for (int64_t rid : running->second) {
+    Find(versions_[rid], txn_id)->commit_ts_ = commit_ts;
+  }
+  committed_.push_back(CommittedTxn{commit_ts, std::move(running->second)});
+  running_.erase(running);
+}
+
+void VersionStore::Abort(txn_id_t txn_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto running = running_.find(txn_id);
+  if (running == running_.end()) {
+    return;
+  }
+  for (int64_t rid : running->second) {
+    auto chain = versions_.find(rid);
+    chain->second.erase(Find(chain->second, txn_id));
+    version_count_--;
+    if (chain->second.empty()) {
+      versions_.erase(chain);
+    }
+  }
+  running_.erase(running);
+}
+
+size_t VersionStore::CollectGarbage(timestamp_t oldest_read_ts) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  size_t dropped = 0;
+  while (!committed_.empty() && committed_.front().commit_ts_ <= oldest_read_ts) {
+    for (int64_t rid : committed_.front().rids_) {
+      auto chain = versions_.find(rid);
+      if (chain == versions_.end()) {
+        continue;
+      }
+      // every snapshot sees the newest committed change, so none reads a version older than it
+      auto &versions = chain->second;
+      size_t keep = versions.size();
+      while (keep > 0 && versions[keep - 1].commit_ts_ > oldest_read_ts) {
+        keep--;
+      }
+      versions.erase(versions.begin(), versions.begin() + keep);
+      dropped += keep;
+      if (versions.empty()) {
+        versions_.erase(chain);
+      }
+    }
+    committed_.pop_front();
+  }
+  version_count_ -= dropped;
+  return dropped;
+}
+
+std::vector<VersionStore::Version>::iterator VersionStore::Find(std::vector<Version> &chain, txn_id_t txn_id) {
+  // usually the newest, but a slot the writer freed may have been taken by an insert meanwhile
+  auto version = chain.end();
+  do {
+    --version;
+  } while (version->writer_ != txn_id);
+  return version;
+}
+
+size_t VersionStore::GetVersionCount() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return version_count_;
+}
@@ -0,0 +1,86 @@
+#include <cctype>
+
+#include "utils/statement_reader.h"
+
+StatementReader::StatementReader(std::string text) : text_(std::move(text)) {
+  data_ = text_.data();
+  size_ = text_.size();
+}
+
+StatementReader::StatementReader(FILE *in) : in_(in) {}
+
+bool StatementReader::Open(const std::string &path) {
+  if (!file_.Open(path)) {
+    return false;
+  }
+  in_ = nullptr;
+  data_ = file_.GetData();
+  size_ = file_.GetSize();
+  pos_ = 0;
+  return true;
+}
+
+bool StatementReader::Next(std::string &statement) {
+  statement.clear();
+  if (in_ == nullptr) {
+    while (pos_ < size_ && isspace(static_cast<unsigned char>(data_[pos_]))) {
+      pos_++;
+    }
+    if (pos_ >= size_) {
+      return false;
+    }
+    size_t len = ScanStatement(pos_);
+    statement.assign(data_ + pos_, len);
+    pos_ += len;
+    return true;
+  }
+  // stream input is read one character at a time so that a statement typed
+  // on a terminal is executed as soon as its ';' arrives
+  int ch;
+  do {
+    ch = getc(in_);
+  } while (ch != EOF && isspace(ch));
+  if (ch == EOF) {
+    return false;
+  }
+  bool in_string = false;
+  bool escaped = false;
+  while (ch != EOF) {
+    statement.push_back(static_cast<char>(ch));
+    if (in_string) {
+      if (escaped) {
+        escaped = false;
+      } else if (ch == '\\') {
+        escaped = true;
+      } else if (ch == '"') {
+        in_string = false;
+      }
+    } else if (ch == '"') {
+      in_string = true;
+    } else if (ch == ';') {
+      break;
+    }
+    ch = getc(in_);
+  }
+  return true;
+}
+
+size_t StatementReader::ScanStatement(size_t pos) const {
+  bool in_string = false;
+  size_t i = pos;
+  for (; i < size_; i++) {
+    char ch = data_[i];
+    if (in_string) {
+      if (ch == '\\') {
+        i++;
+      } else if (ch == '"') {
+        in_string = false;
+      }
+    } else if (ch == '"') {
+      in_string = true;
+    } else if (ch == ';') {
+      return i + 1 - pos;
+    }
+  }
+  return size_ - pos;
+}
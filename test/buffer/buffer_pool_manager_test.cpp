@@ -1,6 +1,9 @@
+#include <algorithm>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
@@ -70,4 +73,232 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
-}
\ No newline at end of file
+}
+TEST(BufferPoolManagerTest, ReplacerPolicyTest) {
+  const std::string db_name = "bpm_test.db";
+  const size_t buffer_pool_size = 10;
+  for (auto replacer_type : {ReplacerType::kLRU, ReplacerType::kLRUK, ReplacerType::kClock}) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, replacer_type);
+    // Scenario: write 3 times as many pages as the pool holds, so every policy has to evict.
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size * 3; i++) {
+      auto *page = bpm->NewPage(page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+      ASSERT_TRUE(bpm->UnpinPage(page_id_temp, true));
+    }
+    // Scenario: every page reads back, and a full pool of pinned pages can not take one more.
+    const auto num_pages = static_cast<page_id_t>(buffer_pool_size * 3);
+    const auto first_pinned = static_cast<page_id_t>(buffer_pool_size * 2);
+    for (page_id_t i = 0; i < num_pages; i++) {
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+      if (i < first_pinned) {
+        ASSERT_TRUE(bpm->UnpinPage(i, false));
+      }
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+    for (page_id_t i = first_pinned; i < num_pages; i++) {
+      ASSERT_TRUE(bpm->UnpinPage(i, false));
+    }
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    disk_manager->Close();
+    delete bpm;
+    delete disk_manager;
+    remove(db_name.c_str());
+  }
+}
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "bpm_test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 64;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    memset(page->GetData(), i, PAGE_SIZE);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  // Scenario: fetch every page right after asking for it and the following ones to be read ahead.
+  // Fetches racing with the background reads must still see the page content.
+  for (int round = 0; round < 4; round++) {
+    for (page_id_t i = 0; i < num_pages; i++) {
+      std::vector<page_id_t> page_ids;
+      for (page_id_t j = i + 1; j < std::min(num_pages, i + 9); j++) {
+        page_ids.push_back(j);
+      }
+      bpm->PrefetchPages(page_ids);
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      ASSERT_EQ(static_cast<char>(i), page->GetData()[0]);
+      ASSERT_EQ(static_cast<char>(i), page->GetData()[PAGE_SIZE - 1]);
+      ASSERT_TRUE(bpm->UnpinPage(i, false));
+    }
+  }
+  // pinning every frame leaves no room for read-ahead, the hints are dropped
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+  }
+  bpm->PrefetchPages({static_cast<page_id_t>(buffer_pool_size), static_cast<page_id_t>(buffer_pool_size + 1)});
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    ASSERT_TRUE(bpm->UnpinPage(i, false));
+  }
+  ASSERT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ConcurrentMissTest) {
+  const std::string db_name = "bpm_test.db";
+  const std::string log_name = "bpm_test.log";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 64;
+  const int num_threads = 4;
+  const int fetches_per_thread = 2000;
+  remove(db_name.c_str());
+  remove(log_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(log_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, ReplacerType::kLRU, log_manager);
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // Scenario: every thread counts its visits to its own pages, which share the frames with the pages of the
+  // others. Most fetches miss and evict a dirty page, the reads and write-backs run without the pool latch
+  // while the other threads go on. No count may get lost.
+  std::vector<uint32_t> visits(num_pages, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::uniform_int_distribution<page_id_t> dist(0, num_pages / num_threads - 1);
+      for (int i = 0; i < fetches_per_thread; i++) {
+        page_id_t target = dist(rng) * num_threads + t;
+        Page *page = bpm->FetchPage(target);
+        ASSERT_NE(nullptr, page);
+        reinterpret_cast<uint32_t *>(page->GetData() + 512)[0]++;
+        visits[target]++;
+        ASSERT_TRUE(bpm->UnpinPage(target, true));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (page_id_t i = 0; i < num_pages; i++) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(visits[i], reinterpret_cast<uint32_t *>(page->GetData() + 512)[0]);
+    ASSERT_TRUE(bpm->UnpinPage(i, false));
+  }
+  ASSERT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete log_manager;
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove(log_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, MissTest) {
+  const std::string db_name = "bpm_test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 1024;
+  const int num_fetches = 20000;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    memset(page->GetData(), i, PAGE_SIZE);
+    bpm->UnpinPage(page_id_temp, true);
+  }
+  // Scenario: random fetches over a working set 64 times the pool, nearly every fetch misses and reads
+  // the page straight into a frame.
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+  for (int i = 0; i < num_fetches; i++) {
+    page_id_t page_id = dist(rng);
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    ASSERT_EQ(static_cast<char>(page_id), page->GetData()[PAGE_SIZE - 1]);
+    bpm->UnpinPage(page_id, false);
+  }
+  ASSERT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, WriteAheadLogTest) {
+  const std::string db_name = "bpm_test.db";
+  const std::string log_name = "bpm_test.log";
+  const size_t buffer_pool_size = 2;
+  remove(db_name.c_str());
+  remove(log_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *log_manager = new LogManager(log_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, ReplacerType::kLRU, log_manager);
+  page_id_t page_id;
+  auto *page = bpm->NewPage(page_id);
+  ASSERT_EQ(0, page_id);
+  strcpy(page->GetData() + 100, "Hello");
+  ASSERT_TRUE(bpm->UnpinPage(0, true));
+  // the change is logged at unpin and its LSN stamped into the page
+  ASSERT_EQ(1, page->GetLSN());
+  ASSERT_EQ(2, log_manager->GetNextLSN());
+  ASSERT_TRUE(bpm->UnpinPage(0, true));
+  ASSERT_EQ(2, log_manager->GetNextLSN());
+  // raw pages keep their own bytes in the slot
+  auto *raw_page = bpm->NewPage(page_id);
+  ASSERT_EQ(1, page_id);
+  bpm->MarkRawPage(1);
+  memset(raw_page->GetData(), 0x5a, PAGE_SIZE);
+  ASSERT_TRUE(bpm->UnpinPage(1, true));
+  ASSERT_EQ(0x5a5a5a5a, raw_page->GetLSN());
+  // evicting page 0 forces its log record to disk first
+  page = bpm->FetchPage(0);
+  strcpy(page->GetData() + 200, "World");
+  ASSERT_TRUE(bpm->UnpinPage(0, true));
+  lsn_t lsn = page->GetLSN();
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  ASSERT_LE(lsn, log_manager->GetPersistentLSN());
+  ASSERT_TRUE(bpm->UnpinPage(2, false));
+  ASSERT_TRUE(bpm->UnpinPage(3, false));
+  // replaying the log rebuilds what was written back
+  delete bpm;
+  delete log_manager;
+  char expect[PAGE_SIZE];
+  char pages[2][PAGE_SIZE];
+  memset(pages, 0x11, sizeof(pages));
+  log_manager = new LogManager(log_name);
+  log_manager->ReadLog(0, [&pages](const LogRecord &record, uint64_t) {
+    for (uint32_t i = 0; i < record.GetPageCount(); i++) {
+      if (record.GetPageId(i) < 2) {
+        record.ApplyTo(i, pages[record.GetPageId(i)]);
+      }
+    }
+    return true;
+  });
+  for (page_id_t i = 0; i < 2; i++) {
+    disk_manager->ReadPage(i, expect);
+    ASSERT_EQ(0, memcmp(expect, pages[i], PAGE_SIZE));
+  }
+  ASSERT_STREQ("World", pages[0] + 200);
+  delete log_manager;
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove(log_name.c_str());
+}
@@ -0,0 +1,59 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+static const std::string db_name = "parallel_bpm_test.db";
+
+TEST(ParallelBufferPoolManagerTest, ConcurrentTest) {
+  const size_t num_instances = 4;
+  const size_t pool_size = 8;
+  const int num_threads = 4;
+  const int pages_per_thread = 50;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+  // Scenario: several threads create and fill pages at once, far more pages than the pools hold.
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        Page *page = bpm->NewPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "thread %d page %d", t, page_id);
+        page_ids[t].push_back(page_id);
+        ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  // Scenario: every thread reads back pages written by every other thread.
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int owner = 0; owner < num_threads; owner++) {
+        for (auto page_id : page_ids[(owner + t) % num_threads]) {
+          Page *page = bpm->FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          std::string expect = "thread " + std::to_string((owner + t) % num_threads) + " page " + std::to_string(page_id);
+          EXPECT_EQ(expect, std::string(page->GetData()));
+          ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -142,4 +142,174 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
   delete db_02;
-}
\ No newline at end of file
+}
+TEST(CatalogTest, CatalogIndexMigrationTest) {
+  SimpleMemHeap heap;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_info));
+  for (int i = 0; i < 100; i++) {
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  }
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info));
+  delete db_01;
+  // pretend the index was written by an older version: mark its keys as row-format
+  page_id_t meta_page_id;
+  IndexMetadata *index_meta = nullptr;
+  {
+    DiskManager disk_mgr(db_file_name);
+    BufferPoolManager bpm(DEFAULT_BUFFER_POOL_SIZE, &disk_mgr);
+    auto catalog_meta_page = bpm.FetchPage(CATALOG_META_PAGE_ID);
+    auto catalog_meta = CatalogMeta::DeserializeFrom(catalog_meta_page->GetData(), &heap);
+    bpm.UnpinPage(CATALOG_META_PAGE_ID, false);
+    ASSERT_EQ(1, catalog_meta->GetIndexMetaPages()->size());
+    meta_page_id = catalog_meta->GetIndexMetaPages()->begin()->second;
+    auto meta_page = bpm.FetchPage(meta_page_id);
+    IndexMetadata::DeserializeFrom(meta_page->GetData(), index_meta, &heap);
+    ASSERT_EQ(IndexMetadata::KEY_ENCODING_MEMCMP, index_meta->GetKeyEncoding());
+    index_meta->SetKeyEncoding(IndexMetadata::KEY_ENCODING_ROW);
+    index_meta->SerializeTo(meta_page->GetData());
+    bpm.UnpinPage(meta_page_id, true);
+  }
+  // the index is rebuilt from the table at load
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  IndexInfo *index_info_02 = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("table-1", "index-1", index_info_02));
+  for (int i = 0; i < 100; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index_info_02->GetIndex()->ScanKey(row, ret, &txn));
+    ASSERT_EQ(1, ret.size());
+  }
+  auto meta_page = db_02->bpm_->FetchPage(meta_page_id);
+  IndexMetadata::DeserializeFrom(meta_page->GetData(), index_meta, &heap);
+  ASSERT_EQ(IndexMetadata::KEY_ENCODING_MEMCMP, index_meta->GetKeyEncoding());
+  db_02->bpm_->UnpinPage(meta_page_id, false);
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogIndexMigrationFreeTest) {
+  SimpleMemHeap heap;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_info));
+  // enough keys for a tree of several levels
+  const int row_nums = 2000;
+  for (int i = 0; i < row_nums; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  }
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-1", {"id"}, &txn, index_info));
+  delete db_01;
+  auto count_pages = [](DiskManager *disk_mgr) {
+    int count = 0;
+    for (page_id_t page_id = 0; page_id < 4096; page_id++) {
+      count += !disk_mgr->IsPageFree(page_id);
+    }
+    return count;
+  };
+  // an int key is as long under the old sizing, so the old tree can be walked
+  int pages_before;
+  {
+    DiskManager disk_mgr(db_file_name);
+    BufferPoolManager bpm(DEFAULT_BUFFER_POOL_SIZE, &disk_mgr);
+    auto catalog_meta_page = bpm.FetchPage(CATALOG_META_PAGE_ID);
+    auto catalog_meta = CatalogMeta::DeserializeFrom(catalog_meta_page->GetData(), &heap);
+    bpm.UnpinPage(CATALOG_META_PAGE_ID, false);
+    page_id_t meta_page_id = catalog_meta->GetIndexMetaPages()->begin()->second;
+    auto meta_page = bpm.FetchPage(meta_page_id);
+    IndexMetadata *index_meta = nullptr;
+    IndexMetadata::DeserializeFrom(meta_page->GetData(), index_meta, &heap);
+    index_meta->SetKeyEncoding(IndexMetadata::KEY_ENCODING_MEMCMP_UNESCAPED);
+    index_meta->SerializeTo(meta_page->GetData());
+    bpm.UnpinPage(meta_page_id, true);
+    pages_before = count_pages(&disk_mgr);
+  }
+  // the pages of the old tree are given back when it is rebuilt
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  IndexInfo *index_info_02 = nullptr;
+  ASSERT_EQ(DB_SUCCESS, db_02->catalog_mgr_->GetIndex("table-1", "index-1", index_info_02));
+  ASSERT_LE(count_pages(db_02->disk_mgr_), pages_before);
+  for (int i = 0; i < row_nums; i += 97) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index_info_02->GetIndex()->ScanKey(row, ret, &txn));
+    ASSERT_EQ(1, ret.size());
+  }
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogLongKeyTest) {
+  SimpleMemHeap heap;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 0, true, false),
+          ALLOC_COLUMN(heap)("code", TypeId::kTypeChar, 4, 1, true, false),
+          ALLOC_COLUMN(heap)("text", TypeId::kTypeChar, 200, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema.get(), &txn, table_info));
+  // keys of 64 bytes differing in the last byte only, and keys made of 0x00 bytes which are escaped
+  std::string names[2] = {std::string(63, 'k') + "a", std::string(63, 'k') + "b"};
+  std::string codes[2] = {std::string("a\0\0\0", 4), std::string("a\0\0b", 4)};
+  std::vector<RowId> rids;
+  for (int i = 0; i < 2; i++) {
+    std::vector<Field> fields{
+            Field(TypeId::kTypeChar, const_cast<char *>(names[i].data()), names[i].size(), true),
+            Field(TypeId::kTypeChar, const_cast<char *>(codes[i].data()), codes[i].size(), true),
+            Field(TypeId::kTypeChar, const_cast<char *>("text"), 4, true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+    rids.push_back(row.GetRowId());
+  }
+  IndexInfo *name_index = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-name", {"name"}, &txn, name_index));
+  IndexInfo *code_index = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-code", {"code"}, &txn, code_index));
+  for (int i = 0; i < 2; i++) {
+    std::vector<Field> name_fields{
+            Field(TypeId::kTypeChar, const_cast<char *>(names[i].data()), names[i].size(), true)};
+    std::vector<Field> code_fields{
+            Field(TypeId::kTypeChar, const_cast<char *>(codes[i].data()), codes[i].size(), true)};
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, name_index->GetIndex()->ScanKey(Row(name_fields), ret, &txn));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(rids[i].Get(), ret[0].Get());
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, code_index->GetIndex()->ScanKey(Row(code_fields), ret, &txn));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(rids[i].Get(), ret[0].Get());
+  }
+  // a key which may not fit the largest key type is refused rather than cut off
+  IndexInfo *text_index = nullptr;
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateIndex("table-1", "index-text", {"text"}, &txn, text_index));
+  ASSERT_EQ(DB_INDEX_NOT_FOUND, catalog_01->GetIndex("table-1", "index-text", text_index));
+  delete db_01;
+}
@@ -0,0 +1,542 @@
+#include <cstdio>
+
+#include "common/instance.h"
+#include "executor/expression.h"
+#include "executor/result_sink.h"
+#include "executor/planner.h"
+#include "gtest/gtest.h"
+
+extern "C" {
+int yyparse(void);
+#include "parser/minisql_lex.h"
+#include "parser/parser.h"
+}
+
+static string db_file_name = "executor_test.db";
+
+/**
+ * Parses one statement, the syntax tree lives until the object is destroyed
+ */
+class ParsedStatement {
+public:
+  explicit ParsedStatement(const std::string &sql) {
+    bp_ = yy_scan_string(sql.c_str());
+    yy_switch_to_buffer(bp_);
+    MinisqlParserInit();
+    yyparse();
+  }
+
+  ~ParsedStatement() {
+    MinisqlParserFinish();
+    yy_delete_buffer(bp_);
+    yylex_destroy();
+  }
+
+  pSyntaxNode Root() const { return MinisqlParserGetError() ? nullptr : MinisqlGetParserRootNode(); }
+
+private:
+  YY_BUFFER_STATE bp_;
+};
+
+/**
+ * Run a DML statement through its plan, counting the affected rows
+ */
+static dberr_t RunDml(CatalogManager *catalog, const std::string &sql, int &affected) {
+  ParsedStatement stmt(sql);
+  EXPECT_NE(nullptr, stmt.Root());
+  Planner planner(catalog, nullptr);
+  std::unique_ptr<AbstractExecutor> plan;
+  dberr_t status;
+  switch (stmt.Root()->type_) {
+    case kNodeInsert: status = planner.PlanInsert(stmt.Root(), plan); break;
+    case kNodeUpdate: status = planner.PlanUpdate(stmt.Root(), plan); break;
+    case kNodeDelete: status = planner.PlanDelete(stmt.Root(), plan); break;
+    default: status = DB_FAILED;
+  }
+  if (status != DB_SUCCESS || (status = plan->Init()) != DB_SUCCESS) {
+    return status;
+  }
+  affected = 0;
+  Row *row;
+  while ((status = plan->Next(row)) == DB_SUCCESS && row != nullptr) {
+    affected++;
+  }
+  return status;
+}
+
+static std::vector<std::vector<std::string>> RunSelect(CatalogManager *catalog, const std::string &sql) {
+  ParsedStatement stmt(sql);
+  EXPECT_NE(nullptr, stmt.Root());
+  Planner planner(catalog, nullptr);
+  std::unique_ptr<AbstractExecutor> plan;
+  std::vector<std::string> columns;
+  std::vector<std::vector<std::string>> result;
+  EXPECT_EQ(DB_SUCCESS, planner.PlanSelect(stmt.Root(), plan, columns));
+  EXPECT_EQ(DB_SUCCESS, plan->Init());
+  Row *row;
+  while (plan->Next(row) == DB_SUCCESS && row != nullptr) {
+    std::vector<std::string> values;
+    for (auto field : row->GetFields()) {
+      values.push_back(field->GetString());
+    }
+    result.push_back(values);
+  }
+  return result;
+}
+
+TEST(ExecutorTest, PlannedDmlTest) {
+  auto db = new DBStorageEngine(db_file_name, true);
+  auto catalog = db->catalog_mgr_;
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, true),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 4, 1, false, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("t", schema.get(), nullptr, table_info));
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("t", "idx_id", {"id"}, nullptr, index_info));
+  // insert: every tenth account is null
+  const int row_nums = 200;
+  int affected = 0;
+  int expect_rich = 0;
+  for (int i = 0; i < row_nums; i++) {
+    char sql[128];
+    if (i % 10 == 0) {
+      snprintf(sql, sizeof(sql), "insert into t values(%d, \"n%03d\", null);", i, i);
+    } else {
+      snprintf(sql, sizeof(sql), "insert into t values(%d, \"n%03d\", %d.5);", i, i, i);
+      expect_rich += (i + 0.5 > 100.0);
+    }
+    ASSERT_EQ(DB_SUCCESS, RunDml(catalog, sql, affected));
+    ASSERT_EQ(1, affected);
+  }
+  ASSERT_EQ(DB_FAILED, RunDml(catalog, "insert into t values(7, \"dup1\", 1.0);", affected));
+  ASSERT_EQ(row_nums, static_cast<int>(RunSelect(catalog, "select * from t;").size()));
+  // point and range lookups through the index
+  auto rows = RunSelect(catalog, "select name from t where id = 7;");
+  ASSERT_EQ(1, rows.size());
+  ASSERT_EQ(1, rows[0].size());
+  EXPECT_EQ("n007", rows[0][0]);
+  rows = RunSelect(catalog, "select id from t where id >= 50 and id < 60;");
+  ASSERT_EQ(10, rows.size());
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(std::to_string(50 + i), rows[i][0]);
+  }
+  // a null never satisfies a comparison
+  EXPECT_EQ(expect_rich, static_cast<int>(RunSelect(catalog, "select * from t where account > 100.0;").size()));
+  EXPECT_EQ(row_nums / 10, static_cast<int>(RunSelect(catalog, "select * from t where account is null;").size()));
+  EXPECT_EQ(row_nums - 11 + 4, static_cast<int>(
+          RunSelect(catalog, "select id from t where id > 10 or account < 5.0;").size()));
+  // update moves the index entry along with the key
+  ASSERT_EQ(DB_SUCCESS, RunDml(catalog, "update t set id = 1000 where id = 5;", affected));
+  ASSERT_EQ(1, affected);
+  EXPECT_EQ(0, RunSelect(catalog, "select * from t where id = 5;").size());
+  rows = RunSelect(catalog, "select name from t where id = 1000;");
+  ASSERT_EQ(1, rows.size());
+  EXPECT_EQ("n005", rows[0][0]);
+  // a duplicate key leaves both the row and its index entry untouched
+  ASSERT_EQ(DB_FAILED, RunDml(catalog, "update t set id = 6 where id = 7;", affected));
+  EXPECT_EQ(1, RunSelect(catalog, "select * from t where id = 7;").size());
+  EXPECT_EQ(1, RunSelect(catalog, "select * from t where id = 6;").size());
+  std::vector<RowId> result;
+  std::vector<Field> key_fields{Field(TypeId::kTypeInt, 7)};
+  Row key(key_fields);
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, nullptr));
+  ASSERT_EQ(1, result.size());
+  // delete removes the rows and their index entries
+  ASSERT_EQ(DB_SUCCESS, RunDml(catalog, "delete from t where id < 20;", affected));
+  ASSERT_EQ(19, affected);
+  EXPECT_EQ(row_nums - 19, static_cast<int>(RunSelect(catalog, "select * from t;").size()));
+  EXPECT_EQ(0, RunSelect(catalog, "select * from t where id <= 19;").size());
+  result.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index_info->GetIndex()->ScanKey(key, result, nullptr));
+  ASSERT_EQ(DB_SUCCESS, RunDml(catalog, "delete from t;", affected));
+  ASSERT_EQ(row_nums - 19, affected);
+  EXPECT_EQ(0, RunSelect(catalog, "select * from t;").size());
+  ASSERT_EQ(DB_SUCCESS, RunDml(catalog, "insert into t values(7, \"n007\", 1.0);", affected));
+  EXPECT_EQ(1, RunSelect(catalog, "select * from t where id = 7;").size());
+  ASSERT_TRUE(db->bpm_->CheckAllUnpinned());
+  delete db;
+}
+
+TEST(ExecutorTest, CompiledExpressionTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 4, 1, false, false),
+                                   ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)};
+  Schema schema(columns);
+  auto compile = [&](const std::string &sql, std::unique_ptr<Expression> &expr) {
+    ParsedStatement stmt(sql);
+    EXPECT_NE(nullptr, stmt.Root());
+    pSyntaxNode where_node = stmt.Root()->child_->next_->next_;
+    return Expression::Compile(where_node->child_, &schema, expr);
+  };
+  std::unique_ptr<Expression> expr;
+  ASSERT_EQ(DB_COLUMN_NAME_NOT_EXIST, compile("select * from t where age = 1;", expr));
+  ASSERT_EQ(DB_FAILED, compile("select * from t where id = \"abc\";", expr));
+  // an int column takes only whole literals in its range
+  ASSERT_EQ(DB_FAILED, compile("select * from t where id = 1.5;", expr));
+  ASSERT_EQ(DB_FAILED, compile("select * from t where id < 3000000000;", expr));
+  ASSERT_EQ(DB_SUCCESS, compile("select * from t where id = -2147483648;", expr));
+  ASSERT_EQ(DB_SUCCESS, compile("select * from t where id >= 10 and name <> \"n012\" or account is null;", expr));
+  ASSERT_EQ(ExpressionType::kOr, expr->GetType());
+  const int row_nums = 1000;
+  std::vector<Row> rows;
+  int expect_match = 0;
+  for (int i = 0; i < row_nums; i++) {
+    char name[8];
+    snprintf(name, sizeof(name), "n%03d", i % 1000);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, name, 4, true),
+                              i % 7 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, i * 1.5f)};
+    rows.emplace_back(fields);
+    expect_match += (i >= 10 && i != 12) || i % 7 == 0;
+  }
+  int match = 0;
+  for (auto &row : rows) {
+    match += expr->Evaluate(&row);
+  }
+  ASSERT_EQ(expect_match, match);
+  // a comparison with null is unknown and never matches, neither does its negation
+  ASSERT_EQ(DB_SUCCESS, compile("select * from t where account < 10.0 or account >= 10.0;", expr));
+  match = 0;
+  for (auto &row : rows) {
+    match += expr->Evaluate(&row);
+  }
+  ASSERT_EQ(row_nums - (row_nums + 6) / 7, match);
+  // a condition compiled once per statement matches the rows one bound again for every row matches
+  ParsedStatement stmt("select * from t where id > 500 and account < 1000.0;");
+  pSyntaxNode condition = stmt.Root()->child_->next_->next_->child_;
+  ASSERT_EQ(DB_SUCCESS, Expression::Compile(condition, &schema, expr));
+  int per_row_match = 0;
+  int compiled_match = 0;
+  for (auto &row : rows) {
+    std::unique_ptr<Expression> row_expr;
+    ASSERT_EQ(DB_SUCCESS, Expression::Compile(condition, &schema, row_expr));
+    per_row_match += row_expr->Evaluate(&row);
+    compiled_match += expr->Evaluate(&row);
+  }
+  ASSERT_EQ(per_row_match, compiled_match);
+}
+
+static std::string ReadAll(FILE *fp) {
+  std::string content;
+  char buf[4096];
+  size_t len;
+  rewind(fp);
+  while ((len = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    content.append(buf, len);
+  }
+  return content;
+}
+
+TEST(ExecutorTest, ResultSinkTest) {
+  std::vector<Row> rows;
+  char names[][16] = {"a", "bb,b", "say \"hi\"", ""};
+  for (int i = 0; i < 4; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i * 500),
+                              Field(TypeId::kTypeChar, names[i], strlen(names[i]), true),
+                              i == 1 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, 1.5f)};
+    rows.emplace_back(fields);
+  }
+  std::vector<std::string> columns{"id", "name", "account"};
+  // table: widths come from the first two rows, the second batch widens the columns
+  FILE *fp = tmpfile();
+  ASSERT_NE(nullptr, fp);
+  {
+    TableResultSink sink(fp, 2);
+    sink.Begin(columns);
+    for (auto &row : rows) {
+      sink.Write(row);
+    }
+    sink.End();
+    ASSERT_EQ(4, sink.GetRowCount());
+  }
+  EXPECT_EQ("+-----+------+----------+\n"
+            "| id  | name | account  |\n"
+            "+-----+------+----------+\n"
+            "| 0   | a    | 1.500000 |\n"
+            "| 500 | bb,b | null     |\n"
+            "+------+----------+----------+\n"
+            "| 1000 | say \"hi\" | 1.500000 |\n"
+            "| 1500 |          | 1.500000 |\n"
+            "+------+----------+----------+\n", ReadAll(fp));
+  fclose(fp);
+  // csv: quoted when needed, null is an empty field
+  fp = tmpfile();
+  {
+    auto sink = ResultSink::Create(ResultFormat::kCsv, fp);
+    sink->Begin(columns);
+    for (auto &row : rows) {
+      sink->Write(row);
+    }
+    sink->End();
+  }
+  EXPECT_EQ("id,name,account\n"
+            "0,a,1.500000\n"
+            "500,\"bb,b\",\n"
+            "1000,\"say \"\"hi\"\"\",1.500000\n"
+            "1500,\"\",1.500000\n", ReadAll(fp));
+  fclose(fp);
+  // binary: decode what was written
+  fp = tmpfile();
+  {
+    auto sink = ResultSink::Create(ResultFormat::kBinary, fp);
+    sink->Begin(columns);
+    for (auto &row : rows) {
+      sink->Write(row);
+    }
+    sink->End();
+  }
+  std::string content = ReadAll(fp);
+  fclose(fp);
+  const char *pos = content.data();
+  auto read_uint32 = [&pos]() {
+    uint32_t val;
+    memcpy(&val, pos, sizeof(uint32_t));
+    pos += sizeof(uint32_t);
+    return val;
+  };
+  ASSERT_EQ(3, read_uint32());
+  for (auto &name : columns) {
+    uint32_t len = read_uint32();
+    ASSERT_EQ(name, std::string(pos, len));
+    pos += len;
+  }
+  for (int i = 0; i < 4; i++) {
+    ASSERT_EQ(BinaryResultSink::TAG_INT, static_cast<uint8_t>(*pos++));
+    ASSERT_EQ(i * 500, static_cast<int>(read_uint32()));
+    ASSERT_EQ(BinaryResultSink::TAG_CHAR, static_cast<uint8_t>(*pos++));
+    uint32_t len = read_uint32();
+    ASSERT_EQ(std::string(names[i]), std::string(pos, len));
+    pos += len;
+    if (i == 1) {
+      ASSERT_EQ(BinaryResultSink::TAG_NULL, static_cast<uint8_t>(*pos++));
+    } else {
+      ASSERT_EQ(BinaryResultSink::TAG_FLOAT, static_cast<uint8_t>(*pos++));
+      float val;
+      memcpy(&val, pos, sizeof(float));
+      pos += sizeof(float);
+      ASSERT_EQ(1.5f, val);
+    }
+  }
+  ASSERT_EQ(BinaryResultSink::TAG_END, static_cast<uint8_t>(*pos++));
+  ASSERT_EQ(content.data() + content.size(), pos);
+}
+
+TEST(ExecutorTest, ScriptParseTest) {
+  // one flex buffer for the whole script, every yyparse call returns one statement
+  const std::string script = "create database db0;\n"
+                             "insert into t values(1, \"a;b\");  select * from t;\n"
+                             "insert into t values(oops;\n"
+                             "delete from t;\n";
+  YY_BUFFER_STATE bp = yy_scan_bytes(script.data(), script.size());
+  std::vector<SyntaxNodeType> types;
+  std::vector<pSyntaxNodeList> trees;
+  int errors = 0;
+  while (true) {
+    MinisqlParserInit();
+    yyparse();
+    pSyntaxNode root = MinisqlGetParserRootNode();
+    trees.push_back(DetachSyntaxTree());
+    if (root != nullptr) {
+      types.push_back(root->type_);
+    } else if (MinisqlParserGetError()) {
+      errors++;
+    } else {
+      break;
+    }
+  }
+  // the trees of all statements stay valid until they are destroyed
+  std::vector<SyntaxNodeType> expect_types{kNodeCreateDB, kNodeInsert, kNodeSelect, kNodeDelete};
+  ASSERT_EQ(expect_types, types);
+  ASSERT_EQ(1, errors);
+  for (auto tree : trees) {
+    DestroySyntaxNodeList(tree);
+  }
+  yy_delete_buffer(bp);
+  yylex_destroy();
+}
+
+TEST(ExecutorTest, MultiRowInsertTest) {
+  auto db = new DBStorageEngine(db_file_name, true);
+  auto catalog = db->catalog_mgr_;
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, true),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 8, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("t", schema.get(), nullptr, table_info));
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("t", "idx_id", {"id"}, nullptr, index_info));
+  // keys out of order, spread over many heap pages
+  const int row_nums = 3000;
+  auto make_insert = [](int begin, int end) {
+    std::string sql = "insert into t values";
+    for (int i = begin; i < end; i++) {
+      char tuple[64];
+      snprintf(tuple, sizeof(tuple), "%s(%d, \"name%04d\")", i == begin ? "" : ", ", (i * 7919) % row_nums, i);
+      sql += tuple;
+    }
+    return sql + ";";
+  };
+  int affected = 0;
+  ASSERT_EQ(DB_SUCCESS, RunDml(catalog, make_insert(0, row_nums / 2), affected));
+  ASSERT_EQ(row_nums / 2, affected);
+  ASSERT_EQ(DB_SUCCESS, RunDml(catalog, make_insert(row_nums / 2, row_nums), affected));
+  ASSERT_EQ(row_nums / 2, affected);
+  auto rows = RunSelect(catalog, "select id from t where id >= 0;");
+  ASSERT_EQ(row_nums, rows.size());
+  for (int i = 0; i < row_nums; i++) {
+    ASSERT_EQ(std::to_string(i), rows[i][0]);
+  }
+  rows = RunSelect(catalog, "select name from t where id = 7919;");
+  ASSERT_EQ(0, rows.size());
+  rows = RunSelect(catalog, "select name from t where id = 1919;");
+  ASSERT_EQ(1, rows.size());
+  EXPECT_EQ("name0001", rows[0][0]);
+  // a duplicate, either with the table or inside the batch, inserts none of the rows
+  ASSERT_EQ(DB_FAILED, RunDml(catalog, "insert into t values(5000, \"new00000\"), (1, \"dup00000\");", affected));
+  ASSERT_EQ(DB_FAILED, RunDml(catalog, "insert into t values(5001, \"new00001\"), (5001, \"dup00001\");", affected));
+  ASSERT_EQ(row_nums, static_cast<int>(RunSelect(catalog, "select * from t;").size()));
+  EXPECT_EQ(0, RunSelect(catalog, "select * from t where id >= 5000;").size());
+  ASSERT_EQ(DB_SUCCESS, RunDml(catalog, "insert into t values(5001, \"new00001\"), (5000, \"new00000\");", affected));
+  ASSERT_EQ(2, affected);
+  EXPECT_EQ(2, RunSelect(catalog, "select * from t where id >= 5000;").size());
+  ASSERT_EQ(DB_FAILED, RunDml(catalog, "insert into t values(6000, \"new00000\"), (6001);", affected));
+  ASSERT_TRUE(db->bpm_->CheckAllUnpinned());
+  delete db;
+}
+
+TEST(ExecutorTest, DeleteReinsertTest) {
+  auto db = new DBStorageEngine(db_file_name, true);
+  auto catalog = db->catalog_mgr_;
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, true),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 8, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("t", schema.get(), nullptr, table_info));
+  const int row_nums = 2000;
+  auto make_insert = [](int begin, int end) {
+    std::string sql = "insert into t values";
+    for (int i = begin; i < end; i++) {
+      char tuple[64];
+      snprintf(tuple, sizeof(tuple), "%s(%d, \"name%04d\")", i == begin ? "" : ", ", i, i);
+      sql += tuple;
+    }
+    return sql + ";";
+  };
+  int affected = 0;
+  ASSERT_EQ(DB_SUCCESS, RunDml(catalog, make_insert(0, row_nums), affected));
+  size_t page_count = table_info->GetTableHeap()->GetPageIds().size();
+  ASSERT_LT(2u, page_count);
+  // the freed space spreads over every page, a batch of the same size must fit in it
+  ASSERT_EQ(DB_SUCCESS, RunDml(catalog, "delete from t where id < 1000;", affected));
+  ASSERT_EQ(1000, affected);
+  ASSERT_EQ(DB_SUCCESS, RunDml(catalog, make_insert(row_nums, row_nums + 1000), affected));
+  ASSERT_EQ(1000, affected);
+  EXPECT_EQ(page_count, table_info->GetTableHeap()->GetPageIds().size());
+  ASSERT_EQ(row_nums, static_cast<int>(RunSelect(catalog, "select * from t;").size()));
+  ASSERT_TRUE(db->bpm_->CheckAllUnpinned());
+  delete db;
+}
+
+TEST(ExecutorTest, CopyFromTest) {
+  auto db = new DBStorageEngine(db_file_name, true);
+  auto catalog = db->catalog_mgr_;
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, true),
+                                   ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 6, 1, false, false),
+                                   ALLOC_COLUMN(heap)("score", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateTable("t", schema.get(), nullptr, table_info));
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("t", "idx_id", {"id"}, nullptr, index_info));
+  {
+    ParsedStatement stmt("copy t from \"copy_test.csv\";");
+    ASSERT_NE(nullptr, stmt.Root());
+    ASSERT_EQ(kNodeCopy, stmt.Root()->type_);
+    EXPECT_STREQ("t", stmt.Root()->child_->val_);
+    EXPECT_STREQ("copy_test.csv", stmt.Root()->child_->next_->val_);
+  }
+  {
+    ParsedStatement stmt("cpy t from \"copy_test.csv\";");
+    ASSERT_EQ(nullptr, stmt.Root());
+  }
+  // large enough to be cut into several chunks, keys out of order
+  const std::string file_name = "copy_test.csv";
+  const int row_nums = 250000;
+  FILE *fp = fopen(file_name.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "id,name,score\n");
+  for (int i = 0; i < row_nums; i++) {
+    int id = static_cast<int>((i * 7919LL) % row_nums);
+    if (i % 10 == 0) {
+      fprintf(fp, "%d,n%05d,\r\n", id, i % 100000);
+    } else if (i % 10 == 1) {
+      fprintf(fp, "%d,\"a,b\"\"cd\",%d.5\n", id, i % 1000);
+    } else {
+      fprintf(fp, "%d,n%05d,%d.5\n", id, i % 100000, i % 1000);
+    }
+  }
+  fclose(fp);
+  uint64_t row_count = 0;
+  ASSERT_EQ(DB_SUCCESS, catalog->CopyFrom("t", file_name, nullptr, row_count));
+  ASSERT_EQ(row_nums, row_count);
+  ASSERT_EQ(row_nums, static_cast<int>(RunSelect(catalog, "select id from t;").size()));
+  EXPECT_EQ(row_nums / 10, static_cast<int>(RunSelect(catalog, "select id from t where score is null;").size()));
+  auto rows = RunSelect(catalog, "select id, name from t where id >= 7919 and id <= 7920;");
+  ASSERT_EQ(2, rows.size());
+  EXPECT_EQ("7919", rows[0][0]);
+  EXPECT_EQ("a,b\"cd", rows[0][1]);
+  EXPECT_EQ("7920", rows[1][0]);
+  // a duplicate key or a malformed line keeps nothing of the file
+  fp = fopen(file_name.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "300000,n00000,1.0\n300001,n00001,\n7,dup000,1.0\n");
+  fclose(fp);
+  ASSERT_EQ(DB_FAILED, catalog->CopyFrom("t", file_name, nullptr, row_count));
+  fp = fopen(file_name.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "300000,n00000,1.0\n300001,n00001,\n300002,bad,1.0\n");
+  fclose(fp);
+  ASSERT_EQ(DB_FAILED, catalog->CopyFrom("t", file_name, nullptr, row_count));
+  fp = fopen(file_name.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "300000,n00000,1.0\n,n00001,1.0\n");
+  fclose(fp);
+  ASSERT_EQ(DB_FAILED, catalog->CopyFrom("t", file_name, nullptr, row_count));
+  ASSERT_EQ(DB_FAILED, catalog->CopyFrom("t", "no_such_file.csv", nullptr, row_count));
+  ASSERT_EQ(DB_TABLE_NOT_EXIST, catalog->CopyFrom("u", file_name, nullptr, row_count));
+  EXPECT_EQ(0, RunSelect(catalog, "select id from t where id >= 300000;").size());
+  ASSERT_EQ(row_nums, static_cast<int>(RunSelect(catalog, "select id from t;").size()));
+  // the keys of the failed loads are gone from the index as well
+  fp = fopen(file_name.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "300000,n00000,1.0\n\n300001,\"n0\"\"01\",\n");
+  fclose(fp);
+  ASSERT_EQ(DB_FAILED, catalog->CopyFrom("t", file_name, nullptr, row_count));
+  fp = fopen(file_name.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "300000,n00000,1.0\n\n300001,\"n0\"\"001\",\n");
+  fclose(fp);
+  ASSERT_EQ(DB_SUCCESS, catalog->CopyFrom("t", file_name, nullptr, row_count));
+  ASSERT_EQ(2, row_count);
+  rows = RunSelect(catalog, "select name, score from t where id >= 300000;");
+  ASSERT_EQ(2, rows.size());
+  EXPECT_EQ("n0\"001", rows[1][0]);
+  // indexes created on the loaded table are built from a scan of it
+  ASSERT_EQ(DB_FAILED, catalog->CreateIndex("t", "idx_name", {"name"}, nullptr, index_info));
+  ASSERT_EQ(DB_SUCCESS, catalog->CreateIndex("t", "idx_id_name", {"id", "name"}, nullptr, index_info));
+  char name[] = "a,b\"cd";
+  std::vector<Field> key_fields{Field(TypeId::kTypeInt, 7919), Field(TypeId::kTypeChar, name, 6, true)};
+  Row key(key_fields);
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, nullptr));
+  ASSERT_EQ(1, result.size());
+  remove(file_name.c_str());
+  ASSERT_TRUE(db->bpm_->CheckAllUnpinned());
+  delete db;
+}
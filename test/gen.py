@@ -1,5 +1,9 @@
 from random import *
 
 N = 10000
-for i in range(N):
-    print(f"insert into account values({1200000 + i:d}, \"name{i:05d}\", {randint(1, 1000) + random():.2f});")
\ No newline at end of file
+# rows per insert statement
+BATCH = 1000
+for begin in range(0, N, BATCH):
+    values = ", ".join(f"({1200000 + i:d}, \"name{i:05d}\", {randint(1, 1000) + random():.2f})"
+                       for i in range(begin, min(begin + BATCH, N)))
+    print(f"insert into account values{values};")
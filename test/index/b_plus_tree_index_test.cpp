@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <memory>
+#include <random>
 #include <string>
 
 #include "common/instance.h"
@@ -80,4 +83,207 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     ASSERT_EQ(i, (*iter).second.GetSlotNum());
     i++;
   }
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, GenericKeyOrderTest) {
+  using INDEX_KEY_TYPE = GenericKey<16>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<16>;
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 1, true, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 8, 2, true, false)
+  };
+  const TableSchema table_schema(columns);
+  INDEX_COMPARATOR_TYPE comparator(nullptr);
+  // every column on its own: encoded keys must sort the same way as the fields do
+  for (uint32_t col = 0; col < columns.size(); col++) {
+    std::vector<uint32_t> index_key_map{col};
+    auto *key_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+    // null sorts before everything
+    std::vector<Field> values;
+    values.emplace_back(columns[col]->GetType());
+    if (col == 0) {
+      for (int32_t v : {-2147483647 - 1, -100, -1, 0, 1, 7, 100, 2147483647}) values.emplace_back(TypeId::kTypeInt, v);
+    } else if (col == 1) {
+      for (float v : {-1e30f, -2.5f, -0.5f, 0.0f, 1e-20f, 0.5f, 3.25f, 1e30f}) values.emplace_back(TypeId::kTypeFloat, v);
+    } else {
+      for (const char *v : {"", "a", "ab", "abc", "abd", "b", "ba", "z"}) {
+        values.emplace_back(TypeId::kTypeChar, const_cast<char *>(v), strlen(v), true);
+      }
+    }
+    std::vector<INDEX_KEY_TYPE> keys(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      std::vector<Field> fields;
+      fields.emplace_back(values[i]);
+      Row row(fields);
+      keys[i].SerializeFromKey(row, key_schema);
+    }
+    for (size_t i = 0; i < keys.size(); i++) {
+      for (size_t j = 0; j < keys.size(); j++) {
+        int cmp = comparator(keys[i], keys[j]);
+        if (i < j) {
+          ASSERT_LT(cmp, 0) << "column " << col << ": " << i << " vs " << j;
+        } else if (i == j) {
+          ASSERT_EQ(cmp, 0);
+        } else {
+          ASSERT_GT(cmp, 0) << "column " << col << ": " << i << " vs " << j;
+        }
+      }
+    }
+  }
+  // composite keys compare column by column
+  std::vector<uint32_t> index_key_map{2, 0};
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto make_key = [&](const char *name, int32_t id) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(name), strlen(name), true),
+                              Field(TypeId::kTypeInt, id)};
+    Row row(fields);
+    INDEX_KEY_TYPE key;
+    key.SerializeFromKey(row, key_schema);
+    return key;
+  };
+  ASSERT_LT(comparator(make_key("ab", 100), make_key("abc", -100)), 0);
+  ASSERT_LT(comparator(make_key("ab", -5), make_key("ab", 3)), 0);
+  ASSERT_GT(comparator(make_key("b", -5), make_key("ab", 3)), 0);
+  // both zeros are the same key
+  std::vector<uint32_t> float_key_map{1};
+  auto *float_key_schema = Schema::ShallowCopySchema(&table_schema, float_key_map, &heap);
+  INDEX_KEY_TYPE zero_keys[2];
+  float zeros[2] = {0.0f, -0.0f};
+  for (int i = 0; i < 2; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeFloat, zeros[i])};
+    Row row(fields);
+    zero_keys[i].SerializeFromKey(row, float_key_schema);
+  }
+  ASSERT_EQ(0, comparator(zero_keys[0], zero_keys[1]));
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexRangeScanTest) {
+  using INDEX_KEY_TYPE = GenericKey<8>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<8>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 1, true, false)
+  };
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  auto make_key = [](int32_t val) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, val)};
+    return Row(fields);
+  };
+  // an empty index yields nothing
+  std::vector<RowId> result;
+  Row low_key = make_key(0);
+  ASSERT_EQ(DB_SUCCESS, index->ScanRange(&low_key, true, nullptr, false, result, nullptr));
+  ASSERT_TRUE(result.empty());
+  // even keys only, enough of them to span many leaves, inserted out of order
+  const int n = 3000;
+  std::vector<int32_t> values;
+  for (int i = 0; i < n; i++) {
+    values.push_back(i * 2);
+  }
+  std::shuffle(values.begin(), values.end(), std::mt19937(0));
+  for (auto val : values) {
+    Row key = make_key(val);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(key, RowId(val, 0), nullptr));
+  }
+  auto check = [&](const int32_t *low, bool low_inclusive, const int32_t *high, bool high_inclusive) {
+    std::vector<RowId> expect;
+    for (int32_t val = 0; val < 2 * n; val += 2) {
+      if (low != nullptr && (val < *low || (val == *low && !low_inclusive))) continue;
+      if (high != nullptr && (val > *high || (val == *high && !high_inclusive))) continue;
+      expect.emplace_back(val, 0);
+    }
+    std::unique_ptr<Row> low_row, high_row;
+    if (low != nullptr) low_row = std::make_unique<Row>(make_key(*low));
+    if (high != nullptr) high_row = std::make_unique<Row>(make_key(*high));
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanRange(low_row.get(), low_inclusive, high_row.get(), high_inclusive, ret, nullptr));
+    ASSERT_EQ(expect.size(), ret.size());
+    for (size_t i = 0; i < expect.size(); i++) {
+      ASSERT_EQ(expect[i].Get(), ret[i].Get());
+    }
+  };
+  for (int32_t low : {-5, 0, 1, 100, 777, 778, 2 * n - 2, 2 * n + 10}) {
+    for (int32_t high : {-1, 0, 99, 100, 3001, 3002, 2 * n - 2, 2 * n + 10}) {
+      for (bool low_inclusive : {true, false}) {
+        for (bool high_inclusive : {true, false}) {
+          check(&low, low_inclusive, &high, high_inclusive);
+        }
+      }
+    }
+    // open-ended ranges
+    check(&low, true, nullptr, false);
+    check(nullptr, false, &low, false);
+  }
+  check(nullptr, false, nullptr, false);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBulkLoadTest) {
+  using INDEX_KEY_TYPE = GenericKey<8>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<8>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 1, true, false)
+  };
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  const int n = 100000;
+  std::vector<int32_t> values;
+  for (int i = 0; i < n; i++) {
+    values.push_back(i);
+  }
+  std::shuffle(values.begin(), values.end(), std::mt19937(0));
+  // every partition hands out a slice of the shuffled keys
+  auto scan_slices = [&values](size_t partition_count) {
+    return [&values, partition_count](size_t partition, const Index::EntrySink &sink) {
+      for (size_t i = values.size() * partition / partition_count;
+           i < values.size() * (partition + 1) / partition_count; i++) {
+        std::vector<Field> fields{Field(TypeId::kTypeInt, values[i])};
+        Row key(fields);
+        sink(key, RowId(values[i], 1));
+      }
+      return true;
+    };
+  };
+  index_id_t index_id = 0;
+  for (size_t partition_count : {1, 4}) {
+    auto *index = ALLOC(heap, BP_TREE_INDEX)(index_id++, index_schema, engine.bpm_);
+    ASSERT_EQ(DB_SUCCESS, index->BulkLoad(partition_count, scan_slices(partition_count), nullptr));
+    ASSERT_FALSE(index->IsEmpty());
+    ASSERT_EQ(DB_FAILED, index->BulkLoad(partition_count, scan_slices(partition_count), nullptr));
+    int32_t expect = 0;
+    for (auto iter = index->GetBeginIterator(); iter != index->GetEndIterator(); ++iter, expect++) {
+      ASSERT_EQ(expect, (*iter).second.GetPageId());
+    }
+    ASSERT_EQ(n, expect);
+  }
+  // a key repeated in two partitions, or a failed scan, leaves the index empty
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(index_id++, index_schema, engine.bpm_);
+  values.push_back(values[0]);
+  ASSERT_EQ(DB_FAILED, index->BulkLoad(4, scan_slices(4), nullptr));
+  ASSERT_TRUE(index->IsEmpty());
+  values.pop_back();
+  ASSERT_EQ(DB_FAILED, index->BulkLoad(4, [](size_t partition, const Index::EntrySink &) {
+    return partition != 2;
+  }, nullptr));
+  ASSERT_TRUE(index->IsEmpty());
+  ASSERT_EQ(DB_SUCCESS, index->BulkLoad(4, scan_slices(4), nullptr));
+  std::vector<RowId> result;
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 4242)};
+  Row key(fields);
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(key, result, nullptr));
+  ASSERT_EQ(1, result.size());
+  ASSERT_EQ(4242, result[0].GetPageId());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
@@ -68,4 +68,62 @@ TEST(BPlusTreeTests, SampleTest) {
   }
   // tree.Destroy();
   // ASSERT_TRUE(tree.IsEmpty());
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, BulkLoadTest) {
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  const int n = 3000;
+  auto entries = [n](int step) {
+    return [n, step, key = 0](std::pair<int, int> &entry) mutable {
+      if (key >= n * step) return false;
+      entry = std::make_pair(key, key * 10);
+      key += step;
+      return true;
+    };
+  };
+  // a repeated key leaves the tree empty
+  BPlusTree<int, int, BasicComparator<int>> failed(1, engine.bpm_, comparator, 4, 4);
+  int key = 0;
+  ASSERT_FALSE(failed.BulkLoad(n, [&key](std::pair<int, int> &entry) {
+    entry = std::make_pair(key < 2000 ? key : 1000, 0);
+    key++;
+    return true;
+  }));
+  ASSERT_TRUE(failed.IsEmpty());
+  ASSERT_TRUE(failed.Check());
+  // keys 0, 2, 4, ... so that the gaps can be inserted afterwards
+  BPlusTree<int, int, BasicComparator<int>> tree(2, engine.bpm_, comparator, 4, 4);
+  ASSERT_TRUE(tree.BulkLoad(n, entries(2)));
+  ASSERT_TRUE(tree.Check());
+  ASSERT_FALSE(tree.BulkLoad(n, entries(2)));
+  int expect = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter, expect += 2) {
+    ASSERT_EQ(expect, (*iter).first);
+    ASSERT_EQ(expect * 10, (*iter).second);
+  }
+  ASSERT_EQ(2 * n, expect);
+  vector<int> ans;
+  for (int i = 0; i < 2 * n; i++) {
+    ASSERT_EQ(i % 2 == 0, tree.GetValue(i, ans));
+  }
+  // the packed pages split and merge like inserted ones
+  for (int i = 1; i < 2 * n; i += 2) {
+    ASSERT_TRUE(tree.Insert(i, i * 10));
+  }
+  for (int i = 0; i < 2 * n; i += 3) {
+    tree.Remove(i);
+  }
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < 2 * n; i++) {
+    ans.clear();
+    ASSERT_EQ(i % 3 != 0, tree.GetValue(i, ans));
+    if (i % 3 != 0) {
+      ASSERT_EQ(i * 10, ans[0]);
+    }
+  }
+  // the root recorded in the roots page is the one of the built tree
+  BPlusTree<int, int, BasicComparator<int>> reopened(2, engine.bpm_, comparator, 4, 4);
+  ans.clear();
+  ASSERT_TRUE(reopened.GetValue(7, ans));
+  ASSERT_EQ(70, ans[0]);
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/key_search.h"
+#include "page/b_plus_tree_internal_page.h"
+#include "page/b_plus_tree_leaf_page.h"
+#include "utils/utils.h"
+
+template<size_t KeySize>
+static GenericKey<KeySize> MakeKey(int32_t val, Schema *key_schema) {
+  std::vector<Field> fields{Field(TypeId::kTypeInt, val)};
+  Row row(fields);
+  GenericKey<KeySize> key;
+  key.SerializeFromKey(row, key_schema);
+  return key;
+}
+
+TEST(KeySearchTest, BoundsTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)};
+  Schema schema(columns);
+  GenericComparator<8> generic_comparator(&schema);
+  BasicComparator<int> int_comparator;
+  // sorted keys with duplicates, probe values around every key
+  std::vector<int32_t> values;
+  for (int i = 0; i < 300; i++) {
+    values.push_back(RandomUtils::RandomInt(-1000, 1000));
+  }
+  std::sort(values.begin(), values.end());
+  std::vector<std::pair<int, int>> int_array;
+  std::vector<std::pair<GenericKey<8>, RowId>> generic_array;
+  for (auto val : values) {
+    int_array.emplace_back(val, 0);
+    generic_array.emplace_back(MakeKey<8>(val, &schema), RowId());
+  }
+  for (int size : {0, 1, 2, 3, 7, 64, 255, 300}) {
+    for (int32_t probe = -1002; probe <= 1002; probe += 3) {
+      auto expect_lower = std::lower_bound(values.begin(), values.begin() + size, probe) - values.begin();
+      auto expect_upper = std::upper_bound(values.begin(), values.begin() + size, probe) - values.begin();
+      ASSERT_EQ(expect_lower, (KeySearch<int, BasicComparator<int>>::LowerBound(
+              int_array.data(), 0, size, probe, int_comparator)));
+      ASSERT_EQ(expect_upper, (KeySearch<int, BasicComparator<int>>::UpperBound(
+              int_array.data(), 0, size, probe, int_comparator)));
+      auto key = MakeKey<8>(probe, &schema);
+      ASSERT_EQ(expect_lower, (KeySearch<GenericKey<8>, GenericComparator<8>>::LowerBound(
+              generic_array.data(), 0, size, key, generic_comparator)));
+      ASSERT_EQ(expect_upper, (KeySearch<GenericKey<8>, GenericComparator<8>>::UpperBound(
+              generic_array.data(), 0, size, key, generic_comparator)));
+    }
+  }
+  // searching from a non-zero begin, as internal pages do
+  auto expect = std::upper_bound(values.begin() + 1, values.end(), values[0]) - values.begin();
+  ASSERT_EQ(expect, (KeySearch<int, BasicComparator<int>>::UpperBound(
+          int_array.data(), 1, values.size(), values[0], int_comparator)));
+  ASSERT_EQ(1, (KeySearch<int, BasicComparator<int>>::LowerBound(
+          int_array.data(), 1, values.size(), -2000, int_comparator)));
+  ASSERT_EQ(static_cast<int>(values.size()), (KeySearch<int, BasicComparator<int>>::UpperBound(
+          int_array.data(), 1, values.size(), 2000, int_comparator)));
+}
+
+TEST(KeySearchTest, LeafLookupTest) {
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RowId, GenericComparator<8>>;
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false)};
+  Schema schema(columns);
+  GenericComparator<8> comparator(&schema);
+  alignas(8) char buf[PAGE_SIZE];
+  auto *leaf = reinterpret_cast<LeafPage *>(buf);
+  leaf->Init(0);
+  const int n = leaf->GetMaxSize();
+  for (int i = 0; i < n; i++) {
+    leaf->Insert(MakeKey<8>(i * 2, &schema), RowId(i, i), comparator);
+  }
+  ASSERT_EQ(n, leaf->GetSize());
+  // a full leaf finds the even keys only, each with its own value
+  for (int32_t val = -1; val <= 2 * n; val++) {
+    RowId rid;
+    bool found = leaf->Lookup(MakeKey<8>(val, &schema), rid, comparator);
+    ASSERT_EQ(val >= 0 && val % 2 == 0 && val < 2 * n, found);
+    if (found) {
+      ASSERT_EQ(RowId(val / 2, val / 2).Get(), rid.Get());
+    }
+  }
+}
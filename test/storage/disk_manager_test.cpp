@@ -34,8 +34,8 @@ TEST(DiskManagerTest, BitMapPageTest) {
 }
 
 TEST(DiskManagerTest, FreePageAllocationTest) {
-  return;
   std::string db_name = "disk_test.db";
+  remove(db_name.c_str());
   DiskManager *disk_mgr = new DiskManager(db_name);
   int extent_nums = 2;
   for (uint32_t i = 0; i < DiskManager::BITMAP_SIZE * extent_nums; i++) {
@@ -58,4 +58,44 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
-}
\ No newline at end of file
+}
+
+TEST(DiskManagerTest, ReadWriteSyncTest) {
+  std::string db_name = "disk_test.db";
+  remove(db_name.c_str());
+  char buf[PAGE_SIZE];
+  char data[PAGE_SIZE];
+  {
+    DiskManager disk_mgr(db_name);
+    // pages that were never written read back as zeros
+    memset(buf, 1, PAGE_SIZE);
+    disk_mgr.ReadPage(10, buf);
+    for (char c : buf) {
+      ASSERT_EQ(0, c);
+    }
+    for (int i = 0; i < 20; i++) {
+      ASSERT_EQ(i, disk_mgr.AllocatePage());
+      memset(data, i + 1, PAGE_SIZE);
+      disk_mgr.WritePage(i, data);
+    }
+    disk_mgr.DeAllocatePage(5);
+    disk_mgr.ReadPage(7, buf);
+    memset(data, 8, PAGE_SIZE);
+    ASSERT_EQ(0, memcmp(buf, data, PAGE_SIZE));
+    disk_mgr.Sync();
+  }
+  // data and allocation meta survive a reopen
+  DiskManager disk_mgr(db_name);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr.GetMetaData());
+  EXPECT_EQ(19, meta_page->GetAllocatedPages());
+  EXPECT_EQ(1, meta_page->GetExtentNums());
+  for (int i = 0; i < 20; i++) {
+    disk_mgr.ReadPage(i, buf);
+    memset(data, i + 1, PAGE_SIZE);
+    ASSERT_EQ(0, memcmp(buf, data, PAGE_SIZE));
+    ASSERT_EQ(i == 5, disk_mgr.IsPageFree(i));
+  }
+  EXPECT_EQ(5, disk_mgr.AllocatePage());
+  disk_mgr.Close();
+  remove(db_name.c_str());
+}
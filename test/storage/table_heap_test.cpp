@@ -54,3 +54,146 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   }
 }
 
+
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 2000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // free the first page, later inserts should reuse it instead of growing the tail
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  ASSERT_EQ(first_page_id, rids[0].GetPageId());
+  ASSERT_NE(first_page_id, rids.back().GetPageId());
+  int freed = 0;
+  for (auto &rid : rids) {
+    if (rid.GetPageId() != first_page_id) break;
+    ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+    table_heap->ApplyDelete(rid, nullptr);
+    freed++;
+  }
+  // reopen the heap from its pages, the map is read back from disk
+  TableHeap *reopened = TableHeap::Create(engine.bpm_, first_page_id, table_heap->GetFirstFreeSpaceMapPageId(),
+                                          schema.get(), nullptr, nullptr, &heap);
+  // fill the tail page first, then the freed page must be picked up
+  int reused = 0;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, row_nums + i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(reopened->InsertTuple(row, nullptr));
+    if (row.GetRowId().GetPageId() == first_page_id) reused++;
+  }
+  // the page keeps its empty slots, and an insert still reserves room for one more slot header
+  ASSERT_GE(reused, freed - 1);
+  ASSERT_LE(reused, freed);
+  // a heap without a map builds one from its page chain
+  TableHeap *rebuilt = TableHeap::Create(engine.bpm_, first_page_id, INVALID_PAGE_ID, schema.get(), nullptr, nullptr,
+                                         &heap);
+  ASSERT_NE(INVALID_PAGE_ID, rebuilt->GetFirstFreeSpaceMapPageId());
+  int count = 0;
+  for (auto iter = rebuilt->Begin(nullptr); iter != rebuilt->End(); iter++) {
+    count++;
+  }
+  ASSERT_EQ(2 * row_nums - freed, count);
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(TableHeapTest, ReadAheadScanTest) {
+  // a pool much smaller than the heap, so the scan keeps evicting and reading pages back
+  DBStorageEngine engine(db_file_name, true, 32);
+  SimpleMemHeap heap;
+  const int row_nums = 10000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  for (uint32_t window : {0u, DEFAULT_PREFETCH_WINDOW, 64u}) {
+    engine.bpm_->SetPrefetchWindow(window);
+    int count = 0;
+    for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); iter++) {
+      ASSERT_EQ(CmpBool::kTrue, iter->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+      count++;
+    }
+    ASSERT_EQ(row_nums, count);
+    ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  }
+}
+
+TEST(TableHeapTest, TableIteratorTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  const int row_nums = 20000;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 32, true),
+                  Field(TypeId::kTypeFloat, 1.5f)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  // empty the first page, Begin() has to skip it
+  int deleted = 0;
+  for (auto &rid : rids) {
+    if (rid.GetPageId() != table_heap->GetFirstPageId()) break;
+    ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+    table_heap->ApplyDelete(rid, nullptr);
+    deleted++;
+  }
+  int count = deleted;
+  {
+    auto iter = table_heap->Begin(nullptr);
+    for (; iter != table_heap->End(); ++iter) {
+      ASSERT_EQ(rids[count].Get(), iter->GetRowId().Get());
+      ASSERT_EQ(CmpBool::kTrue, (*iter).GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+      ASSERT_EQ(3, iter->GetFieldCount());
+      count++;
+    }
+    ASSERT_EQ(row_nums, count);
+    // an iterator which reached the end holds no page
+    ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  }
+  {
+    // copies pin the page on their own, and release it when destroyed
+    auto iter = table_heap->Begin(nullptr);
+    auto copy = iter;
+    ++iter;
+    ASSERT_EQ(rids[deleted].Get(), copy->GetRowId().Get());
+    ASSERT_EQ(rids[deleted + 1].Get(), iter->GetRowId().Get());
+    copy = iter;
+    ASSERT_TRUE(copy == iter);
+    copy = table_heap->End();
+    ASSERT_TRUE(copy == table_heap->End());
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
@@ -0,0 +1,184 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "transaction/lock_manager.h"
+
+static void Sleep() { std::this_thread::sleep_for(std::chrono::milliseconds(100)); }
+
+TEST(LockManagerTest, SharedTest) {
+  LockManager lock_mgr(false);
+  Transaction txn0(0), txn1(1);
+  RowId rid(1, 0);
+  ASSERT_TRUE(lock_mgr.LockRow(&txn0, LockMode::kShared, 0, rid));
+  ASSERT_TRUE(lock_mgr.LockRow(&txn1, LockMode::kShared, 0, rid));
+  // a row lock comes with an intention lock on its table
+  ASSERT_EQ(LockMode::kIntentionShared, txn0.GetTableLocks().at(0));
+  ASSERT_EQ(LockMode::kShared, txn1.GetRowLocks().at(rid.Get()));
+  lock_mgr.ReleaseAll(&txn0);
+  lock_mgr.ReleaseAll(&txn1);
+  ASSERT_TRUE(txn0.GetRowLocks().empty());
+  ASSERT_TRUE(txn0.GetTableLocks().empty());
+}
+
+TEST(LockManagerTest, ExclusiveTest) {
+  LockManager lock_mgr(false);
+  Transaction txn0(0), txn1(1);
+  RowId rid(1, 0);
+  ASSERT_TRUE(lock_mgr.LockRow(&txn0, LockMode::kExclusive, 0, rid));
+  std::atomic<bool> granted{false};
+  std::thread reader([&] {
+    EXPECT_TRUE(lock_mgr.LockRow(&txn1, LockMode::kShared, 0, rid));
+    granted = true;
+  });
+  Sleep();
+  ASSERT_FALSE(granted);
+  lock_mgr.ReleaseAll(&txn0);
+  reader.join();
+  ASSERT_TRUE(granted);
+  lock_mgr.ReleaseAll(&txn1);
+}
+
+TEST(LockManagerTest, UpgradeTest) {
+  LockManager lock_mgr(false);
+  Transaction txn0(0), txn1(1), txn2(2);
+  RowId rid(1, 0);
+  ASSERT_TRUE(lock_mgr.LockRow(&txn0, LockMode::kShared, 0, rid));
+  ASSERT_TRUE(lock_mgr.LockRow(&txn1, LockMode::kShared, 0, rid));
+  std::atomic<bool> upgraded{false}, granted{false};
+  std::thread upgrader([&] {
+    EXPECT_TRUE(lock_mgr.LockRow(&txn0, LockMode::kExclusive, 0, rid));
+    upgraded = true;
+  });
+  Sleep();
+  std::thread reader([&] {
+    EXPECT_TRUE(lock_mgr.LockRow(&txn2, LockMode::kShared, 0, rid));
+    granted = true;
+  });
+  Sleep();
+  ASSERT_FALSE(upgraded);
+  // a second upgrade of the same lock could never be granted
+  ASSERT_FALSE(lock_mgr.LockRow(&txn1, LockMode::kExclusive, 0, rid));
+  ASSERT_EQ(TxnState::kAborted, txn1.GetState());
+  ASSERT_FALSE(upgraded);
+  lock_mgr.ReleaseAll(&txn1);
+  upgrader.join();
+  ASSERT_TRUE(upgraded);
+  ASSERT_EQ(LockMode::kExclusive, txn0.GetRowLocks().at(rid.Get()));
+  ASSERT_EQ(LockMode::kIntentionExclusive, txn0.GetTableLocks().at(0));
+  // the upgrade went before the reader waiting
+  ASSERT_FALSE(granted);
+  lock_mgr.ReleaseAll(&txn0);
+  reader.join();
+  ASSERT_TRUE(granted);
+  lock_mgr.ReleaseAll(&txn2);
+}
+
+TEST(LockManagerTest, TableTest) {
+  LockManager lock_mgr(false);
+  Transaction txn0(0), txn1(1), txn2(2);
+  // writers of different rows share the table
+  ASSERT_TRUE(lock_mgr.LockRow(&txn0, LockMode::kExclusive, 0, RowId(1, 0)));
+  ASSERT_TRUE(lock_mgr.LockRow(&txn1, LockMode::kExclusive, 0, RowId(1, 1)));
+  ASSERT_TRUE(lock_mgr.LockTable(&txn2, LockMode::kIntentionShared, 0));
+  // a scan waits for them
+  std::atomic<bool> granted{false};
+  std::thread scanner([&] {
+    EXPECT_TRUE(lock_mgr.LockTable(&txn2, LockMode::kShared, 0));
+    granted = true;
+  });
+  Sleep();
+  ASSERT_FALSE(granted);
+  lock_mgr.ReleaseAll(&txn0);
+  Sleep();
+  ASSERT_FALSE(granted);
+  lock_mgr.ReleaseAll(&txn1);
+  scanner.join();
+  ASSERT_TRUE(granted);
+  // and covers the rows it reads
+  ASSERT_TRUE(lock_mgr.LockRow(&txn2, LockMode::kShared, 0, RowId(1, 0)));
+  ASSERT_TRUE(txn2.GetRowLocks().empty());
+  // IX and S make SIX
+  ASSERT_TRUE(lock_mgr.LockTable(&txn2, LockMode::kIntentionExclusive, 0));
+  ASSERT_EQ(LockMode::kSharedIntentionExclusive, txn2.GetTableLocks().at(0));
+  ASSERT_TRUE(LockManager::Compatible(LockMode::kSharedIntentionExclusive, LockMode::kIntentionShared));
+  ASSERT_FALSE(LockManager::Compatible(LockMode::kSharedIntentionExclusive, LockMode::kIntentionExclusive));
+  lock_mgr.ReleaseAll(&txn2);
+}
+
+TEST(LockManagerTest, DeadlockTest) {
+  LockManager lock_mgr(false);
+  Transaction txn0(0), txn1(1);
+  RowId rid0(1, 0), rid1(1, 1);
+  ASSERT_TRUE(lock_mgr.LockRow(&txn0, LockMode::kExclusive, 0, rid0));
+  ASSERT_TRUE(lock_mgr.LockRow(&txn1, LockMode::kExclusive, 0, rid1));
+  std::atomic<bool> granted{false};
+  std::thread older([&] {
+    EXPECT_TRUE(lock_mgr.LockRow(&txn0, LockMode::kExclusive, 0, rid1));
+    granted = true;
+  });
+  Sleep();
+  ASSERT_EQ(0u, lock_mgr.DetectDeadlocks());
+  std::thread younger([&] { EXPECT_FALSE(lock_mgr.LockRow(&txn1, LockMode::kExclusive, 0, rid0)); });
+  Sleep();
+  // the youngest transaction is aborted, the other gets its lock once that one is rolled back
+  ASSERT_EQ(1u, lock_mgr.DetectDeadlocks());
+  younger.join();
+  ASSERT_EQ(TxnState::kAborted, txn1.GetState());
+  ASSERT_EQ(TxnState::kGrowing, txn0.GetState());
+  ASSERT_FALSE(granted);
+  lock_mgr.ReleaseAll(&txn1);
+  older.join();
+  ASSERT_TRUE(granted);
+  lock_mgr.ReleaseAll(&txn0);
+}
+
+TEST(LockManagerTest, QueuedDeadlockTest) {
+  LockManager lock_mgr(false);
+  Transaction txn1(1), txn2(2), txn3(3);
+  ASSERT_TRUE(lock_mgr.LockTable(&txn1, LockMode::kShared, 0));
+  ASSERT_TRUE(lock_mgr.LockTable(&txn3, LockMode::kExclusive, 1));
+  // txn2 waits for txn1, txn3 queues behind txn2 although IS goes with the S txn1 holds
+  std::thread writer([&] { EXPECT_TRUE(lock_mgr.LockTable(&txn2, LockMode::kIntentionExclusive, 0)); });
+  Sleep();
+  std::atomic<bool> granted{false};
+  std::thread reader([&] {
+    EXPECT_FALSE(lock_mgr.LockTable(&txn3, LockMode::kIntentionShared, 0));
+    granted = true;
+  });
+  Sleep();
+  ASSERT_FALSE(granted);
+  ASSERT_EQ(0u, lock_mgr.DetectDeadlocks());
+  // txn1 waits for txn3, which waits for txn2 only through the queue
+  std::thread older([&] { EXPECT_TRUE(lock_mgr.LockTable(&txn1, LockMode::kShared, 1)); });
+  Sleep();
+  ASSERT_EQ(1u, lock_mgr.DetectDeadlocks());
+  reader.join();
+  ASSERT_EQ(TxnState::kAborted, txn3.GetState());
+  lock_mgr.ReleaseAll(&txn3);
+  older.join();
+  lock_mgr.ReleaseAll(&txn1);
+  writer.join();
+  ASSERT_EQ(TxnState::kGrowing, txn2.GetState());
+  lock_mgr.ReleaseAll(&txn2);
+}
+
+TEST(LockManagerTest, DetectionThreadTest) {
+  LockManager lock_mgr;
+  Transaction txn0(0), txn1(1);
+  RowId rid0(1, 0), rid1(1, 1);
+  ASSERT_TRUE(lock_mgr.LockRow(&txn0, LockMode::kShared, 0, rid0));
+  ASSERT_TRUE(lock_mgr.LockRow(&txn1, LockMode::kShared, 0, rid1));
+  // each writes the row the other reads, the detector breaks the cycle on its own
+  std::thread older([&] { EXPECT_TRUE(lock_mgr.LockRow(&txn0, LockMode::kExclusive, 0, rid1)); });
+  std::thread younger([&] {
+    EXPECT_FALSE(lock_mgr.LockRow(&txn1, LockMode::kExclusive, 0, rid0));
+    lock_mgr.ReleaseAll(&txn1);
+  });
+  younger.join();
+  older.join();
+  ASSERT_EQ(TxnState::kAborted, txn1.GetState());
+  ASSERT_EQ(LockMode::kExclusive, txn0.GetRowLocks().at(rid1.Get()));
+  lock_mgr.ReleaseAll(&txn0);
+}
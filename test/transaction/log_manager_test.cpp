@@ -0,0 +1,87 @@
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "transaction/log_manager.h"
+
+static const std::string log_name = "log_manager_test.log";
+
+TEST(LogManagerTest, GroupCommitTest) {
+  remove(log_name.c_str());
+  const int thread_count = 8;
+  const int commit_count = 50;
+  LogManager log_manager(log_name);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < thread_count; i++) {
+    threads.emplace_back([&log_manager, i]() {
+      for (int j = 0; j < commit_count; j++) {
+        LogRecord record(i, INVALID_LSN, LogRecordType::kCommit);
+        lsn_t lsn = log_manager.AppendLogRecord(record);
+        log_manager.Flush(lsn);
+        ASSERT_LE(lsn, log_manager.GetPersistentLSN());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(thread_count * commit_count + 1, log_manager.GetNextLSN());
+  // commits waiting together share a sync
+  LOG(INFO) << thread_count * commit_count << " commits in " << log_manager.GetSyncCount() << " syncs";
+  ASSERT_LT(log_manager.GetSyncCount(), static_cast<uint64_t>(thread_count * commit_count));
+  remove(log_name.c_str());
+}
+
+TEST(LogManagerTest, ReopenTest) {
+  remove(log_name.c_str());
+  const int record_count = 1000;
+  char data[PAGE_SIZE];
+  for (int i = 0; i < PAGE_SIZE; i++) {
+    data[i] = static_cast<char>(i * 7);
+  }
+  {
+    LogManager log_manager(log_name);
+    for (int i = 0; i < record_count; i++) {
+      LogRecord record(LogRecordType::kPageWrite);
+      record.AddPage(i, i % 2 == 0, false);
+      // runs stay clear of the LSN slot, which redo overwrites
+      uint32_t offset = 8 + i % 4000;
+      record.AddRun(offset, data, (i * 13) % (PAGE_SIZE - offset));
+      ASSERT_EQ(i + 1, log_manager.AppendLogRecord(record));
+    }
+  }
+  // half a record left by a crash while writing
+  FILE *file = fopen(log_name.c_str(), "ab");
+  fwrite(data, 1, 100, file);
+  fclose(file);
+  {
+    LogManager log_manager(log_name);
+    ASSERT_EQ(record_count, log_manager.GetPersistentLSN());
+    LogRecord record(0, INVALID_LSN, LogRecordType::kCommit);
+    ASSERT_EQ(record_count + 1, log_manager.AppendLogRecord(record));
+  }
+  LogManager log_manager(log_name);
+  int i = 0;
+  log_manager.ReadLog(0, [&](const LogRecord &record, uint64_t) {
+    EXPECT_EQ(i + 1, record.GetLSN());
+    if (i == record_count) {
+      EXPECT_EQ(LogRecordType::kCommit, record.GetType());
+    } else {
+      char page[PAGE_SIZE];
+      memset(page, 0, PAGE_SIZE);
+      record.ApplyTo(0, page);
+      EXPECT_EQ(LogRecordType::kPageWrite, record.GetType());
+      EXPECT_EQ(1u, record.GetPageCount());
+      EXPECT_EQ(i, record.GetPageId(0));
+      EXPECT_EQ(i % 2 == 0, record.HasLSNSlot(0));
+      uint32_t offset = 8 + i % 4000;
+      EXPECT_EQ(0, memcmp(page + offset, data, (i * 13) % (PAGE_SIZE - offset)));
+    }
+    i++;
+    return true;
+  });
+  ASSERT_EQ(record_count + 1, i);
+  remove(log_name.c_str());
+}
@@ -0,0 +1,199 @@
+#include <fstream>
+#include <set>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "recovery_test.db";
+static const std::string crash_name = "recovery_test_crash.db";
+
+/**
+ * Take the files of a running database as a crash would leave them
+ */
+static void Crash(DBStorageEngine *engine) {
+  engine->log_mgr_->Flush();
+  for (const char *suffix : {"", ".log"}) {
+    std::ifstream in(db_name + suffix, std::ios::binary);
+    std::ofstream out(crash_name + suffix, std::ios::binary | std::ios::trunc);
+    out << in.rdbuf();
+  }
+}
+
+/**
+ * Create table t(id, name) with an index on id, {schema} has to outlive the table
+ */
+static void CreateTable(DBStorageEngine *engine, SimpleMemHeap &heap, std::shared_ptr<Schema> &schema,
+                        TableInfo *&table_info, IndexInfo *&index_info) {
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  schema = std::make_shared<Schema>(columns);
+  ASSERT_EQ(DB_SUCCESS, engine->catalog_mgr_->CreateTable("t", schema.get(), nullptr, table_info));
+  ASSERT_EQ(DB_SUCCESS, engine->catalog_mgr_->CreateIndex("t", "t_id", {"id"}, nullptr, index_info));
+}
+
+/**
+ * Insert rows {from} to {to} - 1 with their index entries in {txn}
+ */
+static void InsertRows(TableInfo *table_info, IndexInfo *index_info, int from, int to, Transaction *txn) {
+  for (int i = from; i < to; i++) {
+    std::string name = "row-" + std::to_string(i);
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, txn));
+    std::vector<Field> key_fields{Field(TypeId::kTypeInt, i)};
+    Row key(key_fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(key, row.GetRowId(), txn));
+  }
+}
+
+/**
+ * Check the table holds exactly the rows with ids in {ids}, each reachable through the index
+ */
+static void CheckRows(DBStorageEngine *engine, const std::set<int> &ids) {
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, engine->catalog_mgr_->GetTable("t", table_info));
+  ASSERT_EQ(DB_SUCCESS, engine->catalog_mgr_->GetIndex("t", "t_id", index_info));
+  std::set<int> found;
+  auto *table_heap = table_info->GetTableHeap();
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+    int id = std::stoi(it->GetField(0)->GetString());
+    ASSERT_TRUE(found.insert(id).second);
+    ASSERT_EQ("row-" + std::to_string(id), it->GetField(1)->GetString());
+  }
+  ASSERT_EQ(ids, found);
+  for (int id = 0; id <= *ids.rbegin() + 100; id++) {
+    std::vector<Field> key_fields{Field(TypeId::kTypeInt, id)};
+    Row key(key_fields);
+    std::vector<RowId> rids;
+    index_info->GetIndex()->ScanKey(key, rids, nullptr);
+    ASSERT_EQ(ids.count(id), rids.size());
+  }
+}
+
+static std::set<int> Range(int from, int to) {
+  std::set<int> ids;
+  for (int i = from; i < to; i++) {
+    ids.insert(i);
+  }
+  return ids;
+}
+
+static void RemoveFiles() {
+  for (const std::string &name : {db_name, crash_name}) {
+    remove(name.c_str());
+    remove((name + ".log").c_str());
+  }
+}
+
+TEST(RecoveryTest, CommittedRowsSurviveTest) {
+  SimpleMemHeap heap;
+  std::shared_ptr<Schema> schema;
+  auto *engine = new DBStorageEngine(db_name, true, 16);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  CreateTable(engine, heap, schema, table_info, index_info);
+  Transaction *txn = engine->txn_mgr_->Begin();
+  InsertRows(table_info, index_info, 0, 2000, txn);
+  engine->txn_mgr_->Commit(txn);
+  Crash(engine);
+  auto *recovered = new DBStorageEngine(crash_name, false, 16);
+  CheckRows(recovered, Range(0, 2000));
+  delete recovered;
+  // the recovered database is consistent on disk as well
+  recovered = new DBStorageEngine(crash_name, false, 16);
+  CheckRows(recovered, Range(0, 2000));
+  delete recovered;
+  delete engine;
+  RemoveFiles();
+}
+
+TEST(RecoveryTest, UncommittedChangesUndoneTest) {
+  SimpleMemHeap heap;
+  std::shared_ptr<Schema> schema;
+  auto *engine = new DBStorageEngine(db_name, true, 16);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  CreateTable(engine, heap, schema, table_info, index_info);
+  Transaction *txn = engine->txn_mgr_->Begin();
+  InsertRows(table_info, index_info, 0, 1000, txn);
+  engine->txn_mgr_->Commit(txn);
+  // a loser inserts, deletes and updates, and some of its pages are written back before the crash
+  txn = engine->txn_mgr_->Begin();
+  InsertRows(table_info, index_info, 1000, 1500, txn);
+  auto *table_heap = table_info->GetTableHeap();
+  int count = 0;
+  for (auto it = table_heap->Begin(nullptr); it != table_heap->End() && count < 100; ++it) {
+    int id = std::stoi(it->GetField(0)->GetString());
+    if (id >= 1000 || id % 3 != 0) {
+      continue;
+    }
+    count++;
+    RowId rid = it->GetRowId();
+    if (id % 2 == 0) {
+      ASSERT_TRUE(table_heap->MarkDelete(rid, txn));
+      table_heap->ApplyDelete(rid, txn);
+    } else {
+      std::vector<Field> fields{
+              Field(TypeId::kTypeInt, id),
+              Field(TypeId::kTypeChar, const_cast<char *>("changed"), 7, true)
+      };
+      Row row(fields);
+      ASSERT_TRUE(table_heap->UpdateTuple(row, rid, txn));
+    }
+  }
+  Crash(engine);
+  auto *recovered = new DBStorageEngine(crash_name, false, 16);
+  CheckRows(recovered, Range(0, 1000));
+  // the loser stays rolled back when the database is opened again
+  delete recovered;
+  recovered = new DBStorageEngine(crash_name, false, 16);
+  CheckRows(recovered, Range(0, 1000));
+  // and the next transaction ids do not collide with the log
+  Transaction *next = recovered->txn_mgr_->Begin();
+  ASSERT_GT(next->GetTxnId(), txn->GetTxnId());
+  recovered->txn_mgr_->Commit(next);
+  delete recovered;
+  engine->txn_mgr_->Commit(txn);
+  delete engine;
+  RemoveFiles();
+}
+
+TEST(RecoveryTest, CheckpointTest) {
+  SimpleMemHeap heap;
+  std::shared_ptr<Schema> schema;
+  auto *engine = new DBStorageEngine(db_name, true, 16);
+  TableInfo *table_info = nullptr;
+  IndexInfo *index_info = nullptr;
+  CreateTable(engine, heap, schema, table_info, index_info);
+  Transaction *txn = engine->txn_mgr_->Begin();
+  InsertRows(table_info, index_info, 0, 1000, txn);
+  engine->txn_mgr_->Commit(txn);
+  // a transaction running across the checkpoints still gets rolled back
+  Transaction *loser = engine->txn_mgr_->Begin();
+  InsertRows(table_info, index_info, 1000, 1100, loser);
+  engine->checkpoint_mgr_->Checkpoint();
+  engine->checkpoint_mgr_->Checkpoint();
+  uint64_t checkpoint_offset = engine->disk_mgr_->GetCheckpointOffset();
+  ASSERT_GT(checkpoint_offset, 0u);
+  txn = engine->txn_mgr_->Begin();
+  InsertRows(table_info, index_info, 2000, 2500, txn);
+  engine->txn_mgr_->Commit(txn);
+  Crash(engine);
+  auto *recovered = new DBStorageEngine(crash_name, false, 16);
+  std::set<int> ids = Range(0, 1000);
+  for (int id : Range(2000, 2500)) {
+    ids.insert(id);
+  }
+  CheckRows(recovered, ids);
+  delete recovered;
+  engine->txn_mgr_->Commit(loser);
+  delete engine;
+  RemoveFiles();
+}
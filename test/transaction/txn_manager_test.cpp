@@ -0,0 +1,216 @@
+#include <fstream>
+#include <map>
+#include <set>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "txn_manager_test.db";
+
+class TxnManagerTest : public testing::Test {
+protected:
+  void SetUp() override {
+    engine_ = new DBStorageEngine(db_name, true, 32);
+    std::vector<Column *> columns = {
+            ALLOC_COLUMN(heap_)("id", TypeId::kTypeInt, 0, false, false),
+            ALLOC_COLUMN(heap_)("name", TypeId::kTypeChar, 16, 1, true, false)
+    };
+    schema_ = std::make_shared<Schema>(columns);
+    ASSERT_EQ(DB_SUCCESS, engine_->catalog_mgr_->CreateTable("t", schema_.get(), nullptr, table_info_));
+    ASSERT_EQ(DB_SUCCESS, engine_->catalog_mgr_->CreateIndex("t", "t_id", {"id"}, nullptr, index_info_));
+  }
+
+  void TearDown() override {
+    delete engine_;
+    remove(db_name.c_str());
+    remove((db_name + ".log").c_str());
+  }
+
+  void Insert(int id, const std::string &name, Transaction *txn, RowId *rid = nullptr) {
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, id),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_info_->GetTableHeap()->InsertTuple(row, txn));
+    ASSERT_EQ(DB_SUCCESS, index_info_->GetIndex()->InsertEntry(Key(id), row.GetRowId(), txn));
+    if (rid != nullptr) {
+      *rid = row.GetRowId();
+    }
+  }
+
+  void Delete(int id, const RowId &rid, Transaction *txn) {
+    ASSERT_TRUE(table_info_->GetTableHeap()->MarkDelete(rid, txn));
+    ASSERT_EQ(DB_SUCCESS, index_info_->GetIndex()->RemoveEntry(Key(id), rid, txn));
+    table_info_->GetTableHeap()->ApplyDelete(rid, txn);
+  }
+
+  static Row Key(int id) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id)};
+    return Row(fields);
+  }
+
+  /**
+   * @return name of every row by id, checking the index leads to each of them
+   */
+  std::map<int, std::string> Rows() {
+    std::map<int, std::string> rows;
+    auto *table_heap = table_info_->GetTableHeap();
+    for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); ++it) {
+      int id = std::stoi(it->GetField(0)->GetString());
+      rows[id] = it->GetField(1)->GetString();
+      std::vector<RowId> rids;
+      index_info_->GetIndex()->ScanKey(Key(id), rids, nullptr);
+      EXPECT_EQ(1u, rids.size());
+      EXPECT_EQ(it->GetRowId().Get(), rids.empty() ? INVALID_ROWID.Get() : rids[0].Get());
+    }
+    return rows;
+  }
+
+  size_t IndexSize(int max_id) {
+    size_t size = 0;
+    for (int id = 0; id <= max_id; id++) {
+      std::vector<RowId> rids;
+      index_info_->GetIndex()->ScanKey(Key(id), rids, nullptr);
+      size += rids.size();
+    }
+    return size;
+  }
+
+  SimpleMemHeap heap_;
+  std::shared_ptr<Schema> schema_;
+  DBStorageEngine *engine_{nullptr};
+  TableInfo *table_info_{nullptr};
+  IndexInfo *index_info_{nullptr};
+};
+
+TEST_F(TxnManagerTest, CommitTest) {
+  RowId rids[10];
+  Transaction *txn = engine_->txn_mgr_->Begin();
+  for (int i = 0; i < 10; i++) {
+    Insert(i, "row" + std::to_string(i), txn, &rids[i]);
+  }
+  engine_->txn_mgr_->Commit(txn);
+  // a deleted tuple is only marked until the commit
+  txn = engine_->txn_mgr_->Begin();
+  Delete(3, rids[3], txn);
+  std::string data;
+  auto *page = reinterpret_cast<TablePage *>(engine_->bpm_->FetchPage(rids[3].GetPageId()));
+  ASSERT_TRUE(page->GetTupleData(rids[3], data));
+  engine_->bpm_->UnpinPage(rids[3].GetPageId(), false);
+  ASSERT_EQ(9u, Rows().size());
+  engine_->txn_mgr_->Commit(txn);
+  page = reinterpret_cast<TablePage *>(engine_->bpm_->FetchPage(rids[3].GetPageId()));
+  ASSERT_FALSE(page->GetTupleData(rids[3], data));
+  engine_->bpm_->UnpinPage(rids[3].GetPageId(), false);
+  auto rows = Rows();
+  ASSERT_EQ(9u, rows.size());
+  ASSERT_EQ(0u, rows.count(3));
+}
+
+TEST_F(TxnManagerTest, AbortTest) {
+  RowId rids[20];
+  Transaction *txn = engine_->txn_mgr_->Begin();
+  for (int i = 0; i < 10; i++) {
+    Insert(i, "row" + std::to_string(i), txn, &rids[i]);
+  }
+  engine_->txn_mgr_->Commit(txn);
+  auto before = Rows();
+  // insert, delete and update in one transaction, then roll all of it back
+  txn = engine_->txn_mgr_->Begin();
+  for (int i = 10; i < 20; i++) {
+    Insert(i, "new" + std::to_string(i), txn, &rids[i]);
+  }
+  Delete(2, rids[2], txn);
+  Delete(15, rids[15], txn);
+  std::vector<Field> fields{
+          Field(TypeId::kTypeInt, 5),
+          Field(TypeId::kTypeChar, const_cast<char *>("changed"), 7, true)
+  };
+  Row row(fields);
+  ASSERT_TRUE(table_info_->GetTableHeap()->UpdateTuple(row, rids[5], txn));
+  ASSERT_EQ(18u, Rows().size());
+  // a heap and an index change per insert and delete, the deletes are not applied yet
+  ASSERT_EQ(25u, txn->GetWriteSet().size());
+  engine_->txn_mgr_->Abort(txn);
+  ASSERT_EQ(before, Rows());
+  ASSERT_EQ(10u, IndexSize(20));
+  // the rows rolled back can be inserted again
+  txn = engine_->txn_mgr_->Begin();
+  Insert(10, "again", txn);
+  engine_->txn_mgr_->Commit(txn);
+  ASSERT_EQ(11u, Rows().size());
+}
+
+TEST_F(TxnManagerTest, AbortRecoveryTest) {
+  Transaction *txn = engine_->txn_mgr_->Begin();
+  for (int i = 0; i < 10; i++) {
+    Insert(i, "row" + std::to_string(i), txn);
+  }
+  engine_->txn_mgr_->Abort(txn);
+  txn = engine_->txn_mgr_->Begin();
+  Insert(100, "kept", txn);
+  engine_->txn_mgr_->Commit(txn);
+  // the compensation records keep the recovery from undoing the rollback a second time
+  engine_->log_mgr_->Flush();
+  std::string crash_name = "txn_manager_test_crash.db";
+  for (const char *suffix : {"", ".log"}) {
+    std::ifstream in(db_name + suffix, std::ios::binary);
+    std::ofstream out(crash_name + suffix, std::ios::binary | std::ios::trunc);
+    out << in.rdbuf();
+  }
+  auto *recovered = new DBStorageEngine(crash_name, false, 32);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, recovered->catalog_mgr_->GetTable("t", table_info));
+  std::set<int> ids;
+  for (auto it = table_info->GetTableHeap()->Begin(nullptr); it != table_info->GetTableHeap()->End(); ++it) {
+    ids.insert(std::stoi(it->GetField(0)->GetString()));
+  }
+  ASSERT_EQ(std::set<int>{100}, ids);
+  delete recovered;
+  remove(crash_name.c_str());
+  remove((crash_name + ".log").c_str());
+}
+
+TEST_F(TxnManagerTest, UpdateRollbackTest) {
+  RowId rid;
+  const std::string name(16, 'a');
+  Transaction *txn = engine_->txn_mgr_->Begin();
+  Insert(0, name, txn, &rid);
+  engine_->txn_mgr_->Commit(txn);
+  auto free_space = [&]() {
+    auto *page = reinterpret_cast<TablePage *>(engine_->bpm_->FetchPage(rid.GetPageId()));
+    uint32_t free = page->GetFreeSpaceRemaining();
+    engine_->bpm_->UnpinPage(rid.GetPageId(), false);
+    return free;
+  };
+  auto update = [&](const char *new_name, Transaction *txn) {
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, 0),
+            Field(TypeId::kTypeChar, const_cast<char *>(new_name), strlen(new_name), true)
+    };
+    Row row(fields);
+    return table_info_->GetTableHeap()->UpdateTuple(row, rid, txn);
+  };
+  // the bytes freed by shrinking updates stay with the transaction, other rows fill up the rest of the page
+  uint32_t before = free_space();
+  txn = engine_->txn_mgr_->Begin();
+  ASSERT_TRUE(update("bbbb", txn));
+  ASSERT_TRUE(update("b", txn));
+  ASSERT_EQ(before, free_space());
+  int id = 1;
+  while (table_info_->GetTableHeap()->GetPageIds().size() == 1) {
+    Insert(id++, "x", nullptr);
+  }
+  engine_->txn_mgr_->Abort(txn);
+  ASSERT_EQ(name, Rows()[0]);
+  // a commit gives the bytes back
+  txn = engine_->txn_mgr_->Begin();
+  ASSERT_TRUE(update("b", txn));
+  before = free_space();
+  engine_->txn_mgr_->Commit(txn);
+  ASSERT_LT(before, free_space());
+  ASSERT_EQ("b", Rows()[0]);
+  ASSERT_EQ(static_cast<size_t>(id), Rows().size());
+}
@@ -0,0 +1,156 @@
+#include <map>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "utils/utils.h"
+
+static const std::string db_name = "version_store_test.db";
+
+class VersionStoreTest : public testing::Test {
+protected:
+  void SetUp() override {
+    engine_ = new DBStorageEngine(db_name, true, 64);
+    std::vector<Column *> columns = {
+            ALLOC_COLUMN(heap_)("id", TypeId::kTypeInt, 0, false, false),
+            ALLOC_COLUMN(heap_)("name", TypeId::kTypeChar, 32, 1, true, false)
+    };
+    schema_ = std::make_shared<Schema>(columns);
+    ASSERT_EQ(DB_SUCCESS, engine_->catalog_mgr_->CreateTable("t", schema_.get(), nullptr, table_info_));
+    table_heap_ = table_info_->GetTableHeap();
+    Transaction *txn = engine_->txn_mgr_->Begin();
+    for (int i = 0; i < 1000; i++) {
+      Row row = MakeRow(i, "row" + std::to_string(i));
+      ASSERT_TRUE(table_heap_->InsertTuple(row, txn));
+      rids_.push_back(row.GetRowId());
+    }
+    engine_->txn_mgr_->Commit(txn);
+  }
+
+  void TearDown() override {
+    delete engine_;
+    remove(db_name.c_str());
+    remove((db_name + ".log").c_str());
+  }
+
+  /**
+   * Rows are updated with names of the same length, the pages are full
+   */
+  static Row MakeRow(int id, const std::string &name) {
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, id),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)
+    };
+    return Row(fields);
+  }
+
+  /**
+   * @return name of every row by id, as {txn} sees them
+   */
+  std::map<int, std::string> Scan(Transaction *txn) {
+    std::map<int, std::string> rows;
+    for (auto it = table_heap_->Begin(txn); it != table_heap_->End(); ++it) {
+      rows[std::stoi(it->GetField(0)->GetString())] = it->GetField(1)->GetString();
+    }
+    return rows;
+  }
+
+  SimpleMemHeap heap_;
+  std::shared_ptr<Schema> schema_;
+  DBStorageEngine *engine_{nullptr};
+  TableInfo *table_info_{nullptr};
+  TableHeap *table_heap_{nullptr};
+  std::vector<RowId> rids_;
+};
+
+TEST_F(VersionStoreTest, SnapshotReadTest) {
+  Transaction *reader = engine_->txn_mgr_->Begin();
+  auto before = Scan(reader);
+  ASSERT_EQ(1000u, before.size());
+  // a scan is halfway through while a writer changes rows on both sides of it, without waiting for it
+  auto it = table_heap_->Begin(reader);
+  for (int i = 0; i < 500; i++) {
+    ++it;
+  }
+  Transaction *writer = engine_->txn_mgr_->Begin();
+  Row updated = MakeRow(5, "new5");
+  ASSERT_TRUE(table_heap_->UpdateTuple(updated, rids_[5], writer));
+  Row updated_late = MakeRow(900, "new900");
+  ASSERT_TRUE(table_heap_->UpdateTuple(updated_late, rids_[900], writer));
+  ASSERT_TRUE(table_heap_->MarkDelete(rids_[3], writer));
+  ASSERT_TRUE(table_heap_->MarkDelete(rids_[950], writer));
+  Row inserted = MakeRow(1000, "new");
+  ASSERT_TRUE(table_heap_->InsertTuple(inserted, writer));
+  // the writer reads its own changes, the reader does not see them
+  auto changed = Scan(writer);
+  ASSERT_EQ(999u, changed.size());
+  ASSERT_EQ("new5", changed[5]);
+  ASSERT_EQ(before, Scan(reader));
+  engine_->txn_mgr_->Commit(writer);
+  ASSERT_EQ(before, Scan(reader));
+  int count = 500;
+  for (; it != table_heap_->End(); ++it) {
+    ASSERT_EQ(before[std::stoi(it->GetField(0)->GetString())], it->GetField(1)->GetString());
+    count++;
+  }
+  ASSERT_EQ(1000, count);
+  Row row(rids_[5]);
+  ASSERT_TRUE(table_heap_->GetTuple(&row, reader));
+  ASSERT_EQ("row5", row.GetField(1)->GetString());
+  Row deleted(rids_[3]);
+  ASSERT_TRUE(table_heap_->GetTuple(&deleted, reader));
+  Row new_row(inserted.GetRowId());
+  ASSERT_FALSE(table_heap_->GetTuple(&new_row, reader));
+  // a transaction beginning now sees the commit
+  Transaction *later = engine_->txn_mgr_->Begin();
+  ASSERT_EQ(changed, Scan(later));
+  engine_->txn_mgr_->Commit(later);
+  engine_->txn_mgr_->Commit(reader);
+}
+
+TEST_F(VersionStoreTest, WriteConflictTest) {
+  Transaction *txn0 = engine_->txn_mgr_->Begin();
+  Transaction *txn1 = engine_->txn_mgr_->Begin();
+  Row row0 = MakeRow(1, "one1");
+  ASSERT_TRUE(table_heap_->UpdateTuple(row0, rids_[1], txn0));
+  engine_->txn_mgr_->Commit(txn0);
+  // txn1 began before the commit, its update would overwrite a change it never saw
+  Row row1 = MakeRow(1, "two1");
+  ASSERT_FALSE(table_heap_->UpdateTuple(row1, rids_[1], txn1));
+  ASSERT_EQ(TxnState::kAborted, txn1->GetState());
+  engine_->txn_mgr_->Abort(txn1);
+  // a row nobody changed meanwhile can be written
+  Transaction *txn2 = engine_->txn_mgr_->Begin();
+  Transaction *txn3 = engine_->txn_mgr_->Begin();
+  ASSERT_TRUE(table_heap_->UpdateTuple(row1, rids_[1], txn2));
+  engine_->txn_mgr_->Commit(txn2);
+  ASSERT_TRUE(table_heap_->MarkDelete(rids_[2], txn3));
+  engine_->txn_mgr_->Commit(txn3);
+  auto rows = Scan(nullptr);
+  ASSERT_EQ("two1", rows[1]);
+  ASSERT_EQ(0u, rows.count(2));
+}
+
+TEST_F(VersionStoreTest, GarbageCollectionTest) {
+  ASSERT_EQ(0u, engine_->version_store_->GetVersionCount());
+  Transaction *reader = engine_->txn_mgr_->Begin();
+  for (int i = 0; i < 10; i++) {
+    Transaction *writer = engine_->txn_mgr_->Begin();
+    Row row = MakeRow(i, "new" + std::to_string(i));
+    ASSERT_TRUE(table_heap_->UpdateTuple(row, rids_[i], writer));
+    engine_->txn_mgr_->Commit(writer);
+  }
+  // the reader may still need the first version of every row
+  ASSERT_EQ(10u, engine_->version_store_->GetVersionCount());
+  ASSERT_EQ("row7", Scan(reader)[7]);
+  // a rollback leaves no version behind
+  Transaction *aborted = engine_->txn_mgr_->Begin();
+  Row row = MakeRow(20, "gone");
+  ASSERT_TRUE(table_heap_->UpdateTuple(row, rids_[20], aborted));
+  ASSERT_EQ(11u, engine_->version_store_->GetVersionCount());
+  engine_->txn_mgr_->Abort(aborted);
+  ASSERT_EQ(10u, engine_->version_store_->GetVersionCount());
+  // once the oldest snapshot is gone nobody needs them
+  engine_->txn_mgr_->Commit(reader);
+  ASSERT_EQ(0u, engine_->version_store_->GetVersionCount());
+  ASSERT_EQ("new7", Scan(nullptr)[7]);
+}
@@ -0,0 +1,43 @@
+#include <random>
+
+#include "gtest/gtest.h"
+#include "utils/external_sorter.h"
+
+struct SortItem {
+  int key;
+  int value;
+};
+
+static void SortAndCheck(size_t memory_limit, int n, size_t expect_runs) {
+  auto less = [](const SortItem &a, const SortItem &b) { return a.key < b.key; };
+  ExternalSorter<SortItem, decltype(less)> sorter(less, memory_limit);
+  std::mt19937 random(n);
+  std::vector<int> keys(n);
+  for (int i = 0; i < n; i++) {
+    keys[i] = i;
+  }
+  std::shuffle(keys.begin(), keys.end(), random);
+  for (int key : keys) {
+    ASSERT_TRUE(sorter.Add(SortItem{key, -key}));
+  }
+  ASSERT_TRUE(sorter.Sort());
+  ASSERT_EQ(static_cast<size_t>(n), sorter.GetCount());
+  ASSERT_EQ(expect_runs, sorter.GetRunCount());
+  SortItem item;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(sorter.Next(item));
+    ASSERT_EQ(i, item.key);
+    ASSERT_EQ(-i, item.value);
+  }
+  ASSERT_FALSE(sorter.Next(item));
+}
+
+TEST(ExternalSorterTest, SortTest) {
+  // in memory
+  SortAndCheck(1 << 20, 10000, 0);
+  // 1000 items per run, the last run is partly filled
+  SortAndCheck(1000 * sizeof(SortItem), 10500, 11);
+  // one item per run
+  SortAndCheck(1, 50, 50);
+  SortAndCheck(1 << 20, 0, 0);
+}
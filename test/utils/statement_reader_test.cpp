@@ -0,0 +1,63 @@
+#include <cstdio>
+
+#include "gtest/gtest.h"
+#include "utils/statement_reader.h"
+
+static const std::string script = "create database db0;\n"
+                                  "  insert into t values(1, \"a;b\", \"say \\\"hi;\\\"\");\r\n\n"
+                                  "select * from t where name = \";\";select * from t;\n"
+                                  "quit";
+
+static const std::vector<std::string> expect_statements = {
+        "create database db0;",
+        "insert into t values(1, \"a;b\", \"say \\\"hi;\\\"\");",
+        "select * from t where name = \";\";",
+        "select * from t;",
+        "quit"};
+
+static void ReadAll(StatementReader &reader) {
+  std::string statement;
+  for (auto &expect : expect_statements) {
+    ASSERT_TRUE(reader.Next(statement));
+    ASSERT_EQ(expect, statement);
+  }
+  ASSERT_FALSE(reader.Next(statement));
+  ASSERT_FALSE(reader.Next(statement));
+}
+
+TEST(StatementReaderTest, SplitTest) {
+  // in memory
+  StatementReader text_reader(script);
+  ReadAll(text_reader);
+  // stream
+  FILE *fp = tmpfile();
+  ASSERT_NE(nullptr, fp);
+  fwrite(script.data(), 1, script.size(), fp);
+  rewind(fp);
+  StatementReader stream_reader(fp);
+  ReadAll(stream_reader);
+  fclose(fp);
+  // mapped file, longer than any fixed statement buffer
+  const std::string file_name = "statement_reader_test.sql";
+  std::string long_value(10000, 'x');
+  fp = fopen(file_name.c_str(), "w");
+  ASSERT_NE(nullptr, fp);
+  fprintf(fp, "%s\ninsert into t values(\"%s\");\n", script.c_str(), long_value.c_str());
+  fclose(fp);
+  StatementReader file_reader;
+  ASSERT_TRUE(file_reader.Open(file_name));
+  std::string statement;
+  for (size_t i = 0; i + 1 < expect_statements.size(); i++) {
+    ASSERT_TRUE(file_reader.Next(statement));
+    ASSERT_EQ(expect_statements[i], statement);
+  }
+  ASSERT_TRUE(file_reader.Next(statement));
+  ASSERT_EQ("quit\ninsert into t values(\"" + long_value + "\");", statement);
+  ASSERT_FALSE(file_reader.Next(statement));
+  remove(file_name.c_str());
+  // empty input
+  StatementReader empty_reader("  \n\t");
+  ASSERT_FALSE(empty_reader.Next(statement));
+  StatementReader missing_reader;
+  ASSERT_FALSE(missing_reader.Open("no_such_script.sql"));
+}